@@ -0,0 +1,173 @@
+#include "Tests.h"
+#include "TestHarness.h"
+#include "TestAnimation.h"
+#include "AnimationLod.h"
+#include "ClipCompressor.h"
+#include "ClipSampler.h"
+#include "MatrixPalette.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <vector>
+
+namespace
+{
+
+// Bones the demo's LOD levels skip (see OffBrandChewy.cc)
+const std::vector<std::string> DETAIL_BONES = { "Thumb", "Index", "Middle", "Ring", "Pinky", "Eye", "HeadTop" };
+
+// Playback and palettes of one character, updated the way MixamoCharacter::Update does
+struct CrowdMember
+{
+public:
+	float Time;
+	float TimeSinceEvaluation;
+	float EvaluationGap;
+	std::vector<BoneAnimation::Cursor> Cursors;
+	std::vector<Matrix3x4> PreviousPalette;
+	std::vector<Matrix3x4> EvaluatedPalette;
+	std::vector<Matrix3x4> Palette;
+
+	explicit CrowdMember(std::uint32_t numBones)
+		: Time(0.f)
+		, TimeSinceEvaluation(0.f)
+		, EvaluationGap(0.f)
+		, Cursors(numBones)
+		, PreviousPalette(numBones)
+		, EvaluatedPalette(numBones)
+		, Palette(numBones)
+	{}
+};
+
+float GetTranslationDistance(const Matrix3x4& a, const Matrix3x4& b)
+{
+	float dx = a.m[0u][3u] - b.m[0u][3u];
+	float dy = a.m[1u][3u] - b.m[1u][3u];
+	float dz = a.m[2u][3u] - b.m[2u][3u];
+	return sqrtf(dx * dx + dy * dy + dz * dz);
+}
+
+}
+
+void TestBoneMaskSkipsDetailBones()
+{
+	Skeleton skeleton = BuildTestSkeleton();
+	std::vector<std::uint8_t> mask = BuildBoneMask(skeleton, DETAIL_BONES);
+
+	CHECK(mask.size() == skeleton.GetBoneCount());
+	for (std::uint32_t boneIdx = 0u; boneIdx < skeleton.GetBoneCount(); boneIdx++)
+	{
+		const std::string& name = skeleton.GetBone(boneIdx).Name;
+		bool isDetail = false;
+		for (const std::string& part : DETAIL_BONES)
+		{
+			isDetail = isDetail || name.find(part) != std::string::npos;
+		}
+		CHECK((mask[boneIdx] != 0u) == !isDetail);
+	}
+}
+
+void BenchmarkCrowdLodError()
+{
+	const std::uint32_t NUM_CHARACTERS = 200u;
+	const std::uint32_t NUM_FRAMES = 600u;
+	const std::uint32_t WARMUP_FRAMES = 10u;
+	const std::uint32_t MEASURED_CHARACTER_STRIDE = 17u;
+	const float dt = 1.f / 60.f;
+
+	Skeleton skeleton = BuildTestSkeleton();
+	std::uint32_t numBones = skeleton.GetBoneCount();
+	std::shared_ptr<AnimationClip> clip = BuildTestClip(skeleton, 4.f, 121u);
+	ClipCompressionStats compressionStats;
+	std::shared_ptr<CompressedClip> compressedClip = CompressClip(*clip, skeleton, ClipCompressionOptions(0.01f, 3.f), compressionStats);
+	std::vector<std::uint8_t> mask = BuildBoneMask(skeleton, DETAIL_BONES);
+
+	std::uint32_t numSampled = 0u;
+	for (std::uint8_t isSampled : mask)
+	{
+		numSampled += (isSampled != 0u) ? 1u : 0u;
+	}
+	printf("%u characters of %u bones (%u sampled when masked), %u frames\n", NUM_CHARACTERS, numBones, numSampled, NUM_FRAMES);
+
+	struct LodConfig
+	{
+	public:
+		std::uint32_t UpdateInterval;
+		bool IsMasked;
+	};
+	const LodConfig configs[] = { { 1u, false }, { 1u, true }, { 2u, true }, { 4u, true } };
+
+	// Error is how far each bone is from where a full evaluation every frame puts it
+	Pose pose(numBones);
+	Pose referencePose(numBones);
+	std::vector<Matrix3x4> referencePalette(numBones);
+	for (const LodConfig& config : configs)
+	{
+		std::vector<CrowdMember> crowd(NUM_CHARACTERS, CrowdMember(numBones));
+		const std::uint8_t* boneMask = config.IsMasked ? &mask[0] : nullptr;
+
+		double updateMs = 0.;
+		double errorSum = 0.;
+		float maxError = 0.f;
+		std::uint32_t numErrors = 0u;
+		for (std::uint32_t frameIdx = 0u; frameIdx < NUM_FRAMES; frameIdx++)
+		{
+			Stopwatch stopwatch;
+			for (std::uint32_t characterIdx = 0u; characterIdx < NUM_CHARACTERS; characterIdx++)
+			{
+				CrowdMember& member = crowd[characterIdx];
+				float previousTime = member.Time;
+				member.Time = fmodf((float)(frameIdx + 1u) * dt + 0.37f * (float)characterIdx, compressedClip->GetDuration());
+				member.TimeSinceEvaluation += dt;
+
+				// Restarting the clip or starting out evaluates straight away, and doesn't blend
+				bool isRestarted = frameIdx == 0u || member.Time < previousTime;
+				if (isRestarted || config.UpdateInterval == 1u || (frameIdx + characterIdx) % config.UpdateInterval == 0u)
+				{
+					member.PreviousPalette.swap(member.EvaluatedPalette);
+					SampleClip(*compressedClip, member.Time, &member.Cursors[0], &skeleton, boneMask, pose);
+					skeleton.GetModelPose(pose);
+					BuildMatrixPalette(pose, &member.EvaluatedPalette[0]);
+					if (isRestarted)
+					{
+						member.PreviousPalette = member.EvaluatedPalette;
+					}
+					member.EvaluationGap = member.TimeSinceEvaluation;
+					member.TimeSinceEvaluation = 0.f;
+				}
+
+				if (config.UpdateInterval == 1u)
+				{
+					member.Palette = member.EvaluatedPalette;
+				}
+				else
+				{
+					float ratio = (member.EvaluationGap > 0.f) ? std::min(member.TimeSinceEvaluation / member.EvaluationGap, 1.f) : 1.f;
+					LerpMatrixPalette(&member.PreviousPalette[0], &member.EvaluatedPalette[0], ratio, numBones, &member.Palette[0]);
+				}
+			}
+			updateMs += stopwatch.GetMilliseconds();
+
+			if (frameIdx < WARMUP_FRAMES)
+			{
+				continue;
+			}
+			for (std::uint32_t characterIdx = 0u; characterIdx < NUM_CHARACTERS; characterIdx += MEASURED_CHARACTER_STRIDE)
+			{
+				SampleClip(*compressedClip, crowd[characterIdx].Time, referencePose);
+				skeleton.GetModelPose(referencePose);
+				BuildMatrixPalette(referencePose, &referencePalette[0]);
+				for (std::uint32_t boneIdx = 0u; boneIdx < numBones; boneIdx++)
+				{
+					float error = GetTranslationDistance(crowd[characterIdx].Palette[boneIdx], referencePalette[boneIdx]);
+					errorSum += error;
+					maxError = std::max(maxError, error);
+					numErrors++;
+				}
+			}
+		}
+
+		printf("interval %u, %s: %.3f ms/frame, bone error mean %.3f max %.3f\n", config.UpdateInterval, config.IsMasked ? "masked" : "all bones",
+			updateMs / NUM_FRAMES, errorSum / numErrors, maxError);
+	}
+}
\ No newline at end of file
@@ -0,0 +1,122 @@
+#include "Tests.h"
+#include "TestHarness.h"
+#include "TestAnimation.h"
+#include "BlendTree.h"
+#include <cmath>
+#include <memory>
+#include <vector>
+
+namespace
+{
+
+const float WEIGHT_TOLERANCE = 1e-5f;
+
+// A blend node's weighted children, as clip node to weight
+struct ExpectedWeight
+{
+public:
+	std::uint32_t Child;
+	float Weight;
+};
+
+// The weighted children must be exactly the expected ones, in any order, and sum to 1
+bool AreWeightsExpected(const BlendTree& tree, std::uint32_t nodeIdx, const BlendTree::State& state, const std::vector<ExpectedWeight>& expected)
+{
+	std::uint32_t children[BlendTree::MAX_WEIGHTED_CHILDREN];
+	float weights[BlendTree::MAX_WEIGHTED_CHILDREN];
+	std::uint32_t numChildren = tree.GetWeightedChildren(tree.GetNode(nodeIdx), state, children, weights);
+	if (numChildren != expected.size())
+	{
+		return false;
+	}
+
+	float totalWeight = 0.f;
+	for (std::uint32_t i = 0u; i < numChildren; i++)
+	{
+		bool isFound = false;
+		for (const ExpectedWeight& expectedWeight : expected)
+		{
+			isFound = isFound || (children[i] == expectedWeight.Child && fabsf(weights[i] - expectedWeight.Weight) <= WEIGHT_TOLERANCE);
+		}
+		if (!isFound || weights[i] <= 0.f)
+		{
+			return false;
+		}
+		totalWeight += weights[i];
+	}
+	return fabsf(totalWeight - 1.f) <= WEIGHT_TOLERANCE;
+}
+
+}
+
+void TestBlendSpaceWeights()
+{
+	Skeleton skeleton = BuildTestSkeleton();
+	std::vector<std::shared_ptr<ResampledClip>> clips;
+	for (std::uint32_t clipIdx = 0u; clipIdx < 6u; clipIdx++)
+	{
+		ResampleStats stats;
+		clips.push_back(ResampledClip::Create(*BuildTestClip(skeleton, 1.f + clipIdx, 10u), ResampledClip::DEFAULT_SAMPLE_RATE, stats));
+	}
+
+	BlendTree tree(skeleton.GetBoneCount());
+	std::vector<std::uint32_t> clipNodes;
+	for (const std::shared_ptr<ResampledClip>& clip : clips)
+	{
+		clipNodes.push_back(tree.AddClip(*clip, BlendTree::INVALID_INDEX));
+	}
+
+	// Three clips along one axis, unevenly spaced
+	std::uint32_t speed = tree.AddParameter(0.f);
+	std::uint32_t blend1D = tree.AddBlend1D({ clipNodes[0u], clipNodes[1u], clipNodes[2u] }, { 0.f, 1.f, 3.f }, speed);
+
+	// Three columns by two rows, children in row order
+	std::uint32_t x = tree.AddParameter(0.f);
+	std::uint32_t y = tree.AddParameter(0.f);
+	std::uint32_t blend2D = tree.AddBlend2D(clipNodes, { 0.f, 1.f, 2.f }, { 0.f, 2.f }, x, y);
+
+	BlendTree::State state = tree.CreateState();
+
+	// Beyond either end gives that end, points between two clips split by distance, and points
+	//  on a clip give it alone
+	struct Case1D { float Speed; std::vector<ExpectedWeight> Expected; };
+	const Case1D cases1D[] = {
+		{ -1.f, { { clipNodes[0u], 1.f } } },
+		{ 0.f, { { clipNodes[0u], 1.f } } },
+		{ 0.25f, { { clipNodes[0u], 0.75f }, { clipNodes[1u], 0.25f } } },
+		{ 1.f, { { clipNodes[1u], 1.f } } },
+		{ 2.5f, { { clipNodes[1u], 0.25f }, { clipNodes[2u], 0.75f } } },
+		{ 3.f, { { clipNodes[2u], 1.f } } },
+		{ 10.f, { { clipNodes[2u], 1.f } } },
+	};
+	for (const Case1D& testCase : cases1D)
+	{
+		state.Parameters[speed] = testCase.Speed;
+		CHECK(AreWeightsExpected(tree, blend1D, state, testCase.Expected));
+	}
+
+	// Bilinear between the four clips around the point, fewer on grid lines and outside the grid
+	struct Case2D { float X; float Y; std::vector<ExpectedWeight> Expected; };
+	const Case2D cases2D[] = {
+		{ 0.25f, 0.5f, { { clipNodes[0u], 0.5625f }, { clipNodes[1u], 0.1875f }, { clipNodes[3u], 0.1875f }, { clipNodes[4u], 0.0625f } } },
+		{ 1.5f, 1.f, { { clipNodes[1u], 0.25f }, { clipNodes[2u], 0.25f }, { clipNodes[4u], 0.25f }, { clipNodes[5u], 0.25f } } },
+		{ 1.f, 1.5f, { { clipNodes[1u], 0.25f }, { clipNodes[4u], 0.75f } } },
+		{ 0.5f, 2.f, { { clipNodes[3u], 0.5f }, { clipNodes[4u], 0.5f } } },
+		{ 2.f, 0.f, { { clipNodes[2u], 1.f } } },
+		{ -3.f, 5.f, { { clipNodes[3u], 1.f } } },
+		{ 5.f, 1.f, { { clipNodes[2u], 0.5f }, { clipNodes[5u], 0.5f } } },
+	};
+	for (const Case2D& testCase : cases2D)
+	{
+		state.Parameters[x] = testCase.X;
+		state.Parameters[y] = testCase.Y;
+		CHECK(AreWeightsExpected(tree, blend2D, state, testCase.Expected));
+	}
+
+	// Blend spaces cycle at the weighted duration of their clips - halfway between clips of
+	//  1 and 2 seconds is a 1.5 second cycle
+	state = tree.CreateState();
+	state.Parameters[speed] = 0.5f;
+	tree.Advance(state, 0.3f);
+	CHECK(fabsf(state.Phases[blend1D] - 0.2f) <= WEIGHT_TOLERANCE);
+}
\ No newline at end of file
@@ -0,0 +1,109 @@
+#include "Tests.h"
+#include "TestHarness.h"
+#include "BoneAnimation.h"
+#include <cmath>
+#include <cstdio>
+#include <vector>
+
+namespace
+{
+
+// Keys at 30 per second over ten minutes, in every channel
+const std::uint32_t LONG_TRACK_KEYS = 18000u;
+const float LONG_TRACK_KEY_RATE = 30.f;
+const std::uint32_t PLAYBACK_FRAMES = 600u;
+const float PLAYBACK_DT = 1.f / 60.f;
+
+// Sampling as it was before cursors - every channel scanned forward from its first key
+template <typename KeyframeType, typename ValueType>
+ValueType SampleChannelLinear(const std::vector<KeyframeType>& keys, float time, ValueType KeyframeType::*value)
+{
+	if (keys.size() == 1u || time <= keys.front().Time)
+	{
+		return keys.front().*value;
+	}
+	else if (time >= keys.back().Time)
+	{
+		return keys.back().*value;
+	}
+
+	std::uint32_t idx = 0u;
+	while (idx < keys.size() - 1u && keys[idx + 1u].Time <= time)
+	{
+		idx++;
+	}
+	return KeyframeType::LERP(keys[idx], keys[idx + 1u], time);
+}
+
+Transform GetTransformAtTimeLinear(const BoneAnimation& animation, float time)
+{
+	return Transform(
+		SampleChannelLinear(animation.GetPositionKeyframes(), time, &PositionKeyframe::Translation),
+		SampleChannelLinear(animation.GetRotationKeyframes(), time, &RotationKeyframe::Rotation),
+		SampleChannelLinear(animation.GetScaleKeyframes(), time, &ScaleKeyframe::Scale));
+}
+
+BoneAnimation BuildLongBoneAnimation()
+{
+	std::vector<PositionKeyframe> positions;
+	std::vector<RotationKeyframe> rotations;
+	std::vector<ScaleKeyframe> scales;
+	for (std::uint32_t keyIdx = 0u; keyIdx < LONG_TRACK_KEYS; keyIdx++)
+	{
+		float time = (float)keyIdx / LONG_TRACK_KEY_RATE;
+		positions.push_back(PositionKeyframe(time, Vec3(sinf(time), cosf(time * 0.5f), time)));
+		rotations.push_back(RotationKeyframe(time, Quaternion(Vec3(0.3f, 0.9f, 0.1f).Normal(), 0.5f * sinf(time))));
+		scales.push_back(ScaleKeyframe(time, Vec3(1.f, 1.f, 1.f) * (1.f + 0.1f * sinf(time * 2.f))));
+	}
+	return BoneAnimation(positions, rotations, scales);
+}
+
+// Sums a component of every sample, so none of them can be optimized away
+float SumSample(const Transform& transform)
+{
+	return transform.Pos.x + transform.Rotation.w + transform.Scale.y;
+}
+
+}
+
+void BenchmarkCursorSampling()
+{
+	BoneAnimation animation = BuildLongBoneAnimation();
+	float duration = (float)(LONG_TRACK_KEYS - 1u) / LONG_TRACK_KEY_RATE;
+	printf("%u keys per channel, %u frames of forward playback from each start time\n", LONG_TRACK_KEYS, PLAYBACK_FRAMES);
+
+	// The linear scan costs more the further into the track playback is, the binary search
+	//  and the cursor should not
+	const float startRatios[] = { 0.01f, 0.5f, 0.98f };
+	const char* const startNames[] = { "early", "middle", "late" };
+	for (std::uint32_t startIdx = 0u; startIdx < 3u; startIdx++)
+	{
+		float startTime = duration * startRatios[startIdx];
+		float sum = 0.f;
+
+		Stopwatch linearStopwatch;
+		for (std::uint32_t frameIdx = 0u; frameIdx < PLAYBACK_FRAMES; frameIdx++)
+		{
+			sum += SumSample(GetTransformAtTimeLinear(animation, startTime + frameIdx * PLAYBACK_DT));
+		}
+		double linearMs = linearStopwatch.GetMilliseconds();
+
+		Stopwatch searchStopwatch;
+		for (std::uint32_t frameIdx = 0u; frameIdx < PLAYBACK_FRAMES; frameIdx++)
+		{
+			sum += SumSample(animation.GetTransformAtTime(startTime + frameIdx * PLAYBACK_DT));
+		}
+		double searchMs = searchStopwatch.GetMilliseconds();
+
+		BoneAnimation::Cursor cursor;
+		Stopwatch cursorStopwatch;
+		for (std::uint32_t frameIdx = 0u; frameIdx < PLAYBACK_FRAMES; frameIdx++)
+		{
+			sum += SumSample(animation.GetTransformAtTime(startTime + frameIdx * PLAYBACK_DT, cursor));
+		}
+		double cursorMs = cursorStopwatch.GetMilliseconds();
+
+		printf("%s (%.0f s): linear scan %.1f ns, binary search %.1f ns, cursor %.1f ns per sample (checksum %.1f)\n", startNames[startIdx], startTime,
+			linearMs * 1e6 / PLAYBACK_FRAMES, searchMs * 1e6 / PLAYBACK_FRAMES, cursorMs * 1e6 / PLAYBACK_FRAMES, sum);
+	}
+}
\ No newline at end of file
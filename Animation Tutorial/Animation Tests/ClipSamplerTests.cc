@@ -0,0 +1,327 @@
+#include "Tests.h"
+#include "TestHarness.h"
+#include "TestAnimation.h"
+#include "ClipCompressor.h"
+#include "ClipSampler.h"
+#include "AnimationLod.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <vector>
+
+namespace
+{
+
+const float SAMPLE_TOLERANCE = 1e-4f;
+
+// Decodes the keys either side of the time one at a time with CompressedClip's own decoding,
+//  and interpolates them the way RotationKeyframe::LERP does, after putting them on the
+//  shorter arc
+void SampleCompressedReference(const CompressedClip& clip, float time, std::uint32_t boneIdx, float* outComponents)
+{
+	float keyTime = std::max(time, 0.f) * clip.GetTimeScale();
+	const CompressedClip::Track* tracks[3] = { &clip.GetPositionTrack(boneIdx), &clip.GetRotationTrack(boneIdx), &clip.GetScaleTrack(boneIdx) };
+	const std::uint16_t* times[3] = { clip.GetPositionTimes(), clip.GetRotationTimes(), clip.GetScaleTimes() };
+	const CompressedClip::Key* keys[3] = { clip.GetPositionKeys(), clip.GetRotationKeys(), clip.GetScaleKeys() };
+	const std::uint32_t firstComponents[3] = { (std::uint32_t)POSE_STREAM::POS_X, (std::uint32_t)POSE_STREAM::ROT_X, (std::uint32_t)POSE_STREAM::SCALE_X };
+
+	for (std::uint32_t channel = 0u; channel < 3u; channel++)
+	{
+		const CompressedClip::Track& track = *tracks[channel];
+		std::uint32_t keyIdx = 0u;
+		float ratio = 0.f;
+		bool interpolate = CompressedClip::FindKeys(times[channel] + track.FirstKey, track.NumKeys, keyTime, keyIdx, ratio);
+		const CompressedClip::Key& from = keys[channel][track.FirstKey + keyIdx];
+		const CompressedClip::Key& to = keys[channel][track.FirstKey + keyIdx + (interpolate ? 1u : 0u)];
+		ratio = interpolate ? ratio : 0.f;
+
+		float fromValues[4];
+		float toValues[4];
+		std::uint32_t nComponents = (channel == 1u) ? 4u : 3u;
+		if (channel == 1u)
+		{
+			CompressedClip::DequantizeRotation(from, fromValues);
+			CompressedClip::DequantizeRotation(to, toValues);
+			float dot = fromValues[0u] * toValues[0u] + fromValues[1u] * toValues[1u] + fromValues[2u] * toValues[2u] + fromValues[3u] * toValues[3u];
+			for (std::uint32_t c = 0u; c < 4u; c++)
+			{
+				toValues[c] = (dot < 0.f) ? -toValues[c] : toValues[c];
+			}
+		}
+		else
+		{
+			CompressedClip::DequantizeVector(from, track, fromValues);
+			CompressedClip::DequantizeVector(to, track, toValues);
+		}
+
+		float lengthSq = 0.f;
+		float* out = outComponents + firstComponents[channel];
+		for (std::uint32_t c = 0u; c < nComponents; c++)
+		{
+			out[c] = fromValues[c] + (toValues[c] - fromValues[c]) * ratio;
+			lengthSq += out[c] * out[c];
+		}
+		for (std::uint32_t c = 0u; c < nComponents && channel == 1u; c++)
+		{
+			out[c] /= sqrtf(lengthSq);
+		}
+	}
+}
+
+// Pose components of a transform, with the rotation normalized the way the sampler leaves
+//  it - RotationKeyframe::LERP does not normalize
+void GetComponents(const Transform& transform, float* outComponents)
+{
+	const Quaternion& q = transform.Rotation;
+	float invLength = 1.f / sqrtf(q.x * q.x + q.y * q.y + q.z * q.z + q.w * q.w);
+	const float components[(std::uint32_t)POSE_STREAM::COUNT] = {
+		transform.Pos.x, transform.Pos.y, transform.Pos.z,
+		q.x * invLength, q.y * invLength, q.z * invLength, q.w * invLength,
+		transform.Scale.x, transform.Scale.y, transform.Scale.z
+	};
+	std::copy(components, components + (std::uint32_t)POSE_STREAM::COUNT, outComponents);
+}
+
+bool IsPoseBoneNear(const Pose& pose, std::uint32_t boneIdx, const float* components, float tolerance)
+{
+	for (std::uint32_t c = 0u; c < (std::uint32_t)POSE_STREAM::COUNT; c++)
+	{
+		if (fabsf(pose.GetStream((POSE_STREAM)c)[boneIdx] - components[c]) > tolerance)
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+// Resampled clips need no cursors, and the crowd benchmark samples every format alike
+void SampleCrowdMember(const AnimationClip& clip, float time, BoneAnimation::Cursor* cursors, Pose& outLocalPose)
+{
+	SampleClip(clip, time, cursors, outLocalPose);
+}
+
+void SampleCrowdMember(const CompressedClip& clip, float time, BoneAnimation::Cursor* cursors, Pose& outLocalPose)
+{
+	SampleClip(clip, time, cursors, outLocalPose);
+}
+
+void SampleCrowdMember(const ResampledClip& clip, float time, BoneAnimation::Cursor*, Pose& outLocalPose)
+{
+	SampleClip(clip, time, outLocalPose);
+}
+
+const std::uint32_t BENCHMARK_CHARACTERS = 200u;
+const std::uint32_t BENCHMARK_FRAMES = 300u;
+const std::uint32_t BENCHMARK_RUNS = 8u;
+const float BENCHMARK_DT = 1.f / 60.f;
+
+// Playback of a crowd sampling one clip the way the demo does - every character a frame
+//  further through the clip than last time, at its own offset, with its own cursors
+template <typename ClipType>
+class CrowdSampling
+{
+public:
+	CrowdSampling(const ClipType& clip, std::uint32_t numBones)
+		: clip_(clip)
+		, cursors_(BENCHMARK_CHARACTERS, std::vector<BoneAnimation::Cursor>(numBones))
+		, pose_(numBones)
+		, bestNs_(0.)
+		, numRuns_(0u)
+	{}
+
+	// Plays the clip through once, keeping the best time per pose
+	void Run()
+	{
+		Stopwatch stopwatch;
+		for (std::uint32_t frameIdx = 0u; frameIdx < BENCHMARK_FRAMES; frameIdx++)
+		{
+			for (std::uint32_t characterIdx = 0u; characterIdx < BENCHMARK_CHARACTERS; characterIdx++)
+			{
+				float time = fmodf((float)frameIdx * BENCHMARK_DT + 0.37f * (float)characterIdx, clip_.GetDuration());
+				SampleCrowdMember(clip_, time, &cursors_[characterIdx][0], pose_);
+			}
+		}
+
+		double ns = stopwatch.GetMilliseconds() * 1e6 / ((double)BENCHMARK_FRAMES * BENCHMARK_CHARACTERS);
+		bestNs_ = (numRuns_ == 0u || ns < bestNs_) ? ns : bestNs_;
+		numRuns_++;
+	}
+
+	double GetBestNs() const { return bestNs_; }
+
+private:
+	const ClipType& clip_;
+	std::vector<std::vector<BoneAnimation::Cursor>> cursors_;
+	Pose pose_;
+	double bestNs_;
+	std::uint32_t numRuns_;
+};
+
+}
+
+void TestClipSamplingMatchesBoneAnimations()
+{
+	// Channels of every length, from constant to many keys, at uneven times that differ
+	//  between channels and bones, and some bones left static
+	const float DURATION = 3.f;
+	Skeleton skeleton = BuildTestSkeleton();
+	std::uint32_t numBones = skeleton.GetBoneCount();
+	std::vector<BoneAnimation> boneAnimations;
+	boneAnimations.reserve(numBones);
+	std::vector<const BoneAnimation*> boneAnimationPtrs(numBones, nullptr);
+	std::vector<float> times = { -0.5f, DURATION + 0.5f, DURATION + 20.f };
+	for (std::uint32_t boneIdx = 0u; boneIdx < numBones; boneIdx++)
+	{
+		const Transform& bind = skeleton.GetBone(boneIdx).FromParentTransform;
+		std::vector<PositionKeyframe> positions;
+		std::vector<RotationKeyframe> rotations;
+		std::vector<ScaleKeyframe> scales;
+		std::uint32_t numKeys[3] = { 1u + boneIdx % 4u, 2u + (boneIdx * 7u) % 23u, 1u + (boneIdx / 2u) % 3u };
+		for (std::uint32_t keyIdx = 0u; keyIdx < numKeys[0u]; keyIdx++)
+		{
+			float time = DURATION * sqrtf((float)keyIdx / (float)std::max(numKeys[0u] - 1u, 1u));
+			positions.push_back(PositionKeyframe(time, bind.Pos + Vec3(sinf(time * 3.f), cosf(time), time) * (float)(boneIdx % 3u)));
+			times.push_back(time);
+		}
+		for (std::uint32_t keyIdx = 0u; keyIdx < numKeys[1u]; keyIdx++)
+		{
+			float ratio = (float)keyIdx / (float)(numKeys[1u] - 1u);
+			float time = DURATION * ratio * ratio;
+			rotations.push_back(RotationKeyframe(time, Quaternion(Vec3(0.3f, 0.9f, 0.1f * boneIdx).Normal(), 0.6f * sinf(time * 2.f + (float)boneIdx))));
+			times.push_back(time);
+		}
+		for (std::uint32_t keyIdx = 0u; keyIdx < numKeys[2u]; keyIdx++)
+		{
+			float time = DURATION * (float)keyIdx / (float)std::max(numKeys[2u] - 1u, 1u);
+			scales.push_back(ScaleKeyframe(time, Vec3(1.f, 1.f, 1.f) + Vec3(0.2f, 0.1f, 0.3f) * (float)keyIdx));
+			times.push_back(time);
+		}
+
+		boneAnimations.push_back(BoneAnimation(positions, rotations, scales));
+		boneAnimationPtrs[boneIdx] = (boneIdx % 9u == 4u) ? nullptr : &boneAnimations.back();
+	}
+	std::shared_ptr<AnimationClip> clip = AnimationClip::Create(skeleton, boneAnimationPtrs, DURATION);
+
+	// On every key time, halfway to the next, and outside of the clip
+	std::sort(times.begin(), times.end());
+	for (std::uint32_t timeIdx = 0u, numKeyTimes = (std::uint32_t)times.size(); timeIdx + 1u < numKeyTimes; timeIdx++)
+	{
+		times.push_back(0.5f * (times[timeIdx] + times[timeIdx + 1u]));
+	}
+	std::sort(times.begin(), times.end());
+
+	// Played forward with cursors, like the per-bone path with its own, and without
+	Pose pose(numBones);
+	Pose cursorPose(numBones);
+	std::vector<BoneAnimation::Cursor> cursors(numBones);
+	std::vector<BoneAnimation::Cursor> referenceCursors(numBones);
+	float reference[(std::uint32_t)POSE_STREAM::COUNT];
+	for (float time : times)
+	{
+		SampleClip(*clip, time, pose);
+		SampleClip(*clip, time, &cursors[0], cursorPose);
+		for (std::uint32_t boneIdx = 0u; boneIdx < numBones; boneIdx++)
+		{
+			Transform transform = skeleton.GetBone(boneIdx).FromParentTransform;
+			if (boneAnimationPtrs[boneIdx] != nullptr)
+			{
+				GetComponents(boneAnimationPtrs[boneIdx]->GetTransformAtTime(time), reference);
+				CHECK(IsPoseBoneNear(pose, boneIdx, reference, SAMPLE_TOLERANCE));
+				transform = boneAnimationPtrs[boneIdx]->GetTransformAtTime(time, referenceCursors[boneIdx]);
+			}
+
+			GetComponents(transform, reference);
+			CHECK(IsPoseBoneNear(pose, boneIdx, reference, SAMPLE_TOLERANCE));
+			CHECK(IsPoseBoneNear(cursorPose, boneIdx, reference, SAMPLE_TOLERANCE));
+		}
+	}
+}
+
+void TestCompressedSamplingMatchesDecodedKeys()
+{
+	Skeleton skeleton = BuildTestSkeleton();
+	std::uint32_t numBones = skeleton.GetBoneCount();
+	std::shared_ptr<AnimationClip> clip = BuildTestClip(skeleton, 2.f, 61u);
+	ClipCompressionStats compressionStats;
+	std::shared_ptr<CompressedClip> compressedClip = CompressClip(*clip, skeleton, ClipCompressionOptions(0.01f, 3.f), compressionStats);
+	std::vector<std::uint8_t> mask = BuildBoneMask(skeleton, { "Hand", "Eye" });
+
+	// Before the start, on and between key times, and past the end. Times only move forward,
+	//  so the cursors step along the keys, and sometimes jump.
+	std::vector<float> times = { -0.5f, 0.f };
+	for (std::uint32_t step = 1u; step < 200u; step++)
+	{
+		times.push_back(step * ((step % 7u == 0u) ? 0.0333f : 0.0125f));
+	}
+
+	Pose pose(numBones);
+	Pose maskedPose(numBones);
+	std::vector<BoneAnimation::Cursor> cursors(numBones);
+	std::vector<BoneAnimation::Cursor> maskedCursors(numBones);
+	float reference[(std::uint32_t)POSE_STREAM::COUNT];
+	for (float time : times)
+	{
+		SampleClip(*compressedClip, time, &cursors[0], pose);
+		SampleClip(*compressedClip, time, &maskedCursors[0], &skeleton, &mask[0], maskedPose);
+		for (std::uint32_t boneIdx = 0u; boneIdx < numBones; boneIdx++)
+		{
+			SampleCompressedReference(*compressedClip, time, boneIdx, reference);
+			CHECK(IsPoseBoneNear(pose, boneIdx, reference, SAMPLE_TOLERANCE));
+
+			// Masked bones hold their bind transform, renormalized like any sample, and the rest
+			//  sample as usual
+			if (mask[boneIdx] != 0u)
+			{
+				CHECK(IsPoseBoneNear(maskedPose, boneIdx, reference, SAMPLE_TOLERANCE));
+			}
+			else
+			{
+				GetComponents(skeleton.GetBone(boneIdx).FromParentTransform, reference);
+				CHECK(IsPoseBoneNear(maskedPose, boneIdx, reference, SAMPLE_TOLERANCE));
+			}
+		}
+	}
+}
+
+void BenchmarkCompressedSampling()
+{
+	Skeleton skeleton = BuildTestSkeleton();
+	std::uint32_t numBones = skeleton.GetBoneCount();
+	std::shared_ptr<AnimationClip> clip = BuildTestClip(skeleton, 4.f, 121u);
+	ClipCompressionStats compressionStats;
+	std::shared_ptr<CompressedClip> compressedClip = CompressClip(*clip, skeleton, ClipCompressionOptions(0.01f, 3.f), compressionStats);
+
+	printf("%u characters of %u bones, %u frames, best of %u runs, clip of %u bytes raw and %u compressed\n", BENCHMARK_CHARACTERS, numBones, BENCHMARK_FRAMES, BENCHMARK_RUNS,
+		clip->GetSizeInBytes(), compressedClip->GetSizeInBytes());
+
+	// Runs take turns, so that anything else slowing the machine down hits both alike
+	CrowdSampling<AnimationClip> raw(*clip, numBones);
+	CrowdSampling<CompressedClip> compressed(*compressedClip, numBones);
+	for (std::uint32_t run = 0u; run < BENCHMARK_RUNS; run++)
+	{
+		raw.Run();
+		compressed.Run();
+	}
+	printf("raw %.0f ns/pose, compressed %.0f ns/pose (%.2fx raw)\n", raw.GetBestNs(), compressed.GetBestNs(), compressed.GetBestNs() / raw.GetBestNs());
+}
+
+void BenchmarkResampledSampling()
+{
+	Skeleton skeleton = BuildTestSkeleton();
+	std::uint32_t numBones = skeleton.GetBoneCount();
+	std::shared_ptr<AnimationClip> clip = BuildTestClip(skeleton, 4.f, 121u);
+	ResampleStats resampleStats;
+	std::shared_ptr<ResampledClip> resampledClip = ResampledClip::Create(*clip, ResampledClip::DEFAULT_SAMPLE_RATE, resampleStats);
+
+	printf("%u characters of %u bones, %u frames, best of %u runs, clip of %u bytes raw and %u resampled\n", BENCHMARK_CHARACTERS, numBones, BENCHMARK_FRAMES, BENCHMARK_RUNS,
+		clip->GetSizeInBytes(), resampledClip->GetSizeInBytes());
+
+	CrowdSampling<AnimationClip> raw(*clip, numBones);
+	CrowdSampling<ResampledClip> resampled(*resampledClip, numBones);
+	for (std::uint32_t run = 0u; run < BENCHMARK_RUNS; run++)
+	{
+		raw.Run();
+		resampled.Run();
+	}
+	printf("raw %.0f ns/pose, resampled %.0f ns/pose (%.2fx raw)\n", raw.GetBestNs(), resampled.GetBestNs(), resampled.GetBestNs() / raw.GetBestNs());
+}
\ No newline at end of file
@@ -0,0 +1,140 @@
+#include "Tests.h"
+#include "TestHarness.h"
+#include "ConstantRingAllocator.h"
+#include <deque>
+#include <random>
+#include <vector>
+
+namespace
+{
+
+// Offset and aligned size of an allocated slice
+struct Slice
+{
+public:
+	std::uint32_t Offset;
+	std::uint32_t Size;
+
+	Slice(std::uint32_t offset, std::uint32_t size)
+		: Offset(offset)
+		, Size(size)
+	{}
+};
+
+}
+
+void TestConstantRingAllocatorFillsRing()
+{
+	const std::uint32_t CAPACITY = 4u * ConstantRingAllocator::ALIGNMENT;
+	ConstantRingAllocator allocator(CAPACITY, 2u);
+
+	// Slices are rounded up to the alignment, and an empty ring holds its whole capacity
+	allocator.BeginFrame();
+	std::uint32_t offset = 0u;
+	std::uint32_t numSlices = 0u;
+	while (allocator.Allocate(64u, offset))
+	{
+		CHECK(offset == numSlices * ConstantRingAllocator::ALIGNMENT);
+		numSlices++;
+	}
+	CHECK(numSlices == 4u);
+	CHECK(allocator.GetUsedBytes() == CAPACITY);
+	allocator.EndFrame();
+
+	// Nothing fits until that frame is retired
+	allocator.BeginFrame();
+	CHECK(!allocator.Allocate(1u, offset));
+	allocator.EndFrame();
+	allocator.RetireFrame();
+	allocator.RetireFrame();
+	CHECK(allocator.GetFramesInFlight() == 0u);
+	CHECK(allocator.GetUsedBytes() == 0u);
+
+	// A slice that does not fit before the end of the ring wraps around to the start, once
+	//  the frame there is retired, and the space skipped at the end belongs to its frame
+	allocator.BeginFrame();
+	CHECK(allocator.Allocate(2u * ConstantRingAllocator::ALIGNMENT, offset) && offset == 0u);
+	allocator.EndFrame();
+	allocator.BeginFrame();
+	CHECK(allocator.Allocate(ConstantRingAllocator::ALIGNMENT, offset) && offset == 2u * ConstantRingAllocator::ALIGNMENT);
+	allocator.EndFrame();
+	allocator.RetireFrame();
+	allocator.BeginFrame();
+	CHECK(allocator.Allocate(2u * ConstantRingAllocator::ALIGNMENT, offset) && offset == 0u);
+	CHECK(allocator.GetUsedBytes() == CAPACITY);
+	allocator.EndFrame();
+	allocator.RetireFrame();
+	CHECK(allocator.GetUsedBytes() == 3u * ConstantRingAllocator::ALIGNMENT);
+
+	// Slices larger than the ring never fit
+	allocator.RetireFrame();
+	allocator.BeginFrame();
+	CHECK(!allocator.Allocate(CAPACITY + 1u, offset));
+	allocator.EndFrame();
+}
+
+void TestConstantRingAllocatorKeepsFramesApart()
+{
+	// Random rings and frames, checking that no slice overlaps one of a frame still in flight
+	std::mt19937 random(3u);
+	for (std::uint32_t trial = 0u; trial < 200u; trial++)
+	{
+		std::uint32_t capacity = (1u + random() % 64u) * ConstantRingAllocator::ALIGNMENT;
+		std::uint32_t maxFramesInFlight = 1u + random() % 4u;
+		ConstantRingAllocator allocator(capacity, maxFramesInFlight);
+		std::deque<std::vector<Slice>> frames;
+
+		for (std::uint32_t frameIdx = 0u; frameIdx < 60u; frameIdx++)
+		{
+			// Frames are retired as late as possible, or now and then sooner
+			while (allocator.GetFramesInFlight() == maxFramesInFlight || (allocator.GetFramesInFlight() > 0u && random() % 3u == 0u))
+			{
+				allocator.RetireFrame();
+				frames.pop_front();
+			}
+
+			allocator.BeginFrame();
+			frames.push_back(std::vector<Slice>());
+			std::uint32_t numAllocations = random() % 20u;
+			for (std::uint32_t allocationIdx = 0u; allocationIdx < numAllocations; allocationIdx++)
+			{
+				std::uint32_t size = 1u + random() % 700u;
+				std::uint32_t offset = 0u;
+				if (!allocator.Allocate(size, offset))
+				{
+					continue;
+				}
+
+				Slice slice(offset, ConstantRingAllocator::AlignSize(size));
+				CHECK(slice.Offset % ConstantRingAllocator::ALIGNMENT == 0u);
+				CHECK(slice.Offset + slice.Size <= capacity);
+				for (const std::vector<Slice>& frame : frames)
+				{
+					for (const Slice& other : frame)
+					{
+						CHECK(slice.Offset >= other.Offset + other.Size || other.Offset >= slice.Offset + slice.Size);
+					}
+				}
+				frames.back().push_back(slice);
+			}
+			allocator.EndFrame();
+
+			// Used bytes cover every live slice, along with any space skipped to wrap around
+			std::uint32_t liveBytes = 0u;
+			for (const std::vector<Slice>& frame : frames)
+			{
+				for (const Slice& slice : frame)
+				{
+					liveBytes += slice.Size;
+				}
+			}
+			CHECK(liveBytes <= allocator.GetUsedBytes() && allocator.GetUsedBytes() <= capacity);
+		}
+
+		while (allocator.GetFramesInFlight() > 0u)
+		{
+			allocator.RetireFrame();
+		}
+		CHECK(allocator.GetUsedBytes() == 0u);
+	}
+}
\ No newline at end of file
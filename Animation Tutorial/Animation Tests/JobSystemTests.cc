@@ -0,0 +1,174 @@
+#include "Tests.h"
+#include "TestHarness.h"
+#include "TestAnimation.h"
+#include "JobSystem.h"
+#include "SceneGraph.h"
+#include "ClipCompressor.h"
+#include "ClipSampler.h"
+#include "MatrixPalette.h"
+#include <atomic>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+namespace
+{
+
+const std::uint32_t TEST_THREADS = 4u;
+
+// Does the per-frame work of a MixamoCharacter without its meshes: samples a compressed clip,
+//  and builds the model pose and matrix palette
+class TestCharacter : public ISceneNode
+{
+public:
+	TestCharacter(const Skeleton& skeleton, const CompressedClip& clip, float startTime)
+		: ISceneNode()
+		, skeleton_(skeleton)
+		, clip_(clip)
+		, time_(startTime)
+		, cursors_(skeleton.GetBoneCount())
+		, pose_(skeleton.GetBoneCount())
+		, palette_(skeleton.GetBoneCount())
+	{}
+
+	// Inherited via ISceneNode
+	virtual bool Update(float dt) override
+	{
+		time_ = fmodf(time_ + dt, clip_.GetDuration());
+		SampleClip(clip_, time_, &cursors_[0], pose_);
+		skeleton_.GetModelPose(pose_);
+		BuildMatrixPalette(pose_, &palette_[0]);
+		return true;
+	}
+
+	virtual bool Render(RenderQueue& /*queue*/) override
+	{
+		return true;
+	}
+
+	const std::vector<Matrix3x4>& GetPalette() const { return palette_; }
+
+private:
+	const Skeleton& skeleton_;
+	const CompressedClip& clip_;
+	float time_;
+	std::vector<BoneAnimation::Cursor> cursors_;
+	Pose pose_;
+	std::vector<Matrix3x4> palette_;
+};
+
+}
+
+void TestParallelForCoversRange()
+{
+	JobSystem jobSystem(TEST_THREADS);
+
+	// Every element is visited exactly once, for grains that do and don't divide the range
+	const std::uint32_t grainSizes[] = { 1u, 7u, 64u, 1000u, 5000u };
+	for (std::uint32_t grainSize : grainSizes)
+	{
+		std::vector<std::atomic<std::uint32_t>> visits(1000u);
+		for (auto&& visit : visits)
+		{
+			visit.store(0u);
+		}
+
+		bool isRangeValid = true;
+		jobSystem.ParallelFor((std::uint32_t)visits.size(), grainSize, [&visits, &isRangeValid, grainSize](std::uint32_t begin, std::uint32_t end) {
+			if (begin >= end || end - begin > grainSize)
+			{
+				isRangeValid = false;
+			}
+			for (std::uint32_t idx = begin; idx < end; idx++)
+			{
+				visits[idx].fetch_add(1u);
+			}
+		});
+
+		CHECK(isRangeValid);
+		for (auto&& visit : visits)
+		{
+			CHECK(visit.load() == 1u);
+		}
+	}
+
+	// Nothing to do returns straight away
+	bool isCalled = false;
+	jobSystem.ParallelFor(0u, 1u, [&isCalled](std::uint32_t /*begin*/, std::uint32_t /*end*/) { isCalled = true; });
+	CHECK(!isCalled);
+}
+
+void TestNestedJobs()
+{
+	// Jobs that wait on jobs of their own must finish even with every thread busy waiting
+	JobSystem jobSystem(TEST_THREADS);
+	JobSystem::Counter counter;
+	std::atomic<std::uint32_t> numInnerElements(0u);
+
+	for (std::uint32_t jobIdx = 0u; jobIdx < 100u; jobIdx++)
+	{
+		jobSystem.Run([&jobSystem, &numInnerElements]() {
+			jobSystem.ParallelFor(10u, 1u, [&numInnerElements](std::uint32_t begin, std::uint32_t end) {
+				numInnerElements.fetch_add(end - begin);
+			});
+		}, counter);
+	}
+	jobSystem.Wait(counter);
+
+	CHECK(counter.IsDone());
+	CHECK(numInnerElements.load() == 1000u);
+}
+
+void BenchmarkCrowdUpdateScaling()
+{
+	const std::uint32_t NUM_CHARACTERS = 500u;
+	const std::uint32_t NUM_FRAMES = 100u;
+	const std::uint32_t threadCounts[] = { 1u, 2u, 4u, 8u, 16u };
+	const float dt = 1.f / 60.f;
+
+	Skeleton skeleton = BuildTestSkeleton();
+	std::shared_ptr<AnimationClip> clip = BuildTestClip(skeleton, 4.f, 121u);
+	ClipCompressionStats compressionStats;
+	std::shared_ptr<CompressedClip> compressedClip = CompressClip(*clip, skeleton, ClipCompressionOptions(0.01f, 3.f), compressionStats);
+
+	printf("%u characters of %u bones, %u frames, %u hardware threads\n", NUM_CHARACTERS, skeleton.GetBoneCount(), NUM_FRAMES, std::thread::hardware_concurrency());
+
+	double serialMs = 0.;
+	std::vector<Matrix3x4> serialPalette;
+	for (std::uint32_t numThreads : threadCounts)
+	{
+		SceneGraph sceneGraph;
+		std::vector<std::shared_ptr<TestCharacter>> characters;
+		for (std::uint32_t characterIdx = 0u; characterIdx < NUM_CHARACTERS; characterIdx++)
+		{
+			characters.push_back(std::make_shared<TestCharacter>(skeleton, *compressedClip, 0.37f * (float)characterIdx));
+			sceneGraph.AddSceneNode(nullptr, characters.back());
+		}
+		sceneGraph.SetJobSystem(std::make_shared<JobSystem>(numThreads));
+
+		// First frame outside of the timing, to start the workers and warm the caches
+		sceneGraph.Update(dt);
+
+		Stopwatch stopwatch;
+		for (std::uint32_t frameIdx = 0u; frameIdx < NUM_FRAMES; frameIdx++)
+		{
+			CHECK(sceneGraph.Update(dt));
+		}
+		double frameMs = stopwatch.GetMilliseconds() / NUM_FRAMES;
+
+		// Every thread count must pose the crowd exactly as one thread does
+		if (numThreads == 1u)
+		{
+			serialMs = frameMs;
+			serialPalette = characters.back()->GetPalette();
+		}
+		else
+		{
+			const std::vector<Matrix3x4>& palette = characters.back()->GetPalette();
+			CHECK(memcmp(&palette[0], &serialPalette[0], palette.size() * sizeof(Matrix3x4)) == 0);
+		}
+
+		printf("%2u threads: %.3f ms/frame, %.2fx\n", numThreads, frameMs, serialMs / frameMs);
+	}
+}
\ No newline at end of file
@@ -0,0 +1,254 @@
+#include "Tests.h"
+#include "TestHarness.h"
+#include "maffs.h"
+#include "Simd.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+namespace
+{
+
+const std::uint32_t TEST_VALUES = 1000u;
+const float KERNEL_TOLERANCE = 1e-5f;
+
+// The plain float kernels that MAFFS_NO_SIMD builds use, kept here so that SIMD builds can
+//  be checked and timed against them
+Matrix MultiplyScalar(const Matrix& a, const Matrix& b)
+{
+	Matrix result;
+	for (std::uint32_t row = 0u; row < 4u; row++)
+	{
+		for (std::uint32_t col = 0u; col < 4u; col++)
+		{
+			result.m[row][col] = 0.f;
+			for (std::uint32_t k = 0u; k < 4u; k++)
+			{
+				result.m[row][col] += a.m[row][k] * b.m[k][col];
+			}
+		}
+	}
+	return result;
+}
+
+Vec4 MultiplyScalar(const Matrix& m, const Vec4& v)
+{
+	return Vec4(
+		m._11 * v.x + m._12 * v.y + m._13 * v.z + m._14 * v.w,
+		m._21 * v.x + m._22 * v.y + m._23 * v.z + m._24 * v.w,
+		m._31 * v.x + m._32 * v.y + m._33 * v.z + m._34 * v.w,
+		m._41 * v.x + m._42 * v.y + m._43 * v.z + m._44 * v.w);
+}
+
+Quaternion MultiplyScalar(const Quaternion& q, const Quaternion& o)
+{
+	return Quaternion(
+		o.w * q.w - o.x * q.x - o.y * q.y - o.z * q.z,
+		o.w * q.x + o.x * q.w - o.y * q.z + o.z * q.y,
+		o.w * q.y + o.x * q.z + o.y * q.w - o.z * q.x,
+		o.w * q.z - o.x * q.y + o.y * q.x + o.z * q.w);
+}
+
+Vec3 RotateScalar(const Vec3& v, const Quaternion& q)
+{
+	Vec3 u(q.x, q.y, q.z);
+	float s = q.w;
+	return u * 2.f * Vec3::Dot(u, v) + v * (s * s - Vec3::Dot(u, u)) + Vec3::Cross(u, v) * 2.f * s;
+}
+
+Transform ComposeScalar(const Transform& t, const Transform& o)
+{
+	return Transform(t.Pos + Vec3::ComponentProduct(RotateScalar(o.Pos, t.Rotation), t.Scale), MultiplyScalar(t.Rotation, o.Rotation), Vec3::ComponentProduct(t.Scale, o.Scale));
+}
+
+Transform InverseScalar(const Transform& t)
+{
+	Quaternion rotation(-t.Rotation.w, t.Rotation.x, t.Rotation.y, t.Rotation.z);
+	Vec3 scale(1.f / t.Scale.x, 1.f / t.Scale.y, 1.f / t.Scale.z);
+	return Transform(Vec3::ComponentProduct(RotateScalar(-t.Pos, rotation), scale), rotation, scale);
+}
+
+bool IsNear(float a, float b)
+{
+	return fabsf(a - b) <= KERNEL_TOLERANCE * std::max(1.f, std::max(fabsf(a), fabsf(b)));
+}
+
+bool IsNear(const Vec3& a, const Vec3& b)
+{
+	return IsNear(a.x, b.x) && IsNear(a.y, b.y) && IsNear(a.z, b.z);
+}
+
+bool IsNear(const Quaternion& a, const Quaternion& b)
+{
+	return IsNear(a.x, b.x) && IsNear(a.y, b.y) && IsNear(a.z, b.z) && IsNear(a.w, b.w);
+}
+
+bool IsNear(const Transform& a, const Transform& b)
+{
+	return IsNear(a.Pos, b.Pos) && IsNear(a.Rotation, b.Rotation) && IsNear(a.Scale, b.Scale);
+}
+
+bool IsNear(const Matrix& a, const Matrix& b)
+{
+	bool isNear = true;
+	for (std::uint32_t element = 0u; element < 16u; element++)
+	{
+		isNear = isNear && IsNear(a.m[element / 4u][element % 4u], b.m[element / 4u][element % 4u]);
+	}
+	return isNear;
+}
+
+// Random values of every type the kernels take, with scales of either sign
+struct KernelInputs
+{
+public:
+	std::vector<Matrix> Matrices;
+	std::vector<Vec4> Vectors;
+	std::vector<Quaternion> Rotations;
+	std::vector<Transform> Transforms;
+
+	explicit KernelInputs(std::uint32_t numValues)
+	{
+		std::mt19937 random(11u);
+		std::uniform_real_distribution<float> unit(-1.f, 1.f);
+		for (std::uint32_t valueIdx = 0u; valueIdx < numValues; valueIdx++)
+		{
+			Matrix matrix;
+			for (std::uint32_t element = 0u; element < 16u; element++)
+			{
+				matrix.m[element / 4u][element % 4u] = unit(random) * 10.f;
+			}
+			Matrices.push_back(matrix);
+			Vectors.push_back(Vec4(unit(random) * 10.f, unit(random) * 10.f, unit(random) * 10.f, unit(random)));
+
+			Quaternion rotation(unit(random), unit(random), unit(random), unit(random));
+			Vec3 scale(0.5f + fabsf(unit(random)), 0.5f + fabsf(unit(random)), 0.5f + fabsf(unit(random)));
+			Rotations.push_back(rotation);
+			Transforms.push_back(Transform(Vec3(unit(random), unit(random), unit(random)) * 20.f, rotation, (valueIdx % 3u == 0u) ? -scale : scale));
+		}
+	}
+};
+
+const char* GetSimdName()
+{
+#if defined(MAFFS_SIMD4) && defined(MAFFS_SIMD_FMA)
+	return "SSE with FMA";
+#elif defined(MAFFS_SIMD4)
+	return "SSE";
+#else
+	return "scalar (MAFFS_NO_SIMD)";
+#endif
+}
+
+// Times one kernel over every input, and again over the plain float version of it
+template <typename KernelFn, typename ScalarFn>
+void BenchmarkKernel(const char* name, std::uint32_t numValues, KernelFn kernel, ScalarFn scalar)
+{
+	const std::uint32_t NUM_RUNS = 200u;
+	float sum = 0.f;
+
+	// One pass of each outside of the timing, to warm the caches
+	for (std::uint32_t valueIdx = 0u; valueIdx + 1u < numValues; valueIdx++)
+	{
+		sum += kernel(valueIdx) + scalar(valueIdx);
+	}
+
+	Stopwatch kernelStopwatch;
+	for (std::uint32_t run = 0u; run < NUM_RUNS; run++)
+	{
+		for (std::uint32_t valueIdx = 0u; valueIdx + 1u < numValues; valueIdx++)
+		{
+			sum += kernel(valueIdx);
+		}
+	}
+	double kernelMs = kernelStopwatch.GetMilliseconds();
+
+	Stopwatch scalarStopwatch;
+	for (std::uint32_t run = 0u; run < NUM_RUNS; run++)
+	{
+		for (std::uint32_t valueIdx = 0u; valueIdx + 1u < numValues; valueIdx++)
+		{
+			sum += scalar(valueIdx);
+		}
+	}
+	double scalarMs = scalarStopwatch.GetMilliseconds();
+
+	double numCalls = (double)NUM_RUNS * (numValues - 1u);
+	printf("%s: maffs %.2f ns, scalar %.2f ns (%.2fx) (checksum %.0f)\n", name, kernelMs * 1e6 / numCalls, scalarMs * 1e6 / numCalls, scalarMs / kernelMs, sum);
+}
+
+}
+
+void TestSimdKernelsMatchScalar()
+{
+	KernelInputs inputs(TEST_VALUES);
+	for (std::uint32_t valueIdx = 0u; valueIdx + 1u < TEST_VALUES; valueIdx++)
+	{
+		const Matrix& matrix = inputs.Matrices[valueIdx];
+		CHECK(IsNear(matrix * inputs.Matrices[valueIdx + 1u], MultiplyScalar(matrix, inputs.Matrices[valueIdx + 1u])));
+
+		Vec4 vector = matrix * inputs.Vectors[valueIdx];
+		Vec4 scalarVector = MultiplyScalar(matrix, inputs.Vectors[valueIdx]);
+		CHECK(IsNear(vector.x, scalarVector.x) && IsNear(vector.y, scalarVector.y) && IsNear(vector.z, scalarVector.z) && IsNear(vector.w, scalarVector.w));
+
+		Matrix transposed = matrix.Transpose();
+		CHECK(transposed._12 == matrix._21 && transposed._34 == matrix._43 && transposed._41 == matrix._14 && transposed._33 == matrix._33);
+
+		const Quaternion& rotation = inputs.Rotations[valueIdx];
+		CHECK(IsNear(rotation * inputs.Rotations[valueIdx + 1u], MultiplyScalar(rotation, inputs.Rotations[valueIdx + 1u])));
+		CHECK(IsNear(rotation.Inverse(), Quaternion(-rotation.w, rotation.x, rotation.y, rotation.z)));
+
+		Vec3 point(inputs.Vectors[valueIdx].x, inputs.Vectors[valueIdx].y, inputs.Vectors[valueIdx].z);
+		CHECK(IsNear(point * rotation, RotateScalar(point, rotation)));
+
+		const Transform& transform = inputs.Transforms[valueIdx];
+		CHECK(IsNear(transform * inputs.Transforms[valueIdx + 1u], ComposeScalar(transform, inputs.Transforms[valueIdx + 1u])));
+		CHECK(IsNear(transform.Inverse(), InverseScalar(transform)));
+	}
+}
+
+void TestPerspectiveMatchesDirectXMath()
+{
+	// XMMatrixPerspectiveFovLH(90 degrees, 2, 1, 101), which maps view space z of 1 and 101
+	//  to depth 0 and 1
+	Matrix perspective = PerspectiveLH(Radians(90.f), 2.f, 1.f, 101.f);
+	Matrix expected(
+		0.5f, 0.f, 0.f, 0.f,
+		0.f, 1.f, 0.f, 0.f,
+		0.f, 0.f, 1.01f, 1.f,
+		0.f, 0.f, -1.01f, 0.f);
+	CHECK(IsNear(perspective, expected));
+
+	// Row vectors, as the shaders multiply them
+	Matrix transposed = perspective.Transpose();
+	Vec4 nearPoint = transposed * Vec4(0.f, 0.f, 1.f, 1.f);
+	Vec4 farPoint = transposed * Vec4(0.f, 0.f, 101.f, 1.f);
+	CHECK(IsNear(nearPoint.z / nearPoint.w, 0.f) && IsNear(farPoint.z / farPoint.w, 1.f));
+}
+
+void BenchmarkMaffsKernels()
+{
+	KernelInputs inputs(TEST_VALUES);
+	printf("maffs built as %s, against the plain float kernels, per call\n", GetSimdName());
+
+	BenchmarkKernel("Matrix * Matrix", TEST_VALUES,
+		[&](std::uint32_t i) { return (inputs.Matrices[i] * inputs.Matrices[i + 1u])._23; },
+		[&](std::uint32_t i) { return MultiplyScalar(inputs.Matrices[i], inputs.Matrices[i + 1u])._23; });
+	BenchmarkKernel("Matrix * Vec4", TEST_VALUES,
+		[&](std::uint32_t i) { return (inputs.Matrices[i] * inputs.Vectors[i]).y; },
+		[&](std::uint32_t i) { return MultiplyScalar(inputs.Matrices[i], inputs.Vectors[i]).y; });
+	BenchmarkKernel("Quaternion * Quaternion", TEST_VALUES,
+		[&](std::uint32_t i) { return (inputs.Rotations[i] * inputs.Rotations[i + 1u]).w; },
+		[&](std::uint32_t i) { return MultiplyScalar(inputs.Rotations[i], inputs.Rotations[i + 1u]).w; });
+	BenchmarkKernel("Vec3 * Quaternion", TEST_VALUES,
+		[&](std::uint32_t i) { return (inputs.Transforms[i].Pos * inputs.Rotations[i + 1u]).x; },
+		[&](std::uint32_t i) { return RotateScalar(inputs.Transforms[i].Pos, inputs.Rotations[i + 1u]).x; });
+	BenchmarkKernel("Transform * Transform", TEST_VALUES,
+		[&](std::uint32_t i) { return (inputs.Transforms[i] * inputs.Transforms[i + 1u]).Pos.z; },
+		[&](std::uint32_t i) { return ComposeScalar(inputs.Transforms[i], inputs.Transforms[i + 1u]).Pos.z; });
+	BenchmarkKernel("Transform::Inverse", TEST_VALUES,
+		[&](std::uint32_t i) { return inputs.Transforms[i].Inverse().Pos.z; },
+		[&](std::uint32_t i) { return InverseScalar(inputs.Transforms[i]).Pos.z; });
+}
\ No newline at end of file
@@ -0,0 +1,43 @@
+#include "Tests.h"
+#include "TestHarness.h"
+#include "MappedFile.h"
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+
+namespace
+{
+
+const char* const TEST_FILENAME = "MappedFileTests.tmp";
+
+void WriteTestFile(const char* data, std::uint32_t size)
+{
+	std::ofstream file(TEST_FILENAME, std::ios::binary | std::ios::trunc);
+	file.write(data, size);
+}
+
+}
+
+void TestMappedFileReadsWholeFile()
+{
+	// Bigger than a page, so the view spans several
+	const std::uint32_t SIZE = 10000u;
+	char data[SIZE];
+	for (std::uint32_t byteIdx = 0u; byteIdx < SIZE; byteIdx++)
+	{
+		data[byteIdx] = (char)(byteIdx * 7u);
+	}
+	WriteTestFile(data, SIZE);
+
+	{
+		std::shared_ptr<MappedFile> file = MappedFile::Open(TEST_FILENAME);
+		CHECK(file != nullptr);
+		CHECK(file != nullptr && file->GetSize() == SIZE && memcmp(file->GetData(), data, SIZE) == 0);
+	}
+
+	// Empty and missing files have nothing to map
+	WriteTestFile(data, 0u);
+	CHECK(MappedFile::Open(TEST_FILENAME) == nullptr);
+	remove(TEST_FILENAME);
+	CHECK(MappedFile::Open(TEST_FILENAME) == nullptr);
+}
\ No newline at end of file
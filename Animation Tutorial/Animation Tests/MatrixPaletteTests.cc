@@ -0,0 +1,113 @@
+#include "Tests.h"
+#include "TestHarness.h"
+#include "TestAnimation.h"
+#include "ClipSampler.h"
+#include "MatrixPalette.h"
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+namespace
+{
+
+const float PALETTE_TOLERANCE = 1e-3f;
+
+bool IsNear(const Matrix3x4& a, const Matrix& b)
+{
+	for (std::uint32_t row = 0u; row < 3u; row++)
+	{
+		for (std::uint32_t col = 0u; col < 4u; col++)
+		{
+			if (fabsf(a.m[row][col] - b.m[row][col]) > PALETTE_TOLERANCE)
+			{
+				return false;
+			}
+		}
+	}
+	return true;
+}
+
+}
+
+void TestSkinningPaletteMatchesTransforms()
+{
+	Skeleton skeleton = BuildTestSkeleton();
+	std::shared_ptr<AnimationClip> clip = BuildTestClip(skeleton, 2.f, 30u);
+	std::uint32_t numBones = skeleton.GetBoneCount();
+
+	Pose pose(numBones);
+	SampleClip(*clip, 0.7f, pose);
+	skeleton.GetModelPose(pose);
+
+	std::vector<Matrix3x4> modelPalette(numBones);
+	BuildMatrixPalette(pose, &modelPalette[0]);
+
+	// A mesh influenced by every other bone, listed back to front, with the skeleton's own
+	//  inverse bind transforms as its offsets
+	std::vector<std::uint32_t> boneIndices;
+	std::vector<Matrix3x4> offsets;
+	for (std::uint32_t idx = 0u; idx < numBones; idx += 2u)
+	{
+		std::uint32_t boneIdx = numBones - 1u - idx;
+		boneIndices.push_back(boneIdx);
+		offsets.push_back(ToMatrix3x4(skeleton.GetInverseBindTransform(boneIdx).GetTransformMatrix()));
+	}
+
+	std::uint32_t numMeshBones = (std::uint32_t)boneIndices.size();
+	std::vector<Matrix3x4> skinningPalette(numMeshBones);
+	BuildSkinningPalette(&modelPalette[0], &boneIndices[0], &offsets[0], numMeshBones, &skinningPalette[0]);
+
+	for (std::uint32_t meshBoneIdx = 0u; meshBoneIdx < numMeshBones; meshBoneIdx++)
+	{
+		std::uint32_t boneIdx = boneIndices[meshBoneIdx];
+		Matrix expected = (pose.GetTransform(boneIdx) * skeleton.GetInverseBindTransform(boneIdx)).GetTransformMatrix();
+		CHECK(IsNear(skinningPalette[meshBoneIdx], expected));
+	}
+
+	// The bind pose leaves every vertex where it is
+	for (std::uint32_t boneIdx = 0u; boneIdx < numBones; boneIdx++)
+	{
+		pose.SetTransform(boneIdx, skeleton.GetBone(boneIdx).FromParentTransform);
+	}
+	skeleton.GetModelPose(pose);
+	BuildMatrixPalette(pose, &modelPalette[0]);
+	BuildSkinningPalette(&modelPalette[0], &boneIndices[0], &offsets[0], numMeshBones, &skinningPalette[0]);
+
+	Matrix identity = Transform().GetTransformMatrix();
+	for (const Matrix3x4& skinningMatrix : skinningPalette)
+	{
+		CHECK(IsNear(skinningMatrix, identity));
+	}
+}
+
+void TestBindOffsetsInvertBindPose()
+{
+	Skeleton skeleton = BuildTestSkeleton();
+	std::uint32_t numBones = skeleton.GetBoneCount();
+	std::vector<std::uint32_t> boneIndices;
+	for (std::uint32_t boneIdx = 0u; boneIdx < numBones; boneIdx++)
+	{
+		boneIndices.push_back(boneIdx);
+	}
+	std::vector<Matrix3x4> offsets(numBones);
+	BuildBindOffsets(skeleton, &boneIndices[0], numBones, &offsets[0]);
+
+	// Each offset takes the bone's model space bind transform back to the identity
+	Matrix identity = Transform().GetTransformMatrix();
+	for (std::uint32_t boneIdx = 0u; boneIdx < numBones; boneIdx++)
+	{
+		Matrix offset = skeleton.GetInverseBindTransform(boneIdx).GetTransformMatrix();
+		CHECK(IsNear(offsets[boneIdx], offset));
+		CHECK(IsNear(ToMatrix3x4(skeleton.GetBindModelTransform(boneIdx).GetTransformMatrix() * offset), identity));
+	}
+
+	// Offsets loaded from a mesh bound in the same pose match, and moving one bone shows up
+	//  relative to the size of what moved
+	std::vector<Matrix3x4> meshOffsets = offsets;
+	CHECK(MeasureOffsetDifference(&meshOffsets[0], &offsets[0], numBones) == 0.f);
+
+	float translation = offsets[numBones - 1u].m[1u][3u];
+	meshOffsets[numBones - 1u].m[1u][3u] += 2.f;
+	float expected = 2.f / std::max(1.f, std::max(fabsf(translation), fabsf(translation + 2.f)));
+	CHECK(fabsf(MeasureOffsetDifference(&meshOffsets[0], &offsets[0], numBones) - expected) < 1e-6f);
+}
\ No newline at end of file
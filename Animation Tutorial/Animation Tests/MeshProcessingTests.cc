@@ -0,0 +1,173 @@
+#include "Tests.h"
+#include "TestHarness.h"
+#include "MeshProcessing.h"
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <random>
+#include <vector>
+
+namespace
+{
+
+// Laid out like the position and normal vertices the model loaders weld
+struct TestVertex
+{
+public:
+	float Position[3];
+	float Normal[3];
+};
+
+// A flat grid of cells by cells quads, de-indexed the way the loaders read meshes - every
+//  corner of every triangle is its own vertex, and indices are 0, 1, 2, ...
+void BuildDeindexedGrid(std::uint32_t cells, std::vector<TestVertex>& outVertices, std::vector<std::uint32_t>& outIndices)
+{
+	outVertices.clear();
+	outIndices.clear();
+	for (std::uint32_t row = 0u; row < cells; row++)
+	{
+		for (std::uint32_t col = 0u; col < cells; col++)
+		{
+			const std::uint32_t corners[6][2] = { { col, row }, { col, row + 1u }, { col + 1u, row }, { col + 1u, row }, { col, row + 1u }, { col + 1u, row + 1u } };
+			for (const std::uint32_t* corner : corners)
+			{
+				TestVertex vertex = { { (float)corner[0u], 0.f, (float)corner[1u] }, { 0.f, 1.f, 0.f } };
+				outIndices.push_back((std::uint32_t)outVertices.size());
+				outVertices.push_back(vertex);
+			}
+		}
+	}
+}
+
+bool AreVerticesEqual(const TestVertex& a, const TestVertex& b)
+{
+	return memcmp(&a, &b, sizeof(TestVertex)) == 0;
+}
+
+// Each triangle rotated to start at its lowest index, which keeps its winding, then sorted -
+//  equal for two index buffers of the same triangles in any order
+std::vector<std::array<std::uint32_t, 3>> GetTriangleSet(const std::vector<std::uint32_t>& indices)
+{
+	std::vector<std::array<std::uint32_t, 3>> triangles;
+	for (std::uint32_t i = 0u; i + 2u < indices.size(); i += 3u)
+	{
+		std::uint32_t first = (indices[i] <= indices[i + 1u] && indices[i] <= indices[i + 2u]) ? 0u : (indices[i + 1u] <= indices[i + 2u]) ? 1u : 2u;
+		triangles.push_back({ { indices[i + first], indices[i + (first + 1u) % 3u], indices[i + (first + 2u) % 3u] } });
+	}
+	std::sort(triangles.begin(), triangles.end());
+	return triangles;
+}
+
+}
+
+void TestWeldVerticesMergesIdenticalVertices()
+{
+	const std::uint32_t CELLS = 20u;
+	std::vector<TestVertex> vertices;
+	std::vector<std::uint32_t> indices;
+	BuildDeindexedGrid(CELLS, vertices, indices);
+
+	// Same position as a grid corner, but another normal, or a position of -0 rather than 0 -
+	//  neither is byte-identical to the corner, so both are kept
+	TestVertex otherNormal = vertices[0u];
+	otherNormal.Normal[1u] = -1.f;
+	TestVertex negativeZero = vertices[0u];
+	negativeZero.Position[0u] = -0.f;
+	const TestVertex extraTriangle[3] = { otherNormal, negativeZero, vertices[1u] };
+	for (const TestVertex& vertex : extraTriangle)
+	{
+		indices.push_back((std::uint32_t)vertices.size());
+		vertices.push_back(vertex);
+	}
+
+	std::vector<TestVertex> source = vertices;
+	std::vector<std::uint32_t> sourceIndices = indices;
+	std::uint32_t numWelded = WeldVertices(&vertices[0], sizeof(TestVertex), (std::uint32_t)vertices.size(), indices);
+	CHECK(numWelded == (CELLS + 1u) * (CELLS + 1u) + 2u);
+
+	// Every triangle corner still has the bytes it had, so triangles and their winding are kept
+	CHECK(indices.size() == sourceIndices.size());
+	bool areCornersEqual = true;
+	for (std::uint32_t i = 0u; i < indices.size(); i++)
+	{
+		areCornersEqual = areCornersEqual && indices[i] < numWelded && AreVerticesEqual(vertices[indices[i]], source[sourceIndices[i]]);
+	}
+	CHECK(areCornersEqual);
+
+	// No two vertices left are the same, and they are in order of first use
+	bool areUnique = true;
+	for (std::uint32_t a = 0u; a < numWelded; a++)
+	{
+		for (std::uint32_t b = a + 1u; b < numWelded; b++)
+		{
+			areUnique = areUnique && !AreVerticesEqual(vertices[a], vertices[b]);
+		}
+	}
+	CHECK(areUnique);
+
+	bool isInFirstUseOrder = true;
+	std::uint32_t nextFirstUse = 0u;
+	for (std::uint32_t index : indices)
+	{
+		isInFirstUseOrder = isInFirstUseOrder && index <= nextFirstUse;
+		nextFirstUse = (index == nextFirstUse) ? nextFirstUse + 1u : nextFirstUse;
+	}
+	CHECK(isInFirstUseOrder && nextFirstUse == numWelded);
+
+	// 16 bit indices address up to 65536 vertices
+	CHECK(GetIndexSize(numWelded) == 2u);
+	CHECK(GetIndexSize(0x10000u) == 2u);
+	CHECK(GetIndexSize(0x10001u) == 4u);
+
+	std::vector<std::uint16_t> narrowIndices;
+	NarrowIndices(indices, narrowIndices);
+	bool areNarrowEqual = narrowIndices.size() == indices.size();
+	for (std::uint32_t i = 0u; areNarrowEqual && i < indices.size(); i++)
+	{
+		areNarrowEqual = narrowIndices[i] == indices[i];
+	}
+	CHECK(areNarrowEqual);
+}
+
+void TestOptimizeVertexCacheLowersACMR()
+{
+	const std::uint32_t CELLS = 40u;
+	const std::uint32_t CACHE_SIZE = 16u;
+	std::vector<TestVertex> vertices;
+	std::vector<std::uint32_t> indices;
+	BuildDeindexedGrid(CELLS, vertices, indices);
+	std::uint32_t numVertices = WeldVertices(&vertices[0], sizeof(TestVertex), (std::uint32_t)vertices.size(), indices);
+
+	// The grid in row order, and in no order at all, as an importer might leave it. Either
+	//  way the same triangles come out, in an order that reuses more of the cache.
+	std::vector<std::uint32_t> shuffled = indices;
+	std::vector<std::uint32_t> triangleOrder(shuffled.size() / 3u);
+	for (std::uint32_t triangleIdx = 0u; triangleIdx < triangleOrder.size(); triangleIdx++)
+	{
+		triangleOrder[triangleIdx] = triangleIdx;
+	}
+	std::shuffle(triangleOrder.begin(), triangleOrder.end(), std::mt19937(10u));
+	for (std::uint32_t triangleIdx = 0u; triangleIdx < triangleOrder.size(); triangleIdx++)
+	{
+		for (std::uint32_t corner = 0u; corner < 3u; corner++)
+		{
+			shuffled[triangleIdx * 3u + corner] = indices[triangleOrder[triangleIdx] * 3u + corner];
+		}
+	}
+
+	const std::vector<std::uint32_t>* inputs[] = { &indices, &shuffled };
+	for (std::uint32_t inputIdx = 0u; inputIdx < 2u; inputIdx++)
+	{
+		std::vector<std::uint32_t> optimized = *inputs[inputIdx];
+		OptimizeVertexCache(optimized, numVertices);
+		CHECK(GetTriangleSet(optimized) == GetTriangleSet(*inputs[inputIdx]));
+
+		VertexCacheStats before = SimulateVertexCache(*inputs[inputIdx], numVertices, CACHE_SIZE);
+		VertexCacheStats after = SimulateVertexCache(optimized, numVertices, CACHE_SIZE);
+		CHECK(after.ACMR < before.ACMR);
+
+		// Row order misses on every vertex of the row above (about 1.0), while good orders on a
+		//  regular grid come close to 0.5 - measured at 0.67 here
+		CHECK(after.ACMR < 0.75f);
+	}
+}
\ No newline at end of file
@@ -0,0 +1,181 @@
+#include "Tests.h"
+#include "TestHarness.h"
+#include "PoseBlend.h"
+#include <algorithm>
+#include <cmath>
+#include <random>
+
+namespace
+{
+
+// Not a multiple of any SIMD width, so the last batch is part padding
+const std::uint32_t TEST_BONES = 67u;
+const float BLEND_TOLERANCE = 1e-4f;
+
+// The blends one bone at a time, in plain floats
+Quaternion MultiplyScalar(const Quaternion& q, const Quaternion& o)
+{
+	return Quaternion(
+		q.w * o.w - q.x * o.x - q.y * o.y - q.z * o.z,
+		q.w * o.x + q.x * o.w + q.y * o.z - q.z * o.y,
+		q.w * o.y - q.x * o.z + q.y * o.w + q.z * o.x,
+		q.w * o.z + q.x * o.y - q.y * o.x + q.z * o.w);
+}
+
+Quaternion NlerpScalar(const Quaternion& a, const Quaternion& b, float t)
+{
+	float sign = (a.x * b.x + a.y * b.y + a.z * b.z + a.w * b.w < 0.f) ? -1.f : 1.f;
+	float x = a.x + (b.x * sign - a.x) * t;
+	float y = a.y + (b.y * sign - a.y) * t;
+	float z = a.z + (b.z * sign - a.z) * t;
+	float w = a.w + (b.w * sign - a.w) * t;
+	float length = sqrtf(x * x + y * y + z * z + w * w);
+	return Quaternion(w / length, x / length, y / length, z / length);
+}
+
+float LerpScalar(float a, float b, float t)
+{
+	return a + (b - a) * t;
+}
+
+Transform BlendScalar(const Transform& a, const Transform& b, float t)
+{
+	return Transform(
+		Vec3(LerpScalar(a.Pos.x, b.Pos.x, t), LerpScalar(a.Pos.y, b.Pos.y, t), LerpScalar(a.Pos.z, b.Pos.z, t)),
+		NlerpScalar(a.Rotation, b.Rotation, t),
+		Vec3(LerpScalar(a.Scale.x, b.Scale.x, t), LerpScalar(a.Scale.y, b.Scale.y, t), LerpScalar(a.Scale.z, b.Scale.z, t)));
+}
+
+Transform AddScalar(const Transform& base, const Transform& additive, const Transform& reference, float t)
+{
+	const Quaternion& r = reference.Rotation;
+	Quaternion delta = MultiplyScalar(Quaternion(r.w, -r.x, -r.y, -r.z), additive.Rotation);
+	Quaternion scaledDelta = NlerpScalar(Quaternion(1.f, 0.f, 0.f, 0.f), delta, t);
+
+	return Transform(
+		base.Pos + (additive.Pos - reference.Pos) * t,
+		MultiplyScalar(base.Rotation, scaledDelta),
+		Vec3(base.Scale.x * LerpScalar(1.f, additive.Scale.x / reference.Scale.x, t),
+			base.Scale.y * LerpScalar(1.f, additive.Scale.y / reference.Scale.y, t),
+			base.Scale.z * LerpScalar(1.f, additive.Scale.z / reference.Scale.z, t)));
+}
+
+bool IsNear(float a, float b)
+{
+	return fabsf(a - b) <= BLEND_TOLERANCE * std::max(1.f, std::max(fabsf(a), fabsf(b)));
+}
+
+bool IsNear(const Transform& a, const Transform& b)
+{
+	return IsNear(a.Pos.x, b.Pos.x) && IsNear(a.Pos.y, b.Pos.y) && IsNear(a.Pos.z, b.Pos.z)
+		&& IsNear(a.Rotation.x, b.Rotation.x) && IsNear(a.Rotation.y, b.Rotation.y) && IsNear(a.Rotation.z, b.Rotation.z) && IsNear(a.Rotation.w, b.Rotation.w)
+		&& IsNear(a.Scale.x, b.Scale.x) && IsNear(a.Scale.y, b.Scale.y) && IsNear(a.Scale.z, b.Scale.z);
+}
+
+// Rotations of up to two turns, so about half are on the negative hemisphere of each other
+Pose BuildRandomPose(std::mt19937& random)
+{
+	std::uniform_real_distribution<float> unit(-1.f, 1.f);
+	Pose pose(TEST_BONES);
+	for (std::uint32_t boneIdx = 0u; boneIdx < TEST_BONES; boneIdx++)
+	{
+		Quaternion rotation(Vec3(unit(random), unit(random), unit(random) + 2.f).Normal(), unit(random) * 6.f);
+		Vec3 scale(1.f + 0.5f * unit(random), 1.f + 0.5f * unit(random), 1.f + 0.5f * unit(random));
+		pose.SetTransform(boneIdx, Transform(Vec3(unit(random), unit(random), unit(random)) * 10.f, rotation, scale));
+	}
+	return pose;
+}
+
+// Weights of 0 and 1 on some bones, and anything between on the rest
+BoneWeights BuildRandomBoneWeights(std::mt19937& random)
+{
+	std::uniform_real_distribution<float> unit(0.f, 1.f);
+	BoneWeights boneWeights(TEST_BONES, 0.f);
+	for (std::uint32_t boneIdx = 0u; boneIdx < TEST_BONES; boneIdx++)
+	{
+		boneWeights.SetWeight(boneIdx, (boneIdx % 5u == 0u) ? 0.f : (boneIdx % 5u == 1u) ? 1.f : unit(random));
+	}
+	return boneWeights;
+}
+
+// Padding bones must stay identity transforms, whatever the blend did to the real ones
+bool IsPaddingIdentity(const Pose& pose)
+{
+	bool isIdentity = true;
+	for (std::uint32_t boneIdx = pose.GetBoneCount(); boneIdx < pose.GetPaddedBoneCount(); boneIdx++)
+	{
+		isIdentity = isIdentity && IsNear(pose.GetTransform(boneIdx), Transform());
+	}
+	return isIdentity;
+}
+
+}
+
+void TestPoseBlendsMatchScalar()
+{
+	std::mt19937 random(18u);
+	Pose a = BuildRandomPose(random);
+	Pose b = BuildRandomPose(random);
+	Pose reference = BuildRandomPose(random);
+	BoneWeights boneWeights = BuildRandomBoneWeights(random);
+
+	const float weights[] = { 0.f, 0.3f, 1.f };
+	for (float weight : weights)
+	{
+		for (std::uint32_t maskIdx = 0u; maskIdx < 2u; maskIdx++)
+		{
+			const BoneWeights* mask = (maskIdx == 0u) ? nullptr : &boneWeights;
+
+			Pose blended(TEST_BONES);
+			Pose added(TEST_BONES);
+			BlendPoses(a, b, weight, mask, blended);
+			AddPose(a, b, reference, weight, mask, added);
+
+			bool isBlendNear = true;
+			bool isAddNear = true;
+			for (std::uint32_t boneIdx = 0u; boneIdx < TEST_BONES; boneIdx++)
+			{
+				float t = weight * ((mask != nullptr) ? mask->GetWeight(boneIdx) : 1.f);
+				isBlendNear = isBlendNear && IsNear(blended.GetTransform(boneIdx), BlendScalar(a.GetTransform(boneIdx), b.GetTransform(boneIdx), t));
+				isAddNear = isAddNear && IsNear(added.GetTransform(boneIdx), AddScalar(a.GetTransform(boneIdx), b.GetTransform(boneIdx), reference.GetTransform(boneIdx), t));
+			}
+			CHECK(isBlendNear);
+			CHECK(isAddNear);
+			CHECK(IsPaddingIdentity(blended));
+			CHECK(IsPaddingIdentity(added));
+
+			// Writing over any of the inputs gives the same result, as blend trees do
+			Pose aliasedA = a;
+			Pose aliasedB = b;
+			Pose aliasedBase = a;
+			Pose aliasedAdditive = b;
+			Pose aliasedReference = reference;
+			BlendPoses(aliasedA, b, weight, mask, aliasedA);
+			BlendPoses(a, aliasedB, weight, mask, aliasedB);
+			AddPose(aliasedBase, b, reference, weight, mask, aliasedBase);
+			AddPose(a, aliasedAdditive, reference, weight, mask, aliasedAdditive);
+			AddPose(a, b, aliasedReference, weight, mask, aliasedReference);
+
+			bool isAliasedEqual = true;
+			for (std::uint32_t boneIdx = 0u; boneIdx < TEST_BONES; boneIdx++)
+			{
+				Transform blendedBone = blended.GetTransform(boneIdx);
+				Transform addedBone = added.GetTransform(boneIdx);
+				isAliasedEqual = isAliasedEqual && IsNear(aliasedA.GetTransform(boneIdx), blendedBone) && IsNear(aliasedB.GetTransform(boneIdx), blendedBone)
+					&& IsNear(aliasedBase.GetTransform(boneIdx), addedBone) && IsNear(aliasedAdditive.GetTransform(boneIdx), addedBone)
+					&& IsNear(aliasedReference.GetTransform(boneIdx), addedBone);
+			}
+			CHECK(isAliasedEqual);
+		}
+	}
+
+	// An additive pose equal to its reference changes nothing, at any weight
+	Pose unchanged(TEST_BONES);
+	AddPose(a, reference, reference, 0.7f, &boneWeights, unchanged);
+	bool isUnchanged = true;
+	for (std::uint32_t boneIdx = 0u; boneIdx < TEST_BONES; boneIdx++)
+	{
+		isUnchanged = isUnchanged && IsNear(unchanged.GetTransform(boneIdx), a.GetTransform(boneIdx));
+	}
+	CHECK(isUnchanged);
+}
\ No newline at end of file
@@ -0,0 +1,265 @@
+#include "Tests.h"
+#include "TestHarness.h"
+#include "RenderQueue.h"
+#include "HeadlessRenderBackend.h"
+#include <cstdio>
+#include <vector>
+
+namespace
+{
+
+const std::uint32_t TEST_RING_SIZE = 4u * 1024u * 1024u;
+const std::uint32_t TEST_FRAMES_IN_FLIGHT = 3u;
+const std::uint32_t TEST_VERTEX_STRIDE = 32u;
+
+// Two shaders and a set of meshes of the same vertex layout, and one material
+struct TestScene
+{
+public:
+	HeadlessRenderBackend Backend;
+	std::uint32_t Shaders[2];
+	std::vector<std::uint32_t> Meshes;
+	std::uint32_t Material;
+
+	explicit TestScene(std::uint32_t numMeshes)
+		: Backend(TEST_RING_SIZE, TEST_FRAMES_IN_FLIGHT)
+		, Shaders()
+		, Meshes()
+		, Material(0u)
+	{
+		Shaders[0u] = Backend.AddShader(TEST_VERTEX_STRIDE);
+		Shaders[1u] = Backend.AddShader(TEST_VERTEX_STRIDE);
+		for (std::uint32_t meshIdx = 0u; meshIdx < numMeshes; meshIdx++)
+		{
+			Meshes.push_back(Backend.AddMesh(TEST_VERTEX_STRIDE, 300u + meshIdx));
+		}
+		Material = Backend.AddMaterial();
+	}
+
+	// Draws interleaved across shaders and meshes, the way scene nodes add them
+	void AddDraws(RenderQueue& queue, std::uint32_t numDraws) const
+	{
+		for (std::uint32_t drawIdx = 0u; drawIdx < numDraws; drawIdx++)
+		{
+			std::uint32_t shader = Shaders[(drawIdx % 7u == 0u) ? 0u : 1u];
+			std::uint32_t mesh = Meshes[drawIdx % Meshes.size()];
+			queue.AddDraw(DrawPacket(RenderQueue::SCENE_PASS, shader, Material, mesh, RenderQueue::INVALID_KEY, Matrix()));
+		}
+	}
+};
+
+}
+
+void TestRenderQueueSortsDraws()
+{
+	const std::uint32_t NUM_DRAWS = 5000u;
+	TestScene scene(40u);
+	RenderQueue queue;
+	scene.AddDraws(queue, NUM_DRAWS);
+
+	CHECK(queue.Submit(scene.Backend));
+	const RenderStats& stats = scene.Backend.GetStats();
+	CHECK(stats.NumErrors == 0u);
+	CHECK(stats.NumInstances == NUM_DRAWS);
+	CHECK(stats.NumDraws == queue.GetStats().NumDraws);
+
+	// Sorted by state, each shader is bound once, and nothing is bound twice in a row
+	CHECK(stats.NumShaderBinds == 2u);
+	CHECK(stats.NumRedundantBinds == 0u);
+
+	const std::vector<std::uint32_t>& order = queue.GetSubmitOrder();
+	CHECK(order.size() == NUM_DRAWS);
+	for (std::uint32_t i = 1u; i < order.size(); i++)
+	{
+		CHECK(RenderQueue::MakeSortKey(queue.GetPackets()[order[i - 1u]]) <= RenderQueue::MakeSortKey(queue.GetPackets()[order[i]]));
+	}
+
+	// Every draw of the frame is recorded, after the instance data it reads
+	std::uint32_t numDrawCommands = 0u;
+	bool isInstanceDataBound = false;
+	for (const RenderCommand& command : scene.Backend.GetCommands())
+	{
+		isInstanceDataBound = isInstanceDataBound || command.Type == RENDER_COMMAND_TYPE::BIND_INSTANCE_DATA;
+		if (command.Type == RENDER_COMMAND_TYPE::DRAW)
+		{
+			CHECK(isInstanceDataBound);
+			numDrawCommands++;
+		}
+	}
+	CHECK(numDrawCommands == stats.NumDraws);
+}
+
+void TestRenderQueueGathersInstances()
+{
+	// A crowd of characters of three skinned meshes, each mesh with its own palette, among
+	//  static meshes. Enough characters that each character mesh takes more than one draw.
+	const std::uint32_t NUM_CHARACTERS = 600u;
+	const std::uint32_t NUM_CHARACTER_MESHES = 3u;
+	const std::uint32_t NUM_STATIC_MESHES = 30u;
+	const std::uint32_t meshBoneCounts[NUM_CHARACTER_MESHES] = { 52u, 7u, 65u };
+
+	TestScene scene(NUM_STATIC_MESHES + NUM_CHARACTER_MESHES);
+	std::vector<std::uint32_t> materials(1u, scene.Material);
+	while (materials.size() < 8u)
+	{
+		materials.push_back(scene.Backend.AddMaterial());
+	}
+
+	// Every model is marked with its packet index, and every bone with its character, mesh
+	//  and index in the mesh's palette
+	RenderQueue queue;
+	std::vector<Matrix3x4> palette(meshBoneCounts[2u]);
+	for (std::uint32_t meshIdx = 0u; meshIdx < NUM_STATIC_MESHES; meshIdx++)
+	{
+		Matrix model;
+		model._14 = (float)queue.GetDrawCount();
+		queue.AddDraw(DrawPacket(RenderQueue::SCENE_PASS, scene.Shaders[0u], materials[meshIdx % materials.size()], scene.Meshes[meshIdx], RenderQueue::INVALID_KEY, model));
+	}
+	for (std::uint32_t characterIdx = 0u; characterIdx < NUM_CHARACTERS; characterIdx++)
+	{
+		for (std::uint32_t meshIdx = 0u; meshIdx < NUM_CHARACTER_MESHES; meshIdx++)
+		{
+			for (std::uint32_t boneIdx = 0u; boneIdx < meshBoneCounts[meshIdx]; boneIdx++)
+			{
+				palette[boneIdx].m[0u][3u] = (float)((characterIdx * NUM_CHARACTER_MESHES + meshIdx) * 100u + boneIdx);
+			}
+			std::uint32_t paletteOffset = queue.AddPalette(&palette[0], meshBoneCounts[meshIdx]);
+
+			Matrix model;
+			model._14 = (float)queue.GetDrawCount();
+			std::uint32_t material = materials[(characterIdx + meshIdx) % materials.size()];
+			queue.AddDraw(DrawPacket(RenderQueue::SCENE_PASS, scene.Shaders[1u], material, scene.Meshes[NUM_STATIC_MESHES + meshIdx], paletteOffset, model));
+		}
+	}
+
+	CHECK(queue.Submit(scene.Backend));
+	const RenderStats& stats = scene.Backend.GetStats();
+	CHECK(stats.NumErrors == 0u);
+	CHECK(stats.NumInstances == queue.GetDrawCount());
+	CHECK(stats.NumConstantMaps == 1u);
+
+	// One draw per static mesh, and per full or partial instance array of a character mesh
+	std::uint32_t drawsPerCharacterMesh = (NUM_CHARACTERS + IRenderBackend::MAX_INSTANCES_PER_DRAW - 1u) / IRenderBackend::MAX_INSTANCES_PER_DRAW;
+	CHECK(stats.NumDraws == NUM_STATIC_MESHES + NUM_CHARACTER_MESHES * drawsPerCharacterMesh);
+	CHECK(stats.NumDraws == (std::uint32_t)queue.GetBatches().size());
+
+	// Each draw reads the instances of its packets, and each instance the palette of its mesh
+	const std::vector<std::uint32_t>& order = queue.GetSubmitOrder();
+	const std::vector<InstanceBatch>& batches = queue.GetBatches();
+	std::uint32_t instanceOffset = 0u;
+	std::uint32_t batchIdx = 0u;
+	std::uint32_t numChecked = 0u;
+	for (const RenderCommand& command : scene.Backend.GetCommands())
+	{
+		if (command.Type == RENDER_COMMAND_TYPE::BIND_INSTANCE_DATA)
+		{
+			instanceOffset = command.Value;
+		}
+		if (command.Type != RENDER_COMMAND_TYPE::DRAW)
+		{
+			continue;
+		}
+
+		const InstanceBatch& batch = batches[batchIdx++];
+		CHECK(command.Value == batch.NumInstances && batch.NumInstances <= IRenderBackend::MAX_INSTANCES_PER_DRAW);
+
+		const InstanceData* instances = scene.Backend.GetInstanceData(instanceOffset);
+		for (std::uint32_t instanceIdx = 0u; instanceIdx < batch.NumInstances; instanceIdx++)
+		{
+			std::uint32_t packetIdx = order[batch.FirstInstance + instanceIdx];
+			const DrawPacket& packet = queue.GetPackets()[packetIdx];
+			const InstanceData& instance = instances[instanceIdx];
+			CHECK(packet.ShaderKey == batch.ShaderKey && packet.MeshKey == batch.MeshKey);
+			CHECK(instance.Model._14 == (float)packetIdx);
+			CHECK(instance.MaterialKey == packet.MaterialKey);
+			CHECK(instance.PaletteOffset == packet.PaletteOffset);
+
+			if (packetIdx >= NUM_STATIC_MESHES)
+			{
+				std::uint32_t meshIdx = (packetIdx - NUM_STATIC_MESHES) % NUM_CHARACTER_MESHES;
+				std::uint32_t lastBone = meshBoneCounts[meshIdx] - 1u;
+				const Matrix3x4& bone = scene.Backend.GetPaletteData()[instance.PaletteOffset + lastBone];
+				CHECK(bone.m[0u][3u] == (float)((packetIdx - NUM_STATIC_MESHES) * 100u + lastBone));
+			}
+			numChecked++;
+		}
+	}
+	CHECK(numChecked == queue.GetDrawCount());
+}
+
+void TestHeadlessBackendRejectsInvalidDraws()
+{
+	TestScene scene(1u);
+	std::uint32_t wideShader = scene.Backend.AddShader(TEST_VERTEX_STRIDE * 2u);
+
+	// A shader of another vertex layout than the mesh
+	RenderQueue layoutQueue;
+	layoutQueue.AddDraw(DrawPacket(RenderQueue::SCENE_PASS, wideShader, scene.Material, scene.Meshes[0u], RenderQueue::INVALID_KEY, Matrix()));
+	layoutQueue.AddDraw(DrawPacket(RenderQueue::SCENE_PASS, scene.Shaders[0u], scene.Material, scene.Meshes[0u], RenderQueue::INVALID_KEY, Matrix()));
+	CHECK(!layoutQueue.Submit(scene.Backend));
+	CHECK(scene.Backend.GetStats().NumErrors == 1u);
+	CHECK(scene.Backend.GetStats().NumDraws == 1u);
+
+	// A mesh that was never added
+	RenderQueue meshQueue;
+	meshQueue.AddDraw(DrawPacket(RenderQueue::SCENE_PASS, scene.Shaders[0u], scene.Material, 999u, RenderQueue::INVALID_KEY, Matrix()));
+	CHECK(!meshQueue.Submit(scene.Backend));
+	CHECK(scene.Backend.GetStats().NumDraws == 0u);
+
+	// A material that was never added, or a palette outside the palette data
+	RenderQueue instanceQueue;
+	instanceQueue.AddDraw(DrawPacket(RenderQueue::SCENE_PASS, scene.Shaders[0u], scene.Material + 1u, scene.Meshes[0u], RenderQueue::INVALID_KEY, Matrix()));
+	instanceQueue.AddDraw(DrawPacket(RenderQueue::SCENE_PASS, scene.Shaders[1u], scene.Material, scene.Meshes[0u], 0u, Matrix()));
+	CHECK(!instanceQueue.Submit(scene.Backend));
+	CHECK(scene.Backend.GetStats().NumErrors == 2u);
+	CHECK(scene.Backend.GetStats().NumDraws == 0u);
+
+	// A frame that could not begin, here because the last one was never ended
+	RenderQueue validQueue;
+	scene.AddDraws(validQueue, 10u);
+	CHECK(scene.Backend.BeginFrame());
+	CHECK(!validQueue.Submit(scene.Backend));
+	CHECK(scene.Backend.GetStats().NumErrors == 1u);
+	CHECK(scene.Backend.GetStats().NumDraws == 0u);
+	CHECK(scene.Backend.EndFrame());
+
+	// Valid frames still go through afterwards
+	CHECK(validQueue.Submit(scene.Backend));
+	CHECK(scene.Backend.GetStats().NumErrors == 0u);
+}
+
+void BenchmarkRenderQueueSubmission()
+{
+	const std::uint32_t NUM_DRAWS = 5000u;
+	const std::uint32_t NUM_FRAMES = 200u;
+	TestScene scene(40u);
+	RenderQueue queue;
+
+	printf("%u draws of %u meshes a frame, %u frames\n", NUM_DRAWS, (std::uint32_t)scene.Meshes.size(), NUM_FRAMES);
+
+	Stopwatch fillStopwatch;
+	for (std::uint32_t frameIdx = 0u; frameIdx < NUM_FRAMES; frameIdx++)
+	{
+		queue.Clear();
+		scene.AddDraws(queue, NUM_DRAWS);
+	}
+	printf("queue fill: %.1f ns/draw\n", fillStopwatch.GetMilliseconds() * 1e6 / NUM_FRAMES / NUM_DRAWS);
+
+	const bool recordingModes[] = { true, false };
+	for (bool isRecording : recordingModes)
+	{
+		scene.Backend.SetRecording(isRecording);
+		CHECK(queue.Submit(scene.Backend));
+
+		Stopwatch submitStopwatch;
+		for (std::uint32_t frameIdx = 0u; frameIdx < NUM_FRAMES; frameIdx++)
+		{
+			queue.Submit(scene.Backend);
+		}
+		double submitMs = submitStopwatch.GetMilliseconds() / NUM_FRAMES;
+
+		const RenderStats& stats = scene.Backend.GetStats();
+		printf("submit, %s: %.1f ns/draw, %u draws, %u state changes\n", isRecording ? "recording" : "not recording",
+			submitMs * 1e6 / NUM_DRAWS, stats.NumDraws, stats.GetStateChangeCount());
+	}
+}
\ No newline at end of file
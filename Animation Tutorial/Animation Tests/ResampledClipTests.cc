@@ -0,0 +1,74 @@
+#include "Tests.h"
+#include "TestHarness.h"
+#include "TestAnimation.h"
+#include "ClipSampler.h"
+#include "ResampledClip.h"
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+namespace
+{
+
+// Largest differences between the source and resampled clips over the given times
+ResampleStats MeasureErrorsAt(const AnimationClip& source, const ResampledClip& resampled, const std::vector<float>& times)
+{
+	ResampleStats stats = {};
+	std::uint32_t numBones = source.GetBoneCount();
+	Pose sourcePose(numBones);
+	Pose resampledPose(numBones);
+	for (float time : times)
+	{
+		SampleClip(source, time, sourcePose);
+		SampleClip(resampled, time, resampledPose);
+		for (std::uint32_t boneIdx = 0u; boneIdx < numBones; boneIdx++)
+		{
+			Transform expected = sourcePose.GetTransform(boneIdx);
+			Transform actual = resampledPose.GetTransform(boneIdx);
+			float dot = fabsf(expected.Rotation.x * actual.Rotation.x + expected.Rotation.y * actual.Rotation.y
+				+ expected.Rotation.z * actual.Rotation.z + expected.Rotation.w * actual.Rotation.w);
+			stats.MaxPositionError = std::max(stats.MaxPositionError, (expected.Pos - actual.Pos).Magnitude());
+			stats.MaxRotationError = std::max(stats.MaxRotationError, 2.f * acosf(std::min(1.f, dot)));
+			stats.MaxScaleError = std::max(stats.MaxScaleError, (expected.Scale - actual.Scale).Magnitude());
+		}
+	}
+	return stats;
+}
+
+}
+
+void TestResampledClipErrorsAreBounded()
+{
+	// Keys 30 times a second. Over the 0.1 s between frames at 10 Hz, the hips move at most
+	//  0.07 off the chord between frames, and the bones turn at most 0.013 radians off it.
+	Skeleton skeleton = BuildTestSkeleton();
+	std::shared_ptr<AnimationClip> clip = BuildTestClip(skeleton, 2.f, 61u);
+	std::vector<float> keyTimes;
+	for (std::uint32_t keyIdx = 0u; keyIdx < 61u; keyIdx++)
+	{
+		keyTimes.push_back(2.f * keyIdx / 60.f);
+	}
+
+	// Frames on every source key reproduce the clip at those keys, to within what acosf
+	//  resolves of a float dot product close to 1
+	ResampleStats keyRateStats;
+	std::shared_ptr<ResampledClip> keyRate = ResampledClip::Create(*clip, 30.f, keyRateStats);
+	CHECK(keyRate->GetFrameCount() == 61u);
+	CHECK(keyRateStats.SizeInBytes == keyRate->GetSizeInBytes());
+	CHECK(keyRateStats.MaxPositionError < 1e-4f);
+	CHECK(keyRateStats.MaxRotationError < 2e-3f);
+	CHECK(keyRateStats.MaxScaleError < 1e-5f);
+
+	// Fewer frames than keys lose detail, within the bounds above, and the stats report the
+	//  largest error found at any of the source keys
+	ResampleStats lowRateStats;
+	std::shared_ptr<ResampledClip> lowRate = ResampledClip::Create(*clip, 10.f, lowRateStats);
+	CHECK(lowRate->GetFrameCount() == 21u);
+	CHECK(lowRateStats.MaxPositionError > 1e-3f && lowRateStats.MaxPositionError < 0.07f);
+	CHECK(lowRateStats.MaxRotationError > 1e-3f && lowRateStats.MaxRotationError < 0.013f);
+	CHECK(lowRateStats.MaxScaleError < 1e-5f);
+
+	ResampleStats measured = MeasureErrorsAt(*clip, *lowRate, keyTimes);
+	CHECK(fabsf(measured.MaxPositionError - lowRateStats.MaxPositionError) < 1e-5f);
+	CHECK(fabsf(measured.MaxRotationError - lowRateStats.MaxRotationError) < 1e-4f);
+}
\ No newline at end of file
@@ -0,0 +1,166 @@
+#include "Tests.h"
+#include "TestHarness.h"
+#include "SkinWeights.h"
+#include <cmath>
+#include <cstring>
+#include <random>
+#include <vector>
+
+namespace
+{
+
+const float WEIGHT_TOLERANCE = 1e-5f;
+
+// The weights of a packed vertex as stored, after its four bone indices
+void ReadPackedWeights(const std::uint8_t* packed, INFLUENCE_WEIGHT_FORMAT format, std::uint32_t* outWeights)
+{
+	for (std::uint32_t i = 0u; i < VertexInfluences::MAX_INFLUENCES; i++)
+	{
+		if (format == INFLUENCE_WEIGHT_FORMAT::UNORM16)
+		{
+			std::uint16_t weight = 0u;
+			memcpy(&weight, packed + VertexInfluences::MAX_INFLUENCES + i * sizeof(std::uint16_t), sizeof(weight));
+			outWeights[i] = weight;
+		}
+		else
+		{
+			outWeights[i] = packed[VertexInfluences::MAX_INFLUENCES + i];
+		}
+	}
+}
+
+std::uint32_t GetMaxPackedWeight(INFLUENCE_WEIGHT_FORMAT format)
+{
+	return (format == INFLUENCE_WEIGHT_FORMAT::UNORM16) ? 0xFFFFu : 0xFFu;
+}
+
+}
+
+void TestAddInfluenceKeepsHeaviest()
+{
+	// Six influences, in no order, and one of no weight that is never added
+	VertexInfluences truncated = {};
+	const float weights[] = { 0.1f, 0.4f, 0.05f, 0.3f, 0.2f, 0.f, 0.15f };
+	for (std::uint32_t i = 0u; i < sizeof(weights) / sizeof(float); i++)
+	{
+		AddInfluence(truncated, 10u + i, weights[i]);
+	}
+
+	// The four heaviest are kept heaviest first, and the two lightest are lost
+	const std::uint32_t expectedBones[] = { 11u, 13u, 14u, 16u };
+	const float expectedWeights[] = { 0.4f, 0.3f, 0.2f, 0.15f };
+	CHECK(truncated.NumInfluences == VertexInfluences::MAX_INFLUENCES);
+	bool areKeptExpected = true;
+	for (std::uint32_t i = 0u; i < VertexInfluences::MAX_INFLUENCES; i++)
+	{
+		areKeptExpected = areKeptExpected && truncated.BoneIndices[i] == expectedBones[i] && fabsf(truncated.Weights[i] - expectedWeights[i]) <= WEIGHT_TOLERANCE;
+	}
+	CHECK(areKeptExpected);
+	CHECK(fabsf(truncated.TotalWeight - 1.2f) <= WEIGHT_TOLERANCE);
+	CHECK(fabsf(truncated.LostWeight - 0.15f) <= WEIGHT_TOLERANCE);
+
+	VertexInfluences unweighted = {};
+	VertexInfluences kept = {};
+	AddInfluence(kept, 3u, 0.25f);
+	AddInfluence(kept, 4u, 0.75f);
+	CHECK(kept.NumInfluences == 2u && kept.BoneIndices[0u] == 4u && kept.LostWeight == 0.f);
+
+	// Lost weight is measured as a share of the whole weight of the vertex
+	InfluenceStats stats = MeasureInfluences({ truncated, unweighted, kept });
+	CHECK(stats.NumVertices == 3u);
+	CHECK(stats.NumTruncatedVertices == 1u);
+	CHECK(stats.NumUnweightedVertices == 1u);
+	CHECK(fabsf(stats.MaxLostWeight - 0.125f) <= WEIGHT_TOLERANCE);
+}
+
+void TestPackedWeightsSumToMax()
+{
+	// Weights that rarely round to the maximum on their own, including truncated vertices
+	std::mt19937 random(20u);
+	std::uniform_real_distribution<float> unit(0.001f, 1.f);
+	std::vector<VertexInfluences> vertices(1000u);
+	for (VertexInfluences& vertex : vertices)
+	{
+		vertex = {};
+		std::uint32_t numInfluences = 1u + random() % 6u;
+		for (std::uint32_t i = 0u; i < numInfluences; i++)
+		{
+			AddInfluence(vertex, (std::uint32_t)(random() % MAX_PALETTE_BONES), unit(random));
+		}
+	}
+
+	const INFLUENCE_WEIGHT_FORMAT formats[] = { INFLUENCE_WEIGHT_FORMAT::UNORM16, INFLUENCE_WEIGHT_FORMAT::UNORM8 };
+	for (INFLUENCE_WEIGHT_FORMAT format : formats)
+	{
+		std::uint32_t maxWeight = GetMaxPackedWeight(format);
+		std::uint8_t packed[16];
+		CHECK(GetPackedInfluenceSize(format) <= sizeof(packed));
+
+		bool areSumsMax = true;
+		bool areUnpackedNear = true;
+		for (const VertexInfluences& vertex : vertices)
+		{
+			PackInfluences(vertex, format, packed);
+			std::uint32_t packedWeights[VertexInfluences::MAX_INFLUENCES];
+			ReadPackedWeights(packed, format, packedWeights);
+			std::uint32_t packedTotal = 0u;
+			for (std::uint32_t weight : packedWeights)
+			{
+				packedTotal += weight;
+			}
+			areSumsMax = areSumsMax && packedTotal == maxWeight;
+
+			// Each weight is its share of the kept weight, to within rounding
+			float keptWeight = vertex.TotalWeight - vertex.LostWeight;
+			std::uint8_t boneIndices[VertexInfluences::MAX_INFLUENCES];
+			float weights[VertexInfluences::MAX_INFLUENCES];
+			UnpackInfluences(packed, format, boneIndices, weights);
+			for (std::uint32_t i = 0u; i < vertex.NumInfluences; i++)
+			{
+				areUnpackedNear = areUnpackedNear && boneIndices[i] == vertex.BoneIndices[i]
+					&& fabsf(weights[i] - vertex.Weights[i] / keptWeight) <= 4.f / maxWeight;
+			}
+		}
+		CHECK(areSumsMax);
+		CHECK(areUnpackedNear);
+	}
+}
+
+void TestCompactPaletteMapsUnweightedToBoneZero()
+{
+	// Bones past the 256 a palette can index, and a vertex with none at all
+	const std::uint32_t SOURCE_BONES = 300u;
+	std::vector<VertexInfluences> vertices(3u);
+	for (VertexInfluences& vertex : vertices)
+	{
+		vertex = {};
+	}
+	AddInfluence(vertices[0u], 299u, 0.6f);
+	AddInfluence(vertices[0u], 5u, 0.4f);
+	AddInfluence(vertices[2u], 250u, 1.f);
+
+	std::vector<std::uint32_t> paletteBones;
+	CompactInfluencePalette(vertices, SOURCE_BONES, paletteBones);
+	CHECK(paletteBones == std::vector<std::uint32_t>({ 5u, 250u, 299u }));
+	CHECK(vertices[0u].BoneIndices[0u] == 2u && vertices[0u].BoneIndices[1u] == 0u);
+	CHECK(vertices[1u].NumInfluences == 0u);
+	CHECK(vertices[2u].BoneIndices[0u] == 1u);
+
+	// An unweighted vertex follows palette bone 0 with the whole weight
+	const INFLUENCE_WEIGHT_FORMAT formats[] = { INFLUENCE_WEIGHT_FORMAT::UNORM16, INFLUENCE_WEIGHT_FORMAT::UNORM8 };
+	for (INFLUENCE_WEIGHT_FORMAT format : formats)
+	{
+		std::uint8_t packed[16];
+		memset(packed, 0xAB, sizeof(packed));
+		PackInfluences(vertices[1u], format, packed);
+		std::uint32_t packedWeights[VertexInfluences::MAX_INFLUENCES];
+		ReadPackedWeights(packed, format, packedWeights);
+
+		bool isBoneZero = packedWeights[0u] == GetMaxPackedWeight(format);
+		for (std::uint32_t i = 0u; i < VertexInfluences::MAX_INFLUENCES; i++)
+		{
+			isBoneZero = isBoneZero && packed[i] == 0u && (i == 0u || packedWeights[i] == 0u);
+		}
+		CHECK(isBoneZero);
+	}
+}
\ No newline at end of file
@@ -0,0 +1,230 @@
+#include "Tests.h"
+#include "TestHarness.h"
+#include "Skinning.h"
+#include "MatrixPalette.h"
+#include "Transform.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <memory>
+#include <random>
+#include <vector>
+
+namespace
+{
+
+const std::uint32_t TEST_BONES = 67u;
+const float POSITION_TOLERANCE = 1e-3f;
+const float NORMAL_TOLERANCE = 1e-4f;
+
+// Laid out like the position and normal of a vertex buffer, with room for more attributes
+struct TestVertex
+{
+public:
+	float Position[4];
+	float Normal[4];
+};
+
+// Random rigid bone transforms, and a mesh whose vertices have one to four influences in turn
+struct TestSkin
+{
+public:
+	std::vector<Matrix3x4> Palette;
+	std::unique_ptr<SkinningMesh> Mesh;
+	std::vector<std::uint8_t> BoneIndices;
+	std::vector<float> Weights;
+	std::vector<std::uint32_t> NumInfluences;
+
+	explicit TestSkin(std::uint32_t numVertices)
+		: Palette(TEST_BONES)
+		, Mesh(new SkinningMesh(numVertices))
+		, BoneIndices(numVertices * SkinningMesh::MAX_INFLUENCES)
+		, Weights(numVertices * SkinningMesh::MAX_INFLUENCES)
+		, NumInfluences(numVertices)
+	{
+		std::mt19937 random(7u);
+		std::uniform_real_distribution<float> unit(-1.f, 1.f);
+
+		for (Matrix3x4& bone : Palette)
+		{
+			Vec3 axis = Vec3(unit(random), unit(random), unit(random) + 1.5f).Normal();
+			Transform transform(Vec3(unit(random), unit(random), unit(random)) * 10.f, Quaternion(axis, unit(random) * 1.2f), Vec3(1.f, 1.f, 1.f));
+			bone = ToMatrix3x4(transform.GetTransformMatrix());
+		}
+
+		for (std::uint32_t vertexIdx = 0u; vertexIdx < numVertices; vertexIdx++)
+		{
+			std::uint8_t* boneIndices = &BoneIndices[vertexIdx * SkinningMesh::MAX_INFLUENCES];
+			float* weights = &Weights[vertexIdx * SkinningMesh::MAX_INFLUENCES];
+			NumInfluences[vertexIdx] = 1u + vertexIdx % SkinningMesh::MAX_INFLUENCES;
+
+			float totalWeight = 0.f;
+			for (std::uint32_t influence = 0u; influence < NumInfluences[vertexIdx]; influence++)
+			{
+				boneIndices[influence] = (std::uint8_t)(random() % TEST_BONES);
+				weights[influence] = 0.1f + fabsf(unit(random));
+				totalWeight += weights[influence];
+			}
+			for (std::uint32_t influence = 0u; influence < NumInfluences[vertexIdx]; influence++)
+			{
+				weights[influence] /= totalWeight;
+			}
+
+			Vec3 position = Vec3(unit(random), unit(random), unit(random)) * 50.f;
+			Vec3 normal = Vec3(unit(random), unit(random), unit(random)).Normal();
+			Mesh->SetVertex(vertexIdx, position, normal, boneIndices, weights, NumInfluences[vertexIdx]);
+		}
+	}
+};
+
+SkinningOutput GetOutput(std::vector<TestVertex>& vertices)
+{
+	SkinningOutput output;
+	output.Positions = vertices[0].Position;
+	output.Normals = vertices[0].Normal;
+	output.Stride = sizeof(TestVertex);
+	return output;
+}
+
+// Blends the influence matrices one vertex at a time
+void SkinVertexReference(const TestSkin& skin, std::uint32_t vertexIdx, float* outPosition, float* outNormal)
+{
+	float blended[3][4] = {};
+	for (std::uint32_t influence = 0u; influence < skin.NumInfluences[vertexIdx]; influence++)
+	{
+		const Matrix3x4& bone = skin.Palette[skin.BoneIndices[vertexIdx * SkinningMesh::MAX_INFLUENCES + influence]];
+		float weight = skin.Weights[vertexIdx * SkinningMesh::MAX_INFLUENCES + influence];
+		for (std::uint32_t row = 0u; row < 3u; row++)
+		{
+			for (std::uint32_t col = 0u; col < 4u; col++)
+			{
+				blended[row][col] += weight * bone.m[row][col];
+			}
+		}
+	}
+
+	const SkinningMesh& mesh = *skin.Mesh;
+	float position[3] = { mesh.GetStream(SKINNING_STREAM::POS_X)[vertexIdx], mesh.GetStream(SKINNING_STREAM::POS_Y)[vertexIdx], mesh.GetStream(SKINNING_STREAM::POS_Z)[vertexIdx] };
+	float normal[3] = { mesh.GetStream(SKINNING_STREAM::NORMAL_X)[vertexIdx], mesh.GetStream(SKINNING_STREAM::NORMAL_Y)[vertexIdx], mesh.GetStream(SKINNING_STREAM::NORMAL_Z)[vertexIdx] };
+
+	float normalLength = 0.f;
+	for (std::uint32_t row = 0u; row < 3u; row++)
+	{
+		outPosition[row] = blended[row][0u] * position[0u] + blended[row][1u] * position[1u] + blended[row][2u] * position[2u] + blended[row][3u];
+		outNormal[row] = blended[row][0u] * normal[0u] + blended[row][1u] * normal[1u] + blended[row][2u] * normal[2u];
+		normalLength += outNormal[row] * outNormal[row];
+	}
+
+	normalLength = sqrtf(normalLength);
+	for (std::uint32_t row = 0u; row < 3u; row++)
+	{
+		outNormal[row] /= normalLength;
+	}
+}
+
+bool IsNear(const float* a, const float* b, float tolerance)
+{
+	return fabsf(a[0u] - b[0u]) <= tolerance && fabsf(a[1u] - b[1u]) <= tolerance && fabsf(a[2u] - b[2u]) <= tolerance;
+}
+
+}
+
+void TestLinearBlendSkinningMatchesReference()
+{
+	// Not a multiple of the batch width, so the last batch is partly padding
+	const std::uint32_t NUM_VERTICES = 5003u;
+	TestSkin skin(NUM_VERTICES);
+
+	std::vector<TestVertex> vertices(NUM_VERTICES);
+	SkinVertices(*skin.Mesh, &skin.Palette[0], 0u, NUM_VERTICES, GetOutput(vertices));
+
+	for (std::uint32_t vertexIdx = 0u; vertexIdx < NUM_VERTICES; vertexIdx++)
+	{
+		float position[3];
+		float normal[3];
+		SkinVertexReference(skin, vertexIdx, position, normal);
+		CHECK(IsNear(vertices[vertexIdx].Position, position, POSITION_TOLERANCE));
+		CHECK(IsNear(vertices[vertexIdx].Normal, normal, NORMAL_TOLERANCE));
+	}
+
+	// Anything past x, y and z of the outputs is left alone
+	std::vector<TestVertex> jobVertices(NUM_VERTICES);
+	for (TestVertex& vertex : jobVertices)
+	{
+		vertex.Position[3u] = 2.f;
+		vertex.Normal[3u] = 3.f;
+	}
+
+	// Ranges on the job system write the same vertices
+	JobSystem jobSystem(4u);
+	SkinVertices(jobSystem, *skin.Mesh, &skin.Palette[0], GetOutput(jobVertices));
+	for (std::uint32_t vertexIdx = 0u; vertexIdx < NUM_VERTICES; vertexIdx++)
+	{
+		CHECK(IsNear(jobVertices[vertexIdx].Position, vertices[vertexIdx].Position, 0.f));
+		CHECK(IsNear(jobVertices[vertexIdx].Normal, vertices[vertexIdx].Normal, 0.f));
+		CHECK(jobVertices[vertexIdx].Position[3u] == 2.f && jobVertices[vertexIdx].Normal[3u] == 3.f);
+	}
+}
+
+void TestDualQuaternionSkinningMatchesRigidBones()
+{
+	// With a single influence, both methods apply one rigid transform
+	const std::uint32_t NUM_VERTICES = 4096u;
+	TestSkin skin(NUM_VERTICES);
+
+	std::vector<DualQuaternion> dualQuaternions(TEST_BONES);
+	BuildDualQuaternionPalette(&skin.Palette[0], TEST_BONES, &dualQuaternions[0]);
+
+	std::vector<TestVertex> linearVertices(NUM_VERTICES);
+	std::vector<TestVertex> dualQuaternionVertices(NUM_VERTICES);
+	SkinVertices(*skin.Mesh, &skin.Palette[0], 0u, NUM_VERTICES, GetOutput(linearVertices));
+	SkinVertices(*skin.Mesh, &dualQuaternions[0], 0u, NUM_VERTICES, GetOutput(dualQuaternionVertices));
+
+	for (std::uint32_t vertexIdx = 0u; vertexIdx < NUM_VERTICES; vertexIdx++)
+	{
+		if (skin.NumInfluences[vertexIdx] == 1u)
+		{
+			CHECK(IsNear(dualQuaternionVertices[vertexIdx].Position, linearVertices[vertexIdx].Position, POSITION_TOLERANCE));
+			CHECK(IsNear(dualQuaternionVertices[vertexIdx].Normal, linearVertices[vertexIdx].Normal, NORMAL_TOLERANCE));
+		}
+	}
+}
+
+void BenchmarkSkinning()
+{
+	const std::uint32_t NUM_VERTICES = 200000u;
+	const std::uint32_t NUM_RUNS = 20u;
+	const std::uint32_t threadCounts[] = { 1u, 2u, 4u, 8u };
+
+	TestSkin skin(NUM_VERTICES);
+	std::vector<DualQuaternion> dualQuaternions(TEST_BONES);
+	BuildDualQuaternionPalette(&skin.Palette[0], TEST_BONES, &dualQuaternions[0]);
+	std::vector<TestVertex> vertices(NUM_VERTICES);
+	SkinningOutput output = GetOutput(vertices);
+
+	printf("%u vertices, %u bones, one to four influences each\n", NUM_VERTICES, TEST_BONES);
+	for (std::uint32_t numThreads : threadCounts)
+	{
+		JobSystem jobSystem(numThreads);
+
+		// First run outside of the timing, to start the workers and warm the caches
+		SkinVertices(jobSystem, *skin.Mesh, &skin.Palette[0], output);
+
+		Stopwatch linearStopwatch;
+		for (std::uint32_t run = 0u; run < NUM_RUNS; run++)
+		{
+			SkinVertices(jobSystem, *skin.Mesh, &skin.Palette[0], output);
+		}
+		double linearMs = linearStopwatch.GetMilliseconds() / NUM_RUNS;
+
+		Stopwatch dualQuaternionStopwatch;
+		for (std::uint32_t run = 0u; run < NUM_RUNS; run++)
+		{
+			SkinVertices(jobSystem, *skin.Mesh, &dualQuaternions[0], output);
+		}
+		double dualQuaternionMs = dualQuaternionStopwatch.GetMilliseconds() / NUM_RUNS;
+
+		printf("%u threads: linear blend %.2f ms (%.1f ns/vertex), dual quaternion %.2f ms (%.1f ns/vertex)\n", numThreads,
+			linearMs, linearMs * 1e6 / NUM_VERTICES, dualQuaternionMs, dualQuaternionMs * 1e6 / NUM_VERTICES);
+	}
+}
\ No newline at end of file
@@ -0,0 +1,105 @@
+#include "Tests.h"
+#include "TestHarness.h"
+#include "MeshBaker.h"
+#include "BakedMesh.h"
+#include <cstdio>
+#include <fstream>
+#include <vector>
+
+namespace
+{
+
+// Runs of each path averaged, after one that warms the file cache, so both paths read from memory
+const std::uint32_t NUM_RUNS = 5u;
+
+struct MeshAsset
+{
+public:
+	const char* SourceFilename;
+	const char* BenchmarkFilename;
+	MeshBakeOptions Options;
+};
+
+// The meshes and bake options of RoadBaseModel and MixamoCharacterResources, found from the
+//  output directory of the tests the same way the demo finds them from its own
+const MeshAsset MESH_ASSETS[] = {
+	{ "../../../Animation Tutorial/assets/Road.fbx", "Road.benchmark.mesh", MeshBakeOptions(true, INFLUENCE_WEIGHT_FORMAT::UNORM16) },
+	{ "../../../Animation Tutorial/assets/Beta.fbx", "Beta.benchmark.mesh", MeshBakeOptions(false, INFLUENCE_WEIGHT_FORMAT::UNORM16) },
+};
+
+std::uint32_t SumWords(const void* data, std::uint32_t size)
+{
+	const std::uint32_t* words = static_cast<const std::uint32_t*>(data);
+	std::uint32_t sum = 0u;
+	for (std::uint32_t wordIdx = 0u; wordIdx < size / sizeof(std::uint32_t); wordIdx++)
+	{
+		sum += words[wordIdx];
+	}
+	return sum;
+}
+
+// Reads every stream once, as CreateBuffer does when it uploads them out of the mapping, so
+//  the pages of the file are actually brought in
+std::uint32_t ReadStreams(const BakedMesh& bakedMesh)
+{
+	std::uint32_t sum = 0u;
+	for (std::uint32_t meshIdx = 0u; meshIdx < bakedMesh.GetMeshCount(); meshIdx++)
+	{
+		const BakedMesh::MeshEntry& mesh = bakedMesh.GetMesh(meshIdx);
+		sum += SumWords(bakedMesh.GetVertexData(meshIdx), mesh.NumVertices * mesh.VertexStride);
+		sum += SumWords(bakedMesh.GetIndexData(meshIdx), mesh.NumIndices * mesh.IndexSize);
+		if (bakedMesh.GetInfluenceData(meshIdx) != nullptr)
+		{
+			sum += SumWords(bakedMesh.GetInfluenceData(meshIdx), mesh.NumVertices * mesh.InfluenceSize);
+		}
+	}
+	return sum;
+}
+
+}
+
+// Compares the CPU side of the two ways a mesh reaches startup: importing the FBX file through
+//  assimp and building its streams, or mapping the baked file. Both then create the same
+//  GPU buffers from the same streams, which is left out. The baked file is written from the
+//  same import, so both paths always load identical data.
+void BenchmarkMeshStartup()
+{
+	for (const MeshAsset& asset : MESH_ASSETS)
+	{
+		std::vector<char> blob;
+		if (!CHECK(BuildBakedMesh(asset.SourceFilename, asset.Options, blob)))
+		{
+			printf("%s: could not import - run from the output directory, with the demo's assets in place\n", asset.SourceFilename);
+			continue;
+		}
+
+		std::ofstream(asset.BenchmarkFilename, std::ios::binary).write(&blob[0], blob.size());
+
+		double importMs = 0.;
+		for (std::uint32_t runIdx = 0u; runIdx < NUM_RUNS; runIdx++)
+		{
+			Stopwatch stopwatch;
+			CHECK(BuildBakedMesh(asset.SourceFilename, asset.Options, blob));
+			importMs += stopwatch.GetMilliseconds();
+		}
+
+		std::uint32_t checksum = ReadStreams(*BakedMesh::Load(asset.BenchmarkFilename));
+		double loadMs = 0.;
+		for (std::uint32_t runIdx = 0u; runIdx < NUM_RUNS; runIdx++)
+		{
+			Stopwatch stopwatch;
+			std::shared_ptr<BakedMesh> bakedMesh = BakedMesh::Load(asset.BenchmarkFilename);
+			if (CHECK(bakedMesh != nullptr))
+			{
+				CHECK(ReadStreams(*bakedMesh) == checksum);
+			}
+			loadMs += stopwatch.GetMilliseconds();
+		}
+
+		importMs /= NUM_RUNS;
+		loadMs /= NUM_RUNS;
+		printf("%s (%u bytes baked): FBX import %.2f ms, baked load %.3f ms, %.0fx faster\n", asset.SourceFilename, (std::uint32_t)blob.size(), importMs, loadMs, importMs / loadMs);
+
+		std::remove(asset.BenchmarkFilename);
+	}
+}
\ No newline at end of file
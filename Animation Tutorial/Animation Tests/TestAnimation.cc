@@ -0,0 +1,98 @@
+#include "TestAnimation.h"
+#include <cmath>
+#include <string>
+#include <vector>
+
+namespace
+{
+
+const char* const SIDES[] = { "Left", "Right" };
+const char* const ARM_BONES[] = { "Shoulder", "Arm", "ForeArm", "Hand" };
+const char* const FINGERS[] = { "Thumb", "Index", "Middle", "Ring", "Pinky" };
+const char* const LEG_BONES[] = { "UpLeg", "Leg", "Foot", "ToeBase", "Toe_End" };
+const std::uint32_t BONES_PER_FINGER = 4u;
+
+Transform Offset(float x, float y)
+{
+	return Transform(Vec3(x, y, 0.f), Quaternion(), Vec3(1.f, 1.f, 1.f));
+}
+
+}
+
+Skeleton BuildTestSkeleton()
+{
+	Skeleton skeleton;
+	std::uint32_t hips = skeleton.AddBone("Hips", Skeleton::INVALID_INDEX, Transform());
+	std::uint32_t spine = skeleton.AddBone("Spine", hips, Offset(0.f, 10.f));
+	std::uint32_t spine1 = skeleton.AddBone("Spine1", spine, Offset(0.f, 10.f));
+	std::uint32_t spine2 = skeleton.AddBone("Spine2", spine1, Offset(0.f, 10.f));
+	std::uint32_t neck = skeleton.AddBone("Neck", spine2, Offset(0.f, 10.f));
+	std::uint32_t head = skeleton.AddBone("Head", neck, Offset(0.f, 10.f));
+	skeleton.AddBone("HeadTop_End", head, Offset(0.f, 10.f));
+	skeleton.AddBone("LeftEye", head, Offset(-3.f, 5.f));
+	skeleton.AddBone("RightEye", head, Offset(3.f, 5.f));
+
+	for (const char* side : SIDES)
+	{
+		float direction = (std::string(side) == "Left") ? -1.f : 1.f;
+
+		std::uint32_t parent = spine2;
+		for (const char* bone : ARM_BONES)
+		{
+			parent = skeleton.AddBone(std::string(side) + bone, parent, Offset(8.f * direction, 0.f));
+		}
+
+		std::uint32_t hand = parent;
+		for (const char* finger : FINGERS)
+		{
+			parent = hand;
+			for (std::uint32_t joint = 1u; joint <= BONES_PER_FINGER; joint++)
+			{
+				parent = skeleton.AddBone(std::string(side) + "Hand" + finger + std::to_string(joint), parent, Offset(2.f * direction, 0.f));
+			}
+		}
+
+		parent = hips;
+		for (const char* bone : LEG_BONES)
+		{
+			parent = skeleton.AddBone(std::string(side) + bone, parent, Offset(0.f, -15.f));
+		}
+	}
+
+	return skeleton;
+}
+
+std::shared_ptr<AnimationClip> BuildTestClip(const Skeleton& skeleton, float duration, std::uint32_t numKeys)
+{
+	std::uint32_t numBones = skeleton.GetBoneCount();
+	std::vector<BoneAnimation> boneAnimations;
+	boneAnimations.reserve(numBones);
+
+	for (std::uint32_t boneIdx = 0u; boneIdx < numBones; boneIdx++)
+	{
+		const Transform& bind = skeleton.GetBone(boneIdx).FromParentTransform;
+		float rate = 1.f + (float)(boneIdx % 5u);
+
+		std::vector<PositionKeyframe> positions;
+		std::vector<RotationKeyframe> rotations;
+		std::vector<ScaleKeyframe> scales;
+		for (std::uint32_t keyIdx = 0u; keyIdx < numKeys; keyIdx++)
+		{
+			float time = duration * (float)keyIdx / (float)(numKeys - 1u);
+			Vec3 position = (boneIdx == 0u) ? Vec3(sinf(time) * 50.f, 100.f + cosf(2.f * time) * 5.f, time * 10.f) : bind.Pos;
+
+			positions.push_back(PositionKeyframe(time, position));
+			rotations.push_back(RotationKeyframe(time, Quaternion(Vec3(0.3f, 0.9f, 0.1f).Normal(), 0.4f * sinf(time * rate + (float)boneIdx))));
+			scales.push_back(ScaleKeyframe(time, Vec3(1.f, 1.f, 1.f)));
+		}
+		boneAnimations.push_back(BoneAnimation(positions, rotations, scales));
+	}
+
+	std::vector<const BoneAnimation*> boneAnimationPtrs;
+	for (const BoneAnimation& boneAnimation : boneAnimations)
+	{
+		boneAnimationPtrs.push_back(&boneAnimation);
+	}
+
+	return AnimationClip::Create(skeleton, boneAnimationPtrs, duration);
+}
\ No newline at end of file
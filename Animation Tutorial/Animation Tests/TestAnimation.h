@@ -0,0 +1,16 @@
+#pragma once
+
+#include "Skeleton.h"
+#include "AnimationClip.h"
+#include <memory>
+
+// Synthetic animation data with the shape of the Mixamo assets the demo loads, so tests and
+//  benchmarks run without the FBX files or the importer.
+
+// A 67 bone humanoid, with Mixamo bone names (without the "mixamorig:" prefix), so bone
+//  masks built by name pick out the same bones they would on the real character
+Skeleton BuildTestSkeleton();
+
+// Every bone rotates back and forth at its own rate, and the hips travel, with a key for
+//  every channel at each of numKeys evenly spaced times
+std::shared_ptr<AnimationClip> BuildTestClip(const Skeleton& skeleton, float duration, std::uint32_t numKeys);
\ No newline at end of file
@@ -0,0 +1,25 @@
+#include "TestHarness.h"
+#include <cstdio>
+
+namespace
+{
+
+std::uint32_t g_failedChecks = 0u;
+
+}
+
+bool CheckCondition(bool condition, const char* expression, const char* file, int line)
+{
+	if (!condition)
+	{
+		printf("%s(%d): check failed: %s\n", file, line, expression);
+		g_failedChecks++;
+	}
+
+	return condition;
+}
+
+std::uint32_t GetFailedCheckCount()
+{
+	return g_failedChecks;
+}
\ No newline at end of file
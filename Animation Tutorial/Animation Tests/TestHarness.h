@@ -0,0 +1,28 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+
+// A failed check prints the condition and where it is, and fails the test that made it. The
+//  test carries on, so one run reports every broken check.
+#define CHECK(condition) CheckCondition((condition), #condition, __FILE__, __LINE__)
+
+bool CheckCondition(bool condition, const char* expression, const char* file, int line);
+std::uint32_t GetFailedCheckCount();
+
+// Wall clock time since construction, for benchmarks
+class Stopwatch
+{
+public:
+	Stopwatch()
+		: start_(std::chrono::high_resolution_clock::now())
+	{}
+
+	double GetMilliseconds() const
+	{
+		return std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start_).count();
+	}
+
+private:
+	std::chrono::high_resolution_clock::time_point start_;
+};
\ No newline at end of file
@@ -0,0 +1,75 @@
+#pragma once
+
+// Every test and benchmark of the project, run by name from main.cc. Everything runs
+//  headlessly, on engine code that needs neither a window nor a D3D11 device.
+
+// AnimationLodTests.cc
+void TestBoneMaskSkipsDetailBones();
+void BenchmarkCrowdLodError();
+
+// BlendTreeTests.cc
+void TestBlendSpaceWeights();
+
+// BoneAnimationTests.cc
+void BenchmarkCursorSampling();
+
+// ClipSamplerTests.cc
+void TestClipSamplingMatchesBoneAnimations();
+void TestCompressedSamplingMatchesDecodedKeys();
+void BenchmarkCompressedSampling();
+void BenchmarkResampledSampling();
+
+// ConstantRingAllocatorTests.cc
+void TestConstantRingAllocatorFillsRing();
+void TestConstantRingAllocatorKeepsFramesApart();
+
+// JobSystemTests.cc
+void TestParallelForCoversRange();
+void TestNestedJobs();
+void BenchmarkCrowdUpdateScaling();
+
+// MaffsTests.cc
+void TestSimdKernelsMatchScalar();
+void TestPerspectiveMatchesDirectXMath();
+void BenchmarkMaffsKernels();
+
+// MappedFileTests.cc
+void TestMappedFileReadsWholeFile();
+
+// MatrixPaletteTests.cc
+void TestSkinningPaletteMatchesTransforms();
+void TestBindOffsetsInvertBindPose();
+
+// MeshProcessingTests.cc
+void TestWeldVerticesMergesIdenticalVertices();
+void TestOptimizeVertexCacheLowersACMR();
+
+// PoseBlendTests.cc
+void TestPoseBlendsMatchScalar();
+
+// RenderQueueTests.cc
+void TestRenderQueueSortsDraws();
+void TestRenderQueueGathersInstances();
+void TestHeadlessBackendRejectsInvalidDraws();
+void BenchmarkRenderQueueSubmission();
+
+// ResampledClipTests.cc
+void TestResampledClipErrorsAreBounded();
+
+// SkinningTests.cc
+void TestLinearBlendSkinningMatchesReference();
+void TestDualQuaternionSkinningMatchesRigidBones();
+void BenchmarkSkinning();
+
+// SkinWeightsTests.cc
+void TestAddInfluenceKeepsHeaviest();
+void TestPackedWeightsSumToMax();
+void TestCompactPaletteMapsUnweightedToBoneZero();
+
+// StartupBenchmarks.cc, which bakes meshes with assimp
+#if !defined(ANIMATION_TESTS_NO_ASSIMP)
+void BenchmarkMeshStartup();
+#endif
+
+// TransformHierarchyTests.cc
+void TestTransformHierarchyMatchesBruteForce();
\ No newline at end of file
@@ -0,0 +1,195 @@
+#include "Tests.h"
+#include "TestHarness.h"
+#include "TransformHierarchy.h"
+#include <algorithm>
+#include <cmath>
+#include <memory>
+#include <random>
+#include <vector>
+
+namespace
+{
+
+const std::uint32_t TEST_THREADS = 4u;
+const std::uint32_t INITIAL_NODES = 2000u;
+const std::uint32_t TEST_ROUNDS = 40u;
+const float TRANSFORM_TOLERANCE = 1e-4f;
+
+bool IsNear(float a, float b)
+{
+	return fabsf(a - b) <= TRANSFORM_TOLERANCE * std::max(1.f, std::max(fabsf(a), fabsf(b)));
+}
+
+bool IsNear(const Transform& a, const Transform& b)
+{
+	return IsNear(a.Pos.x, b.Pos.x) && IsNear(a.Pos.y, b.Pos.y) && IsNear(a.Pos.z, b.Pos.z)
+		&& IsNear(a.Rotation.x, b.Rotation.x) && IsNear(a.Rotation.y, b.Rotation.y) && IsNear(a.Rotation.z, b.Rotation.z) && IsNear(a.Rotation.w, b.Rotation.w)
+		&& IsNear(a.Scale.x, b.Scale.x) && IsNear(a.Scale.y, b.Scale.y) && IsNear(a.Scale.z, b.Scale.z);
+}
+
+bool IsNear(const Matrix& a, const Matrix& b)
+{
+	bool isNear = true;
+	for (std::uint32_t element = 0u; element < 16u; element++)
+	{
+		isNear = isNear && IsNear(a.m[element / 4u][element % 4u], b.m[element / 4u][element % 4u]);
+	}
+	return isNear;
+}
+
+Transform RandomTransform(std::mt19937& random)
+{
+	std::uniform_real_distribution<float> unit(-1.f, 1.f);
+	Quaternion rotation(Vec3(unit(random), unit(random), 1.f).Normal(), unit(random) * 3.f);
+	Vec3 scale(1.f + 0.2f * unit(random), 1.f + 0.2f * unit(random), 1.f + 0.2f * unit(random));
+	return Transform(Vec3(unit(random), unit(random), unit(random)) * 5.f, rotation, scale);
+}
+
+// The same nodes as plain parent links, with every world transform recomputed from its
+//  root down each time it is asked for
+struct ReferenceHierarchy
+{
+public:
+	std::vector<std::uint32_t> Parents;
+	std::vector<Transform> LocalTransforms;
+
+	// Set, added or reparented since the last update
+	std::vector<std::uint8_t> IsTouched;
+
+	void AddNode(std::uint32_t parentIdx, const Transform& localTransform)
+	{
+		Parents.push_back(parentIdx);
+		LocalTransforms.push_back(localTransform);
+		IsTouched.push_back(1u);
+	}
+
+	bool IsAncestorOrSelf(std::uint32_t ancestorIdx, std::uint32_t nodeIdx) const
+	{
+		for (; nodeIdx != TransformHierarchy::INVALID_INDEX; nodeIdx = Parents[nodeIdx])
+		{
+			if (nodeIdx == ancestorIdx)
+			{
+				return true;
+			}
+		}
+		return false;
+	}
+
+	Transform GetWorldTransform(std::uint32_t nodeIdx) const
+	{
+		std::uint32_t parentIdx = Parents[nodeIdx];
+		return (parentIdx == TransformHierarchy::INVALID_INDEX) ? LocalTransforms[nodeIdx] : GetWorldTransform(parentIdx) * LocalTransforms[nodeIdx];
+	}
+
+	// The world transform of a node changes if it or any node above it was touched
+	bool IsWorldChanged(std::uint32_t nodeIdx) const
+	{
+		for (; nodeIdx != TransformHierarchy::INVALID_INDEX; nodeIdx = Parents[nodeIdx])
+		{
+			if (IsTouched[nodeIdx] != 0u)
+			{
+				return true;
+			}
+		}
+		return false;
+	}
+};
+
+// Parents are picked from every node so far, so the tree is a few levels deep and wide
+//  enough that levels are split into jobs
+void AddRandomNode(TransformHierarchy& hierarchy, ReferenceHierarchy& reference, std::mt19937& random)
+{
+	std::uint32_t numNodes = (std::uint32_t)reference.Parents.size();
+	std::uint32_t parentIdx = (numNodes == 0u || random() % 20u == 0u) ? TransformHierarchy::INVALID_INDEX : (std::uint32_t)(random() % numNodes);
+	Transform localTransform = RandomTransform(random);
+	CHECK(hierarchy.AddNode(parentIdx, localTransform) == numNodes);
+	reference.AddNode(parentIdx, localTransform);
+}
+
+}
+
+void TestTransformHierarchyMatchesBruteForce()
+{
+	const bool parallelModes[] = { false, true };
+	for (bool isParallel : parallelModes)
+	{
+		std::mt19937 random(25u);
+		TransformHierarchy hierarchy;
+		ReferenceHierarchy reference;
+		if (isParallel)
+		{
+			hierarchy.SetJobSystem(std::make_shared<JobSystem>(TEST_THREADS));
+		}
+
+		for (std::uint32_t nodeIdx = 0u; nodeIdx < INITIAL_NODES; nodeIdx++)
+		{
+			AddRandomNode(hierarchy, reference, random);
+		}
+
+		// Every fifth round changes nothing, so nothing should be recomputed
+		for (std::uint32_t round = 0u; round < TEST_ROUNDS; round++)
+		{
+			if (round % 5u != 4u)
+			{
+				std::uint32_t numNodes = (std::uint32_t)reference.Parents.size();
+				for (std::uint32_t setIdx = 0u; setIdx < numNodes / 50u; setIdx++)
+				{
+					std::uint32_t nodeIdx = (std::uint32_t)(random() % numNodes);
+					Transform localTransform = RandomTransform(random);
+					hierarchy.SetLocalTransform(nodeIdx, localTransform);
+					reference.LocalTransforms[nodeIdx] = localTransform;
+					reference.IsTouched[nodeIdx] = 1u;
+				}
+
+				// Some of these would make a node its own ancestor, and must be refused
+				for (std::uint32_t moveIdx = 0u; moveIdx < 10u; moveIdx++)
+				{
+					std::uint32_t nodeIdx = (std::uint32_t)(random() % numNodes);
+					std::uint32_t parentIdx = (random() % 10u == 0u) ? TransformHierarchy::INVALID_INDEX : (std::uint32_t)(random() % numNodes);
+					bool isValidMove = !reference.IsAncestorOrSelf(nodeIdx, parentIdx);
+					CHECK(hierarchy.SetParent(nodeIdx, parentIdx) == isValidMove);
+					if (isValidMove)
+					{
+						reference.Parents[nodeIdx] = parentIdx;
+						reference.IsTouched[nodeIdx] = 1u;
+					}
+				}
+				CHECK(!hierarchy.SetParent(0u, 0u));
+
+				// New nodes need the layout redone, which renumbers every slot
+				for (std::uint32_t addIdx = 0u; addIdx < 20u; addIdx++)
+				{
+					AddRandomNode(hierarchy, reference, random);
+				}
+			}
+
+			std::uint32_t numUpdated = hierarchy.UpdateWorldTransforms();
+
+			std::uint32_t numNodes = (std::uint32_t)reference.Parents.size();
+			std::uint32_t numChanged = 0u;
+			bool areParentsEqual = true;
+			bool areWorldsNear = true;
+			bool areChangesEqual = true;
+			for (std::uint32_t nodeIdx = 0u; nodeIdx < numNodes; nodeIdx++)
+			{
+				Transform worldTransform = reference.GetWorldTransform(nodeIdx);
+				bool isChanged = reference.IsWorldChanged(nodeIdx);
+				numChanged += isChanged ? 1u : 0u;
+
+				areParentsEqual = areParentsEqual && hierarchy.GetParent(nodeIdx) == reference.Parents[nodeIdx];
+				areWorldsNear = areWorldsNear && IsNear(hierarchy.GetWorldTransform(nodeIdx), worldTransform)
+					&& IsNear(hierarchy.GetWorldMatrix(nodeIdx), worldTransform.GetTransformMatrix());
+				areChangesEqual = areChangesEqual && hierarchy.IsWorldChanged(nodeIdx) == isChanged;
+			}
+
+			CHECK(hierarchy.GetNodeCount() == numNodes);
+			CHECK(areParentsEqual);
+			CHECK(areWorldsNear);
+			CHECK(areChangesEqual);
+			CHECK(numUpdated == numChanged);
+			CHECK(round % 5u != 4u || numUpdated == 0u);
+
+			std::fill(reference.IsTouched.begin(), reference.IsTouched.end(), (std::uint8_t)0u);
+		}
+	}
+}
\ No newline at end of file
@@ -0,0 +1,113 @@
+#include "Tests.h"
+#include "TestHarness.h"
+#include "Logger.h"
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+namespace
+{
+
+struct TestCase
+{
+public:
+	const char* Name;
+	void (*Function)();
+};
+
+const TestCase TESTS[] = {
+	{ "BoneMaskSkipsDetailBones", TestBoneMaskSkipsDetailBones },
+	{ "BlendSpaceWeights", TestBlendSpaceWeights },
+	{ "ClipSamplingMatchesBoneAnimations", TestClipSamplingMatchesBoneAnimations },
+	{ "CompressedSamplingMatchesDecodedKeys", TestCompressedSamplingMatchesDecodedKeys },
+	{ "ConstantRingAllocatorFillsRing", TestConstantRingAllocatorFillsRing },
+	{ "ConstantRingAllocatorKeepsFramesApart", TestConstantRingAllocatorKeepsFramesApart },
+	{ "ParallelForCoversRange", TestParallelForCoversRange },
+	{ "NestedJobs", TestNestedJobs },
+	{ "SimdKernelsMatchScalar", TestSimdKernelsMatchScalar },
+	{ "PerspectiveMatchesDirectXMath", TestPerspectiveMatchesDirectXMath },
+	{ "MappedFileReadsWholeFile", TestMappedFileReadsWholeFile },
+	{ "SkinningPaletteMatchesTransforms", TestSkinningPaletteMatchesTransforms },
+	{ "BindOffsetsInvertBindPose", TestBindOffsetsInvertBindPose },
+	{ "WeldVerticesMergesIdenticalVertices", TestWeldVerticesMergesIdenticalVertices },
+	{ "OptimizeVertexCacheLowersACMR", TestOptimizeVertexCacheLowersACMR },
+	{ "PoseBlendsMatchScalar", TestPoseBlendsMatchScalar },
+	{ "RenderQueueSortsDraws", TestRenderQueueSortsDraws },
+	{ "RenderQueueGathersInstances", TestRenderQueueGathersInstances },
+	{ "HeadlessBackendRejectsInvalidDraws", TestHeadlessBackendRejectsInvalidDraws },
+	{ "ResampledClipErrorsAreBounded", TestResampledClipErrorsAreBounded },
+	{ "LinearBlendSkinningMatchesReference", TestLinearBlendSkinningMatchesReference },
+	{ "DualQuaternionSkinningMatchesRigidBones", TestDualQuaternionSkinningMatchesRigidBones },
+	{ "AddInfluenceKeepsHeaviest", TestAddInfluenceKeepsHeaviest },
+	{ "PackedWeightsSumToMax", TestPackedWeightsSumToMax },
+	{ "CompactPaletteMapsUnweightedToBoneZero", TestCompactPaletteMapsUnweightedToBoneZero },
+	{ "TransformHierarchyMatchesBruteForce", TestTransformHierarchyMatchesBruteForce },
+};
+
+const TestCase BENCHMARKS[] = {
+	{ "CrowdUpdateScaling", BenchmarkCrowdUpdateScaling },
+#if !defined(ANIMATION_TESTS_NO_ASSIMP)
+	{ "MeshStartup", BenchmarkMeshStartup },
+#endif
+	{ "CrowdLodError", BenchmarkCrowdLodError },
+	{ "CompressedSampling", BenchmarkCompressedSampling },
+	{ "CursorSampling", BenchmarkCursorSampling },
+	{ "MaffsKernels", BenchmarkMaffsKernels },
+	{ "ResampledSampling", BenchmarkResampledSampling },
+	{ "RenderQueueSubmission", BenchmarkRenderQueueSubmission },
+	{ "Skinning", BenchmarkSkinning },
+};
+
+// With no names given, everything is selected
+bool IsSelected(const char* name, int argc, char** argv, int firstName)
+{
+	if (firstName >= argc)
+	{
+		return true;
+	}
+
+	for (int arg = firstName; arg < argc; arg++)
+	{
+		if (strcmp(argv[arg], name) == 0)
+		{
+			return true;
+		}
+	}
+	return false;
+}
+
+}
+
+// Runs every test, or with "--bench" every benchmark instead. Names given after that run
+//  only the tests or benchmarks of those names.
+int main(int argc, char** argv)
+{
+	bool isBenchmark = argc > 1 && strcmp(argv[1], "--bench") == 0;
+	int firstName = isBenchmark ? 2 : 1;
+	const TestCase* cases = isBenchmark ? BENCHMARKS : TESTS;
+	std::uint32_t numCases = isBenchmark ? sizeof(BENCHMARKS) / sizeof(TestCase) : sizeof(TESTS) / sizeof(TestCase);
+
+	std::uint32_t numRun = 0u;
+	std::uint32_t numFailed = 0u;
+	for (std::uint32_t caseIdx = 0u; caseIdx < numCases; caseIdx++)
+	{
+		if (!IsSelected(cases[caseIdx].Name, argc, argv, firstName))
+		{
+			continue;
+		}
+
+		printf("[ RUN  ] %s\n", cases[caseIdx].Name);
+		std::uint32_t failedChecks = GetFailedCheckCount();
+		cases[caseIdx].Function();
+
+		bool isPassed = GetFailedCheckCount() == failedChecks;
+		printf("[ %s ] %s\n", isPassed ? " OK " : "FAIL", cases[caseIdx].Name);
+		numRun++;
+		numFailed += isPassed ? 0u : 1u;
+	}
+
+	printf("%u run, %u failed\n", numRun, numFailed);
+	Logger::Shutdown();
+
+	return (numRun > 0u && numFailed == 0u) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
\ No newline at end of file
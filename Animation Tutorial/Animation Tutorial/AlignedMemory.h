@@ -0,0 +1,21 @@
+#pragma once
+
+// _aligned_malloc and _aligned_free come with the MSVC runtime. Other compilers get the same
+//  pair on top of posix_memalign, so engine code that is built headlessly can use them too.
+#if !defined(_MSC_VER)
+
+#include <cstddef>
+#include <cstdlib>
+
+inline void* _aligned_malloc(std::size_t size, std::size_t alignment)
+{
+	void* p = nullptr;
+	return (posix_memalign(&p, alignment, size) == 0) ? p : nullptr;
+}
+
+inline void _aligned_free(void* p)
+{
+	free(p);
+}
+
+#endif
\ No newline at end of file
@@ -1,9 +1,15 @@
 #include "Animation.h"
+#include "ClipSampler.h"
+#include "MatrixPalette.h"
+#include "Logger.h"
 #include <assert.h>
 
 Animation::Animation(std::string name, float duration, bool loopOnFinish)
 	: staticBones_()
 	, animatedBones_()
+	, skeleton_()
+	, clip_(nullptr)
+	, isCompiled_(false)
 	, currentTime_(0.f)
 	, endTime_(duration)
 	, loop_(loopOnFinish)
@@ -13,28 +19,134 @@ Animation::Animation(std::string name, float duration, bool loopOnFinish)
 void Animation::AddStaticBone(std::string boneName, std::string parentName, Transform transform)
 {
 	staticBones_.insert({ boneName, StaticBone(boneName, parentName, transform) });
+	isCompiled_ = false;
 }
 
 void Animation::AddAnimatedBone(std::string boneName, std::string parentName, BoneAnimation animationData)
 {
+	// A bone that never moves stays an animated bone - its collapsed channels take a single
+	//  key each in the clip anyway, and its value must not be confused with the bind
+	//  transform a static bone of the same name holds
 	animatedBones_.insert({ boneName, AnimatedBone(boneName, parentName, animationData) });
+	isCompiled_ = false;
 }
 
-std::vector<Matrix> Animation::GetBoneMatrixArray(const std::vector<std::string>& names, const std::vector<Transform>& offsets) const
+bool Animation::Compile()
 {
-	std::vector<Matrix> tr;
+	skeleton_.Clear();
+	clip_ = nullptr;
+	isCompiled_ = false;
+
+	// Every bone name, along with the name of its parent. Animated bones take
+	//  priority over static bones of the same name.
+	std::map<std::string, std::string> parentNames;
+	for (auto&& bone : staticBones_)
+	{
+		parentNames[bone.first] = bone.second.ParentName;
+	}
+	for (auto&& bone : animatedBones_)
+	{
+		parentNames[bone.first] = bone.second.ParentName;
+	}
+
+	// Indexed in skeleton order - static bones have no animation, and use the skeleton transform instead
+	std::vector<const BoneAnimation*> boneAnimations;
+	boneAnimations.reserve(parentNames.size());
+
+	// Add bones in passes - a bone can be added once its parent is in the skeleton,
+	//  which guarantees the parent-before-child ordering the skeleton requires.
+	while (!parentNames.empty())
+	{
+		std::uint32_t nAddedThisPass = 0u;
+		for (auto it = parentNames.begin(); it != parentNames.end();)
+		{
+			std::uint32_t parentIdx = Skeleton::INVALID_INDEX;
+			if (it->second != "")
+			{
+				parentIdx = skeleton_.GetBoneIndex(it->second);
+				if (parentIdx == Skeleton::INVALID_INDEX)
+				{
+					++it;
+					continue;
+				}
+			}
+
+			auto animatedBone = animatedBones_.find(it->first);
+			auto staticBone = staticBones_.find(it->first);
+			Transform fromParent = (staticBone != staticBones_.end()) ? staticBone->second.FromParentTransform : Transform::Identity;
+
+			skeleton_.AddBone(it->first, parentIdx, fromParent);
+			boneAnimations.push_back((animatedBone != animatedBones_.end()) ? &animatedBone->second.Animation : nullptr);
+
+			it = parentNames.erase(it);
+			nAddedThisPass++;
+		}
+
+		if (nAddedThisPass == 0u)
+		{
+			Logger::Log("Failed to compile animation skeleton - bone has missing parent, or hierarchy has a cycle");
+			return false;
+		}
+	}
+
+	clip_ = AnimationClip::Create(skeleton_, boneAnimations, endTime_);
+	if (!clip_)
+	{
+		return false;
+	}
+
+	isCompiled_ = true;
+	return true;
+}
+
+std::vector<std::uint32_t> Animation::GetBoneIndices(const std::vector<std::string>& names) const
+{
+	std::vector<std::uint32_t> tr;
 
 	tr.reserve(names.size());
 
-	for (std::uint32_t idx = 0u; idx < names.size(); idx++)
+	for (auto&& name : names)
 	{
-		Transform animatedTransform = GetAnimatedNodeTransformAtTime(names[idx], currentTime_);
-		Transform staticTransform = GetStaticNodeTransform(names[idx]);
-		//tr.push_back((/* bone.OffsetMatrix * */animatedTransform * staticTransform.Inverse()).GetTransformMatrix());
-		tr.push_back((animatedTransform * offsets[idx]).GetTransformMatrix());
+		std::uint32_t boneIdx = skeleton_.GetBoneIndex(name);
+		assert(boneIdx != Skeleton::INVALID_INDEX);
+		tr.push_back(boneIdx);
 	}
 
-	return std::move(tr);
+	return tr;
+}
+
+void Animation::GetBoneMatrixArray(BoneAnimation::Cursor* cursors, Pose& pose, Matrix3x4* outPalette) const
+{
+	assert(isCompiled_ && pose.GetBoneCount() == skeleton_.GetBoneCount());
+
+	SampleClip(*clip_, currentTime_, cursors, pose);
+	skeleton_.GetModelPose(pose);
+	BuildMatrixPalette(pose, outPalette);
+}
+
+std::vector<BoneAnimation::Cursor> Animation::CreateCursors() const
+{
+	return std::vector<BoneAnimation::Cursor>(skeleton_.GetBoneCount());
+}
+
+void Animation::GetLocalTransformsAtTime(float time, Transform* outLocalTransforms) const
+{
+	GetLocalTransformsAtTime(time, nullptr, outLocalTransforms);
+}
+
+void Animation::GetLocalTransformsAtTime(float time, BoneAnimation::Cursor* cursors, Transform* outLocalTransforms) const
+{
+	assert(isCompiled_);
+
+	clip_->Sample(time, cursors, outLocalTransforms);
+}
+
+void Animation::GetModelTransformsAtTime(float time, BoneAnimation::Cursor* cursors, Transform* outModelTransforms) const
+{
+	// Sample every bone exactly once into the output array, and then resolve the
+	//  hierarchy in place (the skeleton reads each local transform before writing it)
+	GetLocalTransformsAtTime(time, cursors, outModelTransforms);
+	skeleton_.GetModelTransforms(outModelTransforms, outModelTransforms);
 }
 
 // Inherited via IActor
@@ -58,31 +170,14 @@ bool Animation::Update(float dt)
 	return true;
 }
 
-Transform Animation::GetAnimatedNodeTransformAtTime(std::string nodeName, float time) const
+const Transform& Animation::GetStaticNodeTransform(const std::string& nodeName) const
 {
-	// If empty, assume identity transform
 	if (nodeName == "") return Transform::Identity;
 
-	if (animatedBones_.count(nodeName) > 0u)
-	{
-		Transform parentTransform = GetAnimatedNodeTransformAtTime(animatedBones_.at(nodeName).ParentName, time);
-		Transform childTransform = animatedBones_.at(nodeName).Animation.GetTransformAtTime(time);
-		return parentTransform * childTransform;
-	}
-	else
-	{
-		assert(staticBones_.count(nodeName) > 0u);
-		Transform parentTransform = GetAnimatedNodeTransformAtTime(staticBones_.at(nodeName).ParentName, time);
-		Transform childTransform = staticBones_.at(nodeName).FromParentTransform;
-		return parentTransform * childTransform;
-	}
-}
-
-Transform Animation::GetStaticNodeTransform(std::string nodeName) const
-{
-	if (nodeName == "") return Transform::Identity;
+	assert(isCompiled_);
 
-	assert(staticBones_.count(nodeName) > 0u);
+	std::uint32_t boneIdx = skeleton_.GetBoneIndex(nodeName);
+	assert(boneIdx != Skeleton::INVALID_INDEX);
 
-	return GetStaticNodeTransform(staticBones_.at(nodeName).ParentName) * staticBones_.at(nodeName).FromParentTransform;
+	return skeleton_.GetBindModelTransform(boneIdx);
 }
\ No newline at end of file
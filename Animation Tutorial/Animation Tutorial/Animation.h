@@ -0,0 +1,67 @@
+#pragma once
+
+#include "IActor.h"
+#include "Bone.h"
+#include "Skeleton.h"
+#include "AnimationClip.h"
+#include "Matrix3x4.h"
+#include "Pose.h"
+#include <string>
+#include <vector>
+#include <map>
+
+class Animation : public IActor
+{
+public:
+	Animation(std::string name, float duration, bool loopOnFinish);
+	Animation(const Animation&) = delete;
+	~Animation() = default;
+
+	void AddStaticBone(std::string boneName, std::string parentName, Transform transform);
+	void AddAnimatedBone(std::string boneName, std::string parentName, BoneAnimation animationData);
+
+	// Flattens the bones added so far into an index based skeleton. Must be called
+	//  after all bones have been added, and before requesting any bone matrices.
+	bool Compile();
+	bool IsCompiled() const { return isCompiled_; }
+	const Skeleton& GetSkeleton() const { return skeleton_; }
+	std::shared_ptr<const AnimationClip> GetClip() const { return clip_; }
+
+	// Resolve bone names to skeleton indices once, at load time
+	std::vector<std::uint32_t> GetBoneIndices(const std::vector<std::string>& names) const;
+
+	// Model space matrix of every skeleton bone at this animation's own playback time. Callers
+	//  own the cursors (see below) and both buffers, so instances sharing an animation can be
+	//  evaluated on different threads at once, and nothing is allocated per call. pose must be
+	//  sized for the skeleton, and outPalette hold GetSkeleton().GetBoneCount() matrices.
+	//  Skinning palettes of meshes are built from the result with BuildSkinningPalette.
+	void GetBoneMatrixArray(BoneAnimation::Cursor* cursors, Pose& pose, Matrix3x4* outPalette) const;
+
+	// Cursors, if given, are per-instance playback state and must be created by CreateCursors.
+	//  Output arrays must hold GetSkeleton().GetBoneCount() elements
+	std::vector<BoneAnimation::Cursor> CreateCursors() const;
+	void GetLocalTransformsAtTime(float time, Transform* outLocalTransforms) const;
+	void GetLocalTransformsAtTime(float time, BoneAnimation::Cursor* cursors, Transform* outLocalTransforms) const;
+	void GetModelTransformsAtTime(float time, BoneAnimation::Cursor* cursors, Transform* outModelTransforms) const;
+
+	// Inherited via IActor
+	virtual bool Update(float dt) override;
+
+protected:
+	// Model space bind transform of a bone, looked up from the compiled skeleton
+	const Transform& GetStaticNodeTransform(const std::string& nodeName) const;
+
+private:
+	std::map<std::string, StaticBone> staticBones_;
+	std::map<std::string, AnimatedBone> animatedBones_;
+
+	// Compiled data - the clip holds keys for every skeleton bone, in skeleton order
+	Skeleton skeleton_;
+	std::shared_ptr<const AnimationClip> clip_;
+	bool isCompiled_;
+
+	float currentTime_;
+	float endTime_;
+	bool loop_;
+	std::string name_;
+};
\ No newline at end of file
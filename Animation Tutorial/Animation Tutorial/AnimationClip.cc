@@ -0,0 +1,352 @@
+#include "AnimationClip.h"
+#include "AlignedMemory.h"
+#include "Logger.h"
+#include <fstream>
+#include <cstring>
+#include <assert.h>
+
+const std::uint32_t AnimationClip::MAGIC = 0x50494C43u; // "CLIP"
+const std::uint32_t AnimationClip::VERSION = 1u;
+
+namespace
+{
+
+std::uint32_t AlignUp(std::uint32_t value, std::uint32_t alignment)
+{
+	return (value + alignment - 1u) / alignment * alignment;
+}
+
+bool IsInBlob(std::uint64_t offset, std::uint64_t size, std::uint64_t blobSize)
+{
+	return offset + size <= blobSize;
+}
+
+// Size of a channel's streams, computed wide so that key counts read from a file cannot overflow it
+std::uint64_t ChannelSize(std::uint32_t numKeys, std::uint32_t numComponents)
+{
+	std::uint64_t alignment = AnimationClip::ALIGNMENT;
+	return ((std::uint64_t)numKeys * sizeof(float) + alignment - 1u) / alignment * alignment * numComponents;
+}
+
+}
+
+AnimationClip::AnimationClip(char* blob)
+	: blob_(blob)
+	, header_(reinterpret_cast<const Header*>(blob))
+{}
+
+AnimationClip::~AnimationClip()
+{
+	_aligned_free(blob_);
+}
+
+std::shared_ptr<AnimationClip> AnimationClip::Create(const Skeleton& skeleton, const std::vector<const BoneAnimation*>& boneAnimations, float duration)
+{
+	assert(boneAnimations.size() == skeleton.GetBoneCount());
+
+	Header header = {};
+	header.Magic = MAGIC;
+	header.Version = VERSION;
+	header.NumBones = skeleton.GetBoneCount();
+	header.Duration = duration;
+
+	for (std::uint32_t boneIdx = 0u; boneIdx < header.NumBones; boneIdx++)
+	{
+		const BoneAnimation* anim = boneAnimations[boneIdx];
+		header.NumPositionKeys += anim ? (std::uint32_t)anim->GetPositionKeyframes().size() : 1u;
+		header.NumRotationKeys += anim ? (std::uint32_t)anim->GetRotationKeyframes().size() : 1u;
+		header.NumScaleKeys += anim ? (std::uint32_t)anim->GetScaleKeyframes().size() : 1u;
+	}
+
+	// Lay out every section back to back, each starting on an aligned boundary
+	std::uint32_t tableSize = AlignUp(sizeof(TrackRange) * header.NumBones, ALIGNMENT);
+	header.PositionTracksOffset = AlignUp(sizeof(Header), ALIGNMENT);
+	header.RotationTracksOffset = header.PositionTracksOffset + tableSize;
+	header.ScaleTracksOffset = header.RotationTracksOffset + tableSize;
+	header.PositionDataOffset = header.ScaleTracksOffset + tableSize;
+	header.RotationDataOffset = header.PositionDataOffset + StreamStride(header.NumPositionKeys) * 4u;
+	header.ScaleDataOffset = header.RotationDataOffset + StreamStride(header.NumRotationKeys) * 5u;
+	header.SizeInBytes = header.ScaleDataOffset + StreamStride(header.NumScaleKeys) * 4u;
+
+	char* blob = (char*)_aligned_malloc(header.SizeInBytes, ALIGNMENT);
+	if (blob == nullptr)
+	{
+		Logger::Log("Failed to allocate memory for animation clip");
+		return nullptr;
+	}
+	memset(blob, 0x00, header.SizeInBytes);
+	memcpy(blob, &header, sizeof(Header));
+
+	std::shared_ptr<AnimationClip> clip(new AnimationClip(blob));
+
+	TrackRange* positionTracks = reinterpret_cast<TrackRange*>(blob + header.PositionTracksOffset);
+	TrackRange* rotationTracks = reinterpret_cast<TrackRange*>(blob + header.RotationTracksOffset);
+	TrackRange* scaleTracks = reinterpret_cast<TrackRange*>(blob + header.ScaleTracksOffset);
+
+	float* positions[4];
+	float* rotations[5];
+	float* scales[4];
+	for (std::uint32_t c = 0u; c < 4u; c++)
+	{
+		positions[c] = const_cast<float*>(clip->GetPositionStream(c));
+		scales[c] = const_cast<float*>(clip->GetScaleStream(c));
+	}
+	for (std::uint32_t c = 0u; c < 5u; c++)
+	{
+		rotations[c] = const_cast<float*>(clip->GetRotationStream(c));
+	}
+
+	std::uint32_t nPos = 0u, nRot = 0u, nScl = 0u;
+	for (std::uint32_t boneIdx = 0u; boneIdx < header.NumBones; boneIdx++)
+	{
+		const BoneAnimation* anim = boneAnimations[boneIdx];
+		if (anim == nullptr)
+		{
+			// Static bone - a single key at the start of the clip holds the bind transform
+			const Transform& bind = skeleton.GetBone(boneIdx).FromParentTransform;
+			positionTracks[boneIdx] = { nPos, 1u };
+			rotationTracks[boneIdx] = { nRot, 1u };
+			scaleTracks[boneIdx] = { nScl, 1u };
+
+			positions[0u][nPos] = 0.f; positions[1u][nPos] = bind.Pos.x; positions[2u][nPos] = bind.Pos.y; positions[3u][nPos] = bind.Pos.z;
+			rotations[0u][nRot] = 0.f; rotations[1u][nRot] = bind.Rotation.x; rotations[2u][nRot] = bind.Rotation.y; rotations[3u][nRot] = bind.Rotation.z; rotations[4u][nRot] = bind.Rotation.w;
+			scales[0u][nScl] = 0.f; scales[1u][nScl] = bind.Scale.x; scales[2u][nScl] = bind.Scale.y; scales[3u][nScl] = bind.Scale.z;
+			nPos++; nRot++; nScl++;
+			continue;
+		}
+
+		positionTracks[boneIdx] = { nPos, (std::uint32_t)anim->GetPositionKeyframes().size() };
+		for (auto&& kf : anim->GetPositionKeyframes())
+		{
+			positions[0u][nPos] = kf.Time;
+			positions[1u][nPos] = kf.Translation.x;
+			positions[2u][nPos] = kf.Translation.y;
+			positions[3u][nPos] = kf.Translation.z;
+			nPos++;
+		}
+
+		rotationTracks[boneIdx] = { nRot, (std::uint32_t)anim->GetRotationKeyframes().size() };
+		for (auto&& kf : anim->GetRotationKeyframes())
+		{
+			rotations[0u][nRot] = kf.Time;
+			rotations[1u][nRot] = kf.Rotation.x;
+			rotations[2u][nRot] = kf.Rotation.y;
+			rotations[3u][nRot] = kf.Rotation.z;
+			rotations[4u][nRot] = kf.Rotation.w;
+			nRot++;
+		}
+
+		scaleTracks[boneIdx] = { nScl, (std::uint32_t)anim->GetScaleKeyframes().size() };
+		for (auto&& kf : anim->GetScaleKeyframes())
+		{
+			scales[0u][nScl] = kf.Time;
+			scales[1u][nScl] = kf.Scale.x;
+			scales[2u][nScl] = kf.Scale.y;
+			scales[3u][nScl] = kf.Scale.z;
+			nScl++;
+		}
+	}
+
+	return clip;
+}
+
+std::shared_ptr<AnimationClip> AnimationClip::Load(const char* filename)
+{
+	std::ifstream fin(filename, std::ios::binary);
+	if (!fin)
+	{
+		Logger::Log("Failed to open animation clip file for reading");
+		return nullptr;
+	}
+
+	fin.seekg(0, std::ios::end);
+	std::uint32_t fileSize = (std::uint32_t)fin.tellg();
+	fin.seekg(0, std::ios::beg);
+
+	if (fileSize < sizeof(Header))
+	{
+		Logger::Log("Animation clip file is too small to be valid");
+		return nullptr;
+	}
+
+	char* blob = (char*)_aligned_malloc(fileSize, ALIGNMENT);
+	if (blob == nullptr)
+	{
+		Logger::Log("Failed to allocate memory for animation clip");
+		return nullptr;
+	}
+
+	// Hold the blob immediately, so it is freed on any failure below
+	std::shared_ptr<AnimationClip> clip(new AnimationClip(blob));
+	fin.read(blob, fileSize);
+
+	if (!fin || !clip->Validate(fileSize))
+	{
+		Logger::Log("Animation clip file is corrupt, or was written by a different version");
+		return nullptr;
+	}
+
+	return clip;
+}
+
+bool AnimationClip::Save(const char* filename) const
+{
+	std::ofstream fout(filename, std::ios::binary);
+	if (!fout)
+	{
+		Logger::Log("Failed to open animation clip file for writing");
+		return false;
+	}
+
+	fout.write(blob_, header_->SizeInBytes);
+	return (bool)fout;
+}
+
+const AnimationClip::TrackRange& AnimationClip::GetPositionTrack(std::uint32_t boneIdx) const
+{
+	return reinterpret_cast<const TrackRange*>(blob_ + header_->PositionTracksOffset)[boneIdx];
+}
+
+const AnimationClip::TrackRange& AnimationClip::GetRotationTrack(std::uint32_t boneIdx) const
+{
+	return reinterpret_cast<const TrackRange*>(blob_ + header_->RotationTracksOffset)[boneIdx];
+}
+
+const AnimationClip::TrackRange& AnimationClip::GetScaleTrack(std::uint32_t boneIdx) const
+{
+	return reinterpret_cast<const TrackRange*>(blob_ + header_->ScaleTracksOffset)[boneIdx];
+}
+
+const float* AnimationClip::GetPositionStream(std::uint32_t component) const
+{
+	return GetStream(header_->PositionDataOffset, header_->NumPositionKeys, component);
+}
+
+const float* AnimationClip::GetRotationStream(std::uint32_t component) const
+{
+	return GetStream(header_->RotationDataOffset, header_->NumRotationKeys, component);
+}
+
+const float* AnimationClip::GetScaleStream(std::uint32_t component) const
+{
+	return GetStream(header_->ScaleDataOffset, header_->NumScaleKeys, component);
+}
+
+void AnimationClip::Sample(float time, BoneAnimation::Cursor* cursors, Transform* outLocalTransforms) const
+{
+	const TrackRange* positionTracks = reinterpret_cast<const TrackRange*>(blob_ + header_->PositionTracksOffset);
+	const TrackRange* rotationTracks = reinterpret_cast<const TrackRange*>(blob_ + header_->RotationTracksOffset);
+	const TrackRange* scaleTracks = reinterpret_cast<const TrackRange*>(blob_ + header_->ScaleTracksOffset);
+
+	const float* pt = GetPositionStream(0u), *px = GetPositionStream(1u), *py = GetPositionStream(2u), *pz = GetPositionStream(3u);
+	const float* rt = GetRotationStream(0u), *rx = GetRotationStream(1u), *ry = GetRotationStream(2u), *rz = GetRotationStream(3u), *rw = GetRotationStream(4u);
+	const float* st = GetScaleStream(0u), *sx = GetScaleStream(1u), *sy = GetScaleStream(2u), *sz = GetScaleStream(3u);
+
+	for (std::uint32_t boneIdx = 0u; boneIdx < header_->NumBones; boneIdx++)
+	{
+		BoneAnimation::Cursor noCursor;
+		BoneAnimation::Cursor& cursor = (cursors != nullptr) ? cursors[boneIdx] : noCursor;
+		Transform& out = outLocalTransforms[boneIdx];
+		float ratio = 0.f;
+
+		std::uint32_t first = positionTracks[boneIdx].FirstKey;
+		if (FindKeys(pt + first, positionTracks[boneIdx].NumKeys, time, cursor.PositionIdx, ratio))
+		{
+			std::uint32_t k = first + cursor.PositionIdx;
+			out.Pos = Vec3(px[k], py[k], pz[k]) * (1.f - ratio) + Vec3(px[k + 1u], py[k + 1u], pz[k + 1u]) * ratio;
+		}
+		else
+		{
+			std::uint32_t k = first + cursor.PositionIdx;
+			out.Pos = Vec3(px[k], py[k], pz[k]);
+		}
+
+		first = rotationTracks[boneIdx].FirstKey;
+		if (FindKeys(rt + first, rotationTracks[boneIdx].NumKeys, time, cursor.RotationIdx, ratio))
+		{
+			std::uint32_t k = first + cursor.RotationIdx;
+			out.Rotation = Quaternion(
+				(1.f - ratio) * rw[k] + ratio * rw[k + 1u],
+				(1.f - ratio) * rx[k] + ratio * rx[k + 1u],
+				(1.f - ratio) * ry[k] + ratio * ry[k + 1u],
+				(1.f - ratio) * rz[k] + ratio * rz[k + 1u]);
+		}
+		else
+		{
+			std::uint32_t k = first + cursor.RotationIdx;
+			out.Rotation.x = rx[k];
+			out.Rotation.y = ry[k];
+			out.Rotation.z = rz[k];
+			out.Rotation.w = rw[k];
+		}
+
+		first = scaleTracks[boneIdx].FirstKey;
+		if (FindKeys(st + first, scaleTracks[boneIdx].NumKeys, time, cursor.ScaleIdx, ratio))
+		{
+			std::uint32_t k = first + cursor.ScaleIdx;
+			out.Scale = Vec3(sx[k], sy[k], sz[k]) * (1.f - ratio) + Vec3(sx[k + 1u], sy[k + 1u], sz[k + 1u]) * ratio;
+		}
+		else
+		{
+			std::uint32_t k = first + cursor.ScaleIdx;
+			out.Scale = Vec3(sx[k], sy[k], sz[k]);
+		}
+	}
+}
+
+bool AnimationClip::Validate(std::uint32_t size) const
+{
+	if (size < sizeof(Header) || header_->Magic != MAGIC || header_->Version != VERSION || header_->SizeInBytes != size)
+	{
+		return false;
+	}
+
+	// Streams are read with aligned loads
+	const std::uint32_t offsets[] = {
+		header_->PositionTracksOffset, header_->RotationTracksOffset, header_->ScaleTracksOffset,
+		header_->PositionDataOffset, header_->RotationDataOffset, header_->ScaleDataOffset };
+	for (std::uint32_t offset : offsets)
+	{
+		if (offset % ALIGNMENT != 0u)
+		{
+			return false;
+		}
+	}
+
+	std::uint64_t tableSize = (std::uint64_t)header_->NumBones * sizeof(TrackRange);
+	if (!IsInBlob(header_->PositionTracksOffset, tableSize, size)
+		|| !IsInBlob(header_->RotationTracksOffset, tableSize, size)
+		|| !IsInBlob(header_->ScaleTracksOffset, tableSize, size)
+		|| !IsInBlob(header_->PositionDataOffset, ChannelSize(header_->NumPositionKeys, 4u), size)
+		|| !IsInBlob(header_->RotationDataOffset, ChannelSize(header_->NumRotationKeys, 5u), size)
+		|| !IsInBlob(header_->ScaleDataOffset, ChannelSize(header_->NumScaleKeys, 4u), size))
+	{
+		return false;
+	}
+
+	// Every track needs at least one key, and must lie within its streams
+	for (std::uint32_t boneIdx = 0u; boneIdx < header_->NumBones; boneIdx++)
+	{
+		const TrackRange& position = GetPositionTrack(boneIdx);
+		const TrackRange& rotation = GetRotationTrack(boneIdx);
+		const TrackRange& scale = GetScaleTrack(boneIdx);
+		if (position.NumKeys == 0u || (std::uint64_t)position.FirstKey + position.NumKeys > header_->NumPositionKeys
+			|| rotation.NumKeys == 0u || (std::uint64_t)rotation.FirstKey + rotation.NumKeys > header_->NumRotationKeys
+			|| scale.NumKeys == 0u || (std::uint64_t)scale.FirstKey + scale.NumKeys > header_->NumScaleKeys)
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+std::uint32_t AnimationClip::StreamStride(std::uint32_t numKeys)
+{
+	return AlignUp(sizeof(float) * numKeys, ALIGNMENT);
+}
+
+const float* AnimationClip::GetStream(std::uint32_t dataOffset, std::uint32_t numKeys, std::uint32_t component) const
+{
+	return reinterpret_cast<const float*>(blob_ + dataOffset + StreamStride(numKeys) * component);
+}
\ No newline at end of file
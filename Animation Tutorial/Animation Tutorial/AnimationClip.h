@@ -0,0 +1,139 @@
+#pragma once
+
+#include "BoneAnimation.h"
+#include "Skeleton.h"
+#include <algorithm>
+#include <memory>
+#include <vector>
+
+// Immutable keyframe data for every bone of a skeleton, held in one contiguous allocation.
+//  Key times and values are stored as structure-of-arrays streams (time, x, y, z[, w]),
+//  and each channel has a table giving the range of keys that belong to each bone.
+//  Bones without animation are stored with a single key holding their bind transform, and
+//  constant channels (see BoneAnimation::CONSTANT_EPSILON) with a single key holding their value.
+// The blob contains only offsets, never pointers, so it can be saved and loaded as-is.
+class AnimationClip
+{
+public:
+	struct TrackRange
+	{
+		std::uint32_t FirstKey;
+		std::uint32_t NumKeys;
+	};
+
+	struct Header
+	{
+		std::uint32_t Magic;
+		std::uint32_t Version;
+		std::uint32_t SizeInBytes;
+		std::uint32_t NumBones;
+		float Duration;
+
+		std::uint32_t NumPositionKeys;
+		std::uint32_t NumRotationKeys;
+		std::uint32_t NumScaleKeys;
+
+		// Byte offsets from the start of the blob
+		std::uint32_t PositionTracksOffset;
+		std::uint32_t RotationTracksOffset;
+		std::uint32_t ScaleTracksOffset;
+		std::uint32_t PositionDataOffset;
+		std::uint32_t RotationDataOffset;
+		std::uint32_t ScaleDataOffset;
+	};
+
+	static const std::uint32_t MAGIC;
+	static const std::uint32_t VERSION;
+
+	// Every stream starts on a 16 byte boundary
+	static const std::uint32_t ALIGNMENT = 16u;
+
+public:
+	AnimationClip() = delete;
+	AnimationClip(const AnimationClip&) = delete;
+	~AnimationClip();
+
+	// boneAnimations is indexed by skeleton bone, with nullptr for static bones
+	static std::shared_ptr<AnimationClip> Create(const Skeleton& skeleton, const std::vector<const BoneAnimation*>& boneAnimations, float duration);
+	static std::shared_ptr<AnimationClip> Load(const char* filename);
+	bool Save(const char* filename) const;
+
+	std::uint32_t GetBoneCount() const { return header_->NumBones; }
+	float GetDuration() const { return header_->Duration; }
+	std::uint32_t GetSizeInBytes() const { return header_->SizeInBytes; }
+
+	const TrackRange& GetPositionTrack(std::uint32_t boneIdx) const;
+	const TrackRange& GetRotationTrack(std::uint32_t boneIdx) const;
+	const TrackRange& GetScaleTrack(std::uint32_t boneIdx) const;
+
+	// Streams are indexed by key, not by bone - use the track range to find a bone's keys.
+	//  Position and scale have components (t, x, y, z), rotation has (t, x, y, z, w)
+	const float* GetPositionStream(std::uint32_t component) const;
+	const float* GetRotationStream(std::uint32_t component) const;
+	const float* GetScaleStream(std::uint32_t component) const;
+
+	// Finds the last key at or before the given time within one track, starting from the
+	//  cursor hint in keyIdx. Returns false if the time is outside of the track, in which
+	//  case keyIdx is the key to clamp to and no interpolation is needed. Constant (single
+	//  key) tracks return straight away, without reading their time.
+	//  Times can be any type that compares with float. CompressedClip has its own search for
+	//  its 16 bit times, which compares them as integers.
+	template <typename TimeType>
+	static bool FindKeys(const TimeType* times, std::uint32_t numKeys, float time, std::uint32_t& keyIdx, float& ratio);
+
+	// Cursors are optional, and if given must hold one element per bone
+	void Sample(float time, BoneAnimation::Cursor* cursors, Transform* outLocalTransforms) const;
+
+private:
+	AnimationClip(char* blob);
+
+	// Checks that the header, track tables and streams of a loaded blob of the given size
+	//  describe a clip that can be sampled without reading outside of the blob
+	bool Validate(std::uint32_t size) const;
+
+	static std::uint32_t StreamStride(std::uint32_t numKeys);
+	const float* GetStream(std::uint32_t dataOffset, std::uint32_t numKeys, std::uint32_t component) const;
+
+private:
+	char* blob_;
+	const Header* header_;
+};
+
+template <typename TimeType>
+bool AnimationClip::FindKeys(const TimeType* times, std::uint32_t numKeys, float time, std::uint32_t& keyIdx, float& ratio)
+{
+	if (numKeys == 1u || time <= times[0u])
+	{
+		keyIdx = 0u;
+		return false;
+	}
+	else if (time >= times[numKeys - 1u])
+	{
+		keyIdx = numKeys - 1u;
+		return false;
+	}
+
+	bool found = false;
+	if (keyIdx < numKeys - 1u && times[keyIdx] <= time)
+	{
+		for (std::uint32_t step = 0u; step < BoneAnimation::Cursor::MAX_STEPS && !found; step++)
+		{
+			if (times[keyIdx + 1u] > time)
+			{
+				found = true;
+			}
+			else
+			{
+				keyIdx++;
+			}
+		}
+	}
+
+	if (!found)
+	{
+		keyIdx = (std::uint32_t)(std::upper_bound(times, times + numKeys, time) - times) - 1u;
+	}
+
+	ratio = (time - times[keyIdx]) / (times[keyIdx + 1u] - times[keyIdx]);
+	return true;
+}
\ No newline at end of file
@@ -0,0 +1,44 @@
+#include "AnimationLod.h"
+#include <assert.h>
+
+std::vector<std::uint8_t> BuildBoneMask(const Skeleton& skeleton, const std::vector<std::string>& excludedNameParts)
+{
+	std::vector<std::uint8_t> mask(skeleton.GetBoneCount(), 1u);
+
+	// Parents come before their children, so a parent's flag is final by the time it is read
+	for (std::uint32_t boneIdx = 0u; boneIdx < skeleton.GetBoneCount(); boneIdx++)
+	{
+		const Skeleton::Bone& bone = skeleton.GetBone(boneIdx);
+		if (bone.ParentIndex != Skeleton::INVALID_INDEX && !mask[bone.ParentIndex])
+		{
+			mask[boneIdx] = 0u;
+			continue;
+		}
+
+		for (auto&& part : excludedNameParts)
+		{
+			if (bone.Name.find(part) != std::string::npos)
+			{
+				mask[boneIdx] = 0u;
+				break;
+			}
+		}
+	}
+
+	return mask;
+}
+
+std::uint32_t SelectAnimationLod(const std::vector<AnimationLodLevel>& levels, float distance)
+{
+	assert(!levels.empty());
+
+	for (std::uint32_t levelIdx = 0u; levelIdx < levels.size(); levelIdx++)
+	{
+		if (distance <= levels[levelIdx].MaxDistance)
+		{
+			return levelIdx;
+		}
+	}
+
+	return (std::uint32_t)levels.size() - 1u;
+}
\ No newline at end of file
@@ -0,0 +1,37 @@
+#pragma once
+
+#include "Skeleton.h"
+#include <string>
+#include <vector>
+
+// One level of detail for character animation. Characters further from the viewer can
+//  evaluate their clip less often, and sample fewer bones.
+struct AnimationLodLevel
+{
+public:
+	// Characters up to this distance from the viewer use this level, in world units
+	float MaxDistance;
+
+	// Frames between full evaluations of the clip, at least 1. Palettes are interpolated
+	//  in between, and characters spread their evaluations over these frames.
+	std::uint32_t UpdateInterval;
+
+	// One element per skeleton bone, non-zero for bones to sample, or empty to sample every
+	//  bone. Bones left out hold their bind transform (see BuildBoneMask). Only compressed
+	//  clips take a mask, so it must be empty for characters playing resampled clips.
+	std::vector<std::uint8_t> BoneMask;
+
+	AnimationLodLevel(float maxDistance, std::uint32_t updateInterval)
+		: MaxDistance(maxDistance)
+		, UpdateInterval(updateInterval)
+		, BoneMask()
+	{}
+};
+
+// Samples every bone except those whose name contains one of the given parts, and every
+//  bone below them - such as fingers or face bones.
+std::vector<std::uint8_t> BuildBoneMask(const Skeleton& skeleton, const std::vector<std::string>& excludedNameParts);
+
+// Index of the first level whose MaxDistance covers the distance, or the last level if none
+//  do. Levels must be sorted by MaxDistance, and there must be at least one.
+std::uint32_t SelectAnimationLod(const std::vector<AnimationLodLevel>& levels, float distance);
\ No newline at end of file
@@ -0,0 +1,135 @@
+#include "BakedMesh.h"
+#include "Logger.h"
+
+const std::uint32_t BakedMesh::MAGIC = 0x4853454Du; // "MESH"
+const std::uint32_t BakedMesh::VERSION = 2u;
+
+namespace
+{
+
+bool IsInFile(std::uint64_t offset, std::uint64_t size, std::uint64_t fileSize)
+{
+	return offset + size <= fileSize;
+}
+
+}
+
+BakedMesh::BakedMesh(std::shared_ptr<MappedFile> file)
+	: file_(file)
+	, data_(file->GetData())
+	, header_(reinterpret_cast<const Header*>(file->GetData()))
+{}
+
+std::shared_ptr<BakedMesh> BakedMesh::Load(const char* filename)
+{
+	std::shared_ptr<MappedFile> file = MappedFile::Open(filename);
+	if (!file)
+	{
+		return nullptr;
+	}
+
+	std::shared_ptr<BakedMesh> mesh(new BakedMesh(file));
+	if (!mesh->Validate())
+	{
+		Logger::Log("Baked mesh file is corrupt, or was written by a different version");
+		return nullptr;
+	}
+
+	return mesh;
+}
+
+const BakedMesh::MeshEntry& BakedMesh::GetMesh(std::uint32_t meshIdx) const
+{
+	return reinterpret_cast<const MeshEntry*>(data_ + header_->MeshesOffset)[meshIdx];
+}
+
+const void* BakedMesh::GetVertexData(std::uint32_t meshIdx) const
+{
+	return data_ + GetMesh(meshIdx).VertexDataOffset;
+}
+
+const void* BakedMesh::GetIndexData(std::uint32_t meshIdx) const
+{
+	return data_ + GetMesh(meshIdx).IndexDataOffset;
+}
+
+const void* BakedMesh::GetInfluenceData(std::uint32_t meshIdx) const
+{
+	const MeshEntry& mesh = GetMesh(meshIdx);
+	return (mesh.InfluenceSize > 0u) ? data_ + mesh.InfluenceDataOffset : nullptr;
+}
+
+Material BakedMesh::GetMaterial(std::uint32_t meshIdx) const
+{
+	const MeshEntry& mesh = GetMesh(meshIdx);
+	return Material(
+		Color(mesh.AmbientColor[0u], mesh.AmbientColor[1u], mesh.AmbientColor[2u], mesh.AmbientColor[3u]),
+		Color(mesh.DiffuseColor[0u], mesh.DiffuseColor[1u], mesh.DiffuseColor[2u], mesh.DiffuseColor[3u]),
+		Color(mesh.SpecularColor[0u], mesh.SpecularColor[1u], mesh.SpecularColor[2u], mesh.SpecularColor[3u]));
+}
+
+const BakedMesh::BoneEntry& BakedMesh::GetBone(std::uint32_t meshIdx, std::uint32_t boneIdx) const
+{
+	return reinterpret_cast<const BoneEntry*>(data_ + GetMesh(meshIdx).BonesOffset)[boneIdx];
+}
+
+const char* BakedMesh::GetBoneName(std::uint32_t meshIdx, std::uint32_t boneIdx) const
+{
+	return data_ + header_->StringsOffset + GetBone(meshIdx, boneIdx).NameOffset;
+}
+
+bool BakedMesh::Validate() const
+{
+	std::uint64_t fileSize = file_->GetSize();
+	if (fileSize < sizeof(Header) || header_->Magic != MAGIC || header_->Version != VERSION || header_->SizeInBytes != fileSize)
+	{
+		return false;
+	}
+
+	if (!IsInFile(header_->MeshesOffset, (std::uint64_t)header_->NumMeshes * sizeof(MeshEntry), fileSize)
+		|| !IsInFile(header_->StringsOffset, header_->StringsSize, fileSize))
+	{
+		return false;
+	}
+
+	// Every bone name must be terminated before the end of the string section
+	if (header_->StringsSize > 0u && data_[header_->StringsOffset + header_->StringsSize - 1u] != '\0')
+	{
+		return false;
+	}
+
+	for (std::uint32_t meshIdx = 0u; meshIdx < header_->NumMeshes; meshIdx++)
+	{
+		const MeshEntry& mesh = GetMesh(meshIdx);
+		if ((mesh.IndexSize != 2u && mesh.IndexSize != 4u)
+			|| (mesh.VertexDataOffset % ALIGNMENT) != 0u
+			|| (mesh.IndexDataOffset % ALIGNMENT) != 0u
+			|| !IsInFile(mesh.VertexDataOffset, (std::uint64_t)mesh.NumVertices * mesh.VertexStride, fileSize)
+			|| !IsInFile(mesh.IndexDataOffset, (std::uint64_t)mesh.NumIndices * mesh.IndexSize, fileSize)
+			|| !IsInFile(mesh.BonesOffset, (std::uint64_t)mesh.NumBones * sizeof(BoneEntry), fileSize))
+		{
+			return false;
+		}
+
+		// Influences must be in a known format, and only refer to bones the palette can index
+		if (mesh.InfluenceSize > 0u
+			&& (mesh.InfluenceFormat > (std::uint32_t)INFLUENCE_WEIGHT_FORMAT::UNORM8
+				|| mesh.InfluenceSize != GetPackedInfluenceSize((INFLUENCE_WEIGHT_FORMAT)mesh.InfluenceFormat)
+				|| mesh.NumBones > MAX_PALETTE_BONES
+				|| (mesh.InfluenceDataOffset % ALIGNMENT) != 0u
+				|| !IsInFile(mesh.InfluenceDataOffset, (std::uint64_t)mesh.NumVertices * mesh.InfluenceSize, fileSize)))
+		{
+			return false;
+		}
+
+		for (std::uint32_t boneIdx = 0u; boneIdx < mesh.NumBones; boneIdx++)
+		{
+			if (GetBone(meshIdx, boneIdx).NameOffset >= header_->StringsSize)
+			{
+				return false;
+			}
+		}
+	}
+
+	return true;
+}
\ No newline at end of file
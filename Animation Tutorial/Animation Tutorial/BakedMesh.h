@@ -0,0 +1,99 @@
+#pragma once
+
+#include "MappedFile.h"
+#include "Material.h"
+#include "SkinWeights.h"
+#include <cstdint>
+#include <memory>
+
+// Meshes baked offline by MeshBaker into a single binary file: vertex and index streams
+//  laid out exactly as they are uploaded to the GPU, plus each mesh's material and the
+//  names and offset matrices of the bones that influence it. Meshes with bones also have
+//  a stream of packed bone influences (see SkinWeights.h), indexed like the vertices, whose
+//  bone indices refer to the mesh's bone table.
+// The file is memory mapped rather than read, and stream pointers point straight into
+//  the mapping, so loading does no parsing or copying beyond validating the header.
+class BakedMesh
+{
+public:
+	struct Header
+	{
+		std::uint32_t Magic;
+		std::uint32_t Version;
+		std::uint32_t SizeInBytes;
+		std::uint32_t NumMeshes;
+
+		// Byte offsets from the start of the file
+		std::uint32_t MeshesOffset;
+		std::uint32_t StringsOffset;
+		std::uint32_t StringsSize;
+	};
+
+	struct MeshEntry
+	{
+		std::uint32_t NumVertices;
+		std::uint32_t VertexStride;
+		std::uint32_t VertexDataOffset;
+
+		// Index size is in bytes - 2 or 4
+		std::uint32_t NumIndices;
+		std::uint32_t IndexSize;
+		std::uint32_t IndexDataOffset;
+
+		std::uint32_t NumBones;
+		std::uint32_t BonesOffset;
+
+		// INFLUENCE_WEIGHT_FORMAT, and bytes per vertex - 0 if the mesh has no influence stream
+		std::uint32_t InfluenceFormat;
+		std::uint32_t InfluenceSize;
+		std::uint32_t InfluenceDataOffset;
+
+		float AmbientColor[4];
+		float DiffuseColor[4];
+		float SpecularColor[4];
+	};
+
+	struct BoneEntry
+	{
+		// Offset of the null terminated name within the string section
+		std::uint32_t NameOffset;
+		float OffsetMatrix[16];
+	};
+
+	static const std::uint32_t MAGIC;
+	static const std::uint32_t VERSION;
+
+	// Every section starts on a 16 byte boundary
+	static const std::uint32_t ALIGNMENT = 16u;
+
+public:
+	BakedMesh() = delete;
+	BakedMesh(const BakedMesh&) = delete;
+	~BakedMesh() = default;
+
+	// Returns nullptr if the file is missing, corrupt or of a different version
+	static std::shared_ptr<BakedMesh> Load(const char* filename);
+
+	std::uint32_t GetMeshCount() const { return header_->NumMeshes; }
+	const MeshEntry& GetMesh(std::uint32_t meshIdx) const;
+
+	const void* GetVertexData(std::uint32_t meshIdx) const;
+	const void* GetIndexData(std::uint32_t meshIdx) const;
+
+	// nullptr if the mesh has no influence stream
+	const void* GetInfluenceData(std::uint32_t meshIdx) const;
+	Material GetMaterial(std::uint32_t meshIdx) const;
+
+	const BoneEntry& GetBone(std::uint32_t meshIdx, std::uint32_t boneIdx) const;
+	const char* GetBoneName(std::uint32_t meshIdx, std::uint32_t boneIdx) const;
+
+private:
+	BakedMesh(std::shared_ptr<MappedFile> file);
+
+	bool Validate() const;
+
+private:
+	std::shared_ptr<MappedFile> file_;
+	const char* data_;
+	const Header* header_;
+};
\ No newline at end of file
@@ -6,9 +6,9 @@
 //  - Material
 //  - Single Directional light
 
-cbuffer PerObject : register(b0)
+cbuffer Materials : register(b0)
 {
-	Material ObjectMaterial;
+	Material MaterialTable[MAX_MATERIALS];
 }
 
 cbuffer PerScene : register(b1)
@@ -26,11 +26,13 @@ struct BasicPosNormVertexOutput
 	float4 Position : SV_POSITION;
 	float4 WorldPosition : POSITION;
 	float4 Normal : NORMAL;
+	nointerpolation uint MaterialKey : MATERIAL;
 };
 
 float4 main(BasicPosNormVertexOutput pin) : SV_TARGET
 {
 	// For now, just return the material...
+	Material ObjectMaterial = MaterialTable[pin.MaterialKey];
 	float4 ambient = float4(0.f, 0.f, 0.f, 0.f);
 	float4 diffuse = float4(0.f, 0.f, 0.f, 0.f);
 	float4 specular = float4(0.f, 0.f, 0.f, 0.f);
@@ -8,6 +8,7 @@ struct BasicPosNormVertexInput
 {
 	float4 Position : POSITION;
 	float4 Normal : NORMAL;
+	uint InstanceId : SV_InstanceID;
 };
 
 struct BasicPosNormVertexOutput
@@ -15,14 +16,28 @@ struct BasicPosNormVertexOutput
 	float4 Position : SV_POSITION;
 	float4 WorldPosition : POSITION;
 	float4 Normal : NORMAL;
+	nointerpolation uint MaterialKey : MATERIAL;
+};
+
+// Laid out like InstanceData (IRenderBackend.h)
+struct Instance
+{
+	matrix mModel;
+	uint MaterialKey;
+	uint PaletteOffset;
+	uint2 Padding;
 };
 
 //
 // CBUFFERS
 //
-cbuffer PerObject : register(b0)
+
+// Must match IRenderBackend::MAX_INSTANCES_PER_DRAW. Only the instances of the draw are bound.
+#define MAX_INSTANCES_PER_DRAW 512
+
+cbuffer PerDraw : register(b0)
 {
-	matrix mModel;
+	Instance Instances[MAX_INSTANCES_PER_DRAW];
 }
 
 cbuffer PerFrame : register(b1)
@@ -34,6 +49,7 @@ cbuffer PerFrame : register(b1)
 BasicPosNormVertexOutput main( BasicPosNormVertexInput vin)
 {
 	BasicPosNormVertexOutput vout;
+	matrix mModel = Instances[vin.InstanceId].mModel;
 
 	vin.Position.w = 1.f;
 	vin.Normal.w = 0.f;
@@ -45,6 +61,7 @@ BasicPosNormVertexOutput main( BasicPosNormVertexInput vin)
 	vout.WorldPosition = mul(vin.Position, mModel);
 
 	vout.Normal = mul(vin.Normal, mModel);
+	vout.MaterialKey = Instances[vin.InstanceId].MaterialKey;
 
 	return vout;
 }
\ No newline at end of file
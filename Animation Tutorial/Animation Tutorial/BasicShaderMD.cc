@@ -6,16 +6,12 @@
 
 BasicShaderMD::BasicShaderMD()
 	: vs_cb_frame_({ Matrix(), Matrix() })
-	, vs_cb_object_({ Matrix() })
-	, ps_cb_object_({ Material::BasicGray })
 	, ps_cb_scene_({ DirectionalLight(Color::White, Color::White, Color::White, Vec3::Zero, 1.f) })
 	, ps_cb_frame_({ Vec4(0.f, 0.f, 0.f, 1.f) })
 	, vertShader_(nullptr)
 	, pixelShader_(nullptr)
 	, inputLayout_(nullptr)
 	, vs_cb_frame_buffer_(nullptr)
-	, vs_cb_object_buffer_(nullptr)
-	, ps_cb_object_buffer_(nullptr)
 	, ps_cb_scene_buffer_(nullptr)
 	, ps_cb_frame_buffer_(nullptr)
 {}
@@ -80,18 +76,10 @@ std::future<bool> BasicShaderMD::Initialize(ComPtr<ID3D11Device> device)
 		bufferDesc.MiscFlags = 0x00;
 		bufferDesc.StructureByteStride = 0x00;
 
-		bufferDesc.ByteWidth = sizeof(BasicShaderMD::VSCBuffer_PerObject_Type);
-		hr = device->CreateBuffer(&bufferDesc, nullptr, &vs_cb_object_buffer_);
-		VALIDATE(hr, "Failed to create vertex buffer per-object constant buffer");
-
 		bufferDesc.ByteWidth = sizeof(BasicShaderMD::VSCBuffer_PerFrame_Type);
 		hr = device->CreateBuffer(&bufferDesc, nullptr, &vs_cb_frame_buffer_);
 		VALIDATE(hr, "Failed to create vertex buffer per-frame constant buffer");
 
-		bufferDesc.ByteWidth = sizeof(BasicShaderMD::PSCBuffer_PerObject_Type);
-		hr = device->CreateBuffer(&bufferDesc, nullptr, &ps_cb_object_buffer_);
-		VALIDATE(hr, "Failed to create pixel buffer per-object constant buffer");
-
 		bufferDesc.ByteWidth = sizeof(BasicShaderMD::PSCBuffer_PerScene_Type);
 		hr = device->CreateBuffer(&bufferDesc, nullptr, &ps_cb_scene_buffer_);
 		VALIDATE(hr, "Failed to create pixel buffer per-scene constant buffer");
@@ -131,7 +119,7 @@ std::future<bool> BasicShaderMD::Initialize(ComPtr<ID3D11Device> device)
 	});
 }
 
-bool BasicShaderMD::Render(ComPtr<ID3D11DeviceContext> context, std::uint32_t nVertsToDraw)
+bool BasicShaderMD::Bind(ComPtr<ID3D11DeviceContext> context)
 {
 	HRESULT hr = { 0 };
 
@@ -155,40 +143,10 @@ bool BasicShaderMD::Render(ComPtr<ID3D11DeviceContext> context, std::uint32_t nV
 
 		vs_cb_frame_.Clean();
 	}
-	
-	if (vs_cb_object_.IsDirty())
-	{
-		D3D11_MAPPED_SUBRESOURCE vscb;
-		VSCBuffer_PerObject_Type* data;
-
-		hr = context->Map(vs_cb_object_buffer_.Get(), 0, D3D11_MAP_WRITE_DISCARD, 0x00, &vscb);
-		VALIDATE(hr, "Failed to map vertex per-object constant buffer for CPU writing");
-
-		data = (VSCBuffer_PerObject_Type*)vscb.pData;
-		data->Model = vs_cb_object_.Get().Model;
-
-		context->Unmap(vs_cb_object_buffer_.Get(), 0);
-
-		vs_cb_object_.Clean();
-	}
-	ID3D11Buffer* vsCBuffers[] = { vs_cb_object_buffer_.Get(), vs_cb_frame_buffer_.Get() };
-	context->VSSetConstantBuffers(0, _countof(vsCBuffers), vsCBuffers);
-
-	if (ps_cb_object_.IsDirty())
-	{
-		D3D11_MAPPED_SUBRESOURCE pscb;
-		PSCBuffer_PerObject_Type* data;
 
-		hr = context->Map(ps_cb_object_buffer_.Get(), 0, D3D11_MAP_WRITE_DISCARD, 0x00, &pscb);
-		VALIDATE(hr, "Failed to map per-object constant buffer for CPU writing");
-
-		data = (PSCBuffer_PerObject_Type*)pscb.pData;
-		data->ObjectMaterial = ps_cb_object_.Get().ObjectMaterial;
-
-		context->Unmap(ps_cb_object_buffer_.Get(), 0);
-
-		ps_cb_object_.Clean();
-	}
+	// Slot 0 holds the per-object constants, bound by the render backend for each draw
+	ID3D11Buffer* vsCBuffers[] = { vs_cb_frame_buffer_.Get() };
+	context->VSSetConstantBuffers(1, _countof(vsCBuffers), vsCBuffers);
 
 	if (ps_cb_scene_.IsDirty())
 	{
@@ -222,21 +180,12 @@ bool BasicShaderMD::Render(ComPtr<ID3D11DeviceContext> context, std::uint32_t nV
 		ps_cb_frame_.Clean();
 	}
 
-	ID3D11Buffer*psCBuffers[] = { ps_cb_object_buffer_.Get(), ps_cb_scene_buffer_.Get(), ps_cb_frame_buffer_.Get() };
-	context->PSSetConstantBuffers(0, _countof(psCBuffers), psCBuffers);
-
-	// Perform actual draw calls
-	context->DrawIndexed(nVertsToDraw, 0, 0);
+	ID3D11Buffer*psCBuffers[] = { ps_cb_scene_buffer_.Get(), ps_cb_frame_buffer_.Get() };
+	context->PSSetConstantBuffers(1, _countof(psCBuffers), psCBuffers);
 
 	return true;
 }
 
-void BasicShaderMD::SetModelMatrix(const Matrix& model)
-{
-	vs_cb_object_.Get().Model = model;
-	vs_cb_object_.Dirty();
-}
-
 void BasicShaderMD::SetViewMatrix(const Matrix& view)
 {
 	vs_cb_frame_.Get().View = view.Transpose();
@@ -255,12 +204,6 @@ void BasicShaderMD::SetCameraPosition(const Vec3 & position)
 	ps_cb_frame_.Dirty();
 }
 
-void BasicShaderMD::SetObjectMaterial(const Material& mat)
-{
-	ps_cb_object_.Get().ObjectMaterial = mat;
-	ps_cb_object_.Dirty();
-}
-
 void BasicShaderMD::SetDirectionalLight1(const DirectionalLight& dl)
 {
 	ps_cb_scene_.Get().DirectionalLight1 = dl;
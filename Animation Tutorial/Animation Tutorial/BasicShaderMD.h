@@ -1,6 +1,7 @@
 #pragma once
 
 #include "Material.h"
+#include "IShader.h"
 #include <d3d11.h>
 #include "DirectionalLight.h"
 #include "maffs.h"
@@ -11,7 +12,7 @@
 
 using Microsoft::WRL::ComPtr;
 
-class BasicShaderMD
+class BasicShaderMD : public IShader
 {
 public:
 	struct Vertex
@@ -32,22 +33,12 @@ public:
 	};
 
 protected:
-	struct VSCBuffer_PerObject_Type
-	{
-		Matrix Model;
-	};
-
 	struct VSCBuffer_PerFrame_Type
 	{
 		Matrix View;
 		Matrix Proj;
 	};
 
-	struct PSCBuffer_PerObject_Type
-	{
-		Material ObjectMaterial;
-	};
-
 	struct PSCBuffer_PerFrame_Type
 	{
 		Vec4 CameraPosition;
@@ -64,21 +55,18 @@ public:
 	~BasicShaderMD() = default;
 
 	std::future<bool> Initialize(ComPtr<ID3D11Device> device);
-	bool Render(ComPtr<ID3D11DeviceContext> context, std::uint32_t nVertsToDraw);
+
+	// Inherited via IShader
+	virtual bool Bind(ComPtr<ID3D11DeviceContext> context) override;
 
 	// Shader property setters
-	void SetModelMatrix(const Matrix& model);
 	void SetViewMatrix(const Matrix& view);
 	void SetProjMatrix(const Matrix& proj);
 	void SetCameraPosition(const Vec3& position);
-
-	void SetObjectMaterial(const Material& mat);
 	void SetDirectionalLight1(const DirectionalLight& dl1);
 
 private:
 	Dirtyable<VSCBuffer_PerFrame_Type> vs_cb_frame_;
-	Dirtyable<VSCBuffer_PerObject_Type> vs_cb_object_;
-	Dirtyable<PSCBuffer_PerObject_Type> ps_cb_object_;
 	Dirtyable<PSCBuffer_PerScene_Type> ps_cb_scene_;
 	Dirtyable<PSCBuffer_PerFrame_Type> ps_cb_frame_;
 
@@ -87,8 +75,6 @@ private:
 	ComPtr<ID3D11PixelShader> pixelShader_;
 	ComPtr<ID3D11InputLayout> inputLayout_;
 	ComPtr<ID3D11Buffer> vs_cb_frame_buffer_;
-	ComPtr<ID3D11Buffer> vs_cb_object_buffer_;
-	ComPtr<ID3D11Buffer> ps_cb_object_buffer_;
 	ComPtr<ID3D11Buffer> ps_cb_scene_buffer_;
 	ComPtr<ID3D11Buffer> ps_cb_frame_buffer_;
 };
\ No newline at end of file
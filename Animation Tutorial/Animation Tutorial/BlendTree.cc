@@ -0,0 +1,350 @@
+#include "BlendTree.h"
+#include "ClipSampler.h"
+#include <algorithm>
+#include <assert.h>
+#include <cmath>
+
+const std::uint32_t BlendTree::INVALID_INDEX = 0xFFFFFFFFu;
+
+namespace
+{
+
+BlendTree::Node MakeNode(BlendTree::NODE_TYPE type)
+{
+	BlendTree::Node node;
+	node.Type = type;
+	node.Clip = nullptr;
+	node.Resampled = nullptr;
+	node.Duration = 0.f;
+	node.Parameters[0u] = BlendTree::INVALID_INDEX;
+	node.Parameters[1u] = BlendTree::INVALID_INDEX;
+	node.BoneWeightsIdx = BlendTree::INVALID_INDEX;
+	return node;
+}
+
+// Finds the pair of positions either side of the value, as the index of the first and the
+//  ratio between them. Values beyond either end give that end, with a ratio of 0.
+void FindSegment(const std::vector<float>& positions, float value, std::uint32_t& outFirst, float& outRatio)
+{
+	outFirst = 0u;
+	outRatio = 0.f;
+	if (positions.size() < 2u || value <= positions.front())
+	{
+		return;
+	}
+
+	std::uint32_t last = (std::uint32_t)positions.size() - 1u;
+	if (value >= positions[last])
+	{
+		outFirst = last;
+		return;
+	}
+
+	while (value >= positions[outFirst + 1u])
+	{
+		outFirst++;
+	}
+	outRatio = (value - positions[outFirst]) / (positions[outFirst + 1u] - positions[outFirst]);
+}
+
+float Saturate(float value)
+{
+	return std::min(std::max(value, 0.f), 1.f);
+}
+
+bool AreClipNodes(const std::vector<BlendTree::Node>& nodes, const std::vector<std::uint32_t>& nodeIndices)
+{
+	for (std::uint32_t nodeIdx : nodeIndices)
+	{
+		if (nodeIdx >= nodes.size() || nodes[nodeIdx].Type != BlendTree::NODE_TYPE::CLIP)
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+}
+
+BlendTree::BlendTree(std::uint32_t numBones)
+	: numBones_(numBones)
+	, nodes_()
+	, defaultParameters_()
+	, boneWeights_()
+{}
+
+std::uint32_t BlendTree::AddParameter(float defaultValue)
+{
+	defaultParameters_.push_back(defaultValue);
+	return (std::uint32_t)defaultParameters_.size() - 1u;
+}
+
+std::uint32_t BlendTree::AddClip(const CompressedClip& clip, std::uint32_t timeParameter)
+{
+	assert(clip.GetBoneCount() == numBones_);
+	assert(timeParameter == INVALID_INDEX || timeParameter < defaultParameters_.size());
+
+	Node node = MakeNode(NODE_TYPE::CLIP);
+	node.Clip = &clip;
+	node.Duration = clip.GetDuration();
+	node.Parameters[0u] = timeParameter;
+	return AddNode(node);
+}
+
+std::uint32_t BlendTree::AddClip(const ResampledClip& clip, std::uint32_t timeParameter)
+{
+	assert(clip.GetBoneCount() == numBones_);
+	assert(timeParameter == INVALID_INDEX || timeParameter < defaultParameters_.size());
+
+	Node node = MakeNode(NODE_TYPE::CLIP);
+	node.Resampled = &clip;
+	node.Duration = clip.GetDuration();
+	node.Parameters[0u] = timeParameter;
+	return AddNode(node);
+}
+
+std::uint32_t BlendTree::AddCrossfade(std::uint32_t fromNode, std::uint32_t toNode, std::uint32_t weightParameter)
+{
+	assert(fromNode < nodes_.size() && toNode < nodes_.size());
+	assert(weightParameter < defaultParameters_.size());
+
+	Node node = MakeNode(NODE_TYPE::CROSSFADE);
+	node.Children.push_back(fromNode);
+	node.Children.push_back(toNode);
+	node.Parameters[0u] = weightParameter;
+	return AddNode(node);
+}
+
+std::uint32_t BlendTree::AddBlend1D(const std::vector<std::uint32_t>& clipNodes, const std::vector<float>& positions, std::uint32_t parameter)
+{
+	assert(!clipNodes.empty() && clipNodes.size() == positions.size() && AreClipNodes(nodes_, clipNodes));
+	assert(std::is_sorted(positions.begin(), positions.end()));
+	assert(parameter < defaultParameters_.size());
+
+	Node node = MakeNode(NODE_TYPE::BLEND_1D);
+	node.Children = clipNodes;
+	node.Positions[0u] = positions;
+	node.Parameters[0u] = parameter;
+	return AddNode(node);
+}
+
+std::uint32_t BlendTree::AddBlend2D(const std::vector<std::uint32_t>& clipNodes, const std::vector<float>& xPositions, const std::vector<float>& yPositions,
+	std::uint32_t xParameter, std::uint32_t yParameter)
+{
+	assert(!clipNodes.empty() && clipNodes.size() == xPositions.size() * yPositions.size() && AreClipNodes(nodes_, clipNodes));
+	assert(std::is_sorted(xPositions.begin(), xPositions.end()) && std::is_sorted(yPositions.begin(), yPositions.end()));
+	assert(xParameter < defaultParameters_.size() && yParameter < defaultParameters_.size());
+
+	Node node = MakeNode(NODE_TYPE::BLEND_2D);
+	node.Children = clipNodes;
+	node.Positions[0u] = xPositions;
+	node.Positions[1u] = yPositions;
+	node.Parameters[0u] = xParameter;
+	node.Parameters[1u] = yParameter;
+	return AddNode(node);
+}
+
+std::uint32_t BlendTree::AddAdditive(std::uint32_t baseNode, std::uint32_t additiveNode, std::uint32_t referenceNode, std::uint32_t weightParameter, const BoneWeights* boneWeights)
+{
+	assert(baseNode < nodes_.size() && additiveNode < nodes_.size() && referenceNode < nodes_.size());
+	assert(weightParameter < defaultParameters_.size());
+	assert(boneWeights == nullptr || boneWeights->GetBoneCount() == numBones_);
+
+	Node node = MakeNode(NODE_TYPE::ADDITIVE);
+	node.Children.push_back(baseNode);
+	node.Children.push_back(additiveNode);
+	node.Children.push_back(referenceNode);
+	node.Parameters[0u] = weightParameter;
+	if (boneWeights != nullptr)
+	{
+		boneWeights_.push_back(*boneWeights);
+		node.BoneWeightsIdx = (std::uint32_t)boneWeights_.size() - 1u;
+	}
+	return AddNode(node);
+}
+
+BlendTree::State BlendTree::CreateState() const
+{
+	State state;
+	state.Time = 0.f;
+	state.Parameters = defaultParameters_;
+	state.Phases.resize(nodes_.size(), 0.f);
+	state.Cursors.resize(nodes_.size());
+	for (std::uint32_t nodeIdx = 0u; nodeIdx < nodes_.size(); nodeIdx++)
+	{
+		if (nodes_[nodeIdx].Clip != nullptr)
+		{
+			state.Cursors[nodeIdx].resize(numBones_);
+		}
+	}
+	return state;
+}
+
+void BlendTree::Advance(State& state, float dt) const
+{
+	state.Time += dt;
+
+	// Blend spaces move through their cycle at the rate of the weighted duration of their clips
+	std::uint32_t children[MAX_WEIGHTED_CHILDREN];
+	float weights[MAX_WEIGHTED_CHILDREN];
+	for (std::uint32_t nodeIdx = 0u; nodeIdx < nodes_.size(); nodeIdx++)
+	{
+		const Node& node = nodes_[nodeIdx];
+		if (node.Type != NODE_TYPE::BLEND_1D && node.Type != NODE_TYPE::BLEND_2D)
+		{
+			continue;
+		}
+
+		float duration = 0.f;
+		std::uint32_t numChildren = GetWeightedChildren(node, state, children, weights);
+		for (std::uint32_t i = 0u; i < numChildren; i++)
+		{
+			duration += weights[i] * nodes_[children[i]].Duration;
+		}
+
+		if (duration > 0.f)
+		{
+			float phase = state.Phases[nodeIdx] + dt / duration;
+			state.Phases[nodeIdx] = phase - floorf(phase);
+		}
+	}
+}
+
+void BlendTree::Evaluate(State& state, PosePool& pool, Pose& outLocalPose) const
+{
+	assert(!nodes_.empty() && outLocalPose.GetBoneCount() == numBones_);
+	assert(state.Phases.size() == nodes_.size());
+
+	EvaluateNode((std::uint32_t)nodes_.size() - 1u, -1.f, state, pool, outLocalPose);
+}
+
+std::uint32_t BlendTree::AddNode(const Node& node)
+{
+	nodes_.push_back(node);
+	return (std::uint32_t)nodes_.size() - 1u;
+}
+
+std::uint32_t BlendTree::GetWeightedChildren(const Node& node, const State& state, std::uint32_t* outChildren, float* outWeights) const
+{
+	std::uint32_t x = 0u;
+	std::uint32_t y = 0u;
+	float xRatio = 0.f;
+	float yRatio = 0.f;
+	FindSegment(node.Positions[0u], state.Parameters[node.Parameters[0u]], x, xRatio);
+	if (node.Type == NODE_TYPE::BLEND_2D)
+	{
+		FindSegment(node.Positions[1u], state.Parameters[node.Parameters[1u]], y, yRatio);
+	}
+
+	// Bilinear weights of the (up to) four clips around the point - a 1D blend is a single row
+	std::uint32_t numColumns = (std::uint32_t)node.Positions[0u].size();
+	float cornerWeights[4] = { (1.f - xRatio) * (1.f - yRatio), xRatio * (1.f - yRatio), (1.f - xRatio) * yRatio, xRatio * yRatio };
+	std::uint32_t corners[4] = { y * numColumns + x, y * numColumns + x + 1u, (y + 1u) * numColumns + x, (y + 1u) * numColumns + x + 1u };
+
+	std::uint32_t numChildren = 0u;
+	for (std::uint32_t c = 0u; c < 4u; c++)
+	{
+		if (cornerWeights[c] > 0.f)
+		{
+			outChildren[numChildren] = node.Children[corners[c]];
+			outWeights[numChildren] = cornerWeights[c];
+			numChildren++;
+		}
+	}
+	return numChildren;
+}
+
+void BlendTree::EvaluateNode(std::uint32_t nodeIdx, float phase, State& state, PosePool& pool, Pose& outLocalPose) const
+{
+	const Node& node = nodes_[nodeIdx];
+	switch (node.Type)
+	{
+	case NODE_TYPE::CLIP:
+	{
+		float time = 0.f;
+		if (phase >= 0.f)
+		{
+			time = phase * node.Duration;
+		}
+		else
+		{
+			time = (node.Parameters[0u] != INVALID_INDEX) ? state.Parameters[node.Parameters[0u]] : state.Time;
+			time = (node.Duration > 0.f) ? fmodf(std::max(time, 0.f), node.Duration) : 0.f;
+		}
+
+		if (node.Clip != nullptr)
+		{
+			SampleClip(*node.Clip, time, &state.Cursors[nodeIdx][0], outLocalPose);
+		}
+		else
+		{
+			SampleClip(*node.Resampled, time, outLocalPose);
+		}
+		break;
+	}
+
+	case NODE_TYPE::CROSSFADE:
+	{
+		float weight = Saturate(state.Parameters[node.Parameters[0u]]);
+		if (weight <= 0.f || weight >= 1.f)
+		{
+			EvaluateNode(node.Children[(weight <= 0.f) ? 0u : 1u], phase, state, pool, outLocalPose);
+			break;
+		}
+
+		Pose& to = pool.Acquire(numBones_);
+		EvaluateNode(node.Children[0u], phase, state, pool, outLocalPose);
+		EvaluateNode(node.Children[1u], phase, state, pool, to);
+		BlendPoses(outLocalPose, to, weight, nullptr, outLocalPose);
+		pool.Release(to);
+		break;
+	}
+
+	case NODE_TYPE::BLEND_1D:
+	case NODE_TYPE::BLEND_2D:
+	{
+		std::uint32_t children[MAX_WEIGHTED_CHILDREN];
+		float weights[MAX_WEIGHTED_CHILDREN];
+		std::uint32_t numChildren = GetWeightedChildren(node, state, children, weights);
+		float childPhase = state.Phases[nodeIdx];
+
+		EvaluateNode(children[0u], childPhase, state, pool, outLocalPose);
+		if (numChildren > 1u)
+		{
+			// Blending each clip in by its share of the weight so far gives every clip its own weight
+			Pose& child = pool.Acquire(numBones_);
+			float totalWeight = weights[0u];
+			for (std::uint32_t i = 1u; i < numChildren; i++)
+			{
+				totalWeight += weights[i];
+				EvaluateNode(children[i], childPhase, state, pool, child);
+				BlendPoses(outLocalPose, child, weights[i] / totalWeight, nullptr, outLocalPose);
+			}
+			pool.Release(child);
+		}
+		break;
+	}
+
+	case NODE_TYPE::ADDITIVE:
+	{
+		EvaluateNode(node.Children[0u], phase, state, pool, outLocalPose);
+
+		float weight = Saturate(state.Parameters[node.Parameters[0u]]);
+		if (weight <= 0.f)
+		{
+			break;
+		}
+
+		Pose& additive = pool.Acquire(numBones_);
+		Pose& reference = pool.Acquire(numBones_);
+		EvaluateNode(node.Children[1u], phase, state, pool, additive);
+		EvaluateNode(node.Children[2u], phase, state, pool, reference);
+
+		const BoneWeights* boneWeights = (node.BoneWeightsIdx != INVALID_INDEX) ? &boneWeights_[node.BoneWeightsIdx] : nullptr;
+		AddPose(outLocalPose, additive, reference, weight, boneWeights, outLocalPose);
+		pool.Release(reference);
+		pool.Release(additive);
+		break;
+	}
+	}
+}
\ No newline at end of file
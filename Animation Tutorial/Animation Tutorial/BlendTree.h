@@ -0,0 +1,130 @@
+#pragma once
+
+#include "CompressedClip.h"
+#include "ResampledClip.h"
+#include "PoseBlend.h"
+#include "PosePool.h"
+#include <vector>
+
+// A graph of clips and blends, evaluated into a local pose. The tree itself is immutable once
+//  built, and can be shared by every character that uses it - each character only keeps a
+//  State with its own parameters, playback position and keyframe cursors.
+// Nodes are added children first, and the last node added is the root. Only the children
+//  with a non-zero weight are evaluated, and blends draw their intermediate poses from a
+//  PosePool, so evaluating a tree does not allocate.
+class BlendTree
+{
+public:
+	enum class NODE_TYPE
+	{
+		CLIP,
+		CROSSFADE,
+		BLEND_1D,
+		BLEND_2D,
+		ADDITIVE
+	};
+
+	// Playback state of one character, made by CreateState
+	struct State
+	{
+	public:
+		// Seconds since playback started
+		float Time;
+
+		// Indexed by the value returned from AddParameter
+		std::vector<float> Parameters;
+
+		// Indexed by node. Blend spaces play their clips in step, at the same point of their
+		//  cycle - this is that point, from 0 to 1.
+		std::vector<float> Phases;
+
+		// Indexed by node. Keyframe cursors of the compressed clip nodes.
+		std::vector<std::vector<BoneAnimation::Cursor>> Cursors;
+	};
+
+	struct Node
+	{
+	public:
+		NODE_TYPE Type;
+
+		// Clips - one of the two is set
+		const CompressedClip* Clip;
+		const ResampledClip* Resampled;
+		float Duration;
+
+		// Blends. Children of a 2D blend space are in rows of Positions[0].size() columns.
+		std::vector<std::uint32_t> Children;
+		std::vector<float> Positions[2];
+
+		// Time parameter of a clip, weight parameter of a crossfade or additive layer, or the
+		//  axes of a blend space. INVALID_INDEX when not used.
+		std::uint32_t Parameters[2];
+
+		// Additive layers only, INVALID_INDEX for no bone weights
+		std::uint32_t BoneWeightsIdx;
+	};
+
+	static const std::uint32_t INVALID_INDEX;
+
+	// No more than this many children contribute to one node
+	static const std::uint32_t MAX_WEIGHTED_CHILDREN = 4u;
+
+public:
+	explicit BlendTree(std::uint32_t numBones);
+	BlendTree(const BlendTree&) = delete;
+	~BlendTree() = default;
+
+	std::uint32_t AddParameter(float defaultValue);
+
+	// Clips must outlive the tree, and have one bone per bone of the tree. Clips play from
+	//  the start of the tree's playback and loop, unless they are in a blend space, or are
+	//  given a time parameter (which holds the clip time in seconds, e.g. for starting the
+	//  clip a crossfade blends to). Pass INVALID_INDEX for no time parameter.
+	std::uint32_t AddClip(const CompressedClip& clip, std::uint32_t timeParameter);
+	std::uint32_t AddClip(const ResampledClip& clip, std::uint32_t timeParameter);
+
+	// Blends from one node to another as the weight parameter goes from 0 to 1
+	std::uint32_t AddCrossfade(std::uint32_t fromNode, std::uint32_t toNode, std::uint32_t weightParameter);
+
+	// Blend spaces of clip nodes. Clips are placed at increasing positions along one axis, or on
+	//  a grid (xPositions columns by yPositions rows, children in row order), and the parameters
+	//  pick the point to sample. Clips are blended with their neighbours either side of that
+	//  point, and played in step, so that (for example) walk and run cycles plant their feet
+	//  together.
+	std::uint32_t AddBlend1D(const std::vector<std::uint32_t>& clipNodes, const std::vector<float>& positions, std::uint32_t parameter);
+	std::uint32_t AddBlend2D(const std::vector<std::uint32_t>& clipNodes, const std::vector<float>& xPositions, const std::vector<float>& yPositions,
+		std::uint32_t xParameter, std::uint32_t yParameter);
+
+	// Layers the difference between the additive and reference nodes on top of the base node
+	//  (see AddPose), scaled by the weight parameter. Bone weights are optional, to mask the
+	//  layer to part of the skeleton.
+	std::uint32_t AddAdditive(std::uint32_t baseNode, std::uint32_t additiveNode, std::uint32_t referenceNode, std::uint32_t weightParameter, const BoneWeights* boneWeights);
+
+	std::uint32_t GetBoneCount() const { return numBones_; }
+	std::uint32_t GetNodeCount() const { return (std::uint32_t)nodes_.size(); }
+	const Node& GetNode(std::uint32_t nodeIdx) const { return nodes_[nodeIdx]; }
+
+	// Children of a blend space node with non-zero weight at the state's parameters, and
+	//  their weights, which sum to 1. The outputs hold MAX_WEIGHTED_CHILDREN.
+	std::uint32_t GetWeightedChildren(const Node& node, const State& state, std::uint32_t* outChildren, float* outWeights) const;
+
+	State CreateState() const;
+
+	// Moves playback on by dt seconds
+	void Advance(State& state, float dt) const;
+
+	// outLocalPose must be sized for the tree's bone count
+	void Evaluate(State& state, PosePool& pool, Pose& outLocalPose) const;
+
+private:
+	std::uint32_t AddNode(const Node& node);
+
+	// phase is the point in the cycle of the blend space above a clip, or negative outside of one
+	void EvaluateNode(std::uint32_t nodeIdx, float phase, State& state, PosePool& pool, Pose& outLocalPose) const;
+
+private:
+	std::uint32_t numBones_;
+	std::vector<Node> nodes_;
+	std::vector<float> defaultParameters_;
+	std::vector<BoneWeights> boneWeights_;
+};
\ No newline at end of file
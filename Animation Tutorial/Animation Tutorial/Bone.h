@@ -0,0 +1,28 @@
+#pragma once
+
+#include "BoneAnimation.h"
+#include <string>
+
+struct AnimatedBone
+{
+public:
+	std::string Name;
+	std::string ParentName;
+	BoneAnimation Animation;
+
+public:
+	AnimatedBone(std::string name, std::string parentName, BoneAnimation animation);
+	AnimatedBone(const AnimatedBone&) = default;
+};
+
+struct StaticBone
+{
+public:
+	std::string Name;
+	std::string ParentName;
+	Transform FromParentTransform;
+
+public:
+	StaticBone(std::string name, std::string parentName, Transform fromParentTransform);
+	StaticBone(const StaticBone&) = default;
+};
\ No newline at end of file
@@ -1,88 +1,126 @@
 #include "BoneAnimation.h"
 #include <algorithm>
+#include <cmath>
 #include "Logger.h"
 
-BoneAnimation::BoneAnimation(std::vector<PositionKeyframe> positions, std::vector<RotationKeyframe> rotations, std::vector<ScaleKeyframe> scales)
-	: positions_(positions)
-	, rotations_(rotations)
-	, scales_(scales)
+const float BoneAnimation::CONSTANT_EPSILON = 1e-5f;
+
+namespace
 {
-	std::sort(positions_.begin(), positions_.end(), [](PositionKeyframe kf1, PositionKeyframe kf2) { return kf1.Time < kf2.Time; });
-	std::sort(rotations_.begin(), rotations_.end(), [](RotationKeyframe kf1, RotationKeyframe kf2) { return kf1.Time < kf2.Time; });
-	std::sort(scales_.begin(), scales_.end(), [](ScaleKeyframe kf1, ScaleKeyframe kf2) { return kf1.Time < kf2.Time; });
+
+bool NearlyEqual(float a, float b)
+{
+	return fabsf(a - b) <= BoneAnimation::CONSTANT_EPSILON * std::max(1.f, std::max(fabsf(a), fabsf(b)));
 }
 
-Transform BoneAnimation::GetTransformAtTime(float time) const
+bool NearlyEqual(const Vec3& a, const Vec3& b)
 {
-	Vec3 pos;
-	Quaternion rot;
-	Vec3 scl;
+	return NearlyEqual(a.x, b.x) && NearlyEqual(a.y, b.y) && NearlyEqual(a.z, b.z);
+}
 
-	if (time <= positions_.front().Time)
-	{
-		pos = positions_.front().Translation;
-	}
-	else if (time >= positions_.back().Time)
-	{
-		pos = positions_.back().Translation;
-	}
-	else
+bool NearlyEqual(const Quaternion& a, const Quaternion& b)
+{
+	// q and -q are the same rotation
+	float sign = (a.x * b.x + a.y * b.y + a.z * b.z + a.w * b.w < 0.f) ? -1.f : 1.f;
+	return NearlyEqual(a.x, b.x * sign) && NearlyEqual(a.y, b.y * sign) && NearlyEqual(a.z, b.z * sign) && NearlyEqual(a.w, b.w * sign);
+}
+
+// Drops every key but the first from a channel that never changes
+template <typename KeyframeType, typename ValueType>
+void CollapseConstantChannel(std::vector<KeyframeType>& keys, ValueType KeyframeType::*value)
+{
+	for (auto&& kf : keys)
 	{
-		// Find interpolated position
-		std::uint32_t idx = 0u;
-		while (idx < positions_.size() - 1u
-			&& positions_[idx].Time <= time
-			&& positions_[idx + 1].Time <= time)
+		if (!NearlyEqual(keys.front().*value, kf.*value))
 		{
-			idx++;
+			return;
 		}
-		
-		pos = PositionKeyframe::LERP(positions_[idx], positions_[idx + 1u], time);
 	}
 
-	if (time <= rotations_.front().Time)
-	{
-		rot = rotations_.front().Rotation;
-	}
-	else if (time >= rotations_.back().Time)
+	if (keys.size() > 1u)
 	{
-		rot = rotations_.back().Rotation;
+		keys.erase(keys.begin() + 1u, keys.end());
 	}
-	else
+}
+
+// Finds the last keyframe at or before the given time, starting the search from
+//  the cursor hint. Requires keys.front().Time < time < keys.back().Time
+template <typename KeyframeType>
+std::uint32_t FindKeyframe(const std::vector<KeyframeType>& keys, float time, std::uint32_t hint)
+{
+	if (hint < keys.size() - 1u && keys[hint].Time <= time)
 	{
-		// Find interpolated rotation
-		std::uint32_t idx = 0u;
-		while (idx < rotations_.size() - 1u
-			&& rotations_[idx].Time <= time
-			&& rotations_[idx + 1].Time <= time)
+		for (std::uint32_t step = 0u; step < BoneAnimation::Cursor::MAX_STEPS; step++, hint++)
 		{
-			idx++;
+			if (keys[hint + 1u].Time > time)
+			{
+				return hint;
+			}
 		}
-
-		rot = RotationKeyframe::LERP(rotations_[idx], rotations_[idx + 1u], time);
 	}
 
-	if (time <= scales_.front().Time)
+	// Seek, loop, or large jump - fall back to a binary search
+	auto next = std::upper_bound(keys.begin(), keys.end(), time, [](float t, const KeyframeType& kf) { return t < kf.Time; });
+	return (std::uint32_t)(next - keys.begin()) - 1u;
+}
+
+template <typename KeyframeType, typename ValueType>
+ValueType SampleChannel(const std::vector<KeyframeType>& keys, float time, std::uint32_t& cursor, ValueType KeyframeType::*value)
+{
+	if (keys.size() == 1u)
+	{
+		// Constant channel - nothing to search or interpolate
+		return keys.front().*value;
+	}
+	else if (time <= keys.front().Time)
 	{
-		scl = scales_.front().Scale;
+		cursor = 0u;
+		return keys.front().*value;
 	}
-	else if (time >= scales_.back().Time)
+	else if (time >= keys.back().Time)
 	{
-		scl = scales_.back().Scale;
+		cursor = (std::uint32_t)keys.size() - 1u;
+		return keys.back().*value;
 	}
 	else
 	{
-		// Find interpolated scaling
-		std::uint32_t idx = 0u;
-		while (idx < scales_.size() - 1u
-			&& scales_[idx].Time <= time
-			&& scales_[idx + 1].Time <= time)
-		{
-			idx++;
-		}
-
-		scl = ScaleKeyframe::LERP(scales_[idx], scales_[idx + 1u], time);
+		cursor = FindKeyframe(keys, time, cursor);
+		return KeyframeType::LERP(keys[cursor], keys[cursor + 1u], time);
 	}
+}
+
+}
+
+BoneAnimation::BoneAnimation(std::vector<PositionKeyframe> positions, std::vector<RotationKeyframe> rotations, std::vector<ScaleKeyframe> scales)
+	: positions_(positions)
+	, rotations_(rotations)
+	, scales_(scales)
+{
+	std::sort(positions_.begin(), positions_.end(), [](PositionKeyframe kf1, PositionKeyframe kf2) { return kf1.Time < kf2.Time; });
+	std::sort(rotations_.begin(), rotations_.end(), [](RotationKeyframe kf1, RotationKeyframe kf2) { return kf1.Time < kf2.Time; });
+	std::sort(scales_.begin(), scales_.end(), [](ScaleKeyframe kf1, ScaleKeyframe kf2) { return kf1.Time < kf2.Time; });
+
+	CollapseConstantChannel(positions_, &PositionKeyframe::Translation);
+	CollapseConstantChannel(rotations_, &RotationKeyframe::Rotation);
+	CollapseConstantChannel(scales_, &ScaleKeyframe::Scale);
+}
+
+std::uint32_t BoneAnimation::GetConstantChannelCount() const
+{
+	return (positions_.size() == 1u ? 1u : 0u) + (rotations_.size() == 1u ? 1u : 0u) + (scales_.size() == 1u ? 1u : 0u);
+}
+
+Transform BoneAnimation::GetTransformAtTime(float time) const
+{
+	Cursor cursor;
+	return GetTransformAtTime(time, cursor);
+}
+
+Transform BoneAnimation::GetTransformAtTime(float time, Cursor& cursor) const
+{
+	Vec3 pos = SampleChannel(positions_, time, cursor.PositionIdx, &PositionKeyframe::Translation);
+	Quaternion rot = SampleChannel(rotations_, time, cursor.RotationIdx, &RotationKeyframe::Rotation);
+	Vec3 scl = SampleChannel(scales_, time, cursor.ScaleIdx, &ScaleKeyframe::Scale);
 
-	return std::move(Transform(pos, rot, scl));
+	return Transform(pos, rot, scl);
 }
\ No newline at end of file
@@ -0,0 +1,60 @@
+#pragma once
+
+#include "PositionKeyframe.h"
+#include "RotationKeyframe.h"
+#include "ScaleKeyframe.h"
+#include <cstdint>
+#include <vector>
+
+class BoneAnimation
+{
+public:
+	// Per-instance playback position in each channel. Lets forward playback pick up
+	//  the keyframe search where the previous frame left off.
+	struct Cursor
+	{
+	public:
+		// Forward playback usually moves zero or one keys per frame. Past this many,
+		//  it's cheaper to binary search than to keep stepping.
+		static const std::uint32_t MAX_STEPS = 4u;
+
+	public:
+		std::uint32_t PositionIdx;
+		std::uint32_t RotationIdx;
+		std::uint32_t ScaleIdx;
+
+	public:
+		Cursor()
+			: PositionIdx(0u)
+			, RotationIdx(0u)
+			, ScaleIdx(0u)
+		{}
+	};
+
+	// Channels whose keys all lie within this of the first key are constant, and are
+	//  stored as that single key. Relative to the size of the value, for values above 1.
+	static const float CONSTANT_EPSILON;
+
+public:
+	BoneAnimation(std::vector<PositionKeyframe> positions, std::vector<RotationKeyframe> rotations, std::vector<ScaleKeyframe> scales);
+	BoneAnimation(const BoneAnimation&) = default;
+	~BoneAnimation() = default;
+
+	Transform GetTransformAtTime(float time) const;
+	Transform GetTransformAtTime(float time, Cursor& cursor) const;
+
+	const std::vector<PositionKeyframe>& GetPositionKeyframes() const { return positions_; }
+	const std::vector<RotationKeyframe>& GetRotationKeyframes() const { return rotations_; }
+	const std::vector<ScaleKeyframe>& GetScaleKeyframes() const { return scales_; }
+
+	// Number of channels (out of position, rotation and scale) holding a single key
+	std::uint32_t GetConstantChannelCount() const;
+
+	// A bone whose channels are all constant does not animate at all
+	bool IsStatic() const { return GetConstantChannelCount() == 3u; }
+
+private:
+	std::vector<PositionKeyframe> positions_;
+	std::vector<RotationKeyframe> rotations_;
+	std::vector<ScaleKeyframe> scales_;
+};
\ No newline at end of file
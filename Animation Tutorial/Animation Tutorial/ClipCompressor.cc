@@ -0,0 +1,384 @@
+#include "ClipCompressor.h"
+#include "ClipSampler.h"
+#include "Logger.h"
+#include <algorithm>
+#include <cstring>
+#include <cmath>
+#include <assert.h>
+
+namespace
+{
+
+const float ERROR_SAMPLE_RATE = 60.f;
+
+enum class TRACK_KIND
+{
+	VECTOR,
+	ROTATION
+};
+
+// How far a local error on a bone moves the virtual vertices in model space.
+//  Extent is the distance to the furthest virtual vertex the bone moves, which
+//  scales rotation and scale errors. Position errors are scaled by the parent.
+struct BoneErrorScale
+{
+	float Extent;
+	float ParentScale;
+};
+
+// One channel of one bone, with the source keys and their quantized forms side by side
+struct TrackKeys
+{
+	std::vector<std::uint16_t> Times;
+	std::vector<CompressedClip::Key> Keys;
+	std::vector<float> Decoded;
+	std::vector<float> Source;
+	std::vector<float> SourceTimes;
+};
+
+std::uint32_t AlignUp(std::uint32_t value, std::uint32_t alignment)
+{
+	return (value + alignment - 1u) / alignment * alignment;
+}
+
+std::uint32_t Append(std::vector<char>& blob, const void* data, std::uint32_t size)
+{
+	std::uint32_t offset = AlignUp((std::uint32_t)blob.size(), CompressedClip::ALIGNMENT);
+	blob.resize(offset + size);
+	if (size > 0u)
+	{
+		memcpy(&blob[offset], data, size);
+	}
+	return offset;
+}
+
+float MaxAbsComponent(const Vec3& v)
+{
+	return std::max(fabsf(v.x), std::max(fabsf(v.y), fabsf(v.z)));
+}
+
+std::vector<BoneErrorScale> GetErrorScales(const Skeleton& skeleton, float shellDistance)
+{
+	std::uint32_t numBones = skeleton.GetBoneCount();
+	std::vector<BoneErrorScale> scales(numBones, { shellDistance, 1.f });
+	if (numBones == 0u)
+	{
+		return scales;
+	}
+
+	std::vector<Transform> local(numBones);
+	std::vector<Transform> model(numBones);
+	for (std::uint32_t boneIdx = 0u; boneIdx < numBones; boneIdx++)
+	{
+		local[boneIdx] = skeleton.GetBone(boneIdx).FromParentTransform;
+	}
+	skeleton.GetModelTransforms(&local[0], &model[0]);
+
+	// Every bone pushes out the extent of each of its ancestors
+	for (std::uint32_t boneIdx = 0u; boneIdx < numBones; boneIdx++)
+	{
+		std::uint32_t parentIdx = skeleton.GetBone(boneIdx).ParentIndex;
+		if (parentIdx != Skeleton::INVALID_INDEX)
+		{
+			scales[boneIdx].ParentScale = MaxAbsComponent(model[parentIdx].Scale);
+		}
+
+		for (std::uint32_t ancestorIdx = parentIdx; ancestorIdx != Skeleton::INVALID_INDEX; ancestorIdx = skeleton.GetBone(ancestorIdx).ParentIndex)
+		{
+			float distance = (model[boneIdx].Pos - model[ancestorIdx].Pos).Magnitude() + shellDistance;
+			scales[ancestorIdx].Extent = std::max(scales[ancestorIdx].Extent, distance);
+		}
+	}
+
+	return scales;
+}
+
+// Interpolates two decoded keys the way ClipSampler does (rotations are nlerped along the
+//  shorter arc), then measures how far the result is from the source value
+float KeyError(TRACK_KIND kind, const float* from, const float* to, float ratio, const float* source, float errorScale)
+{
+	if (kind == TRACK_KIND::ROTATION)
+	{
+		float sign = (from[0u] * to[0u] + from[1u] * to[1u] + from[2u] * to[2u] + from[3u] * to[3u] < 0.f) ? -1.f : 1.f;
+		float q[4];
+		float lengthSq = 0.f;
+		for (std::uint32_t c = 0u; c < 4u; c++)
+		{
+			q[c] = from[c] * (1.f - ratio) + to[c] * sign * ratio;
+			lengthSq += q[c] * q[c];
+		}
+
+		// Chord length of the rotation between the two, at the extent of the bone
+		float dot = fabsf(q[0u] * source[0u] + q[1u] * source[1u] + q[2u] * source[2u] + q[3u] * source[3u]) / sqrtf(lengthSq);
+		return 2.f * sqrtf(std::max(0.f, 1.f - dot * dot)) * errorScale;
+	}
+
+	float distanceSq = 0.f;
+	for (std::uint32_t c = 0u; c < 3u; c++)
+	{
+		float d = from[c] * (1.f - ratio) + to[c] * ratio - source[c];
+		distanceSq += d * d;
+	}
+	return sqrtf(distanceSq) * errorScale;
+}
+
+// Whether interpolating between keys first and last reproduces every source key in between
+bool SpanFits(TRACK_KIND kind, const TrackKeys& track, std::uint32_t nComponents, std::uint32_t first, std::uint32_t last, float timeScale, float errorScale, float tolerance)
+{
+	const float* from = &track.Decoded[first * nComponents];
+	const float* to = &track.Decoded[last * nComponents];
+	float span = (float)track.Times[last] - (float)track.Times[first];
+
+	for (std::uint32_t keyIdx = first + 1u; keyIdx < last; keyIdx++)
+	{
+		float ratio = (span > 0.f) ? (track.SourceTimes[keyIdx] * timeScale - track.Times[first]) / span : 0.f;
+		ratio = std::min(1.f, std::max(0.f, ratio));
+		if (KeyError(kind, from, to, ratio, &track.Source[keyIdx * nComponents], errorScale) > tolerance)
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+// Greedy key reduction - from each kept key, extend the span as far as it still fits
+std::vector<std::uint32_t> ReduceKeys(TRACK_KIND kind, const TrackKeys& track, std::uint32_t nComponents, float timeScale, float errorScale, float tolerance)
+{
+	std::uint32_t numKeys = (std::uint32_t)track.Times.size();
+	std::vector<std::uint32_t> kept(1u, 0u);
+
+	// Constant track - the first key alone is close enough to every other key
+	bool isConstant = true;
+	for (std::uint32_t keyIdx = 1u; keyIdx < numKeys && isConstant; keyIdx++)
+	{
+		isConstant = KeyError(kind, &track.Decoded[0u], &track.Decoded[0u], 0.f, &track.Source[keyIdx * nComponents], errorScale) <= tolerance;
+	}
+	if (isConstant)
+	{
+		return kept;
+	}
+
+	std::uint32_t first = 0u;
+	while (first < numKeys - 1u)
+	{
+		std::uint32_t last = first + 1u;
+		while (last + 1u < numKeys && SpanFits(kind, track, nComponents, first, last + 1u, timeScale, errorScale, tolerance))
+		{
+			last++;
+		}
+		kept.push_back(last);
+		first = last;
+	}
+
+	return kept;
+}
+
+// Quantizes and reduces one track, appending its keys to the output streams
+CompressedClip::Track CompressTrack(TRACK_KIND kind, const AnimationClip::TrackRange& range, const float* const* streams, float timeScale, float errorScale, float tolerance,
+	std::vector<std::uint16_t>& outTimes, std::vector<CompressedClip::Key>& outKeys)
+{
+	std::uint32_t nComponents = (kind == TRACK_KIND::ROTATION) ? 4u : 3u;
+
+	CompressedClip::Track compressed = {};
+	if (kind == TRACK_KIND::VECTOR)
+	{
+		for (std::uint32_t c = 0u; c < 3u; c++)
+		{
+			const float* values = streams[c + 1u] + range.FirstKey;
+			float min = *std::min_element(values, values + range.NumKeys);
+			float max = *std::max_element(values, values + range.NumKeys);
+			compressed.Min[c] = min;
+			compressed.Step[c] = (max - min) / CompressedClip::MAX_QUANTIZED;
+		}
+	}
+
+	TrackKeys track;
+	track.Source.resize(range.NumKeys * nComponents);
+	track.Decoded.resize(range.NumKeys * nComponents);
+	for (std::uint32_t keyIdx = 0u; keyIdx < range.NumKeys; keyIdx++)
+	{
+		float* source = &track.Source[keyIdx * nComponents];
+		for (std::uint32_t c = 0u; c < nComponents; c++)
+		{
+			source[c] = streams[c + 1u][range.FirstKey + keyIdx];
+		}
+
+		CompressedClip::Key key;
+		if (kind == TRACK_KIND::ROTATION)
+		{
+			Quaternion rotation;
+			rotation.x = source[0u];
+			rotation.y = source[1u];
+			rotation.z = source[2u];
+			rotation.w = source[3u];
+			key = CompressedClip::QuantizeRotation(rotation);
+			CompressedClip::DequantizeRotation(key, &track.Decoded[keyIdx * nComponents]);
+		}
+		else
+		{
+			key = CompressedClip::QuantizeVector(source, compressed.Min, compressed.Step);
+			CompressedClip::DequantizeVector(key, compressed, &track.Decoded[keyIdx * nComponents]);
+		}
+
+		float time = streams[0u][range.FirstKey + keyIdx];
+		track.SourceTimes.push_back(time);
+		track.Times.push_back(CompressedClip::QuantizeTime(time, timeScale));
+		track.Keys.push_back(key);
+	}
+
+	std::vector<std::uint32_t> kept = ReduceKeys(kind, track, nComponents, timeScale, errorScale, tolerance);
+
+	// A constant vector track keeps its value in Min, so the sampler needs neither its key
+	//  nor any decoding
+	if (kind == TRACK_KIND::VECTOR && kept.size() == 1u)
+	{
+		for (std::uint32_t c = 0u; c < 3u; c++)
+		{
+			compressed.Min[c] = track.Decoded[kept[0u] * nComponents + c];
+			compressed.Step[c] = 0.f;
+		}
+		track.Keys[kept[0u]] = CompressedClip::QuantizeVector(&compressed.Min[0u], compressed.Min, compressed.Step);
+	}
+
+	compressed.FirstKey = (std::uint32_t)outKeys.size();
+	compressed.NumKeys = (std::uint32_t)kept.size();
+	for (std::uint32_t keyIdx : kept)
+	{
+		outTimes.push_back(track.Times[keyIdx]);
+		outKeys.push_back(track.Keys[keyIdx]);
+	}
+
+	return compressed;
+}
+
+// Positions of the virtual vertices of every bone, in model space
+void GetVirtualVertices(const Skeleton& skeleton, const std::vector<Transform>& localTransforms, float shellDistance, std::vector<Transform>& modelTransforms, std::vector<Vec3>& outVertices)
+{
+	skeleton.GetModelTransforms(&localTransforms[0], &modelTransforms[0]);
+
+	outVertices.clear();
+	for (const Transform& model : modelTransforms)
+	{
+		outVertices.push_back(model.Pos);
+		outVertices.push_back((model * Transform(Vec3::UnitX * shellDistance, Quaternion(), Vec3(1.f, 1.f, 1.f))).Pos);
+		outVertices.push_back((model * Transform(Vec3::UnitY * shellDistance, Quaternion(), Vec3(1.f, 1.f, 1.f))).Pos);
+		outVertices.push_back((model * Transform(Vec3::UnitZ * shellDistance, Quaternion(), Vec3(1.f, 1.f, 1.f))).Pos);
+	}
+}
+
+float MeasureMaxError(const AnimationClip& source, const CompressedClip& compressed, const Skeleton& skeleton, float shellDistance)
+{
+	std::uint32_t numBones = skeleton.GetBoneCount();
+	if (numBones == 0u)
+	{
+		return 0.f;
+	}
+
+	std::vector<Transform> sourceLocal(numBones);
+	std::vector<Transform> compressedLocal(numBones);
+	std::vector<Transform> model(numBones);
+	std::vector<Vec3> sourceVertices;
+	std::vector<Vec3> compressedVertices;
+	Pose pose(numBones);
+
+	float maxError = 0.f;
+	std::uint32_t numSamples = (std::uint32_t)ceilf(source.GetDuration() * ERROR_SAMPLE_RATE) + 1u;
+	for (std::uint32_t sampleIdx = 0u; sampleIdx < numSamples; sampleIdx++)
+	{
+		float time = std::min(sampleIdx / ERROR_SAMPLE_RATE, source.GetDuration());
+
+		source.Sample(time, nullptr, &sourceLocal[0]);
+		SampleClip(compressed, time, pose);
+		for (std::uint32_t boneIdx = 0u; boneIdx < numBones; boneIdx++)
+		{
+			compressedLocal[boneIdx] = pose.GetTransform(boneIdx);
+		}
+
+		GetVirtualVertices(skeleton, sourceLocal, shellDistance, model, sourceVertices);
+		GetVirtualVertices(skeleton, compressedLocal, shellDistance, model, compressedVertices);
+		for (std::uint32_t vertIdx = 0u; vertIdx < sourceVertices.size(); vertIdx++)
+		{
+			maxError = std::max(maxError, (sourceVertices[vertIdx] - compressedVertices[vertIdx]).Magnitude());
+		}
+	}
+
+	return maxError;
+}
+
+}
+
+std::shared_ptr<CompressedClip> CompressClip(const AnimationClip& clip, const Skeleton& skeleton, const ClipCompressionOptions& options, ClipCompressionStats& outStats)
+{
+	assert(clip.GetBoneCount() == skeleton.GetBoneCount());
+	assert(options.BoneTolerances.empty() || options.BoneTolerances.size() == skeleton.GetBoneCount());
+
+	if (clip.GetBoneCount() == 0u)
+	{
+		Logger::Log("Cannot compress an animation clip without any bones");
+		return nullptr;
+	}
+
+	const float* positions[4] = { clip.GetPositionStream(0u), clip.GetPositionStream(1u), clip.GetPositionStream(2u), clip.GetPositionStream(3u) };
+	const float* rotations[5] = { clip.GetRotationStream(0u), clip.GetRotationStream(1u), clip.GetRotationStream(2u), clip.GetRotationStream(3u), clip.GetRotationStream(4u) };
+	const float* scales[4] = { clip.GetScaleStream(0u), clip.GetScaleStream(1u), clip.GetScaleStream(2u), clip.GetScaleStream(3u) };
+
+	CompressedClip::Header header = {};
+	header.Magic = CompressedClip::MAGIC;
+	header.Version = CompressedClip::VERSION;
+	header.NumBones = clip.GetBoneCount();
+	header.Duration = clip.GetDuration();
+	header.TimeScale = (header.Duration > 0.f) ? CompressedClip::MAX_KEY_TIME / header.Duration : 0.f;
+
+	std::vector<BoneErrorScale> errorScales = GetErrorScales(skeleton, options.ShellDistance);
+	std::vector<CompressedClip::Track> positionTracks, rotationTracks, scaleTracks;
+	std::vector<std::uint16_t> positionTimes, rotationTimes, scaleTimes;
+	std::vector<CompressedClip::Key> positionKeys, rotationKeys, scaleKeys;
+
+	outStats.SourceKeys = 0u;
+	for (std::uint32_t boneIdx = 0u; boneIdx < header.NumBones; boneIdx++)
+	{
+		float tolerance = options.BoneTolerances.empty() ? options.Tolerance : options.BoneTolerances[boneIdx];
+		const BoneErrorScale& errorScale = errorScales[boneIdx];
+
+		positionTracks.push_back(CompressTrack(TRACK_KIND::VECTOR, clip.GetPositionTrack(boneIdx), positions, header.TimeScale, errorScale.ParentScale, tolerance, positionTimes, positionKeys));
+		rotationTracks.push_back(CompressTrack(TRACK_KIND::ROTATION, clip.GetRotationTrack(boneIdx), rotations, header.TimeScale, errorScale.Extent, tolerance, rotationTimes, rotationKeys));
+		scaleTracks.push_back(CompressTrack(TRACK_KIND::VECTOR, clip.GetScaleTrack(boneIdx), scales, header.TimeScale, errorScale.Extent, tolerance, scaleTimes, scaleKeys));
+
+		outStats.SourceKeys += clip.GetPositionTrack(boneIdx).NumKeys + clip.GetRotationTrack(boneIdx).NumKeys + clip.GetScaleTrack(boneIdx).NumKeys;
+	}
+
+	header.NumPositionKeys = (std::uint32_t)positionKeys.size();
+	header.NumRotationKeys = (std::uint32_t)rotationKeys.size();
+	header.NumScaleKeys = (std::uint32_t)scaleKeys.size();
+
+	// Every bone has at least one key in each channel, so none of the streams are empty
+	std::vector<char> blob(sizeof(CompressedClip::Header), 0);
+	std::uint32_t tableSize = header.NumBones * sizeof(CompressedClip::Track);
+	header.PositionTracksOffset = Append(blob, &positionTracks[0], tableSize);
+	header.RotationTracksOffset = Append(blob, &rotationTracks[0], tableSize);
+	header.ScaleTracksOffset = Append(blob, &scaleTracks[0], tableSize);
+	header.PositionTimesOffset = Append(blob, &positionTimes[0], header.NumPositionKeys * sizeof(std::uint16_t));
+	header.RotationTimesOffset = Append(blob, &rotationTimes[0], header.NumRotationKeys * sizeof(std::uint16_t));
+	header.ScaleTimesOffset = Append(blob, &scaleTimes[0], header.NumScaleKeys * sizeof(std::uint16_t));
+	header.PositionKeysOffset = Append(blob, &positionKeys[0], header.NumPositionKeys * sizeof(CompressedClip::Key));
+	header.RotationKeysOffset = Append(blob, &rotationKeys[0], header.NumRotationKeys * sizeof(CompressedClip::Key));
+	header.ScaleKeysOffset = Append(blob, &scaleKeys[0], header.NumScaleKeys * sizeof(CompressedClip::Key));
+
+	blob.resize(AlignUp((std::uint32_t)blob.size(), CompressedClip::ALIGNMENT), 0);
+	header.SizeInBytes = (std::uint32_t)blob.size();
+	memcpy(&blob[0], &header, sizeof(header));
+
+	std::shared_ptr<CompressedClip> compressed = CompressedClip::FromMemory(&blob[0], header.SizeInBytes);
+	if (!compressed)
+	{
+		return nullptr;
+	}
+
+	outStats.SourceBytes = clip.GetSizeInBytes();
+	outStats.CompressedBytes = compressed->GetSizeInBytes();
+	outStats.CompressedKeys = header.NumPositionKeys + header.NumRotationKeys + header.NumScaleKeys;
+	outStats.MaxError = MeasureMaxError(clip, *compressed, skeleton, options.ShellDistance);
+
+	return compressed;
+}
\ No newline at end of file
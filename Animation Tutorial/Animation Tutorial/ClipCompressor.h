@@ -0,0 +1,48 @@
+#pragma once
+
+#include "AnimationClip.h"
+#include "CompressedClip.h"
+#include "Skeleton.h"
+#include <memory>
+#include <vector>
+
+// How much error compression may add to a clip. Error is measured in model space, at
+//  virtual vertices ShellDistance away from each bone and from every bone below it, so
+//  a small rotation error near the root counts for more than the same error on a finger.
+struct ClipCompressionOptions
+{
+public:
+	// Largest distance any virtual vertex may move, in model space units
+	float Tolerance;
+
+	// Distance from a bone to the skin it moves, in model space units
+	float ShellDistance;
+
+	// Optional - tolerance for each skeleton bone, replacing Tolerance
+	std::vector<float> BoneTolerances;
+
+	ClipCompressionOptions(float tolerance, float shellDistance)
+		: Tolerance(tolerance)
+		, ShellDistance(shellDistance)
+		, BoneTolerances()
+	{}
+};
+
+struct ClipCompressionStats
+{
+public:
+	std::uint32_t SourceBytes;
+	std::uint32_t CompressedBytes;
+	std::uint32_t SourceKeys;
+	std::uint32_t CompressedKeys;
+
+	// Largest distance between source and compressed virtual vertices, sampled at 60 Hz
+	//  over the whole clip in model space. Errors add up along the hierarchy, so this
+	//  can be somewhat above the tolerance.
+	float MaxError;
+};
+
+// Quantizes every key of the clip, and drops the keys that linear interpolation of the
+//  quantized keys either side of them reproduces within tolerance. Constant tracks are
+//  stored as a single key. The skeleton must be the one the clip was created for.
+std::shared_ptr<CompressedClip> CompressClip(const AnimationClip& clip, const Skeleton& skeleton, const ClipCompressionOptions& options, ClipCompressionStats& outStats);
\ No newline at end of file
@@ -0,0 +1,383 @@
+#include "ClipSampler.h"
+#include "Simd.h"
+#include <algorithm>
+#include <assert.h>
+
+namespace
+{
+
+const std::uint32_t NUM_COMPONENTS = (std::uint32_t)POSE_STREAM::COUNT;
+
+// Key values either side of the sample time, gathered for each lane of one batch
+struct LaneKeys
+{
+	alignas(32) float From[NUM_COMPONENTS][SIMD_WIDTH];
+	alignas(32) float To[NUM_COMPONENTS][SIMD_WIDTH];
+	alignas(32) float PositionRatio[SIMD_WIDTH];
+	alignas(32) float RotationRatio[SIMD_WIDTH];
+	alignas(32) float ScaleRatio[SIMD_WIDTH];
+};
+
+// Finds the keys either side of the time in one track, and copies their values into a lane.
+//  Times outside of the track clamp to an end key, with a ratio of zero.
+void GatherTrack(const AnimationClip::TrackRange& track, const float* const* streams, std::uint32_t firstComponent, std::uint32_t nComponents,
+	float time, std::uint32_t& cursor, LaneKeys& keys, float* ratios, std::uint32_t lane)
+{
+	float ratio = 0.f;
+	bool interpolate = AnimationClip::FindKeys(streams[0u] + track.FirstKey, track.NumKeys, time, cursor, ratio);
+
+	std::uint32_t from = track.FirstKey + cursor;
+	std::uint32_t to = interpolate ? from + 1u : from;
+
+	for (std::uint32_t c = 0u; c < nComponents; c++)
+	{
+		keys.From[firstComponent + c][lane] = streams[c + 1u][from];
+		keys.To[firstComponent + c][lane] = streams[c + 1u][to];
+	}
+	ratios[lane] = interpolate ? ratio : 0.f;
+}
+
+void GatherIdentity(LaneKeys& keys, std::uint32_t lane)
+{
+	for (std::uint32_t c = 0u; c < NUM_COMPONENTS; c++)
+	{
+		keys.From[c][lane] = 0.f;
+		keys.To[c][lane] = 0.f;
+	}
+
+	keys.From[(std::uint32_t)POSE_STREAM::ROT_W][lane] = keys.To[(std::uint32_t)POSE_STREAM::ROT_W][lane] = 1.f;
+	keys.From[(std::uint32_t)POSE_STREAM::SCALE_X][lane] = keys.To[(std::uint32_t)POSE_STREAM::SCALE_X][lane] = 1.f;
+	keys.From[(std::uint32_t)POSE_STREAM::SCALE_Y][lane] = keys.To[(std::uint32_t)POSE_STREAM::SCALE_Y][lane] = 1.f;
+	keys.From[(std::uint32_t)POSE_STREAM::SCALE_Z][lane] = keys.To[(std::uint32_t)POSE_STREAM::SCALE_Z][lane] = 1.f;
+	keys.PositionRatio[lane] = keys.RotationRatio[lane] = keys.ScaleRatio[lane] = 0.f;
+}
+
+// Copies a fixed transform into a lane, for bones that are not sampled
+void GatherTransform(const Transform& transform, LaneKeys& keys, std::uint32_t lane)
+{
+	const float values[NUM_COMPONENTS] = {
+		transform.Pos.x, transform.Pos.y, transform.Pos.z,
+		transform.Rotation.x, transform.Rotation.y, transform.Rotation.z, transform.Rotation.w,
+		transform.Scale.x, transform.Scale.y, transform.Scale.z
+	};
+	for (std::uint32_t c = 0u; c < NUM_COMPONENTS; c++)
+	{
+		keys.From[c][lane] = keys.To[c][lane] = values[c];
+	}
+	keys.PositionRatio[lane] = keys.RotationRatio[lane] = keys.ScaleRatio[lane] = 0.f;
+}
+
+// Rotation keys of a compressed clip either side of the sample time, gathered for each
+//  lane of one batch as they are stored, and decoded for every lane at once by
+//  DecodeBatch. Components hold twice their quantized value less MAX_QUANTIZED_ROTATION:
+//  an odd whole number, which decodes with a single multiply. The slot of the dropped
+//  component holds zero, the only even value, so it decodes to zero and is picked out
+//  without knowing which slot it is.
+struct QuantizedLaneKeys
+{
+	alignas(32) float From[4][SIMD_WIDTH];
+	alignas(32) float To[4][SIMD_WIDTH];
+};
+
+// Same as GatherTrack, for a position or scale track of a compressed clip. keyTime is in
+//  the units of the clip's key times. Constant tracks hold their value in Min, and need no
+//  search or decoding. The few animated ones are decoded here, a multiply-add apiece.
+void GatherCompressedTrack(const CompressedClip::Track& track, const std::uint16_t* times, const CompressedClip::Key* values, std::uint32_t firstComponent,
+	float keyTime, std::uint32_t& cursor, LaneKeys& keys, float* ratios, std::uint32_t lane)
+{
+	if (track.NumKeys == 1u)
+	{
+		for (std::uint32_t c = 0u; c < 3u; c++)
+		{
+			keys.From[firstComponent + c][lane] = keys.To[firstComponent + c][lane] = track.Min[c];
+		}
+		ratios[lane] = 0.f;
+		return;
+	}
+
+	float ratio = 0.f;
+	bool interpolate = CompressedClip::FindKeys(times + track.FirstKey, track.NumKeys, keyTime, cursor, ratio);
+
+	const CompressedClip::Key& from = values[track.FirstKey + cursor];
+	const CompressedClip::Key& to = interpolate ? values[track.FirstKey + cursor + 1u] : from;
+
+	for (std::uint32_t c = 0u; c < 3u; c++)
+	{
+		keys.From[firstComponent + c][lane] = track.Min[c] + from.Values[c] * track.Step[c];
+		keys.To[firstComponent + c][lane] = track.Min[c] + to.Values[c] * track.Step[c];
+	}
+	ratios[lane] = interpolate ? ratio : 0.f;
+}
+
+// Unpacks the stored components of a smallest three rotation key into their slots. Each slot
+//  is picked out with comparisons rather than a table, so the stores go to fixed addresses.
+void GatherRotationKey(const CompressedClip::Key& key, float (*components)[SIMD_WIDTH], std::uint32_t lane)
+{
+	std::uint32_t largest = CompressedClip::GetDroppedComponent(key);
+	int a = 2 * (key.Values[0u] & CompressedClip::MAX_QUANTIZED_ROTATION) - CompressedClip::MAX_QUANTIZED_ROTATION;
+	int b = 2 * (key.Values[1u] & CompressedClip::MAX_QUANTIZED_ROTATION) - CompressedClip::MAX_QUANTIZED_ROTATION;
+	int c = 2 * (key.Values[2u] & CompressedClip::MAX_QUANTIZED_ROTATION) - CompressedClip::MAX_QUANTIZED_ROTATION;
+
+	components[0u][lane] = (float)((largest > 0u) ? a : 0);
+	components[1u][lane] = (float)((largest > 1u) ? b : ((largest == 1u) ? 0 : a));
+	components[2u][lane] = (float)((largest > 2u) ? c : ((largest == 2u) ? 0 : b));
+	components[3u][lane] = (float)((largest == 3u) ? 0 : c);
+}
+
+void GatherCompressedRotationTrack(const CompressedClip::Track& track, const std::uint16_t* times, const CompressedClip::Key* values,
+	float keyTime, std::uint32_t& cursor, QuantizedLaneKeys& quantized, float* ratios, std::uint32_t lane)
+{
+	float ratio = 0.f;
+	bool interpolate = CompressedClip::FindKeys(times + track.FirstKey, track.NumKeys, keyTime, cursor, ratio);
+
+	const CompressedClip::Key& from = values[track.FirstKey + cursor];
+	const CompressedClip::Key& to = interpolate ? values[track.FirstKey + cursor + 1u] : from;
+
+	GatherRotationKey(from, quantized.From, lane);
+	GatherRotationKey(to, quantized.To, lane);
+	ratios[lane] = interpolate ? ratio : 0.f;
+}
+
+// One component of a rotation key in every lane, with the mask of the lanes in which it is
+//  the dropped one. 1 - value^2 clamped at zero is one for the dropped component's zero,
+//  and zero for the odd values of the others.
+SimdFloat DecodeRotationComponent(const float* values, SimdFloat& outIsDropped)
+{
+	SimdFloat value = SimdLoad(values);
+	outIsDropped = SimdMax(SimdSet(0.f), SimdSub(SimdSet(1.f), SimdMul(value, value)));
+	return SimdMul(value, SimdSet(0.5f * CompressedClip::ROTATION_STEP));
+}
+
+// Decodes one rotation key in every lane, rebuilding the dropped component from the unit
+//  length. The slot holding it decodes to zero, so it adds nothing to the length, and the
+//  rebuilt value is then added into it.
+void DecodeRotations(const float (*components)[SIMD_WIDTH], SimdFloat& outX, SimdFloat& outY, SimdFloat& outZ, SimdFloat& outW)
+{
+	SimdFloat isDroppedX, isDroppedY, isDroppedZ, isDroppedW;
+	SimdFloat x = DecodeRotationComponent(components[0u], isDroppedX);
+	SimdFloat y = DecodeRotationComponent(components[1u], isDroppedY);
+	SimdFloat z = DecodeRotationComponent(components[2u], isDroppedZ);
+	SimdFloat w = DecodeRotationComponent(components[3u], isDroppedW);
+
+	SimdFloat lengthSq = SimdMulAdd(x, x, SimdMulAdd(y, y, SimdMulAdd(z, z, SimdMul(w, w))));
+	SimdFloat largest = SimdSqrt(SimdMax(SimdSet(0.f), SimdSub(SimdSet(1.f), lengthSq)));
+
+	outX = SimdMulAdd(largest, isDroppedX, x);
+	outY = SimdMulAdd(largest, isDroppedY, y);
+	outZ = SimdMulAdd(largest, isDroppedZ, z);
+	outW = SimdMulAdd(largest, isDroppedW, w);
+}
+
+// Decodes every lane of one batch at once. Rotation keys are put on the shorter arc,
+//  since quantizing can flip their sign.
+void DecodeBatch(const QuantizedLaneKeys& quantized, LaneKeys& outKeys)
+{
+	SimdFloat fromX, fromY, fromZ, fromW;
+	SimdFloat toX, toY, toZ, toW;
+	DecodeRotations(quantized.From, fromX, fromY, fromZ, fromW);
+	DecodeRotations(quantized.To, toX, toY, toZ, toW);
+
+	SimdFloat dot = SimdMulAdd(fromX, toX, SimdMulAdd(fromY, toY, SimdMulAdd(fromZ, toZ, SimdMul(fromW, toW))));
+	SimdStore(outKeys.From[(std::uint32_t)POSE_STREAM::ROT_X], fromX);
+	SimdStore(outKeys.From[(std::uint32_t)POSE_STREAM::ROT_Y], fromY);
+	SimdStore(outKeys.From[(std::uint32_t)POSE_STREAM::ROT_Z], fromZ);
+	SimdStore(outKeys.From[(std::uint32_t)POSE_STREAM::ROT_W], fromW);
+	SimdStore(outKeys.To[(std::uint32_t)POSE_STREAM::ROT_X], SimdMulSign(toX, dot));
+	SimdStore(outKeys.To[(std::uint32_t)POSE_STREAM::ROT_Y], SimdMulSign(toY, dot));
+	SimdStore(outKeys.To[(std::uint32_t)POSE_STREAM::ROT_Z], SimdMulSign(toZ, dot));
+	SimdStore(outKeys.To[(std::uint32_t)POSE_STREAM::ROT_W], SimdMulSign(toW, dot));
+}
+
+SimdFloat LerpComponent(const LaneKeys& keys, POSE_STREAM component, SimdFloat t)
+{
+	return SimdLerp(SimdLoad(keys.From[(std::uint32_t)component]), SimdLoad(keys.To[(std::uint32_t)component]), t);
+}
+
+// One stream of one batch, lerped between two frames of a resampled clip
+SimdFloat LerpFrames(const float* from, const float* to, POSE_STREAM stream, std::uint32_t paddedBones, std::uint32_t batch, SimdFloat t)
+{
+	std::uint32_t offset = (std::uint32_t)stream * paddedBones + batch;
+	return SimdLerp(SimdLoad(from + offset), SimdLoad(to + offset), t);
+}
+
+// Interpolates all lanes of one batch at once, into the pose
+void InterpolateBatch(const LaneKeys& keys, std::uint32_t batch, Pose& outLocalPose)
+{
+	SimdFloat tPos = SimdLoad(keys.PositionRatio);
+	SimdFloat tRot = SimdLoad(keys.RotationRatio);
+	SimdFloat tScl = SimdLoad(keys.ScaleRatio);
+
+	SimdStore(outLocalPose.GetStream(POSE_STREAM::POS_X) + batch, LerpComponent(keys, POSE_STREAM::POS_X, tPos));
+	SimdStore(outLocalPose.GetStream(POSE_STREAM::POS_Y) + batch, LerpComponent(keys, POSE_STREAM::POS_Y, tPos));
+	SimdStore(outLocalPose.GetStream(POSE_STREAM::POS_Z) + batch, LerpComponent(keys, POSE_STREAM::POS_Z, tPos));
+
+	// nlerp - like RotationKeyframe::LERP, this does not correct for the keys lying in
+	//  opposite hemispheres, so the two paths stay interchangeable. Compressed keys are
+	//  put on the shorter arc as they are decoded, since quantizing can flip their sign.
+	SimdFloat qx = LerpComponent(keys, POSE_STREAM::ROT_X, tRot);
+	SimdFloat qy = LerpComponent(keys, POSE_STREAM::ROT_Y, tRot);
+	SimdFloat qz = LerpComponent(keys, POSE_STREAM::ROT_Z, tRot);
+	SimdFloat qw = LerpComponent(keys, POSE_STREAM::ROT_W, tRot);
+	SimdFloat lengthSq = SimdMulAdd(qx, qx, SimdMulAdd(qy, qy, SimdMulAdd(qz, qz, SimdMul(qw, qw))));
+	SimdFloat invLength = SimdRsqrt(lengthSq);
+
+	SimdStore(outLocalPose.GetStream(POSE_STREAM::ROT_X) + batch, SimdMul(qx, invLength));
+	SimdStore(outLocalPose.GetStream(POSE_STREAM::ROT_Y) + batch, SimdMul(qy, invLength));
+	SimdStore(outLocalPose.GetStream(POSE_STREAM::ROT_Z) + batch, SimdMul(qz, invLength));
+	SimdStore(outLocalPose.GetStream(POSE_STREAM::ROT_W) + batch, SimdMul(qw, invLength));
+
+	SimdStore(outLocalPose.GetStream(POSE_STREAM::SCALE_X) + batch, LerpComponent(keys, POSE_STREAM::SCALE_X, tScl));
+	SimdStore(outLocalPose.GetStream(POSE_STREAM::SCALE_Y) + batch, LerpComponent(keys, POSE_STREAM::SCALE_Y, tScl));
+	SimdStore(outLocalPose.GetStream(POSE_STREAM::SCALE_Z) + batch, LerpComponent(keys, POSE_STREAM::SCALE_Z, tScl));
+}
+
+}
+
+void SampleClip(const AnimationClip& clip, float time, Pose& outLocalPose)
+{
+	SampleClip(clip, time, nullptr, outLocalPose);
+}
+
+void SampleClip(const AnimationClip& clip, float time, BoneAnimation::Cursor* cursors, Pose& outLocalPose)
+{
+	assert(outLocalPose.GetBoneCount() == clip.GetBoneCount());
+
+	const float* positions[4] = { clip.GetPositionStream(0u), clip.GetPositionStream(1u), clip.GetPositionStream(2u), clip.GetPositionStream(3u) };
+	const float* rotations[5] = { clip.GetRotationStream(0u), clip.GetRotationStream(1u), clip.GetRotationStream(2u), clip.GetRotationStream(3u), clip.GetRotationStream(4u) };
+	const float* scales[4] = { clip.GetScaleStream(0u), clip.GetScaleStream(1u), clip.GetScaleStream(2u), clip.GetScaleStream(3u) };
+
+	std::uint32_t numBones = clip.GetBoneCount();
+	LaneKeys keys;
+
+	for (std::uint32_t batch = 0u; batch < outLocalPose.GetPaddedBoneCount(); batch += SIMD_WIDTH)
+	{
+		// Gather - one bone per lane. Lanes past the end of the skeleton sample identity.
+		for (std::uint32_t lane = 0u; lane < SIMD_WIDTH; lane++)
+		{
+			std::uint32_t boneIdx = batch + lane;
+			if (boneIdx >= numBones)
+			{
+				GatherIdentity(keys, lane);
+				continue;
+			}
+
+			BoneAnimation::Cursor noCursor;
+			BoneAnimation::Cursor& cursor = (cursors != nullptr) ? cursors[boneIdx] : noCursor;
+
+			GatherTrack(clip.GetPositionTrack(boneIdx), positions, (std::uint32_t)POSE_STREAM::POS_X, 3u, time, cursor.PositionIdx, keys, keys.PositionRatio, lane);
+			GatherTrack(clip.GetRotationTrack(boneIdx), rotations, (std::uint32_t)POSE_STREAM::ROT_X, 4u, time, cursor.RotationIdx, keys, keys.RotationRatio, lane);
+			GatherTrack(clip.GetScaleTrack(boneIdx), scales, (std::uint32_t)POSE_STREAM::SCALE_X, 3u, time, cursor.ScaleIdx, keys, keys.ScaleRatio, lane);
+		}
+
+		InterpolateBatch(keys, batch, outLocalPose);
+	}
+}
+
+void SampleClip(const CompressedClip& clip, float time, Pose& outLocalPose)
+{
+	SampleClip(clip, time, nullptr, outLocalPose);
+}
+
+void SampleClip(const CompressedClip& clip, float time, BoneAnimation::Cursor* cursors, Pose& outLocalPose)
+{
+	SampleClip(clip, time, cursors, nullptr, nullptr, outLocalPose);
+}
+
+void SampleClip(const CompressedClip& clip, float time, BoneAnimation::Cursor* cursors, const Skeleton* skeleton, const std::uint8_t* boneMask, Pose& outLocalPose)
+{
+	assert(outLocalPose.GetBoneCount() == clip.GetBoneCount());
+	assert(boneMask == nullptr || (skeleton != nullptr && skeleton->GetBoneCount() == clip.GetBoneCount()));
+
+	const std::uint16_t* positionTimes = clip.GetPositionTimes();
+	const std::uint16_t* rotationTimes = clip.GetRotationTimes();
+	const std::uint16_t* scaleTimes = clip.GetScaleTimes();
+	const CompressedClip::Key* positions = clip.GetPositionKeys();
+	const CompressedClip::Key* rotations = clip.GetRotationKeys();
+	const CompressedClip::Key* scales = clip.GetScaleKeys();
+
+	std::uint32_t numBones = clip.GetBoneCount();
+	float keyTime = std::max(time, 0.f) * clip.GetTimeScale();
+	LaneKeys keys;
+
+	// Lanes that are not sampled keep whatever an earlier batch left in them, which is
+	//  decoded along with the rest and then overwritten - so it only needs to be finite
+	QuantizedLaneKeys quantized = {};
+
+	for (std::uint32_t batch = 0u; batch < outLocalPose.GetPaddedBoneCount(); batch += SIMD_WIDTH)
+	{
+		// Gather - one bone per lane, as stored
+		bool isBatchSampled = true;
+		for (std::uint32_t lane = 0u; lane < SIMD_WIDTH; lane++)
+		{
+			std::uint32_t boneIdx = batch + lane;
+			if (boneIdx >= numBones || (boneMask != nullptr && !boneMask[boneIdx]))
+			{
+				isBatchSampled = false;
+				continue;
+			}
+
+			BoneAnimation::Cursor noCursor;
+			BoneAnimation::Cursor& cursor = (cursors != nullptr) ? cursors[boneIdx] : noCursor;
+
+			GatherCompressedTrack(clip.GetPositionTrack(boneIdx), positionTimes, positions, (std::uint32_t)POSE_STREAM::POS_X, keyTime, cursor.PositionIdx, keys, keys.PositionRatio, lane);
+			GatherCompressedRotationTrack(clip.GetRotationTrack(boneIdx), rotationTimes, rotations, keyTime, cursor.RotationIdx, quantized, keys.RotationRatio, lane);
+			GatherCompressedTrack(clip.GetScaleTrack(boneIdx), scaleTimes, scales, (std::uint32_t)POSE_STREAM::SCALE_X, keyTime, cursor.ScaleIdx, keys, keys.ScaleRatio, lane);
+		}
+
+		DecodeBatch(quantized, keys);
+
+		// Lanes past the end of the skeleton sample identity, and masked bones their bind
+		//  transform, without any key search or decoding
+		for (std::uint32_t lane = 0u; lane < SIMD_WIDTH && !isBatchSampled; lane++)
+		{
+			std::uint32_t boneIdx = batch + lane;
+			if (boneIdx >= numBones)
+			{
+				GatherIdentity(keys, lane);
+			}
+			else if (boneMask != nullptr && !boneMask[boneIdx])
+			{
+				GatherTransform(skeleton->GetBone(boneIdx).FromParentTransform, keys, lane);
+			}
+		}
+
+		InterpolateBatch(keys, batch, outLocalPose);
+	}
+}
+
+void SampleClip(const ResampledClip& clip, float time, Pose& outLocalPose)
+{
+	assert(outLocalPose.GetBoneCount() == clip.GetBoneCount());
+
+	// Frames are evenly spaced, so the pair either side of the time is found directly
+	float frameTime = std::min(std::max(time, 0.f), clip.GetDuration()) * clip.GetSampleRate();
+	std::uint32_t frameIdx = std::min((std::uint32_t)frameTime, clip.GetFrameCount() - 2u);
+	SimdFloat t = SimdSet(std::min(frameTime - frameIdx, 1.f));
+
+	const float* from = clip.GetFrame(frameIdx);
+	const float* to = clip.GetFrame(frameIdx + 1u);
+	std::uint32_t paddedBones = clip.GetPaddedBoneCount();
+
+	for (std::uint32_t batch = 0u; batch < paddedBones; batch += SIMD_WIDTH)
+	{
+		SimdStore(outLocalPose.GetStream(POSE_STREAM::POS_X) + batch, LerpFrames(from, to, POSE_STREAM::POS_X, paddedBones, batch, t));
+		SimdStore(outLocalPose.GetStream(POSE_STREAM::POS_Y) + batch, LerpFrames(from, to, POSE_STREAM::POS_Y, paddedBones, batch, t));
+		SimdStore(outLocalPose.GetStream(POSE_STREAM::POS_Z) + batch, LerpFrames(from, to, POSE_STREAM::POS_Z, paddedBones, batch, t));
+
+		// Frames are kept in matching hemispheres when the clip is resampled
+		SimdFloat qx = LerpFrames(from, to, POSE_STREAM::ROT_X, paddedBones, batch, t);
+		SimdFloat qy = LerpFrames(from, to, POSE_STREAM::ROT_Y, paddedBones, batch, t);
+		SimdFloat qz = LerpFrames(from, to, POSE_STREAM::ROT_Z, paddedBones, batch, t);
+		SimdFloat qw = LerpFrames(from, to, POSE_STREAM::ROT_W, paddedBones, batch, t);
+		SimdFloat invLength = SimdRsqrt(SimdMulAdd(qx, qx, SimdMulAdd(qy, qy, SimdMulAdd(qz, qz, SimdMul(qw, qw)))));
+
+		SimdStore(outLocalPose.GetStream(POSE_STREAM::ROT_X) + batch, SimdMul(qx, invLength));
+		SimdStore(outLocalPose.GetStream(POSE_STREAM::ROT_Y) + batch, SimdMul(qy, invLength));
+		SimdStore(outLocalPose.GetStream(POSE_STREAM::ROT_Z) + batch, SimdMul(qz, invLength));
+		SimdStore(outLocalPose.GetStream(POSE_STREAM::ROT_W) + batch, SimdMul(qw, invLength));
+
+		SimdStore(outLocalPose.GetStream(POSE_STREAM::SCALE_X) + batch, LerpFrames(from, to, POSE_STREAM::SCALE_X, paddedBones, batch, t));
+		SimdStore(outLocalPose.GetStream(POSE_STREAM::SCALE_Y) + batch, LerpFrames(from, to, POSE_STREAM::SCALE_Y, paddedBones, batch, t));
+		SimdStore(outLocalPose.GetStream(POSE_STREAM::SCALE_Z) + batch, LerpFrames(from, to, POSE_STREAM::SCALE_Z, paddedBones, batch, t));
+	}
+}
\ No newline at end of file
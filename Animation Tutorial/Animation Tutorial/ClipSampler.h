@@ -0,0 +1,31 @@
+#pragma once
+
+#include "AnimationClip.h"
+#include "CompressedClip.h"
+#include "ResampledClip.h"
+#include "Pose.h"
+
+// Samples every bone of a clip into a structure-of-arrays local pose, SIMD_WIDTH bones
+//  at a time (see Simd.h). Key searches stay scalar, since every track has its own key
+//  times, but interpolation runs across lanes. Rotations are nlerped and normalized with
+//  a single reciprocal square root, rather than the sqrt and four divides per key done by
+//  the Quaternion constructor. Results match AnimationClip::Sample to within float epsilon.
+// outLocalPose must be sized for the clip's bone count. Cursors are optional, and if
+//  given must hold one element per bone.
+void SampleClip(const AnimationClip& clip, float time, Pose& outLocalPose);
+void SampleClip(const AnimationClip& clip, float time, BoneAnimation::Cursor* cursors, Pose& outLocalPose);
+
+// Same as above for a compressed clip. Rotation keys are gathered quantized and decoded a
+//  batch at a time, constant tracks are read straight from the track, and the
+//  interpolation is shared with uncompressed clips.
+void SampleClip(const CompressedClip& clip, float time, Pose& outLocalPose);
+void SampleClip(const CompressedClip& clip, float time, BoneAnimation::Cursor* cursors, Pose& outLocalPose);
+
+// Same as above, sampling only the bones with a non-zero element in boneMask (one element
+//  per bone, or nullptr for every bone). The others hold their bind transform from the
+//  skeleton, without any key search or decoding - used to drop detail bones at a distance.
+void SampleClip(const CompressedClip& clip, float time, BoneAnimation::Cursor* cursors, const Skeleton* skeleton, const std::uint8_t* boneMask, Pose& outLocalPose);
+
+// Same as above for a uniformly resampled clip - one lerp between the two frames either
+//  side of the time, with no key searches. Cursors are not needed.
+void SampleClip(const ResampledClip& clip, float time, Pose& outLocalPose);
\ No newline at end of file
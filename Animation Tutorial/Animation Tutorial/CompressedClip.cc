@@ -0,0 +1,205 @@
+#include "CompressedClip.h"
+#include "AlignedMemory.h"
+#include "Logger.h"
+#include <fstream>
+#include <cstring>
+#include <cmath>
+
+const std::uint32_t CompressedClip::MAGIC = 0x504C4343u; // "CCLP"
+const std::uint32_t CompressedClip::VERSION = 2u;
+const float CompressedClip::ROTATION_RANGE = 0.70710678f;
+const float CompressedClip::ROTATION_CENTER = 0.5f * CompressedClip::MAX_QUANTIZED_ROTATION;
+const float CompressedClip::ROTATION_STEP = 2.f * CompressedClip::ROTATION_RANGE / CompressedClip::MAX_QUANTIZED_ROTATION;
+
+namespace
+{
+
+bool IsInBlob(std::uint64_t offset, std::uint64_t size, std::uint64_t blobSize)
+{
+	return offset + size <= blobSize;
+}
+
+std::uint16_t Quantize(float value, float min, float step, std::uint16_t maxValue)
+{
+	if (step <= 0.f)
+	{
+		return 0u;
+	}
+
+	float q = floorf((value - min) / step + 0.5f);
+	return (std::uint16_t)((q < 0.f) ? 0.f : ((q > maxValue) ? maxValue : q));
+}
+
+}
+
+CompressedClip::CompressedClip(char* blob)
+	: blob_(blob)
+	, header_(reinterpret_cast<const Header*>(blob))
+{}
+
+CompressedClip::~CompressedClip()
+{
+	_aligned_free(blob_);
+}
+
+std::shared_ptr<CompressedClip> CompressedClip::FromMemory(const char* data, std::uint32_t size)
+{
+	if (size < sizeof(Header))
+	{
+		Logger::Log("Compressed animation clip is too small to be valid");
+		return nullptr;
+	}
+
+	char* blob = (char*)_aligned_malloc(size, ALIGNMENT);
+	if (blob == nullptr)
+	{
+		Logger::Log("Failed to allocate memory for compressed animation clip");
+		return nullptr;
+	}
+	memcpy(blob, data, size);
+
+	std::shared_ptr<CompressedClip> clip(new CompressedClip(blob));
+	if (!clip->Validate(size))
+	{
+		Logger::Log("Compressed animation clip is corrupt, or was written by a different version");
+		return nullptr;
+	}
+
+	return clip;
+}
+
+std::shared_ptr<CompressedClip> CompressedClip::Load(const char* filename)
+{
+	std::ifstream fin(filename, std::ios::binary);
+	if (!fin)
+	{
+		Logger::Log("Failed to open compressed animation clip file for reading");
+		return nullptr;
+	}
+
+	fin.seekg(0, std::ios::end);
+	std::uint32_t fileSize = (std::uint32_t)fin.tellg();
+	fin.seekg(0, std::ios::beg);
+
+	if (fileSize < sizeof(Header))
+	{
+		Logger::Log("Compressed animation clip file is too small to be valid");
+		return nullptr;
+	}
+
+	char* blob = (char*)_aligned_malloc(fileSize, ALIGNMENT);
+	if (blob == nullptr)
+	{
+		Logger::Log("Failed to allocate memory for compressed animation clip");
+		return nullptr;
+	}
+
+	// Hold the blob immediately, so it is freed on any failure below
+	std::shared_ptr<CompressedClip> clip(new CompressedClip(blob));
+	fin.read(blob, fileSize);
+
+	if (!fin || !clip->Validate(fileSize))
+	{
+		Logger::Log("Compressed animation clip file is corrupt, or was written by a different version");
+		return nullptr;
+	}
+
+	return clip;
+}
+
+bool CompressedClip::Save(const char* filename) const
+{
+	std::ofstream fout(filename, std::ios::binary);
+	if (!fout)
+	{
+		Logger::Log("Failed to open compressed animation clip file for writing");
+		return false;
+	}
+
+	fout.write(blob_, header_->SizeInBytes);
+	return (bool)fout;
+}
+
+std::uint16_t CompressedClip::QuantizeTime(float time, float timeScale)
+{
+	return Quantize(time * timeScale, 0.f, 1.f, MAX_KEY_TIME);
+}
+
+CompressedClip::Key CompressedClip::QuantizeVector(const float* values, const float* min, const float* step)
+{
+	Key key;
+	for (std::uint32_t c = 0u; c < 3u; c++)
+	{
+		key.Values[c] = Quantize(values[c], min[c], step[c], MAX_QUANTIZED);
+	}
+	return key;
+}
+
+CompressedClip::Key CompressedClip::QuantizeRotation(const Quaternion& rotation)
+{
+	float q[4] = { rotation.x, rotation.y, rotation.z, rotation.w };
+
+	std::uint32_t largest = 0u;
+	for (std::uint32_t c = 1u; c < 4u; c++)
+	{
+		if (fabsf(q[c]) > fabsf(q[largest]))
+		{
+			largest = c;
+		}
+	}
+
+	// q and -q are the same rotation - keep the dropped component positive
+	float sign = (q[largest] < 0.f) ? -1.f : 1.f;
+
+	Key key;
+	std::uint32_t k = 0u;
+	for (std::uint32_t c = 0u; c < 4u; c++)
+	{
+		if (c != largest)
+		{
+			key.Values[k++] = Quantize(q[c] * sign, -ROTATION_RANGE, ROTATION_STEP, MAX_QUANTIZED_ROTATION);
+		}
+	}
+
+	key.Values[0u] |= (std::uint16_t)((largest >> 1u) << 15u);
+	key.Values[1u] |= (std::uint16_t)((largest & 1u) << 15u);
+	return key;
+}
+
+bool CompressedClip::Validate(std::uint32_t size) const
+{
+	if (size < sizeof(Header) || header_->Magic != MAGIC || header_->Version != VERSION || header_->SizeInBytes != size)
+	{
+		return false;
+	}
+
+	std::uint64_t tableSize = (std::uint64_t)header_->NumBones * sizeof(Track);
+	if (!IsInBlob(header_->PositionTracksOffset, tableSize, size)
+		|| !IsInBlob(header_->RotationTracksOffset, tableSize, size)
+		|| !IsInBlob(header_->ScaleTracksOffset, tableSize, size)
+		|| !IsInBlob(header_->PositionTimesOffset, (std::uint64_t)header_->NumPositionKeys * sizeof(std::uint16_t), size)
+		|| !IsInBlob(header_->RotationTimesOffset, (std::uint64_t)header_->NumRotationKeys * sizeof(std::uint16_t), size)
+		|| !IsInBlob(header_->ScaleTimesOffset, (std::uint64_t)header_->NumScaleKeys * sizeof(std::uint16_t), size)
+		|| !IsInBlob(header_->PositionKeysOffset, (std::uint64_t)header_->NumPositionKeys * sizeof(Key), size)
+		|| !IsInBlob(header_->RotationKeysOffset, (std::uint64_t)header_->NumRotationKeys * sizeof(Key), size)
+		|| !IsInBlob(header_->ScaleKeysOffset, (std::uint64_t)header_->NumScaleKeys * sizeof(Key), size))
+	{
+		return false;
+	}
+
+	// Every track needs at least one key, and must lie within its streams
+	for (std::uint32_t boneIdx = 0u; boneIdx < header_->NumBones; boneIdx++)
+	{
+		const Track& position = GetPositionTrack(boneIdx);
+		const Track& rotation = GetRotationTrack(boneIdx);
+		const Track& scale = GetScaleTrack(boneIdx);
+		if (position.NumKeys == 0u || (std::uint64_t)position.FirstKey + position.NumKeys > header_->NumPositionKeys
+			|| rotation.NumKeys == 0u || (std::uint64_t)rotation.FirstKey + rotation.NumKeys > header_->NumRotationKeys
+			|| scale.NumKeys == 0u || (std::uint64_t)scale.FirstKey + scale.NumKeys > header_->NumScaleKeys)
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
\ No newline at end of file
@@ -0,0 +1,197 @@
+#pragma once
+
+#include "AnimationClip.h"
+#include <algorithm>
+#include <cmath>
+#include <memory>
+
+// Runtime form of an AnimationClip, built offline by CompressClip (see ClipCompressor.h).
+//  Same layout ideas as AnimationClip - one contiguous blob of offsets and streams, with a
+//  table giving the range of keys belonging to each bone - but every key is 8 bytes
+//  instead of 16 to 20:
+//  - Key times are 16 bit, spread evenly over the duration of the clip
+//  - Rotations are 48 bit "smallest three" quaternions: the largest component is dropped
+//    (and rebuilt from the unit length), the other three are 15 bits each
+//  - Positions and scales are 16 bits per component, spread over the range of their track
+//  - Keys that linear interpolation between their neighbours reproduces are removed
+class CompressedClip
+{
+public:
+	struct Track
+	{
+		std::uint32_t FirstKey;
+		std::uint32_t NumKeys;
+
+		// Position and scale only - component = Min + quantized value * Step
+		float Min[3];
+		float Step[3];
+	};
+
+	struct Key
+	{
+		std::uint16_t Values[3];
+	};
+
+	struct Header
+	{
+		std::uint32_t Magic;
+		std::uint32_t Version;
+		std::uint32_t SizeInBytes;
+		std::uint32_t NumBones;
+		float Duration;
+
+		// Converts seconds into the units of the key time streams
+		float TimeScale;
+
+		std::uint32_t NumPositionKeys;
+		std::uint32_t NumRotationKeys;
+		std::uint32_t NumScaleKeys;
+
+		// Byte offsets from the start of the blob
+		std::uint32_t PositionTracksOffset;
+		std::uint32_t RotationTracksOffset;
+		std::uint32_t ScaleTracksOffset;
+		std::uint32_t PositionTimesOffset;
+		std::uint32_t RotationTimesOffset;
+		std::uint32_t ScaleTimesOffset;
+		std::uint32_t PositionKeysOffset;
+		std::uint32_t RotationKeysOffset;
+		std::uint32_t ScaleKeysOffset;
+	};
+
+	static const std::uint32_t MAGIC;
+	static const std::uint32_t VERSION;
+
+	// Every section starts on a 16 byte boundary
+	static const std::uint32_t ALIGNMENT = 16u;
+
+	static const std::uint16_t MAX_KEY_TIME = 0xFFFFu;
+	static const std::uint16_t MAX_QUANTIZED = 0xFFFFu;
+
+	// Rotation components use 15 bits - the top bit of the first two holds the index
+	//  of the dropped component
+	static const std::uint16_t MAX_QUANTIZED_ROTATION = 0x7FFFu;
+
+	// Components other than the largest lie within +-1/sqrt(2), and decode as
+	//  (quantized value - ROTATION_CENTER) * ROTATION_STEP
+	static const float ROTATION_RANGE;
+	static const float ROTATION_CENTER;
+	static const float ROTATION_STEP;
+
+public:
+	CompressedClip() = delete;
+	CompressedClip(const CompressedClip&) = delete;
+	~CompressedClip();
+
+	// Copies and validates a complete compressed clip blob
+	static std::shared_ptr<CompressedClip> FromMemory(const char* data, std::uint32_t size);
+	static std::shared_ptr<CompressedClip> Load(const char* filename);
+	bool Save(const char* filename) const;
+
+	std::uint32_t GetBoneCount() const { return header_->NumBones; }
+	float GetDuration() const { return header_->Duration; }
+	float GetTimeScale() const { return header_->TimeScale; }
+	std::uint32_t GetSizeInBytes() const { return header_->SizeInBytes; }
+
+	const Track& GetPositionTrack(std::uint32_t boneIdx) const { return GetTracks(header_->PositionTracksOffset)[boneIdx]; }
+	const Track& GetRotationTrack(std::uint32_t boneIdx) const { return GetTracks(header_->RotationTracksOffset)[boneIdx]; }
+	const Track& GetScaleTrack(std::uint32_t boneIdx) const { return GetTracks(header_->ScaleTracksOffset)[boneIdx]; }
+
+	// Indexed by key, like the streams of AnimationClip
+	const std::uint16_t* GetPositionTimes() const { return GetTimes(header_->PositionTimesOffset); }
+	const std::uint16_t* GetRotationTimes() const { return GetTimes(header_->RotationTimesOffset); }
+	const std::uint16_t* GetScaleTimes() const { return GetTimes(header_->ScaleTimesOffset); }
+	const Key* GetPositionKeys() const { return GetKeys(header_->PositionKeysOffset); }
+	const Key* GetRotationKeys() const { return GetKeys(header_->RotationKeysOffset); }
+	const Key* GetScaleKeys() const { return GetKeys(header_->ScaleKeysOffset); }
+
+	// Key encoding, shared by the compressor and the sampler. Decoding is inline, as it
+	//  runs for every key the sampler gathers.
+	static std::uint16_t QuantizeTime(float time, float timeScale);
+	static Key QuantizeVector(const float* values, const float* min, const float* step);
+	static void DequantizeVector(const Key& key, const Track& track, float* outValues);
+	static Key QuantizeRotation(const Quaternion& rotation);
+	static void DequantizeRotation(const Key& key, float* outXYZW);
+	static std::uint32_t GetDroppedComponent(const Key& key) { return ((key.Values[0u] >> 15u) << 1u) | (key.Values[1u] >> 15u); }
+
+	// Same as AnimationClip::FindKeys, for a track of 16 bit key times. keyTime is in the
+	//  units of the key times, and must not be negative. Key times are whole numbers, so
+	//  the search compares them with the whole part of keyTime, as integers.
+	static bool FindKeys(const std::uint16_t* times, std::uint32_t numKeys, float keyTime, std::uint32_t& keyIdx, float& ratio);
+
+private:
+	CompressedClip(char* blob);
+
+	bool Validate(std::uint32_t size) const;
+	const Track* GetTracks(std::uint32_t offset) const { return reinterpret_cast<const Track*>(blob_ + offset); }
+	const std::uint16_t* GetTimes(std::uint32_t offset) const { return reinterpret_cast<const std::uint16_t*>(blob_ + offset); }
+	const Key* GetKeys(std::uint32_t offset) const { return reinterpret_cast<const Key*>(blob_ + offset); }
+
+private:
+	char* blob_;
+	const Header* header_;
+};
+
+inline bool CompressedClip::FindKeys(const std::uint16_t* times, std::uint32_t numKeys, float keyTime, std::uint32_t& keyIdx, float& ratio)
+{
+	std::uint32_t wholeTime = (std::uint32_t)keyTime;
+	if (numKeys == 1u || wholeTime < times[0u])
+	{
+		keyIdx = 0u;
+		return false;
+	}
+	else if (wholeTime >= times[numKeys - 1u])
+	{
+		keyIdx = numKeys - 1u;
+		return false;
+	}
+
+	bool found = false;
+	if (keyIdx < numKeys - 1u && times[keyIdx] <= wholeTime)
+	{
+		for (std::uint32_t step = 0u; step < BoneAnimation::Cursor::MAX_STEPS && !found; step++)
+		{
+			if (times[keyIdx + 1u] > wholeTime)
+			{
+				found = true;
+			}
+			else
+			{
+				keyIdx++;
+			}
+		}
+	}
+
+	if (!found)
+	{
+		keyIdx = (std::uint32_t)(std::upper_bound(times, times + numKeys, (std::uint16_t)wholeTime) - times) - 1u;
+	}
+
+	ratio = (keyTime - times[keyIdx]) / (float)(times[keyIdx + 1u] - times[keyIdx]);
+	return true;
+}
+
+inline void CompressedClip::DequantizeVector(const Key& key, const Track& track, float* outValues)
+{
+	outValues[0u] = track.Min[0u] + key.Values[0u] * track.Step[0u];
+	outValues[1u] = track.Min[1u] + key.Values[1u] * track.Step[1u];
+	outValues[2u] = track.Min[2u] + key.Values[2u] * track.Step[2u];
+}
+
+inline void CompressedClip::DequantizeRotation(const Key& key, float* outXYZW)
+{
+	// Where the three stored components go, for each index of the dropped one. Looked up
+	//  rather than switched on, since the dropped component changes from key to key, and
+	//  a branch on it would be unpredictable.
+	static const std::uint8_t STORED_COMPONENTS[4][3] = { { 1u, 2u, 3u }, { 0u, 2u, 3u }, { 0u, 1u, 3u }, { 0u, 1u, 2u } };
+
+	std::uint32_t largest = GetDroppedComponent(key);
+	float a = ((key.Values[0u] & MAX_QUANTIZED_ROTATION) - ROTATION_CENTER) * ROTATION_STEP;
+	float b = ((key.Values[1u] & MAX_QUANTIZED_ROTATION) - ROTATION_CENTER) * ROTATION_STEP;
+	float c = ((key.Values[2u] & MAX_QUANTIZED_ROTATION) - ROTATION_CENTER) * ROTATION_STEP;
+
+	outXYZW[STORED_COMPONENTS[largest][0u]] = a;
+	outXYZW[STORED_COMPONENTS[largest][1u]] = b;
+	outXYZW[STORED_COMPONENTS[largest][2u]] = c;
+	outXYZW[largest] = sqrtf(std::max(0.f, 1.f - a * a - b * b - c * c));
+}
\ No newline at end of file
@@ -0,0 +1,87 @@
+#include "ConstantRingAllocator.h"
+#include <assert.h>
+
+ConstantRingAllocator::ConstantRingAllocator(std::uint32_t capacity, std::uint32_t maxFramesInFlight)
+	: capacity_(capacity & ~(ALIGNMENT - 1u))
+	, head_(0u)
+	, tail_(0u)
+	, usedBytes_(0u)
+	, frameSizes_(maxFramesInFlight, 0u)
+	, oldestFrame_(0u)
+	, numFramesInFlight_(0u)
+	, isInFrame_(false)
+{
+	assert(maxFramesInFlight > 0u);
+}
+
+void ConstantRingAllocator::BeginFrame()
+{
+	assert(!isInFrame_ && numFramesInFlight_ < frameSizes_.size());
+
+	frameSizes_[(oldestFrame_ + numFramesInFlight_) % frameSizes_.size()] = 0u;
+	numFramesInFlight_++;
+	isInFrame_ = true;
+}
+
+void ConstantRingAllocator::EndFrame()
+{
+	assert(isInFrame_);
+	isInFrame_ = false;
+}
+
+void ConstantRingAllocator::RetireFrame()
+{
+	assert(numFramesInFlight_ > 0u && !(isInFrame_ && numFramesInFlight_ == 1u));
+
+	std::uint32_t frameSize = frameSizes_[oldestFrame_];
+	tail_ = (tail_ + frameSize) % capacity_;
+	usedBytes_ -= frameSize;
+	oldestFrame_ = (oldestFrame_ + 1u) % frameSizes_.size();
+	numFramesInFlight_--;
+}
+
+bool ConstantRingAllocator::Allocate(std::uint32_t size, std::uint32_t& outOffset)
+{
+	assert(isInFrame_);
+
+	std::uint32_t alignedSize = AlignSize(size);
+	if (alignedSize == 0u || alignedSize > capacity_ - usedBytes_)
+	{
+		return false;
+	}
+
+	// Nothing in flight - start again from the beginning, so the whole buffer is one run
+	if (usedBytes_ == 0u)
+	{
+		head_ = 0u;
+		tail_ = 0u;
+	}
+
+	// Free space is one run up to the tail, or two when the used space has not wrapped:
+	//  from the head to the end of the buffer, then from the start up to the tail
+	std::uint32_t skippedBytes = 0u;
+	if (head_ >= tail_)
+	{
+		if (capacity_ - head_ < alignedSize)
+		{
+			if (tail_ < alignedSize)
+			{
+				return false;
+			}
+
+			// Slices are contiguous, so the end of the buffer is skipped, and belongs to this frame
+			skippedBytes = capacity_ - head_;
+			head_ = 0u;
+		}
+	}
+	else if (tail_ - head_ < alignedSize)
+	{
+		return false;
+	}
+
+	outOffset = head_;
+	head_ = (head_ + alignedSize) % capacity_;
+	usedBytes_ += skippedBytes + alignedSize;
+	frameSizes_[(oldestFrame_ + numFramesInFlight_ - 1u) % frameSizes_.size()] += skippedBytes + alignedSize;
+	return true;
+}
\ No newline at end of file
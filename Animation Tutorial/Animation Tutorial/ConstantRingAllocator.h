@@ -0,0 +1,54 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+// Hands out slices of one large constant buffer to the frames being drawn. Each frame
+//  allocates after the last, wrapping around to the start of the buffer, and its slices
+//  are only reused once the frame is retired - when the GPU has finished drawing it.
+//  Only offsets are managed here, so the owner decides where the bytes live and how to
+//  tell when the GPU is done.
+// Slices are aligned to 256 bytes, the granularity at which D3D11.1 binds a constant
+//  buffer from an offset.
+class ConstantRingAllocator
+{
+public:
+	static const std::uint32_t ALIGNMENT = 256u;
+
+public:
+	ConstantRingAllocator() = delete;
+	ConstantRingAllocator(std::uint32_t capacity, std::uint32_t maxFramesInFlight);
+	ConstantRingAllocator(const ConstantRingAllocator&) = delete;
+	~ConstantRingAllocator() = default;
+
+	// Frames must be retired before more than maxFramesInFlight are begun
+	void BeginFrame();
+	void EndFrame();
+	void RetireFrame();
+
+	// Fails when the slice does not fit in the space not used by frames in flight
+	bool Allocate(std::uint32_t size, std::uint32_t& outOffset);
+
+	std::uint32_t GetCapacity() const { return capacity_; }
+	std::uint32_t GetFramesInFlight() const { return numFramesInFlight_; }
+	std::uint32_t GetMaxFramesInFlight() const { return (std::uint32_t)frameSizes_.size(); }
+
+	// Bytes held by frames in flight, including space skipped when wrapping around
+	std::uint32_t GetUsedBytes() const { return usedBytes_; }
+
+	static std::uint32_t AlignSize(std::uint32_t size) { return (size + ALIGNMENT - 1u) & ~(ALIGNMENT - 1u); }
+
+private:
+	std::uint32_t capacity_;
+
+	// Next allocation starts at head_, the oldest frame in flight starts at tail_
+	std::uint32_t head_;
+	std::uint32_t tail_;
+	std::uint32_t usedBytes_;
+
+	// Bytes taken by each frame in flight, oldest first from oldestFrame_
+	std::vector<std::uint32_t> frameSizes_;
+	std::uint32_t oldestFrame_;
+	std::uint32_t numFramesInFlight_;
+	bool isInFrame_;
+};
\ No newline at end of file
@@ -0,0 +1,353 @@
+#include "D3D11RenderBackend.h"
+#include "RenderQueue.h"
+#include "Logger.h"
+#include <algorithm>
+#include <cstring>
+#include <thread>
+
+#ifndef VALIDATE
+#define VALIDATE(hr, msg) if (FAILED(hr)) { Logger::Log(msg); return false; }
+#endif
+
+namespace
+{
+
+// Room for the instance data of about 50000 instances, shared by the frames in flight
+const std::uint32_t CONSTANT_RING_SIZE = 4u * 1024u * 1024u;
+
+// Size of the material table, as declared in Material.hlsli
+const std::uint32_t MAX_MATERIALS = 1024u;
+
+// Register of the bone palettes in the vertex stage
+const UINT PALETTE_SLOT = 0u;
+
+// The default DXGI frame latency
+const std::uint32_t MAX_FRAMES_IN_FLIGHT = 3u;
+
+// Constant buffer offsets and sizes are counted in 16 byte shader constants
+const std::uint32_t CONSTANT_SIZE = 16u;
+
+}
+
+D3D11RenderBackend::D3D11RenderBackend(ComPtr<ID3D11Device> device, ComPtr<ID3D11DeviceContext> context)
+	: device_(device)
+	, context_(context)
+	, context1_(nullptr)
+	, shaders_()
+	, materials_()
+	, meshes_()
+	, materialBuffer_(nullptr)
+	, numUploadedMaterials_(0u)
+	, paletteBuffer_(nullptr)
+	, paletteView_(nullptr)
+	, paletteCapacity_(0u)
+	, constantRing_(nullptr)
+	, ringAllocator_(CONSTANT_RING_SIZE, MAX_FRAMES_IN_FLIGHT)
+	, frameQueries_(MAX_FRAMES_IN_FLIGHT)
+	, nextQuery_(0u)
+	, mappedRing_(nullptr)
+	, hasMappedRing_(false)
+	, shader_(nullptr)
+	, mesh_(nullptr)
+{}
+
+bool D3D11RenderBackend::Initialize()
+{
+	HRESULT hr = context_.As(&context1_);
+	VALIDATE(hr, "Render backend needs a D3D11.1 device context, to bind constant buffers from an offset");
+
+	D3D11_FEATURE_DATA_D3D11_OPTIONS options;
+	ZeroMemory(&options, sizeof(options));
+	hr = device_->CheckFeatureSupport(D3D11_FEATURE_D3D11_OPTIONS, &options, sizeof(options));
+	VALIDATE(hr, "Failed to check D3D11.1 feature support");
+	if (!options.ConstantBufferOffsetting || !options.MapNoOverwriteOnDynamicConstantBuffer)
+	{
+		Logger::Log("Render backend needs constant buffer offsetting and no-overwrite maps of constant buffers");
+		return false;
+	}
+
+	D3D11_BUFFER_DESC bufferDesc = {};
+	bufferDesc.Usage = D3D11_USAGE_DYNAMIC;
+	bufferDesc.BindFlags = D3D11_BIND_CONSTANT_BUFFER;
+	bufferDesc.CPUAccessFlags = D3D11_CPU_ACCESS_WRITE;
+	bufferDesc.MiscFlags = 0x00;
+	bufferDesc.StructureByteStride = 0x00;
+	bufferDesc.ByteWidth = ringAllocator_.GetCapacity();
+	hr = device_->CreateBuffer(&bufferDesc, nullptr, &constantRing_);
+	VALIDATE(hr, "Failed to create constant ring buffer");
+
+	D3D11_QUERY_DESC queryDesc = { D3D11_QUERY_EVENT, 0x00 };
+	for (ComPtr<ID3D11Query>& query : frameQueries_)
+	{
+		hr = device_->CreateQuery(&queryDesc, &query);
+		VALIDATE(hr, "Failed to create frame event query");
+	}
+
+	return true;
+}
+
+std::uint32_t D3D11RenderBackend::AddShader(std::shared_ptr<IShader> shader)
+{
+	shaders_.push_back(shader);
+	return (std::uint32_t)shaders_.size() - 1u;
+}
+
+std::uint32_t D3D11RenderBackend::AddMesh(const Mesh& mesh)
+{
+	meshes_.push_back(mesh);
+	return (std::uint32_t)meshes_.size() - 1u;
+}
+
+std::uint32_t D3D11RenderBackend::AddMaterial(const Material& material)
+{
+	for (std::uint32_t materialKey = 0u; materialKey < materials_.size(); materialKey++)
+	{
+		if (memcmp(&materials_[materialKey], &material, sizeof(Material)) == 0)
+		{
+			return materialKey;
+		}
+	}
+
+	if (materials_.size() == MAX_MATERIALS)
+	{
+		Logger::Log("Material table of the D3D11 render backend is full");
+		return RenderQueue::INVALID_KEY;
+	}
+
+	materials_.push_back(material);
+	return (std::uint32_t)materials_.size() - 1u;
+}
+
+bool D3D11RenderBackend::UploadMaterials()
+{
+	// Sized for the whole table the shaders declare, so the bind is never smaller than what
+	//  they read
+	std::vector<Material> data(MAX_MATERIALS, Material::BasicGray);
+	std::copy(materials_.begin(), materials_.end(), data.begin());
+
+	D3D11_BUFFER_DESC bufferDesc = {};
+	bufferDesc.Usage = D3D11_USAGE_IMMUTABLE;
+	bufferDesc.BindFlags = D3D11_BIND_CONSTANT_BUFFER;
+	bufferDesc.CPUAccessFlags = 0x00;
+	bufferDesc.MiscFlags = 0x00;
+	bufferDesc.StructureByteStride = 0x00;
+	bufferDesc.ByteWidth = MAX_MATERIALS * sizeof(Material);
+
+	D3D11_SUBRESOURCE_DATA bufferData = {};
+	bufferData.pSysMem = &data[0];
+
+	HRESULT hr = device_->CreateBuffer(&bufferDesc, &bufferData, &materialBuffer_);
+	VALIDATE(hr, "Failed to create material constant buffer");
+
+	numUploadedMaterials_ = (std::uint32_t)materials_.size();
+	return true;
+}
+
+bool D3D11RenderBackend::ResizePaletteBuffer(std::uint32_t numBones)
+{
+	// Grows geometrically, so a growing crowd does not recreate the buffer every frame
+	std::uint32_t capacity = std::max(numBones, paletteCapacity_ * 2u);
+
+	D3D11_BUFFER_DESC bufferDesc = {};
+	bufferDesc.Usage = D3D11_USAGE_DYNAMIC;
+	bufferDesc.BindFlags = D3D11_BIND_SHADER_RESOURCE;
+	bufferDesc.CPUAccessFlags = D3D11_CPU_ACCESS_WRITE;
+	bufferDesc.MiscFlags = D3D11_RESOURCE_MISC_BUFFER_STRUCTURED;
+	bufferDesc.StructureByteStride = sizeof(Matrix3x4);
+	bufferDesc.ByteWidth = capacity * sizeof(Matrix3x4);
+
+	HRESULT hr = device_->CreateBuffer(&bufferDesc, nullptr, &paletteBuffer_);
+	VALIDATE(hr, "Failed to create bone palette buffer");
+
+	D3D11_SHADER_RESOURCE_VIEW_DESC viewDesc;
+	ZeroMemory(&viewDesc, sizeof(viewDesc));
+	viewDesc.Format = DXGI_FORMAT_UNKNOWN;
+	viewDesc.ViewDimension = D3D11_SRV_DIMENSION_BUFFER;
+	viewDesc.Buffer.FirstElement = 0;
+	viewDesc.Buffer.NumElements = capacity;
+
+	hr = device_->CreateShaderResourceView(paletteBuffer_.Get(), &viewDesc, &paletteView_);
+	VALIDATE(hr, "Failed to create bone palette shader resource view");
+
+	paletteCapacity_ = capacity;
+	return true;
+}
+
+bool D3D11RenderBackend::BeginFrame()
+{
+	shader_ = nullptr;
+	mesh_ = nullptr;
+
+	if (materials_.size() != numUploadedMaterials_ && !UploadMaterials())
+	{
+		return false;
+	}
+
+	// Reuse the ring space of frames the GPU has finished, and wait for the oldest frame
+	//  only when every frame is still in flight
+	while (ringAllocator_.GetFramesInFlight() > 0u)
+	{
+		std::uint32_t oldestQuery = (nextQuery_ + MAX_FRAMES_IN_FLIGHT - ringAllocator_.GetFramesInFlight()) % MAX_FRAMES_IN_FLIGHT;
+		bool mustWait = ringAllocator_.GetFramesInFlight() == ringAllocator_.GetMaxFramesInFlight();
+
+		HRESULT hr = context_->GetData(frameQueries_[oldestQuery].Get(), nullptr, 0, 0x00);
+		while (hr == S_FALSE && mustWait)
+		{
+			std::this_thread::yield();
+			hr = context_->GetData(frameQueries_[oldestQuery].Get(), nullptr, 0, 0x00);
+		}
+
+		if (hr == S_FALSE)
+		{
+			break;
+		}
+		ringAllocator_.RetireFrame();
+	}
+
+	ringAllocator_.BeginFrame();
+
+	// Shaders only bind their frame and scene buffers, so the table stays bound all frame
+	context_->PSSetConstantBuffers(0, 1, materialBuffer_.GetAddressOf());
+	return true;
+}
+
+bool D3D11RenderBackend::WritePaletteData(const Matrix3x4* bones, std::uint32_t numBones)
+{
+	if (numBones > paletteCapacity_ && !ResizePaletteBuffer(numBones))
+	{
+		return false;
+	}
+
+	D3D11_MAPPED_SUBRESOURCE mapped;
+	HRESULT hr = context_->Map(paletteBuffer_.Get(), 0, D3D11_MAP_WRITE_DISCARD, 0x00, &mapped);
+	VALIDATE(hr, "Failed to map bone palette buffer for CPU writing");
+
+	memcpy(mapped.pData, bones, numBones * sizeof(Matrix3x4));
+	context_->Unmap(paletteBuffer_.Get(), 0);
+
+	context_->VSSetShaderResources(PALETTE_SLOT, 1, paletteView_.GetAddressOf());
+	return true;
+}
+
+bool D3D11RenderBackend::WriteInstanceData(const InstanceData* instances, std::uint32_t numInstances, std::uint32_t& outOffset)
+{
+	if (numInstances > MAX_INSTANCES_PER_DRAW)
+	{
+		Logger::Log("Draw has more instances than the shaders can read, dropping it");
+		return false;
+	}
+
+	// Shaders index the material table without checking it
+	for (std::uint32_t i = 0u; i < numInstances; i++)
+	{
+		if (instances[i].MaterialKey >= numUploadedMaterials_)
+		{
+			Logger::Log("Draw packet uses a material that was never added to the D3D11 render backend");
+			return false;
+		}
+	}
+
+	std::uint32_t size = numInstances * sizeof(InstanceData);
+	if (!ringAllocator_.Allocate(size, outOffset))
+	{
+		Logger::Log("Constant ring is full, dropping draw");
+		return false;
+	}
+
+	// The very first map must discard. After that nothing the GPU may still read is
+	//  written, so the whole frame is written through one map without waiting on it.
+	if (mappedRing_ == nullptr)
+	{
+		D3D11_MAPPED_SUBRESOURCE mapped;
+		HRESULT hr = context_->Map(constantRing_.Get(), 0, hasMappedRing_ ? D3D11_MAP_WRITE_NO_OVERWRITE : D3D11_MAP_WRITE_DISCARD, 0x00, &mapped);
+		VALIDATE(hr, "Failed to map constant ring for CPU writing");
+
+		mappedRing_ = (char*)mapped.pData;
+		hasMappedRing_ = true;
+	}
+
+	memcpy(mappedRing_ + outOffset, instances, size);
+	return true;
+}
+
+bool D3D11RenderBackend::FlushInstanceData()
+{
+	if (mappedRing_ != nullptr)
+	{
+		context_->Unmap(constantRing_.Get(), 0);
+		mappedRing_ = nullptr;
+	}
+
+	return true;
+}
+
+bool D3D11RenderBackend::BindShader(std::uint32_t shaderKey)
+{
+	// Draws only use a shader once it is known to be bound
+	shader_ = nullptr;
+	if (shaderKey >= shaders_.size())
+	{
+		Logger::Log("Draw packet uses a shader that was never added to the D3D11 render backend");
+		return false;
+	}
+
+	if (!shaders_[shaderKey]->Bind(context_))
+	{
+		return false;
+	}
+
+	shader_ = shaders_[shaderKey].get();
+	return true;
+}
+
+bool D3D11RenderBackend::BindMesh(std::uint32_t meshKey)
+{
+	if (meshKey >= meshes_.size())
+	{
+		Logger::Log("Draw packet uses a mesh that was never added to the D3D11 render backend");
+		mesh_ = nullptr;
+		return false;
+	}
+
+	mesh_ = &meshes_[meshKey];
+
+	// Both streams are set, so a mesh without influences never leaves the last mesh's bound
+	ID3D11Buffer* vertexBuffers[] = { mesh_->VertexBuffer.Get(), mesh_->InfluenceBuffer.Get() };
+	UINT strides[] = { mesh_->VertexStride, mesh_->InfluenceStride };
+	UINT offsets[] = { 0u, 0u };
+	context_->IASetVertexBuffers(0, _countof(vertexBuffers), vertexBuffers, strides, offsets);
+	context_->IASetIndexBuffer(mesh_->IndexBuffer.Get(), mesh_->IndexFormat, 0);
+	context_->IASetPrimitiveTopology(D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
+	return true;
+}
+
+bool D3D11RenderBackend::BindInstanceData(std::uint32_t offset, std::uint32_t numInstances)
+{
+	// Bound ranges are whole 256 byte slices, as the allocator hands them out
+	UINT firstConstant = offset / CONSTANT_SIZE;
+	UINT numConstants = ConstantRingAllocator::AlignSize(numInstances * sizeof(InstanceData)) / CONSTANT_SIZE;
+	context1_->VSSetConstantBuffers1(0, 1, constantRing_.GetAddressOf(), &firstConstant, &numConstants);
+	return true;
+}
+
+bool D3D11RenderBackend::Draw(std::uint32_t numInstances)
+{
+	// Failed binds were already logged - skip the draw rather than use stale state
+	if (shader_ == nullptr || mesh_ == nullptr)
+	{
+		return false;
+	}
+
+	context_->DrawIndexedInstanced(mesh_->NumIndices, numInstances, 0, 0, 0);
+	return true;
+}
+
+bool D3D11RenderBackend::EndFrame()
+{
+	FlushInstanceData();
+
+	context_->End(frameQueries_[nextQuery_].Get());
+	nextQuery_ = (nextQuery_ + 1u) % MAX_FRAMES_IN_FLIGHT;
+	ringAllocator_.EndFrame();
+	return true;
+}
\ No newline at end of file
@@ -0,0 +1,122 @@
+#pragma once
+
+#include "IRenderBackend.h"
+#include "IShader.h"
+#include "Material.h"
+#include "ConstantRingAllocator.h"
+#include <d3d11_1.h>
+#include <d3d11.h>
+#include <wrl.h>
+#include <memory>
+#include <vector>
+using Microsoft::WRL::ComPtr;
+
+// Draws submitted render queues on a D3D11 device context. Shaders, materials and meshes
+//  are added once, after they are loaded, and the keys returned go into draw packets.
+// Every draw is instanced. Instance data is never mapped per draw: each frame writes it all
+//  into one large dynamic constant buffer with a single map, and draws bind their slice of
+//  it by offset. Materials live in one constant buffer table, bound once a frame, and the
+//  bone palettes of the frame in one structured buffer.
+class D3D11RenderBackend : public IRenderBackend
+{
+public:
+	struct Mesh
+	{
+	public:
+		ComPtr<ID3D11Buffer> VertexBuffer;
+		ComPtr<ID3D11Buffer> IndexBuffer;
+		DXGI_FORMAT IndexFormat;
+		std::uint32_t VertexStride;
+		std::uint32_t NumIndices;
+
+		// Packed bone influences, bound as the second vertex stream for skinning shaders.
+		//  Null for meshes without bones.
+		ComPtr<ID3D11Buffer> InfluenceBuffer;
+		std::uint32_t InfluenceStride;
+
+		Mesh(ComPtr<ID3D11Buffer> vertexBuffer, ComPtr<ID3D11Buffer> indexBuffer, DXGI_FORMAT indexFormat, std::uint32_t vertexStride, std::uint32_t numIndices)
+			: VertexBuffer(vertexBuffer)
+			, IndexBuffer(indexBuffer)
+			, IndexFormat(indexFormat)
+			, VertexStride(vertexStride)
+			, NumIndices(numIndices)
+			, InfluenceBuffer(nullptr)
+			, InfluenceStride(0u)
+		{}
+
+		Mesh(ComPtr<ID3D11Buffer> vertexBuffer, ComPtr<ID3D11Buffer> indexBuffer, DXGI_FORMAT indexFormat, std::uint32_t vertexStride, std::uint32_t numIndices,
+			ComPtr<ID3D11Buffer> influenceBuffer, std::uint32_t influenceStride)
+			: VertexBuffer(vertexBuffer)
+			, IndexBuffer(indexBuffer)
+			, IndexFormat(indexFormat)
+			, VertexStride(vertexStride)
+			, NumIndices(numIndices)
+			, InfluenceBuffer(influenceBuffer)
+			, InfluenceStride(influenceStride)
+		{}
+	};
+
+public:
+	D3D11RenderBackend() = delete;
+	D3D11RenderBackend(ComPtr<ID3D11Device> device, ComPtr<ID3D11DeviceContext> context);
+	D3D11RenderBackend(const D3D11RenderBackend&) = delete;
+	~D3D11RenderBackend() = default;
+
+	// Creates the constant ring. Binding constant buffers from an offset needs D3D11.1.
+	bool Initialize();
+
+	// Not thread safe - add everything from one thread, outside of frame submission
+	std::uint32_t AddShader(std::shared_ptr<IShader> shader);
+	std::uint32_t AddMesh(const Mesh& mesh);
+
+	// Materials equal to one already added share its key. Returns INVALID_KEY once the
+	//  material table is full.
+	std::uint32_t AddMaterial(const Material& material);
+
+public:
+	// Inherited via IRenderBackend
+	virtual bool BeginFrame() override;
+	virtual bool WritePaletteData(const Matrix3x4* bones, std::uint32_t numBones) override;
+	virtual bool WriteInstanceData(const InstanceData* instances, std::uint32_t numInstances, std::uint32_t& outOffset) override;
+	virtual bool FlushInstanceData() override;
+	virtual bool BindShader(std::uint32_t shaderKey) override;
+	virtual bool BindMesh(std::uint32_t meshKey) override;
+	virtual bool BindInstanceData(std::uint32_t offset, std::uint32_t numInstances) override;
+	virtual bool Draw(std::uint32_t numInstances) override;
+	virtual bool EndFrame() override;
+
+private:
+	bool UploadMaterials();
+	bool ResizePaletteBuffer(std::uint32_t numBones);
+
+private:
+	ComPtr<ID3D11Device> device_;
+	ComPtr<ID3D11DeviceContext> context_;
+	ComPtr<ID3D11DeviceContext1> context1_;
+	std::vector<std::shared_ptr<IShader>> shaders_;
+	std::vector<Material> materials_;
+	std::vector<Mesh> meshes_;
+
+	// Every material, rebuilt whenever materials are added
+	ComPtr<ID3D11Buffer> materialBuffer_;
+	std::uint32_t numUploadedMaterials_;
+
+	// Bone palettes of the frame, grown as needed and rewritten every frame
+	ComPtr<ID3D11Buffer> paletteBuffer_;
+	ComPtr<ID3D11ShaderResourceView> paletteView_;
+	std::uint32_t paletteCapacity_;
+
+	// Instance data of the frames being drawn. Slices are handed out by the
+	//  allocator, and each frame ends with an event query, so the slices of a frame are
+	//  only reused once the GPU has passed the query.
+	ComPtr<ID3D11Buffer> constantRing_;
+	ConstantRingAllocator ringAllocator_;
+	std::vector<ComPtr<ID3D11Query>> frameQueries_;
+	std::uint32_t nextQuery_;
+	char* mappedRing_;
+	bool hasMappedRing_;
+
+	// Bound by the last BindShader and BindMesh of the frame
+	IShader* shader_;
+	const Mesh* mesh_;
+};
\ No newline at end of file
@@ -1,8 +1,11 @@
 #include "DemoApp.h"
 #include "OffBrandChewy.h"
+#include "RoadBaseModel.h"
+#include "MixamoCharacterResources.h"
 #include <cinttypes>
 #include <cfloat>
 #include <cassert>
+#include <chrono>
 #include "Logger.h"
 
 namespace
@@ -42,7 +45,7 @@ LRESULT CALLBACK WndProc(HWND hWnd, UINT msg, WPARAM wParam, LPARAM lParam)
 
 };
 
-void Run(HINSTANCE hInst)
+void Run(HINSTANCE hInst, std::uint32_t crowdSize)
 {
 	g_hInst = hInst;
 
@@ -86,7 +89,7 @@ void Run(HINSTANCE hInst)
 	}
 
 	Logger::Log("Loading Off Brand Chewy Scene");
-	g_activeScene = std::make_shared<OffBrandChewy>(g_hWnd, device, context);
+	g_activeScene = std::make_shared<OffBrandChewy>(g_hWnd, device, context, crowdSize);
 	if (g_activeScene->LoadScene().get())
 	{
 		Logger::Log("Loading finished. Beginning main render loop.");
@@ -155,4 +158,19 @@ void Run(HINSTANCE hInst)
 
 	DestroyWindow(g_hWnd);
 	UnregisterClass(APP_NAME, hInst);
+
+	Logger::Shutdown();
+}
+
+bool BakeAssets()
+{
+	Logger::Log("Baking assets");
+
+	bool isValid = RoadBaseModel::Bake();
+	isValid &= MixamoCharacterResources::Bake();
+
+	Logger::Log(isValid ? "Finished baking assets" : "Failed to bake all assets!");
+	Logger::Shutdown();
+
+	return isValid;
 }
\ No newline at end of file
@@ -8,4 +8,10 @@
 
 #include "IScene.h"
 
-void Run(HINSTANCE hInst);
\ No newline at end of file
+// Characters in the demo crowd, unless the command line asks for another number
+const std::uint32_t DEFAULT_CROWD_SIZE = 1024u;
+
+void Run(HINSTANCE hInst, std::uint32_t crowdSize);
+
+// Converts the FBX models used by the demo into baked meshes, which load without assimp
+bool BakeAssets();
\ No newline at end of file
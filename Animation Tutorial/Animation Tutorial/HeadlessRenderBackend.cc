@@ -0,0 +1,241 @@
+#include "HeadlessRenderBackend.h"
+#include "RenderQueue.h"
+#include "Logger.h"
+#include <cstring>
+
+HeadlessRenderBackend::HeadlessRenderBackend(std::uint32_t constantRingSize, std::uint32_t maxFramesInFlight)
+	: shaderStrides_()
+	, meshes_()
+	, numMaterials_(0u)
+	, ringAllocator_(constantRingSize, maxFramesInFlight)
+	, ringMemory_(constantRingSize)
+	, palette_()
+	, isInstanceDataWritten_(false)
+	, isPaletteWritten_(false)
+	, isRecording_(true)
+	, isInFrame_(false)
+	, numFrames_(0u)
+	, commands_()
+	, stats_()
+	, shader_(RenderQueue::INVALID_KEY)
+	, mesh_(RenderQueue::INVALID_KEY)
+	, numBoundInstances_(0u)
+{}
+
+std::uint32_t HeadlessRenderBackend::AddShader(std::uint32_t vertexStride)
+{
+	shaderStrides_.push_back(vertexStride);
+	return (std::uint32_t)shaderStrides_.size() - 1u;
+}
+
+std::uint32_t HeadlessRenderBackend::AddMesh(std::uint32_t vertexStride, std::uint32_t numIndices)
+{
+	Mesh mesh = { vertexStride, numIndices };
+	meshes_.push_back(mesh);
+	return (std::uint32_t)meshes_.size() - 1u;
+}
+
+std::uint32_t HeadlessRenderBackend::AddMaterial()
+{
+	return numMaterials_++;
+}
+
+const InstanceData* HeadlessRenderBackend::GetInstanceData(std::uint32_t offset) const
+{
+	return reinterpret_cast<const InstanceData*>(&ringMemory_[offset]);
+}
+
+bool HeadlessRenderBackend::BeginFrame()
+{
+	if (isInFrame_)
+	{
+		return Fail("Headless render backend frame begun twice without ending it");
+	}
+
+	isInFrame_ = true;
+	commands_.clear();
+	stats_ = RenderStats();
+	shader_ = RenderQueue::INVALID_KEY;
+	mesh_ = RenderQueue::INVALID_KEY;
+	numBoundInstances_ = 0u;
+	isInstanceDataWritten_ = false;
+	isPaletteWritten_ = false;
+	palette_.clear();
+
+	if (ringAllocator_.GetFramesInFlight() == ringAllocator_.GetMaxFramesInFlight())
+	{
+		ringAllocator_.RetireFrame();
+	}
+	ringAllocator_.BeginFrame();
+	return true;
+}
+
+bool HeadlessRenderBackend::WritePaletteData(const Matrix3x4* bones, std::uint32_t numBones)
+{
+	if (!isInFrame_ || isPaletteWritten_ || isInstanceDataWritten_ || shader_ != RenderQueue::INVALID_KEY)
+	{
+		return Fail("Headless render backend given palette data outside of a frame, more than once, or after instance data");
+	}
+
+	palette_.assign(bones, bones + numBones);
+	isPaletteWritten_ = true;
+	stats_.NumPaletteBones += numBones;
+	if (isRecording_)
+	{
+		commands_.push_back(RenderCommand(RENDER_COMMAND_TYPE::WRITE_PALETTE_DATA, numBones));
+	}
+	return true;
+}
+
+bool HeadlessRenderBackend::WriteInstanceData(const InstanceData* instances, std::uint32_t numInstances, std::uint32_t& outOffset)
+{
+	if (!isInFrame_ || shader_ != RenderQueue::INVALID_KEY)
+	{
+		return Fail("Headless render backend given instance data outside of a frame, or after its first bind");
+	}
+
+	if (numInstances == 0u || numInstances > MAX_INSTANCES_PER_DRAW)
+	{
+		return Fail("Headless render backend given more instances than one draw can read, or none");
+	}
+
+	for (std::uint32_t i = 0u; i < numInstances; i++)
+	{
+		if (instances[i].MaterialKey >= numMaterials_
+			|| (instances[i].PaletteOffset != RenderQueue::INVALID_KEY && instances[i].PaletteOffset >= palette_.size()))
+		{
+			return Fail("Headless render backend given an instance with an unknown material, or a palette outside the palette data");
+		}
+	}
+
+	std::uint32_t usedBytes = ringAllocator_.GetUsedBytes();
+	if (!ringAllocator_.Allocate(numInstances * sizeof(InstanceData), outOffset))
+	{
+		return Fail("Headless render backend constant ring is full");
+	}
+
+	// Written through a single map, as the D3D11 backend does
+	if (!isInstanceDataWritten_)
+	{
+		stats_.NumConstantMaps++;
+		isInstanceDataWritten_ = true;
+	}
+
+	memcpy(&ringMemory_[outOffset], instances, numInstances * sizeof(InstanceData));
+	stats_.NumInstanceWrites++;
+	stats_.NumConstantBytes += ringAllocator_.GetUsedBytes() - usedBytes;
+	if (isRecording_)
+	{
+		commands_.push_back(RenderCommand(RENDER_COMMAND_TYPE::WRITE_INSTANCE_DATA, outOffset));
+	}
+	return true;
+}
+
+bool HeadlessRenderBackend::FlushInstanceData()
+{
+	return true;
+}
+
+bool HeadlessRenderBackend::BindShader(std::uint32_t shaderKey)
+{
+	if (!isInFrame_ || shaderKey >= shaderStrides_.size())
+	{
+		shader_ = RenderQueue::INVALID_KEY;
+		return Fail("Headless render backend given an unknown shader, or a bind outside of a frame");
+	}
+
+	if (shaderKey == shader_)
+	{
+		stats_.NumRedundantBinds++;
+	}
+
+	shader_ = shaderKey;
+	stats_.NumShaderBinds++;
+	if (isRecording_)
+	{
+		commands_.push_back(RenderCommand(RENDER_COMMAND_TYPE::BIND_SHADER, shaderKey));
+	}
+	return true;
+}
+
+bool HeadlessRenderBackend::BindMesh(std::uint32_t meshKey)
+{
+	if (!isInFrame_ || meshKey >= meshes_.size())
+	{
+		mesh_ = RenderQueue::INVALID_KEY;
+		return Fail("Headless render backend given an unknown mesh, or a bind outside of a frame");
+	}
+
+	if (meshKey == mesh_)
+	{
+		stats_.NumRedundantBinds++;
+	}
+
+	mesh_ = meshKey;
+	stats_.NumMeshBinds++;
+	if (isRecording_)
+	{
+		commands_.push_back(RenderCommand(RENDER_COMMAND_TYPE::BIND_MESH, meshKey));
+	}
+	return true;
+}
+
+bool HeadlessRenderBackend::BindInstanceData(std::uint32_t offset, std::uint32_t numInstances)
+{
+	if (!isInFrame_ || offset % ConstantRingAllocator::ALIGNMENT != 0u || (std::uint64_t)offset + numInstances * sizeof(InstanceData) > ringAllocator_.GetCapacity())
+	{
+		numBoundInstances_ = 0u;
+		return Fail("Headless render backend given instance data at an offset that is not a constant ring slice");
+	}
+
+	numBoundInstances_ = numInstances;
+	stats_.NumInstanceBinds++;
+	if (isRecording_)
+	{
+		commands_.push_back(RenderCommand(RENDER_COMMAND_TYPE::BIND_INSTANCE_DATA, offset));
+	}
+	return true;
+}
+
+bool HeadlessRenderBackend::Draw(std::uint32_t numInstances)
+{
+	if (!isInFrame_ || shader_ == RenderQueue::INVALID_KEY || mesh_ == RenderQueue::INVALID_KEY || numInstances == 0u || numInstances > numBoundInstances_)
+	{
+		return Fail("Headless render backend asked to draw without a shader, mesh and instance data for every instance");
+	}
+
+	const Mesh& mesh = meshes_[mesh_];
+	if (mesh.VertexStride != shaderStrides_[shader_])
+	{
+		return Fail("Headless render backend asked to draw a mesh with a shader of a different vertex layout");
+	}
+
+	stats_.NumDraws++;
+	stats_.NumInstances += numInstances;
+	stats_.NumIndices += mesh.NumIndices * numInstances;
+	if (isRecording_)
+	{
+		commands_.push_back(RenderCommand(RENDER_COMMAND_TYPE::DRAW, numInstances));
+	}
+	return true;
+}
+
+bool HeadlessRenderBackend::EndFrame()
+{
+	if (!isInFrame_)
+	{
+		return Fail("Headless render backend frame ended without beginning it");
+	}
+
+	isInFrame_ = false;
+	numFrames_++;
+	ringAllocator_.EndFrame();
+	return true;
+}
+
+bool HeadlessRenderBackend::Fail(const char* message)
+{
+	stats_.NumErrors++;
+	Logger::Log(message);
+	return false;
+}
\ No newline at end of file
@@ -0,0 +1,155 @@
+#pragma once
+
+#include "IRenderBackend.h"
+#include "ConstantRingAllocator.h"
+#include <cstdint>
+#include <vector>
+
+enum class RENDER_COMMAND_TYPE
+{
+	WRITE_PALETTE_DATA,
+	WRITE_INSTANCE_DATA,
+	BIND_SHADER,
+	BIND_MESH,
+	BIND_INSTANCE_DATA,
+	DRAW
+};
+
+// Commands of the last submitted frame, as received by the backend
+struct RenderCommand
+{
+public:
+	RENDER_COMMAND_TYPE Type;
+
+	// Key of what was bound for binds, constant ring offset for instance data, bone count for
+	//  palette data, instance count for draws
+	std::uint32_t Value;
+
+	RenderCommand(RENDER_COMMAND_TYPE type, std::uint32_t value)
+		: Type(type)
+		, Value(value)
+	{}
+};
+
+struct RenderStats
+{
+public:
+	std::uint32_t NumDraws;
+	std::uint32_t NumInstances;
+
+	// Over every instance drawn
+	std::uint32_t NumIndices;
+
+	std::uint32_t NumShaderBinds;
+	std::uint32_t NumMeshBinds;
+	std::uint32_t NumInstanceBinds;
+
+	// Constant ring slices written, and the ring space they took including any skipped
+	//  at its end, and maps of the ring (at most one a frame)
+	std::uint32_t NumInstanceWrites;
+	std::uint32_t NumConstantBytes;
+	std::uint32_t NumConstantMaps;
+
+	std::uint32_t NumPaletteBones;
+
+	// Binds of the shader or mesh that was already bound
+	std::uint32_t NumRedundantBinds;
+
+	// Commands rejected by validation. Rejected draws are not counted as draws.
+	std::uint32_t NumErrors;
+
+	RenderStats()
+		: NumDraws(0u)
+		, NumInstances(0u)
+		, NumIndices(0u)
+		, NumShaderBinds(0u)
+		, NumMeshBinds(0u)
+		, NumInstanceBinds(0u)
+		, NumInstanceWrites(0u)
+		, NumConstantBytes(0u)
+		, NumConstantMaps(0u)
+		, NumPaletteBones(0u)
+		, NumRedundantBinds(0u)
+		, NumErrors(0u)
+	{}
+
+	// Every bind is a state change on the GPU
+	std::uint32_t GetStateChangeCount() const { return NumShaderBinds + NumMeshBinds + NumInstanceBinds; }
+};
+
+// Render backend without a GPU, for measuring and checking draw submission on any machine.
+//  Records each command of a frame and keeps counts of them. Commands are checked the way
+//  the D3D11 debug layer would: keys must have been added, draws need a shader, mesh and
+//  instance data for at least as many instances as they draw, and the vertex stride of the
+//  mesh must match that of the shader. Every instance must use a material that was added,
+//  and a palette offset within the palette data of the frame.
+// Instance data goes through the same constant ring allocation as on the GPU, into memory,
+//  with frames retired only once maxFramesInFlight are in flight - as late as a GPU could.
+class HeadlessRenderBackend : public IRenderBackend
+{
+public:
+	HeadlessRenderBackend(std::uint32_t constantRingSize, std::uint32_t maxFramesInFlight);
+	HeadlessRenderBackend(const HeadlessRenderBackend&) = delete;
+	~HeadlessRenderBackend() = default;
+
+	// Stand-ins for the D3D11 shaders and meshes, with only what validation needs
+	std::uint32_t AddShader(std::uint32_t vertexStride);
+	std::uint32_t AddMesh(std::uint32_t vertexStride, std::uint32_t numIndices);
+	std::uint32_t AddMaterial();
+
+	// Recording every command costs a little time - turn it off to measure submission alone
+	void SetRecording(bool isRecording) { isRecording_ = isRecording; }
+
+	const std::vector<RenderCommand>& GetCommands() const { return commands_; }
+	const RenderStats& GetStats() const { return stats_; }
+	const ConstantRingAllocator& GetConstantRing() const { return ringAllocator_; }
+
+	// Instance and palette data as written by the last frame, for checking what a draw would read
+	const InstanceData* GetInstanceData(std::uint32_t offset) const;
+	const std::vector<Matrix3x4>& GetPaletteData() const { return palette_; }
+	std::uint32_t GetFrameCount() const { return numFrames_; }
+
+public:
+	// Inherited via IRenderBackend
+	virtual bool BeginFrame() override;
+	virtual bool WritePaletteData(const Matrix3x4* bones, std::uint32_t numBones) override;
+	virtual bool WriteInstanceData(const InstanceData* instances, std::uint32_t numInstances, std::uint32_t& outOffset) override;
+	virtual bool FlushInstanceData() override;
+	virtual bool BindShader(std::uint32_t shaderKey) override;
+	virtual bool BindMesh(std::uint32_t meshKey) override;
+	virtual bool BindInstanceData(std::uint32_t offset, std::uint32_t numInstances) override;
+	virtual bool Draw(std::uint32_t numInstances) override;
+	virtual bool EndFrame() override;
+
+private:
+	bool Fail(const char* message);
+
+private:
+	struct Mesh
+	{
+	public:
+		std::uint32_t VertexStride;
+		std::uint32_t NumIndices;
+	};
+
+	std::vector<std::uint32_t> shaderStrides_;
+	std::vector<Mesh> meshes_;
+	std::uint32_t numMaterials_;
+
+	ConstantRingAllocator ringAllocator_;
+	std::vector<char> ringMemory_;
+	std::vector<Matrix3x4> palette_;
+	bool isInstanceDataWritten_;
+	bool isPaletteWritten_;
+
+	bool isRecording_;
+	bool isInFrame_;
+	std::uint32_t numFrames_;
+	std::vector<RenderCommand> commands_;
+	RenderStats stats_;
+
+	// Bound state, INVALID_KEY or no instances until bound in the frame
+	std::uint32_t shader_;
+	std::uint32_t mesh_;
+	std::uint32_t numBoundInstances_;
+};
\ No newline at end of file
@@ -0,0 +1,47 @@
+#pragma once
+
+#include "Matrix.h"
+#include "Matrix3x4.h"
+#include <cstdint>
+
+// What a shader reads of one instance of an instanced draw. Laid out like an element of a
+//  constant buffer array, so each instance takes five 16 byte shader constants.
+struct InstanceData
+{
+public:
+	Matrix Model;
+
+	// Index into the material table of the backend
+	std::uint32_t MaterialKey;
+
+	// First bone of the instance's palette in the frame's palette data, or
+	//  RenderQueue::INVALID_KEY for instances without bones
+	std::uint32_t PaletteOffset;
+
+	std::uint32_t Padding[2];
+};
+
+// Receives the commands of a submitted RenderQueue. Bone palettes of the frame are written
+//  first, then the instance data of every draw, each write giving the offset it was written
+//  to, and both are flushed before any binds. Then every Draw draws the given number of
+//  instances of the mesh most recently bound, with the shader and instance data most
+//  recently bound. A frame whose BeginFrame fails gets no further commands.
+// Materials are not bound: every shader sees the whole material table, and picks the
+//  material of each instance by its key.
+class IRenderBackend
+{
+public:
+	// Instances of one draw are read from a constant buffer array of this size
+	static const std::uint32_t MAX_INSTANCES_PER_DRAW = 512u;
+
+public:
+	virtual bool BeginFrame() = 0;
+	virtual bool WritePaletteData(const Matrix3x4* bones, std::uint32_t numBones) = 0;
+	virtual bool WriteInstanceData(const InstanceData* instances, std::uint32_t numInstances, std::uint32_t& outOffset) = 0;
+	virtual bool FlushInstanceData() = 0;
+	virtual bool BindShader(std::uint32_t shaderKey) = 0;
+	virtual bool BindMesh(std::uint32_t meshKey) = 0;
+	virtual bool BindInstanceData(std::uint32_t offset, std::uint32_t numInstances) = 0;
+	virtual bool Draw(std::uint32_t numInstances) = 0;
+	virtual bool EndFrame() = 0;
+};
\ No newline at end of file
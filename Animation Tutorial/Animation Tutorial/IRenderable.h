@@ -1,9 +1,11 @@
 #pragma once
 
 #include "IActor.h"
+#include "RenderQueue.h"
 
 class IRenderable
 {
 public:
-	virtual bool Render() = 0;
+	// Writes the draws of the renderable into the frame's queue, rather than drawing directly
+	virtual bool Render(RenderQueue& queue) = 0;
 };
\ No newline at end of file
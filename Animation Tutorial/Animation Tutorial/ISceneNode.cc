@@ -0,0 +1,29 @@
+#include "ISceneNode.h"
+
+void ISceneNode::AddToHierarchy(TransformHierarchy& hierarchy, std::uint32_t parentNode)
+{
+	hierarchy_ = &hierarchy;
+	hierarchyNode_ = hierarchy.AddNode(parentNode, transform_);
+}
+
+void ISceneNode::SetLocalTransform(const Transform& transform)
+{
+	if (hierarchy_ != nullptr)
+	{
+		hierarchy_->SetLocalTransform(hierarchyNode_, transform);
+	}
+	else
+	{
+		transform_ = transform;
+	}
+}
+
+const Transform& ISceneNode::GetLocalTransform() const
+{
+	return (hierarchy_ != nullptr) ? hierarchy_->GetLocalTransform(hierarchyNode_) : transform_;
+}
+
+const Transform& ISceneNode::GetWorldTransform() const
+{
+	return (hierarchy_ != nullptr) ? hierarchy_->GetWorldTransform(hierarchyNode_) : transform_;
+}
\ No newline at end of file
@@ -3,21 +3,40 @@
 #include "IRenderable.h"
 #include "IActor.h"
 #include "Transform.h"
+#include "TransformHierarchy.h"
 
 class ISceneNode : public IActor, public IRenderable
 {
 public:
 	ISceneNode()
-		: transform_()
+		: ISceneNode(Transform())
 	{}
 
 	ISceneNode(Transform transform)
 		: transform_(transform)
+		, hierarchy_(nullptr)
+		, hierarchyNode_(TransformHierarchy::INVALID_INDEX)
 	{}
 
 	virtual bool Update(float dt) = 0;
-	virtual bool Render() = 0;
+	virtual bool Render(RenderQueue& queue) = 0;
+
+	// Called once, by the scene graph as it adds the node. Nodes that draw meshes add a child
+	//  hierarchy node for each mesh as well, so mesh world matrices are cached along with
+	//  every other world transform instead of being rebuilt each frame.
+	virtual void AddToHierarchy(TransformHierarchy& hierarchy, std::uint32_t parentNode);
+	std::uint32_t GetHierarchyNode() const { return hierarchyNode_; }
+
+	// Relative to the parent node. Moves every child with the node.
+	void SetLocalTransform(const Transform& transform);
+	const Transform& GetLocalTransform() const;
+
+	// As of the last scene graph update
+	const Transform& GetWorldTransform() const;
 
 protected:
+	// Held here only until the node is added to a hierarchy, which holds it from then on
 	Transform transform_;
+	TransformHierarchy* hierarchy_;
+	std::uint32_t hierarchyNode_;
 };
\ No newline at end of file
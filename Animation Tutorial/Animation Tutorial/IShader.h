@@ -0,0 +1,21 @@
+#pragma once
+
+#include <d3d11.h>
+#include <wrl.h>
+using Microsoft::WRL::ComPtr;
+
+// What the D3D11 render backend needs of a shader to draw objects with it. Frame and
+//  scene properties (camera, lights) are still set on the shader classes themselves.
+// Bind sets the input layout, shaders and frame and scene constant buffers, and only
+//  needs repeating once another shader has been bound. Everything else is bound by the
+//  backend, and shaders declare it at fixed registers:
+//  - b0 of the vertex stage: the InstanceData array of the draw (see IRenderBackend.h),
+//    indexed by SV_InstanceID
+//  - b0 of the pixel stage: the material table, indexed by the instance's material key
+//  - t0 of the vertex stage: the bone palettes of the frame, for shaders that skin
+//  - vertex stream 1: the packed bone influences of the mesh, for shaders that skin
+class IShader
+{
+public:
+	virtual bool Bind(ComPtr<ID3D11DeviceContext> context) = 0;
+};
\ No newline at end of file
@@ -0,0 +1,177 @@
+#include "JobSystem.h"
+#include <algorithm>
+#include <assert.h>
+
+namespace
+{
+
+// Queue belonging to the current thread. Threads that are not workers of a job system
+//  (such as the one that created it) share queue zero of that system.
+thread_local const JobSystem* tlsJobSystem = nullptr;
+thread_local std::uint32_t tlsQueueIdx = 0u;
+
+}
+
+JobSystem::JobSystem(std::uint32_t numThreads)
+	: queues_()
+	, workers_()
+	, queuedJobs_(0u)
+	, isShuttingDown_(false)
+	, sleepLock_()
+	, wakeCondition_()
+{
+	if (numThreads == 0u)
+	{
+		numThreads = std::max(std::thread::hardware_concurrency(), 1u);
+	}
+
+	for (std::uint32_t i = 0u; i < numThreads; i++)
+	{
+		queues_.push_back(std::unique_ptr<WorkQueue>(new WorkQueue()));
+	}
+
+	// Queue zero belongs to the owning thread, which runs jobs while it waits
+	for (std::uint32_t i = 1u; i < numThreads; i++)
+	{
+		workers_.push_back(std::thread(&JobSystem::WorkerMain, this, i));
+	}
+}
+
+JobSystem::~JobSystem()
+{
+	{
+		std::lock_guard<std::mutex> lock(sleepLock_);
+		isShuttingDown_.store(true);
+	}
+	wakeCondition_.notify_all();
+
+	for (std::thread& worker : workers_)
+	{
+		worker.join();
+	}
+}
+
+void JobSystem::Run(Job job, Counter& counter)
+{
+	counter.pending_.fetch_add(1u, std::memory_order_relaxed);
+
+	WorkQueue& queue = *queues_[GetQueueIndex()];
+	{
+		std::lock_guard<std::mutex> lock(queue.Lock);
+		queue.Jobs.push_back({ std::move(job), &counter });
+	}
+
+	// Taking the sleep lock orders this against a worker checking for work before it sleeps
+	queuedJobs_.fetch_add(1u);
+	{
+		std::lock_guard<std::mutex> lock(sleepLock_);
+	}
+	wakeCondition_.notify_one();
+}
+
+void JobSystem::Wait(Counter& counter)
+{
+	std::uint32_t queueIdx = GetQueueIndex();
+	while (!counter.IsDone())
+	{
+		if (!TryRunOne(queueIdx))
+		{
+			// Remaining jobs are already running on other threads
+			std::this_thread::yield();
+		}
+	}
+}
+
+void JobSystem::ParallelFor(std::uint32_t count, std::uint32_t grainSize, const std::function<void(std::uint32_t, std::uint32_t)>& body)
+{
+	assert(grainSize > 0u);
+
+	if (count <= grainSize || queues_.size() == 1u)
+	{
+		if (count > 0u)
+		{
+			body(0u, count);
+		}
+		return;
+	}
+
+	Counter counter;
+	for (std::uint32_t begin = 0u; begin < count; begin += grainSize)
+	{
+		std::uint32_t end = std::min(begin + grainSize, count);
+		Run([&body, begin, end] { body(begin, end); }, counter);
+	}
+	Wait(counter);
+}
+
+void JobSystem::WorkerMain(std::uint32_t queueIdx)
+{
+	tlsJobSystem = this;
+	tlsQueueIdx = queueIdx;
+
+	while (true)
+	{
+		if (TryRunOne(queueIdx))
+		{
+			continue;
+		}
+
+		std::unique_lock<std::mutex> lock(sleepLock_);
+		wakeCondition_.wait(lock, [this] { return isShuttingDown_.load() || queuedJobs_.load() > 0u; });
+		if (isShuttingDown_.load())
+		{
+			return;
+		}
+	}
+}
+
+std::uint32_t JobSystem::GetQueueIndex() const
+{
+	return (tlsJobSystem == this) ? tlsQueueIdx : 0u;
+}
+
+bool JobSystem::PopOrSteal(std::uint32_t queueIdx, QueuedJob& outJob)
+{
+	// Newest job from our own queue first - it is most likely to still be in cache
+	{
+		WorkQueue& queue = *queues_[queueIdx];
+		std::lock_guard<std::mutex> lock(queue.Lock);
+		if (!queue.Jobs.empty())
+		{
+			outJob = std::move(queue.Jobs.back());
+			queue.Jobs.pop_back();
+			return true;
+		}
+	}
+
+	// Then the oldest job of any other queue, starting with our neighbour
+	std::uint32_t numQueues = (std::uint32_t)queues_.size();
+	for (std::uint32_t i = 1u; i < numQueues; i++)
+	{
+		WorkQueue& queue = *queues_[(queueIdx + i) % numQueues];
+		std::lock_guard<std::mutex> lock(queue.Lock);
+		if (!queue.Jobs.empty())
+		{
+			outJob = std::move(queue.Jobs.front());
+			queue.Jobs.pop_front();
+			return true;
+		}
+	}
+
+	return false;
+}
+
+bool JobSystem::TryRunOne(std::uint32_t queueIdx)
+{
+	QueuedJob job;
+	if (!PopOrSteal(queueIdx, job))
+	{
+		return false;
+	}
+	queuedJobs_.fetch_sub(1u);
+
+	job.Function();
+	job.JobCounter->pending_.fetch_sub(1u, std::memory_order_release);
+
+	return true;
+}
\ No newline at end of file
@@ -0,0 +1,80 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Fixed pool of worker threads, each with its own job deque. A thread pushes and pops
+//  jobs at the back of its own deque, and when that runs dry it steals from the front of
+//  the others, so work spreads out without a single shared queue to fight over.
+// Jobs are joined through a Counter. Waiting on a counter runs pending jobs on the
+//  waiting thread instead of blocking it, so jobs may safely wait on jobs of their own.
+class JobSystem
+{
+public:
+	typedef std::function<void()> Job;
+
+	// Number of jobs started against it that have not yet finished
+	class Counter
+	{
+	public:
+		Counter() : pending_(0u) {}
+		Counter(const Counter&) = delete;
+
+		bool IsDone() const { return pending_.load(std::memory_order_acquire) == 0u; }
+
+	private:
+		friend class JobSystem;
+		std::atomic<std::uint32_t> pending_;
+	};
+
+public:
+	// numThreads includes the thread that owns the job system. Zero uses one thread per
+	//  hardware core, and one runs every job on the calling thread inside Wait.
+	JobSystem(std::uint32_t numThreads);
+	JobSystem(const JobSystem&) = delete;
+	~JobSystem();
+
+	std::uint32_t GetThreadCount() const { return (std::uint32_t)queues_.size(); }
+
+	void Run(Job job, Counter& counter);
+	void Wait(Counter& counter);
+
+	// Calls body(begin, end) over [0, count) in ranges of at most grainSize elements,
+	//  and returns once every range has finished
+	void ParallelFor(std::uint32_t count, std::uint32_t grainSize, const std::function<void(std::uint32_t, std::uint32_t)>& body);
+
+private:
+	struct QueuedJob
+	{
+		Job Function;
+		Counter* JobCounter;
+	};
+
+	struct WorkQueue
+	{
+		std::mutex Lock;
+		std::deque<QueuedJob> Jobs;
+	};
+
+	void WorkerMain(std::uint32_t queueIdx);
+	std::uint32_t GetQueueIndex() const;
+
+	bool PopOrSteal(std::uint32_t queueIdx, QueuedJob& outJob);
+	bool TryRunOne(std::uint32_t queueIdx);
+
+private:
+	std::vector<std::unique_ptr<WorkQueue>> queues_;
+	std::vector<std::thread> workers_;
+
+	std::atomic<std::uint32_t> queuedJobs_;
+	std::atomic<bool> isShuttingDown_;
+	std::mutex sleepLock_;
+	std::condition_variable wakeCondition_;
+};
\ No newline at end of file
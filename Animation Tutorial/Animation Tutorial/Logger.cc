@@ -1,4 +1,246 @@
 #include "Logger.h"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <mutex>
+#include <thread>
 
-std::mutex Logger::write_lock_;
-std::chrono::high_resolution_clock::time_point Logger::appStart_ = std::chrono::high_resolution_clock::now();
\ No newline at end of file
+namespace
+{
+
+// Must be a power of two
+const std::uint32_t RING_SIZE = 1024u;
+const std::uint32_t RING_MASK = RING_SIZE - 1u;
+const std::uint32_t MAX_MESSAGE_LENGTH = 256u;
+
+// How long the writer sleeps when it finds the ring empty. Producers never signal it,
+//  so that logging stays lock free.
+const std::chrono::milliseconds WRITER_IDLE_TIME(2);
+
+struct LogSlot
+{
+	// Equal to the enqueue position when free for that position, and one past it once
+	//  the message is written and ready to be read
+	std::atomic<std::uint32_t> Sequence;
+	char Text[MAX_MESSAGE_LENGTH];
+};
+
+// Bounded multi-producer, single-consumer queue of preformatted messages
+class LogRing
+{
+public:
+	LogRing()
+		: appStart_(std::chrono::high_resolution_clock::now())
+		, enqueuePos_(0u)
+		, dequeuePos_(0u)
+		, droppedCount_(0u)
+		, isShuttingDown_(false)
+		, writeLock_()
+		, idleLock_()
+		, idleCondition_()
+		, writer_()
+	{
+		for (std::uint32_t i = 0u; i < RING_SIZE; i++)
+		{
+			slots_[i].Sequence.store(i, std::memory_order_relaxed);
+		}
+
+		writer_ = std::thread(&LogRing::WriterMain, this);
+	}
+
+	LogRing(const LogRing&) = delete;
+
+	~LogRing()
+	{
+		Shutdown();
+	}
+
+	void Push(const char* message)
+	{
+		float timestamp = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::high_resolution_clock::now() - appStart_).count() / 1000000.f;
+
+		if (isShuttingDown_.load(std::memory_order_acquire))
+		{
+			std::lock_guard<std::mutex> lock(writeLock_);
+			std::printf("(%.6f) %s\n", timestamp, message);
+			std::fflush(stdout);
+			return;
+		}
+
+		// Claim a slot
+		LogSlot* slot = nullptr;
+		std::uint32_t pos = enqueuePos_.load(std::memory_order_relaxed);
+		while (true)
+		{
+			slot = &slots_[pos & RING_MASK];
+			std::int32_t diff = (std::int32_t)(slot->Sequence.load(std::memory_order_acquire) - pos);
+			if (diff == 0)
+			{
+				if (enqueuePos_.compare_exchange_weak(pos, pos + 1u, std::memory_order_relaxed))
+				{
+					break;
+				}
+			}
+			else if (diff < 0)
+			{
+				// The writer has not yet read the message a full lap ago - ring is full
+				droppedCount_.fetch_add(1u, std::memory_order_relaxed);
+				return;
+			}
+			else
+			{
+				pos = enqueuePos_.load(std::memory_order_relaxed);
+			}
+		}
+
+		std::snprintf(slot->Text, MAX_MESSAGE_LENGTH, "(%.6f) %s", timestamp, message);
+		slot->Sequence.store(pos + 1u, std::memory_order_seq_cst);
+
+		// Claimed before shutdown began, but perhaps after Shutdown stopped waiting for claimed
+		//  slots - nothing else will write it out now. Sequentially consistent with the flag, so
+		//  either Shutdown sees the message published or this sees the flag set.
+		if (isShuttingDown_.load(std::memory_order_seq_cst))
+		{
+			std::lock_guard<std::mutex> lock(writeLock_);
+			while (WriteNext()) {}
+			std::fflush(stdout);
+		}
+	}
+
+	void Shutdown()
+	{
+		if (isShuttingDown_.exchange(true))
+		{
+			return;
+		}
+
+		idleCondition_.notify_one();
+		if (writer_.joinable())
+		{
+			writer_.join();
+		}
+
+		// Anything that was mid-write while the writer stopped. Nothing between claiming a slot
+		//  and publishing it can block, so wait for every slot claimed so far rather than stop at
+		//  the first one still being written, and lose the messages after it.
+		std::lock_guard<std::mutex> lock(writeLock_);
+		std::uint32_t endPos = enqueuePos_.load(std::memory_order_seq_cst);
+		while (dequeuePos_ != endPos)
+		{
+			if (!WriteNext())
+			{
+				std::this_thread::yield();
+			}
+		}
+		std::fflush(stdout);
+	}
+
+	std::uint32_t GetDroppedCount() const
+	{
+		return droppedCount_.load(std::memory_order_relaxed);
+	}
+
+private:
+	bool WriteNext()
+	{
+		LogSlot& slot = slots_[dequeuePos_ & RING_MASK];
+		if (slot.Sequence.load(std::memory_order_acquire) != dequeuePos_ + 1u)
+		{
+			return false;
+		}
+
+		std::fputs(slot.Text, stdout);
+		std::fputc('\n', stdout);
+
+		slot.Sequence.store(dequeuePos_ + RING_SIZE, std::memory_order_release);
+		dequeuePos_++;
+		return true;
+	}
+
+	void WriterMain()
+	{
+		std::uint32_t reportedDropCount = 0u;
+
+		while (true)
+		{
+			// Read the flag before draining, so nothing logged before shutdown is missed
+			bool isShuttingDown = isShuttingDown_.load(std::memory_order_acquire);
+
+			bool wroteAny = false;
+			{
+				std::lock_guard<std::mutex> lock(writeLock_);
+				while (WriteNext())
+				{
+					wroteAny = true;
+				}
+
+				std::uint32_t dropCount = droppedCount_.load(std::memory_order_relaxed);
+				if (dropCount != reportedDropCount)
+				{
+					std::printf("(Logger) %u messages dropped, log ring was full\n", dropCount - reportedDropCount);
+					reportedDropCount = dropCount;
+					wroteAny = true;
+				}
+
+				if (wroteAny)
+				{
+					std::fflush(stdout);
+				}
+			}
+
+			if (isShuttingDown)
+			{
+				return;
+			}
+
+			if (!wroteAny)
+			{
+				std::unique_lock<std::mutex> lock(idleLock_);
+				idleCondition_.wait_for(lock, WRITER_IDLE_TIME);
+			}
+		}
+	}
+
+private:
+	std::chrono::high_resolution_clock::time_point appStart_;
+
+	LogSlot slots_[RING_SIZE];
+	std::atomic<std::uint32_t> enqueuePos_;
+	std::uint32_t dequeuePos_;
+	std::atomic<std::uint32_t> droppedCount_;
+
+	std::atomic<bool> isShuttingDown_;
+	std::mutex writeLock_;
+	std::mutex idleLock_;
+	std::condition_variable idleCondition_;
+	std::thread writer_;
+};
+
+LogRing& GetLogRing()
+{
+	static LogRing ring;
+	return ring;
+}
+
+}
+
+void Logger::Log(const char* message)
+{
+	GetLogRing().Push(message);
+}
+
+void Logger::Log(const std::string& message)
+{
+	GetLogRing().Push(message.c_str());
+}
+
+void Logger::Shutdown()
+{
+	GetLogRing().Shutdown();
+}
+
+std::uint32_t Logger::GetDroppedMessageCount()
+{
+	return GetLogRing().GetDroppedCount();
+}
\ No newline at end of file
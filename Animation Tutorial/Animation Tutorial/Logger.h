@@ -1,25 +1,21 @@
 #pragma once
 
-#include <mutex>
-#include <iostream>
-#include <chrono>
-#include <iomanip>
-#include <future>
+#include <cstdint>
+#include <string>
 
+// Log never blocks or allocates: the message is timestamped and copied into a slot of a
+//  fixed size ring buffer, which a background thread writes out to the console. If the
+//  ring is full the message is dropped and counted, rather than stalling the caller.
+//  Messages longer than a slot are truncated.
 class Logger
 {
 public:
-	template <class MsgType>
-	static void Log(MsgType message)
-	{
-		std::async(std::launch::async, [&message] {
-			std::lock_guard<std::mutex> lock(write_lock_);
-			auto dur = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::high_resolution_clock::now() - appStart_).count() / 1000000.f;
-			std::cout << "(" << std::fixed << std::setprecision(6) << dur << ") " << message << std::endl;
-		});
-	}
+	static void Log(const char* message);
+	static void Log(const std::string& message);
 
-private:
-	static std::mutex write_lock_;
-	static std::chrono::high_resolution_clock::time_point appStart_;
+	// Writes out every queued message and stops the background thread. Messages logged
+	//  after this are written synchronously. Also happens automatically at exit.
+	static void Shutdown();
+
+	static std::uint32_t GetDroppedMessageCount();
 };
\ No newline at end of file
@@ -0,0 +1,98 @@
+#include "MappedFile.h"
+
+#if defined(_WIN32)
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#include <Windows.h>
+#undef WIN32_LEAN_AND_MEAN
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+MappedFile::MappedFile(void* fileHandle, void* mappingHandle, const char* data, std::uint64_t size)
+	: fileHandle_(fileHandle)
+	, mappingHandle_(mappingHandle)
+	, data_(data)
+	, size_(size)
+{}
+
+#if defined(_WIN32)
+
+MappedFile::~MappedFile()
+{
+	UnmapViewOfFile(data_);
+	CloseHandle(mappingHandle_);
+	CloseHandle(fileHandle_);
+}
+
+std::shared_ptr<MappedFile> MappedFile::Open(const char* filename)
+{
+	HANDLE file = CreateFileA(filename, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+	if (file == INVALID_HANDLE_VALUE)
+	{
+		return nullptr;
+	}
+
+	LARGE_INTEGER size = {};
+	if (!GetFileSizeEx(file, &size) || size.QuadPart == 0)
+	{
+		CloseHandle(file);
+		return nullptr;
+	}
+
+	HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	if (mapping == nullptr)
+	{
+		CloseHandle(file);
+		return nullptr;
+	}
+
+	const char* data = (const char*)MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+	if (data == nullptr)
+	{
+		CloseHandle(mapping);
+		CloseHandle(file);
+		return nullptr;
+	}
+
+	return std::shared_ptr<MappedFile>(new MappedFile(file, mapping, data, (std::uint64_t)size.QuadPart));
+}
+
+#else
+
+// The mapping outlives the file descriptor, so only the view is kept
+MappedFile::~MappedFile()
+{
+	munmap((void*)data_, (size_t)size_);
+}
+
+std::shared_ptr<MappedFile> MappedFile::Open(const char* filename)
+{
+	int file = open(filename, O_RDONLY);
+	if (file < 0)
+	{
+		return nullptr;
+	}
+
+	struct stat status = {};
+	if (fstat(file, &status) != 0 || status.st_size == 0)
+	{
+		close(file);
+		return nullptr;
+	}
+
+	void* data = mmap(nullptr, (size_t)status.st_size, PROT_READ, MAP_PRIVATE, file, 0);
+	close(file);
+	if (data == MAP_FAILED)
+	{
+		return nullptr;
+	}
+
+	return std::shared_ptr<MappedFile>(new MappedFile(nullptr, nullptr, (const char*)data, (std::uint64_t)status.st_size));
+}
+
+#endif
\ No newline at end of file
@@ -0,0 +1,30 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+
+// Read-only view of a whole file, mapped into memory by the OS. Pages are read from disk
+//  on first access, and nothing is copied into process memory unless the OS needs to.
+class MappedFile
+{
+public:
+	MappedFile() = delete;
+	MappedFile(const MappedFile&) = delete;
+	~MappedFile();
+
+	// Returns nullptr if the file does not exist or cannot be mapped
+	static std::shared_ptr<MappedFile> Open(const char* filename);
+
+	const char* GetData() const { return data_; }
+	std::uint64_t GetSize() const { return size_; }
+
+private:
+	MappedFile(void* fileHandle, void* mappingHandle, const char* data, std::uint64_t size);
+
+private:
+	// Windows file and mapping handles. Null elsewhere, where the view is all that is kept.
+	void* fileHandle_;
+	void* mappingHandle_;
+	const char* data_;
+	std::uint64_t size_;
+};
\ No newline at end of file
@@ -1,3 +1,6 @@
+// Size of the material table of the render backend (D3D11RenderBackend.cc)
+#define MAX_MATERIALS 1024
+
 struct Material
 {
 	float4 AmbientColor;
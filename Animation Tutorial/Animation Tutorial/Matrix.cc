@@ -1,4 +1,5 @@
 #include "Matrix.h"
+#include "Simd.h"
 
 const Matrix Matrix::Identity = { 1.f, 0.f, 0.f, 0.f,  0.f, 1.f, 0.f, 0.f,  0.f, 0.f, 1.f, 0.f,  0.f, 0.f, 0.f, 1.f };
 
@@ -19,7 +20,18 @@ Matrix::Matrix(float m11, float m12, float m13, float m14, float m21, float m22,
 Matrix Matrix::Transpose() const
 {
 	Matrix tr;
-	
+
+#if defined(MAFFS_SIMD4)
+	SimdFloat4 r0 = Simd4Load(m[0]);
+	SimdFloat4 r1 = Simd4Load(m[1]);
+	SimdFloat4 r2 = Simd4Load(m[2]);
+	SimdFloat4 r3 = Simd4Load(m[3]);
+	_MM_TRANSPOSE4_PS(r0, r1, r2, r3);
+	Simd4Store(tr.m[0], r0);
+	Simd4Store(tr.m[1], r1);
+	Simd4Store(tr.m[2], r2);
+	Simd4Store(tr.m[3], r3);
+#else
 	for (std::uint8_t r = 0u; r < 4u; r++)
 	{
 		for (std::uint8_t c = 0u; c < 4u; c++)
@@ -27,6 +39,7 @@ Matrix Matrix::Transpose() const
 			tr.m[r][c] = m[c][r];
 		}
 	}
+#endif
 
 	return tr;
 }
@@ -44,6 +57,21 @@ Matrix Matrix::operator*(const Matrix & m2) const
 {
 	Matrix tr;
 
+#if defined(MAFFS_SIMD4)
+	// Each row of the result is a combination of the rows of m2, weighted by the row of this
+	SimdFloat4 b0 = Simd4Load(m2.m[0]);
+	SimdFloat4 b1 = Simd4Load(m2.m[1]);
+	SimdFloat4 b2 = Simd4Load(m2.m[2]);
+	SimdFloat4 b3 = Simd4Load(m2.m[3]);
+	for (std::uint32_t row = 0u; row < 4u; row++)
+	{
+		SimdFloat4 r = Simd4Mul(Simd4Splat(m[row][0]), b0);
+		r = Simd4MulAdd(Simd4Splat(m[row][1]), b1, r);
+		r = Simd4MulAdd(Simd4Splat(m[row][2]), b2, r);
+		r = Simd4MulAdd(Simd4Splat(m[row][3]), b3, r);
+		Simd4Store(tr.m[row], r);
+	}
+#else
 	for (std::uint8_t row = 0u; row < 4; row++)
 	{
 		for (std::uint8_t col = 0u; col < 4; col++)
@@ -55,6 +83,7 @@ Matrix Matrix::operator*(const Matrix & m2) const
 			}
 		}
 	}
+#endif
 
-	return std::move(tr);
+	return tr;
 }
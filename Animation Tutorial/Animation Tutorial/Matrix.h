@@ -1,5 +1,6 @@
 #pragma once
 
+#include "AlignedMemory.h"
 #include <memory>
 
 class Matrix
@@ -0,0 +1,10 @@
+#pragma once
+
+// Top three rows of an affine transform matrix, laid out like Matrix (translation in the
+//  last column). The bottom row is always 0 0 0 1, so skinning palettes store 48 bytes
+//  per bone instead of 64, as three float4 rows a shader can read directly.
+struct alignas(16) Matrix3x4
+{
+public:
+	float m[3][4];
+};
\ No newline at end of file
@@ -0,0 +1,218 @@
+#include "MatrixPalette.h"
+#include "Simd.h"
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+
+const std::uint32_t PALETTE_ROWS = 3u;
+const std::uint32_t PALETTE_COLUMNS = 4u;
+
+// Palette elements of one batch of bones, as one lane per bone
+struct BatchMatrices
+{
+	alignas(32) float Elements[PALETTE_ROWS][PALETTE_COLUMNS][SIMD_WIDTH];
+};
+
+void ComputeBatch(const Pose& pose, std::uint32_t firstBone, BatchMatrices& outBatch)
+{
+	SimdFloat px = SimdLoad(pose.GetStream(POSE_STREAM::POS_X) + firstBone);
+	SimdFloat py = SimdLoad(pose.GetStream(POSE_STREAM::POS_Y) + firstBone);
+	SimdFloat pz = SimdLoad(pose.GetStream(POSE_STREAM::POS_Z) + firstBone);
+	SimdFloat x = SimdLoad(pose.GetStream(POSE_STREAM::ROT_X) + firstBone);
+	SimdFloat y = SimdLoad(pose.GetStream(POSE_STREAM::ROT_Y) + firstBone);
+	SimdFloat z = SimdLoad(pose.GetStream(POSE_STREAM::ROT_Z) + firstBone);
+	SimdFloat w = SimdLoad(pose.GetStream(POSE_STREAM::ROT_W) + firstBone);
+	SimdFloat sx = SimdLoad(pose.GetStream(POSE_STREAM::SCALE_X) + firstBone);
+	SimdFloat sy = SimdLoad(pose.GetStream(POSE_STREAM::SCALE_Y) + firstBone);
+	SimdFloat sz = SimdLoad(pose.GetStream(POSE_STREAM::SCALE_Z) + firstBone);
+
+	// Same terms as Transform::GetTransformMatrix
+	SimdFloat one = SimdSet(1.f);
+	SimdFloat x2 = SimdAdd(x, x);
+	SimdFloat y2 = SimdAdd(y, y);
+	SimdFloat z2 = SimdAdd(z, z);
+	SimdFloat xx = SimdMul(x2, x);
+	SimdFloat yy = SimdMul(y2, y);
+	SimdFloat zz = SimdMul(z2, z);
+	SimdFloat xy = SimdMul(x2, y);
+	SimdFloat xz = SimdMul(x2, z);
+	SimdFloat yz = SimdMul(y2, z);
+	SimdFloat xw = SimdMul(x2, w);
+	SimdFloat yw = SimdMul(y2, w);
+	SimdFloat zw = SimdMul(z2, w);
+
+	SimdStore(outBatch.Elements[0u][0u], SimdMul(sx, SimdSub(SimdSub(one, yy), zz)));
+	SimdStore(outBatch.Elements[0u][1u], SimdMul(sy, SimdSub(xy, zw)));
+	SimdStore(outBatch.Elements[0u][2u], SimdMul(sz, SimdAdd(xz, yw)));
+	SimdStore(outBatch.Elements[0u][3u], px);
+
+	SimdStore(outBatch.Elements[1u][0u], SimdMul(sx, SimdAdd(xy, zw)));
+	SimdStore(outBatch.Elements[1u][1u], SimdMul(sy, SimdSub(SimdSub(one, xx), zz)));
+	SimdStore(outBatch.Elements[1u][2u], SimdMul(sz, SimdSub(yz, xw)));
+	SimdStore(outBatch.Elements[1u][3u], py);
+
+	SimdStore(outBatch.Elements[2u][0u], SimdMul(sx, SimdSub(xz, yw)));
+	SimdStore(outBatch.Elements[2u][1u], SimdMul(sy, SimdAdd(yz, xw)));
+	SimdStore(outBatch.Elements[2u][2u], SimdMul(sz, SimdSub(SimdSub(one, xx), yy)));
+	SimdStore(outBatch.Elements[2u][3u], pz);
+}
+
+// Turns the lanes of one batch back into a matrix per bone
+void StoreBatch(const BatchMatrices& batch, std::uint32_t nBones, Matrix3x4* outPalette)
+{
+#if defined(MAFFS_SIMD4)
+	// Four bones at a time - a 4x4 transpose turns four lanes of each column into four rows
+	for (std::uint32_t lane = 0u; lane < nBones; lane += 4u)
+	{
+		for (std::uint32_t row = 0u; row < PALETTE_ROWS; row++)
+		{
+			SimdFloat4 c0 = Simd4Load(batch.Elements[row][0u] + lane);
+			SimdFloat4 c1 = Simd4Load(batch.Elements[row][1u] + lane);
+			SimdFloat4 c2 = Simd4Load(batch.Elements[row][2u] + lane);
+			SimdFloat4 c3 = Simd4Load(batch.Elements[row][3u] + lane);
+			_MM_TRANSPOSE4_PS(c0, c1, c2, c3);
+
+			SimdFloat4 rows[4u] = { c0, c1, c2, c3 };
+			for (std::uint32_t boneIdx = lane; boneIdx < nBones && boneIdx < lane + 4u; boneIdx++)
+			{
+				Simd4Store(outPalette[boneIdx].m[row], rows[boneIdx - lane]);
+			}
+		}
+	}
+#else
+	for (std::uint32_t boneIdx = 0u; boneIdx < nBones; boneIdx++)
+	{
+		for (std::uint32_t row = 0u; row < PALETTE_ROWS; row++)
+		{
+			for (std::uint32_t col = 0u; col < PALETTE_COLUMNS; col++)
+			{
+				outPalette[boneIdx].m[row][col] = batch.Elements[row][col][boneIdx];
+			}
+		}
+	}
+#endif
+}
+
+}
+
+void BuildMatrixPalette(const Pose& pose, Matrix3x4* outPalette)
+{
+	static_assert(Pose::LANE_PADDING % SIMD_WIDTH == 0u, "Pose streams must be padded to whole SIMD batches");
+
+	BatchMatrices batch;
+	std::uint32_t nBones = pose.GetBoneCount();
+
+	for (std::uint32_t firstBone = 0u; firstBone < nBones; firstBone += SIMD_WIDTH)
+	{
+		ComputeBatch(pose, firstBone, batch);
+
+		std::uint32_t nBatchBones = (nBones - firstBone < SIMD_WIDTH) ? nBones - firstBone : SIMD_WIDTH;
+		StoreBatch(batch, nBatchBones, outPalette + firstBone);
+	}
+}
+
+Matrix3x4 ToMatrix3x4(const Matrix& matrix)
+{
+	Matrix3x4 tr;
+	for (std::uint32_t row = 0u; row < PALETTE_ROWS; row++)
+	{
+		for (std::uint32_t col = 0u; col < PALETTE_COLUMNS; col++)
+		{
+			tr.m[row][col] = matrix.m[row][col];
+		}
+	}
+	return tr;
+}
+
+void LerpMatrixPalette(const Matrix3x4* from, const Matrix3x4* to, float ratio, std::uint32_t nBones, Matrix3x4* outPalette)
+{
+#if defined(MAFFS_SIMD4)
+	SimdFloat4 t = Simd4Splat(ratio);
+	for (std::uint32_t boneIdx = 0u; boneIdx < nBones; boneIdx++)
+	{
+		for (std::uint32_t row = 0u; row < PALETTE_ROWS; row++)
+		{
+			SimdFloat4 a = Simd4Load(from[boneIdx].m[row]);
+			SimdFloat4 b = Simd4Load(to[boneIdx].m[row]);
+			Simd4Store(outPalette[boneIdx].m[row], Simd4MulAdd(Simd4Sub(b, a), t, a));
+		}
+	}
+#else
+	for (std::uint32_t boneIdx = 0u; boneIdx < nBones; boneIdx++)
+	{
+		for (std::uint32_t row = 0u; row < PALETTE_ROWS; row++)
+		{
+			for (std::uint32_t col = 0u; col < PALETTE_COLUMNS; col++)
+			{
+				float a = from[boneIdx].m[row][col];
+				outPalette[boneIdx].m[row][col] = a + (to[boneIdx].m[row][col] - a) * ratio;
+			}
+		}
+	}
+#endif
+}
+
+void BuildSkinningPalette(const Matrix3x4* modelPalette, const std::uint32_t* boneIndices, const Matrix3x4* offsets, std::uint32_t nBones, Matrix3x4* outPalette)
+{
+	// Both are affine, so the bottom row of the offset only adds its translation column
+#if defined(MAFFS_SIMD4)
+	SimdFloat4 lastRow = Simd4Set(0.f, 0.f, 0.f, 1.f);
+	for (std::uint32_t boneIdx = 0u; boneIdx < nBones; boneIdx++)
+	{
+		const Matrix3x4& bone = modelPalette[boneIndices[boneIdx]];
+		SimdFloat4 offset0 = Simd4Load(offsets[boneIdx].m[0u]);
+		SimdFloat4 offset1 = Simd4Load(offsets[boneIdx].m[1u]);
+		SimdFloat4 offset2 = Simd4Load(offsets[boneIdx].m[2u]);
+		for (std::uint32_t row = 0u; row < PALETTE_ROWS; row++)
+		{
+			SimdFloat4 result = Simd4Mul(Simd4Splat(bone.m[row][3u]), lastRow);
+			result = Simd4MulAdd(Simd4Splat(bone.m[row][0u]), offset0, result);
+			result = Simd4MulAdd(Simd4Splat(bone.m[row][1u]), offset1, result);
+			result = Simd4MulAdd(Simd4Splat(bone.m[row][2u]), offset2, result);
+			Simd4Store(outPalette[boneIdx].m[row], result);
+		}
+	}
+#else
+	for (std::uint32_t boneIdx = 0u; boneIdx < nBones; boneIdx++)
+	{
+		const Matrix3x4& bone = modelPalette[boneIndices[boneIdx]];
+		const Matrix3x4& offset = offsets[boneIdx];
+		for (std::uint32_t row = 0u; row < PALETTE_ROWS; row++)
+		{
+			for (std::uint32_t col = 0u; col < PALETTE_COLUMNS; col++)
+			{
+				outPalette[boneIdx].m[row][col] = bone.m[row][0u] * offset.m[0u][col] + bone.m[row][1u] * offset.m[1u][col] + bone.m[row][2u] * offset.m[2u][col]
+					+ ((col == PALETTE_COLUMNS - 1u) ? bone.m[row][3u] : 0.f);
+			}
+		}
+	}
+#endif
+}
+
+void BuildBindOffsets(const Skeleton& skeleton, const std::uint32_t* boneIndices, std::uint32_t nBones, Matrix3x4* outOffsets)
+{
+	for (std::uint32_t boneIdx = 0u; boneIdx < nBones; boneIdx++)
+	{
+		outOffsets[boneIdx] = ToMatrix3x4(skeleton.GetInverseBindTransform(boneIndices[boneIdx]).GetTransformMatrix());
+	}
+}
+
+float MeasureOffsetDifference(const Matrix3x4* a, const Matrix3x4* b, std::uint32_t nBones)
+{
+	float maxDifference = 0.f;
+	for (std::uint32_t boneIdx = 0u; boneIdx < nBones; boneIdx++)
+	{
+		for (std::uint32_t row = 0u; row < PALETTE_ROWS; row++)
+		{
+			for (std::uint32_t col = 0u; col < PALETTE_COLUMNS; col++)
+			{
+				float x = a[boneIdx].m[row][col];
+				float y = b[boneIdx].m[row][col];
+				maxDifference = std::max(maxDifference, fabsf(x - y) / std::max(1.f, std::max(fabsf(x), fabsf(y))));
+			}
+		}
+	}
+	return maxDifference;
+}
\ No newline at end of file
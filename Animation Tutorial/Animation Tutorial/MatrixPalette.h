@@ -0,0 +1,36 @@
+#pragma once
+
+#include "Matrix3x4.h"
+#include "Matrix.h"
+#include "Pose.h"
+#include "Skeleton.h"
+
+// Converts every bone of a pose into the matrix Transform::GetTransformMatrix would give,
+//  SIMD_WIDTH bones at a time (see Simd.h). Works straight from the structure-of-arrays
+//  streams of the pose, and writes into a palette owned by the caller, so nothing is
+//  allocated per frame.
+// outPalette must hold pose.GetBoneCount() matrices. Only those are written - padding
+//  bones of the pose are never stored.
+void BuildMatrixPalette(const Pose& pose, Matrix3x4* outPalette);
+
+// Top three rows of an affine matrix, for palette data built once at load time
+Matrix3x4 ToMatrix3x4(const Matrix& matrix);
+
+// Blends two palettes element by element, for poses between two evaluations. Only valid
+//  for palettes that are close together, as blended rotations are not renormalized.
+//  Arrays hold nBones matrices, and outPalette may be the same array as either input.
+void LerpMatrixPalette(const Matrix3x4* from, const Matrix3x4* to, float ratio, std::uint32_t nBones, Matrix3x4* outPalette);
+
+// Builds the skinning palette of a mesh from the model space palette of its skeleton: element i
+//  is modelPalette[boneIndices[i]] * offsets[i], which takes a vertex from the mesh's bind pose
+//  to where bone i puts it. Offsets are the inverse bind matrices of the mesh's bones, and
+//  every array but modelPalette holds nBones elements.
+void BuildSkinningPalette(const Matrix3x4* modelPalette, const std::uint32_t* boneIndices, const Matrix3x4* offsets, std::uint32_t nBones, Matrix3x4* outPalette);
+
+// Offsets of the given skeleton bones, from the skeleton's own bind pose - the matrix of each
+//  bone's inverse bind transform. Arrays hold nBones elements.
+void BuildBindOffsets(const Skeleton& skeleton, const std::uint32_t* boneIndices, std::uint32_t nBones, Matrix3x4* outOffsets);
+
+// Largest difference between matching elements of two sets of offsets, relative to the
+//  size of the element for elements above 1. Arrays hold nBones elements.
+float MeasureOffsetDifference(const Matrix3x4* a, const Matrix3x4* b, std::uint32_t nBones);
\ No newline at end of file
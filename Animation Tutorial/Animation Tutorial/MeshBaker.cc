@@ -0,0 +1,351 @@
+#include "MeshBaker.h"
+#include "BakedMesh.h"
+#include "Logger.h"
+#include "MeshProcessing.h"
+#include "Vec3.h"
+#include <assimp/cimport.h>
+#include <assimp/scene.h>
+#include <assimp/postprocess.h>
+#include <assimp/material.h>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace
+{
+
+const std::uint32_t FLOATS_PER_VERTEX = 8u;
+
+std::uint32_t AlignUp(std::uint32_t value, std::uint32_t alignment)
+{
+	return (value + alignment - 1u) / alignment * alignment;
+}
+
+// Appends raw data to the blob at the next aligned offset, and returns that offset
+std::uint32_t Append(std::vector<char>& blob, const void* data, std::uint32_t size)
+{
+	std::uint32_t offset = AlignUp((std::uint32_t)blob.size(), BakedMesh::ALIGNMENT);
+	blob.resize(offset + size);
+	if (size > 0u)
+	{
+		memcpy(&blob[offset], data, size);
+	}
+	return offset;
+}
+
+void PushVertex(std::vector<float>& vertices, const aiVector3D& position, float nx, float ny, float nz)
+{
+	// Adding zero turns -0 into +0, so that welding (which compares bytes) treats them as equal
+	float vertex[FLOATS_PER_VERTEX] = { position.x + 0.f, position.y + 0.f, position.z + 0.f, 1.f, nx + 0.f, ny + 0.f, nz + 0.f, 0.f };
+	vertices.insert(vertices.end(), vertex, vertex + FLOATS_PER_VERTEX);
+}
+
+// outSourceVertices gets the source vertex each vertex was made from
+bool BuildStreams(const aiMesh* mesh, const MeshBakeOptions& options, std::vector<float>& outVertices, std::vector<std::uint32_t>& outIndices, std::vector<std::uint32_t>& outSourceVertices)
+{
+	outVertices.clear();
+	outIndices.clear();
+	outSourceVertices.clear();
+
+	for (std::uint32_t faceIdx = 0u; faceIdx < mesh->mNumFaces; faceIdx++)
+	{
+		if (mesh->mFaces[faceIdx].mNumIndices != 3u)
+		{
+			Logger::Log("Mesh does not contain triangulated faces (mesh baker)");
+			return false;
+		}
+	}
+
+	if (options.FacetedNormals)
+	{
+		outVertices.reserve(mesh->mNumFaces * 3u * FLOATS_PER_VERTEX);
+		outIndices.reserve(mesh->mNumFaces * 3u);
+		outSourceVertices.reserve(mesh->mNumFaces * 3u);
+		for (std::uint32_t faceIdx = 0u; faceIdx < mesh->mNumFaces; faceIdx++)
+		{
+			const aiVector3D& v1 = mesh->mVertices[mesh->mFaces[faceIdx].mIndices[0u]];
+			const aiVector3D& v2 = mesh->mVertices[mesh->mFaces[faceIdx].mIndices[1u]];
+			const aiVector3D& v3 = mesh->mVertices[mesh->mFaces[faceIdx].mIndices[2u]];
+			outSourceVertices.insert(outSourceVertices.end(), mesh->mFaces[faceIdx].mIndices, mesh->mFaces[faceIdx].mIndices + 3u);
+			Vec3 n = Vec3::Cross(Vec3(v2.x - v1.x, v2.y - v1.y, v2.z - v1.z), Vec3(v3.x - v1.x, v3.y - v1.y, v3.z - v1.z)).Normal();
+
+			PushVertex(outVertices, v1, n.x, n.y, n.z);
+			PushVertex(outVertices, v2, n.x, n.y, n.z);
+			PushVertex(outVertices, v3, n.x, n.y, n.z);
+			outIndices.push_back(faceIdx * 3u);
+			outIndices.push_back(faceIdx * 3u + 1u);
+			outIndices.push_back(faceIdx * 3u + 2u);
+		}
+	}
+	else
+	{
+		outVertices.reserve(mesh->mNumVertices * FLOATS_PER_VERTEX);
+		outIndices.reserve(mesh->mNumFaces * 3u);
+		for (std::uint32_t vertIdx = 0u; vertIdx < mesh->mNumVertices; vertIdx++)
+		{
+			const aiVector3D& n = mesh->mNormals[vertIdx];
+			PushVertex(outVertices, mesh->mVertices[vertIdx], n.x, n.y, n.z);
+			outSourceVertices.push_back(vertIdx);
+		}
+		for (std::uint32_t faceIdx = 0u; faceIdx < mesh->mNumFaces; faceIdx++)
+		{
+			outIndices.push_back(mesh->mFaces[faceIdx].mIndices[0u]);
+			outIndices.push_back(mesh->mFaces[faceIdx].mIndices[1u]);
+			outIndices.push_back(mesh->mFaces[faceIdx].mIndices[2u]);
+		}
+	}
+
+	return true;
+}
+
+// Packs the influences of every vertex made from the mesh, and fills outPaletteBones with the
+//  mesh bones they refer to. Returns false if there are more bones than a palette can index.
+bool BuildInfluences(const aiMesh* mesh, const std::vector<std::uint32_t>& sourceVertices, INFLUENCE_WEIGHT_FORMAT format,
+	std::vector<char>& outInfluences, std::vector<std::uint32_t>& outPaletteBones)
+{
+	std::vector<VertexInfluences> influences;
+	GatherInfluences(mesh, influences);
+
+	CompactInfluencePalette(influences, mesh->mNumBones, outPaletteBones);
+	if (outPaletteBones.size() > MAX_PALETTE_BONES)
+	{
+		Logger::Log("Mesh has more influencing bones than a palette can index (mesh baker)");
+		return false;
+	}
+
+	InfluenceStats stats = MeasureInfluences(influences);
+	std::stringstream ss;
+	ss << "Mesh influences: " << outPaletteBones.size() << " of " << mesh->mNumBones << " bones used, " << stats.NumTruncatedVertices << " of "
+		<< stats.NumVertices << " vertices lost weight (at most " << 100.f * stats.MaxLostWeight << "%), " << stats.NumUnweightedVertices << " unweighted (mesh baker)";
+	Logger::Log(ss.str());
+
+	std::uint32_t influenceSize = GetPackedInfluenceSize(format);
+	outInfluences.resize(sourceVertices.size() * influenceSize);
+	for (std::uint32_t vertIdx = 0u; vertIdx < sourceVertices.size(); vertIdx++)
+	{
+		PackInfluences(influences[sourceVertices[vertIdx]], format, &outInfluences[vertIdx * influenceSize]);
+	}
+
+	return true;
+}
+
+void ReadMaterial(const aiMaterial* material, BakedMesh::MeshEntry& outEntry)
+{
+	aiColor4D diffuseColor;
+	aiColor4D ambientColor;
+	aiColor4D specularColor;
+	float shininess = 0.f;
+
+	// Ambient is taken from the diffuse color, as the runtime importers always did
+	aiGetMaterialColor(material, AI_MATKEY_COLOR_DIFFUSE, &diffuseColor);
+	aiGetMaterialColor(material, AI_MATKEY_COLOR_DIFFUSE, &ambientColor);
+	aiGetMaterialColor(material, AI_MATKEY_COLOR_SPECULAR, &specularColor);
+	aiGetMaterialFloat(material, AI_MATKEY_SHININESS, &shininess);
+
+	float ambient[4] = { ambientColor.r, ambientColor.g, ambientColor.b, ambientColor.a };
+	float diffuse[4] = { diffuseColor.r, diffuseColor.g, diffuseColor.b, diffuseColor.a };
+	float specular[4] = { specularColor.r, specularColor.g, specularColor.b, shininess };
+	memcpy(outEntry.AmbientColor, ambient, sizeof(ambient));
+	memcpy(outEntry.DiffuseColor, diffuse, sizeof(diffuse));
+	memcpy(outEntry.SpecularColor, specular, sizeof(specular));
+}
+
+}
+
+void GatherInfluences(const aiMesh* mesh, std::vector<VertexInfluences>& outInfluences)
+{
+	outInfluences.assign(mesh->mNumVertices, VertexInfluences());
+	for (std::uint32_t boneIdx = 0u; boneIdx < mesh->mNumBones; boneIdx++)
+	{
+		const aiBone* bone = mesh->mBones[boneIdx];
+		for (std::uint32_t weightIdx = 0u; weightIdx < bone->mNumWeights; weightIdx++)
+		{
+			AddInfluence(outInfluences[bone->mWeights[weightIdx].mVertexId], boneIdx, bone->mWeights[weightIdx].mWeight);
+		}
+	}
+}
+
+bool BuildBakedMesh(const char* sourceFilename, const MeshBakeOptions& options, std::vector<char>& outBlob)
+{
+	const aiScene* scene = aiImportFile(sourceFilename, aiProcessPreset_TargetRealtime_MaxQuality);
+	if (!scene)
+	{
+		Logger::Log(std::string("Failed to import mesh source file ") + sourceFilename);
+		return false;
+	}
+
+	std::vector<BakedMesh::MeshEntry> entries;
+	std::vector<std::vector<BakedMesh::BoneEntry>> bones;
+	std::string strings;
+
+	std::vector<char> blob(sizeof(BakedMesh::Header), 0);
+	std::vector<float> vertices;
+	std::vector<std::uint32_t> indices;
+	std::vector<std::uint16_t> shortIndices;
+	std::vector<std::uint32_t> sourceVertices;
+	std::vector<char> influences;
+	std::vector<char> interleaved;
+	std::vector<std::uint32_t> paletteBones;
+
+	bool isValid = true;
+	for (std::uint32_t meshIdx = 0u; meshIdx < scene->mNumMeshes && isValid; meshIdx++)
+	{
+		const aiMesh* mesh = scene->mMeshes[meshIdx];
+		if (!mesh->mNormals)
+		{
+			Logger::Log("Could not find normals for mesh (mesh baker)");
+			isValid = false;
+			break;
+		}
+
+		if (mesh->mNumFaces == 0u)
+		{
+			Logger::Log("Mesh does not contain any faces, skipping (mesh baker)");
+			continue;
+		}
+
+		if (!BuildStreams(mesh, options, vertices, indices, sourceVertices))
+		{
+			isValid = false;
+			break;
+		}
+
+		// Influences are interleaved with the vertices while welding and optimizing, so a
+		//  vertex is only welded to another with the same influences
+		std::uint32_t vertexStride = FLOATS_PER_VERTEX * sizeof(float);
+		std::uint32_t influenceSize = 0u;
+		influences.clear();
+		paletteBones.clear();
+		if (mesh->mNumBones > 0u)
+		{
+			if (!BuildInfluences(mesh, sourceVertices, options.InfluenceFormat, influences, paletteBones))
+			{
+				isValid = false;
+				break;
+			}
+			influenceSize = GetPackedInfluenceSize(options.InfluenceFormat);
+		}
+
+		std::uint32_t numSourceVertices = (std::uint32_t)sourceVertices.size();
+		interleaved.resize((std::size_t)numSourceVertices * (vertexStride + influenceSize));
+		InterleaveStreams(&vertices[0], vertexStride, influences.empty() ? nullptr : &influences[0], influenceSize, numSourceVertices, &interleaved[0]);
+
+		std::uint32_t numVertices = WeldVertices(&interleaved[0], vertexStride + influenceSize, numSourceVertices, indices);
+
+		MeshOptimizationStats optimizationStats;
+		numVertices = OptimizeMesh(&interleaved[0], vertexStride + influenceSize, numVertices, indices, optimizationStats);
+		vertices.resize(numVertices * FLOATS_PER_VERTEX);
+		influences.resize((std::size_t)numVertices * influenceSize);
+		DeinterleaveStreams(&interleaved[0], vertexStride, influenceSize, numVertices, &vertices[0], influences.empty() ? nullptr : &influences[0]);
+
+		std::stringstream ss;
+		ss << "Mesh " << meshIdx << " welded from " << numSourceVertices << " to " << numVertices << " vertices, ACMR "
+			<< optimizationStats.Before.ACMR << " -> " << optimizationStats.After.ACMR << ", ATVR "
+			<< optimizationStats.Before.ATVR << " -> " << optimizationStats.After.ATVR << " (mesh baker)";
+		Logger::Log(ss.str());
+
+		BakedMesh::MeshEntry entry = {};
+		entry.NumVertices = numVertices;
+		entry.VertexStride = FLOATS_PER_VERTEX * sizeof(float);
+		entry.VertexDataOffset = Append(blob, &vertices[0], (std::uint32_t)(vertices.size() * sizeof(float)));
+
+		entry.NumIndices = (std::uint32_t)indices.size();
+		entry.IndexSize = GetIndexSize(numVertices);
+		if (entry.IndexSize == sizeof(std::uint16_t))
+		{
+			NarrowIndices(indices, shortIndices);
+			entry.IndexDataOffset = Append(blob, &shortIndices[0], (std::uint32_t)(shortIndices.size() * sizeof(std::uint16_t)));
+		}
+		else
+		{
+			entry.IndexDataOffset = Append(blob, &indices[0], (std::uint32_t)(indices.size() * sizeof(std::uint32_t)));
+		}
+
+		if (influenceSize > 0u)
+		{
+			entry.InfluenceFormat = (std::uint32_t)options.InfluenceFormat;
+			entry.InfluenceSize = influenceSize;
+			entry.InfluenceDataOffset = Append(blob, &influences[0], (std::uint32_t)influences.size());
+		}
+
+		ReadMaterial(scene->mMaterials[mesh->mMaterialIndex], entry);
+
+		// Bone tables are appended once all streams are written. Only the bones in the
+		//  influence palette are kept, in palette order.
+		std::vector<BakedMesh::BoneEntry> meshBones(paletteBones.size());
+		for (std::uint32_t boneIdx = 0u; boneIdx < paletteBones.size(); boneIdx++)
+		{
+			const aiBone* bone = mesh->mBones[paletteBones[boneIdx]];
+			meshBones[boneIdx].NameOffset = (std::uint32_t)strings.size();
+			strings.append(bone->mName.C_Str(), bone->mName.length + 1u);
+
+			const aiMatrix4x4& m = bone->mOffsetMatrix;
+			float offset[16] = { m.a1, m.a2, m.a3, m.a4, m.b1, m.b2, m.b3, m.b4, m.c1, m.c2, m.c3, m.c4, m.d1, m.d2, m.d3, m.d4 };
+			memcpy(meshBones[boneIdx].OffsetMatrix, offset, sizeof(offset));
+		}
+		entry.NumBones = (std::uint32_t)paletteBones.size();
+
+		entries.push_back(entry);
+		bones.push_back(meshBones);
+	}
+
+	aiReleaseImport(scene);
+
+	if (!isValid)
+	{
+		return false;
+	}
+
+	for (std::uint32_t meshIdx = 0u; meshIdx < entries.size(); meshIdx++)
+	{
+		entries[meshIdx].BonesOffset = bones[meshIdx].empty()
+			? AlignUp((std::uint32_t)blob.size(), BakedMesh::ALIGNMENT)
+			: Append(blob, &bones[meshIdx][0], (std::uint32_t)(bones[meshIdx].size() * sizeof(BakedMesh::BoneEntry)));
+	}
+
+	BakedMesh::Header header = {};
+	header.Magic = BakedMesh::MAGIC;
+	header.Version = BakedMesh::VERSION;
+	header.NumMeshes = (std::uint32_t)entries.size();
+	header.MeshesOffset = entries.empty() ? AlignUp((std::uint32_t)blob.size(), BakedMesh::ALIGNMENT)
+		: Append(blob, &entries[0], (std::uint32_t)(entries.size() * sizeof(BakedMesh::MeshEntry)));
+	header.StringsSize = (std::uint32_t)strings.size();
+	header.StringsOffset = Append(blob, strings.data(), header.StringsSize);
+
+	blob.resize(AlignUp((std::uint32_t)blob.size(), BakedMesh::ALIGNMENT), 0);
+	header.SizeInBytes = (std::uint32_t)blob.size();
+	memcpy(&blob[0], &header, sizeof(header));
+
+	outBlob.swap(blob);
+	return true;
+}
+
+bool BakeMesh(const char* sourceFilename, const char* bakedFilename, const MeshBakeOptions& options)
+{
+	std::vector<char> blob;
+	if (!BuildBakedMesh(sourceFilename, options, blob))
+	{
+		return false;
+	}
+
+	std::ofstream fout(bakedFilename, std::ios::binary);
+	if (!fout)
+	{
+		Logger::Log(std::string("Failed to open baked mesh file for writing: ") + bakedFilename);
+		return false;
+	}
+	fout.write(&blob[0], blob.size());
+	if (!fout)
+	{
+		Logger::Log(std::string("Failed to write baked mesh file: ") + bakedFilename);
+		return false;
+	}
+
+	std::stringstream ss;
+	ss << "Baked " << reinterpret_cast<const BakedMesh::Header*>(&blob[0])->NumMeshes << " mesh(es) from " << sourceFilename << " into " << bakedFilename << " (" << blob.size() << " bytes)";
+	Logger::Log(ss.str());
+
+	return true;
+}
\ No newline at end of file
@@ -0,0 +1,40 @@
+#pragma once
+
+#include "SkinWeights.h"
+#include <cstdint>
+#include <vector>
+
+struct aiMesh;
+
+// How source geometry is turned into vertex and index streams. Vertices are always a
+//  position (w = 1) followed by a normal (w = 0), matching the Vertex of BasicShaderMD
+//  and ShaderPNS4_MD1. Identical vertices are always welded, and each mesh gets 16 bit
+//  indices if it has few enough vertices, or 32 bit indices otherwise. Meshes with bones
+//  also get a stream of their four heaviest bone influences per vertex, and only the bones
+//  those influences refer to are kept.
+struct MeshBakeOptions
+{
+public:
+	// Gives every triangle the face normal, instead of the source's smooth normals.
+	//  Only triangles with the same normal can share vertices.
+	bool FacetedNormals;
+
+	// Precision of packed influence weights
+	INFLUENCE_WEIGHT_FORMAT InfluenceFormat;
+
+	MeshBakeOptions(bool facetedNormals, INFLUENCE_WEIGHT_FORMAT influenceFormat)
+		: FacetedNormals(facetedNormals)
+		, InfluenceFormat(influenceFormat)
+	{}
+};
+
+// Imports a model file through assimp and writes its meshes as a BakedMesh file, which
+//  can then be loaded at runtime without assimp.
+bool BakeMesh(const char* sourceFilename, const char* bakedFilename, const MeshBakeOptions& options);
+
+// Same as above, into memory instead of a file - the whole cost of importing the model
+//  at startup, which the baked mesh saves
+bool BuildBakedMesh(const char* sourceFilename, const MeshBakeOptions& options, std::vector<char>& outBlob);
+
+// Bone influences of every vertex of an imported mesh, with bone indices into the mesh's bones
+void GatherInfluences(const aiMesh* mesh, std::vector<VertexInfluences>& outInfluences);
\ No newline at end of file
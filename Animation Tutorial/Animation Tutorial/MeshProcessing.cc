@@ -0,0 +1,368 @@
+#include "MeshProcessing.h"
+#include <assert.h>
+#include <cmath>
+#include <cstring>
+#include <utility>
+
+namespace
+{
+
+const std::uint32_t EMPTY_SLOT = 0xFFFFFFFFu;
+
+// FNV-1a over the raw bytes of a vertex
+std::uint32_t HashVertex(const std::uint8_t* vertex, std::uint32_t vertexStride)
+{
+	std::uint32_t hash = 2166136261u;
+	for (std::uint32_t i = 0u; i < vertexStride; i++)
+	{
+		hash = (hash ^ vertex[i]) * 16777619u;
+	}
+	return hash;
+}
+
+std::uint32_t NextPowerOfTwo(std::uint32_t value)
+{
+	std::uint32_t result = 1u;
+	while (result < value)
+	{
+		result <<= 1u;
+	}
+	return result;
+}
+
+// Tuning from Forsyth's "Linear-Speed Vertex Cache Optimisation"
+const std::uint32_t FORSYTH_CACHE_SIZE = 32u;
+const float FORSYTH_CACHE_DECAY_POWER = 1.5f;
+const float FORSYTH_LAST_TRIANGLE_SCORE = 0.75f;
+const float FORSYTH_VALENCE_BOOST_SCALE = 2.f;
+const float FORSYTH_VALENCE_BOOST_POWER = 0.5f;
+
+// Cache size assumed when measuring before and after OptimizeMesh
+const std::uint32_t SIMULATED_CACHE_SIZE = 16u;
+
+float ForsythVertexScore(std::int32_t cachePosition, std::uint32_t remainingTriangles)
+{
+	if (remainingTriangles == 0u)
+	{
+		// Nothing left to draw with this vertex
+		return -1.f;
+	}
+
+	float score = 0.f;
+	if (cachePosition >= 0)
+	{
+		if (cachePosition < 3)
+		{
+			// Used by the triangle just drawn - a fixed score, so that the next triangle
+			//  does not simply prefer whichever of its vertices came first
+			score = FORSYTH_LAST_TRIANGLE_SCORE;
+		}
+		else
+		{
+			float scale = 1.f / (FORSYTH_CACHE_SIZE - 3u);
+			score = powf(1.f - (cachePosition - 3) * scale, FORSYTH_CACHE_DECAY_POWER);
+		}
+	}
+
+	// Favour vertices with few triangles left, so they get finished off and stop
+	//  leaving lone triangles behind
+	score += FORSYTH_VALENCE_BOOST_SCALE * powf((float)remainingTriangles, -FORSYTH_VALENCE_BOOST_POWER);
+
+	return score;
+}
+
+}
+
+std::uint32_t WeldVertices(void* vertices, std::uint32_t vertexStride, std::uint32_t numVertices, std::vector<std::uint32_t>& indices)
+{
+	// Compacted vertices are written over the originals, so read from a copy - indices
+	//  can use vertices in any order
+	std::uint8_t* data = reinterpret_cast<std::uint8_t*>(vertices);
+	std::vector<std::uint8_t> source(data, data + (std::size_t)numVertices * vertexStride);
+
+	// Open addressed table of compacted vertex indices, kept at most half full
+	std::uint32_t tableSize = NextPowerOfTwo(numVertices * 2u);
+	std::uint32_t tableMask = tableSize - 1u;
+	std::vector<std::uint32_t> table(tableSize, EMPTY_SLOT);
+
+	// Compacted index of each source vertex, filled in as vertices are first used
+	std::vector<std::uint32_t> remap(numVertices, EMPTY_SLOT);
+	std::uint32_t numUnique = 0u;
+
+	for (std::uint32_t& index : indices)
+	{
+		assert(index < numVertices);
+		if (remap[index] == EMPTY_SLOT)
+		{
+			const std::uint8_t* vertex = &source[(std::size_t)index * vertexStride];
+			std::uint32_t slot = HashVertex(vertex, vertexStride) & tableMask;
+			while (table[slot] != EMPTY_SLOT && memcmp(data + (std::size_t)table[slot] * vertexStride, vertex, vertexStride) != 0)
+			{
+				slot = (slot + 1u) & tableMask;
+			}
+
+			if (table[slot] == EMPTY_SLOT)
+			{
+				memcpy(data + (std::size_t)numUnique * vertexStride, vertex, vertexStride);
+				table[slot] = numUnique++;
+			}
+
+			remap[index] = table[slot];
+		}
+
+		index = remap[index];
+	}
+
+	return numUnique;
+}
+
+std::uint32_t GetIndexSize(std::uint32_t numVertices)
+{
+	return (numVertices <= 0x10000u) ? sizeof(std::uint16_t) : sizeof(std::uint32_t);
+}
+
+void NarrowIndices(const std::vector<std::uint32_t>& indices, std::vector<std::uint16_t>& outIndices)
+{
+	outIndices.resize(indices.size());
+	for (std::size_t i = 0u; i < indices.size(); i++)
+	{
+		assert(indices[i] <= 0xFFFFu);
+		outIndices[i] = (std::uint16_t)indices[i];
+	}
+}
+
+VertexCacheStats SimulateVertexCache(const std::vector<std::uint32_t>& indices, std::uint32_t numVertices, std::uint32_t cacheSize)
+{
+	// A vertex is in the FIFO if fewer than cacheSize misses have happened since it was
+	//  added, so the cache never needs to be searched
+	std::vector<std::uint32_t> addedAtMiss(numVertices, 0u);
+	std::vector<bool> isUsed(numVertices, false);
+	std::uint32_t numMisses = 0u;
+	std::uint32_t numUsed = 0u;
+
+	for (std::uint32_t index : indices)
+	{
+		if (!isUsed[index] || numMisses - addedAtMiss[index] >= cacheSize)
+		{
+			if (!isUsed[index])
+			{
+				isUsed[index] = true;
+				numUsed++;
+			}
+			addedAtMiss[index] = numMisses++;
+		}
+	}
+
+	VertexCacheStats stats = { 0.f, 0.f };
+	if (indices.size() >= 3u)
+	{
+		stats.ACMR = numMisses / (indices.size() / 3.f);
+		stats.ATVR = numMisses / (float)numUsed;
+	}
+	return stats;
+}
+
+void OptimizeVertexCache(std::vector<std::uint32_t>& indices, std::uint32_t numVertices)
+{
+	std::uint32_t numTriangles = (std::uint32_t)(indices.size() / 3u);
+	if (numTriangles == 0u)
+	{
+		return;
+	}
+
+	// Triangles using each vertex, packed into one array. Each vertex's list is kept
+	//  split into triangles still to draw, followed by ones already drawn.
+	std::vector<std::uint32_t> remaining(numVertices, 0u);
+	for (std::uint32_t index : indices)
+	{
+		remaining[index]++;
+	}
+
+	std::vector<std::uint32_t> firstTriangle(numVertices + 1u, 0u);
+	for (std::uint32_t vertIdx = 0u; vertIdx < numVertices; vertIdx++)
+	{
+		firstTriangle[vertIdx + 1u] = firstTriangle[vertIdx] + remaining[vertIdx];
+	}
+
+	std::vector<std::uint32_t> vertexTriangles(indices.size());
+	{
+		std::vector<std::uint32_t> fill(firstTriangle.begin(), firstTriangle.end() - 1);
+		for (std::uint32_t i = 0u; i < indices.size(); i++)
+		{
+			vertexTriangles[fill[indices[i]]++] = i / 3u;
+		}
+	}
+
+	std::vector<std::int32_t> cachePosition(numVertices, -1);
+	std::vector<float> vertexScore(numVertices);
+	for (std::uint32_t vertIdx = 0u; vertIdx < numVertices; vertIdx++)
+	{
+		vertexScore[vertIdx] = ForsythVertexScore(-1, remaining[vertIdx]);
+	}
+
+	std::vector<float> triangleScore(numTriangles);
+	std::vector<bool> isDrawn(numTriangles, false);
+	std::uint32_t bestTriangle = 0u;
+	for (std::uint32_t triIdx = 0u; triIdx < numTriangles; triIdx++)
+	{
+		triangleScore[triIdx] = vertexScore[indices[triIdx * 3u]] + vertexScore[indices[triIdx * 3u + 1u]] + vertexScore[indices[triIdx * 3u + 2u]];
+		if (triangleScore[triIdx] > triangleScore[bestTriangle])
+		{
+			bestTriangle = triIdx;
+		}
+	}
+
+	std::vector<std::uint32_t> output;
+	output.reserve(indices.size());
+
+	std::vector<std::uint32_t> cache;
+	std::vector<std::uint32_t> nextCache;
+	cache.reserve(FORSYTH_CACHE_SIZE + 3u);
+	nextCache.reserve(FORSYTH_CACHE_SIZE + 3u);
+
+	const std::uint32_t NO_TRIANGLE = 0xFFFFFFFFu;
+	std::uint32_t scanStart = 0u;
+
+	for (std::uint32_t drawn = 0u; drawn < numTriangles; drawn++)
+	{
+		if (bestTriangle == NO_TRIANGLE)
+		{
+			// Nothing in the cache touches an undrawn triangle - start again from the
+			//  best triangle anywhere, skipping the run of drawn ones at the front
+			while (isDrawn[scanStart])
+			{
+				scanStart++;
+			}
+
+			bestTriangle = scanStart;
+			for (std::uint32_t triIdx = scanStart + 1u; triIdx < numTriangles; triIdx++)
+			{
+				if (!isDrawn[triIdx] && triangleScore[triIdx] > triangleScore[bestTriangle])
+				{
+					bestTriangle = triIdx;
+				}
+			}
+		}
+
+		isDrawn[bestTriangle] = true;
+		const std::uint32_t* triangle = &indices[bestTriangle * 3u];
+		output.insert(output.end(), triangle, triangle + 3u);
+
+		// Move the triangle from the undrawn part of each vertex's list into the drawn part
+		for (std::uint32_t corner = 0u; corner < 3u; corner++)
+		{
+			std::uint32_t vertIdx = triangle[corner];
+			std::uint32_t* first = &vertexTriangles[firstTriangle[vertIdx]];
+			std::uint32_t* last = first + remaining[vertIdx] - 1u;
+			for (std::uint32_t* it = first; it <= last; it++)
+			{
+				if (*it == bestTriangle)
+				{
+					std::swap(*it, *last);
+					break;
+				}
+			}
+			remaining[vertIdx]--;
+		}
+
+		// The triangle's vertices move to the front of the cache, pushing the rest back
+		nextCache.assign(triangle, triangle + 3u);
+		for (std::uint32_t cached : cache)
+		{
+			if (cached != triangle[0u] && cached != triangle[1u] && cached != triangle[2u])
+			{
+				nextCache.push_back(cached);
+			}
+		}
+		std::swap(cache, nextCache);
+
+		// Rescore everything in the cache, including vertices that just fell out of it
+		for (std::uint32_t cacheIdx = 0u; cacheIdx < cache.size(); cacheIdx++)
+		{
+			std::uint32_t vertIdx = cache[cacheIdx];
+			cachePosition[vertIdx] = (cacheIdx < FORSYTH_CACHE_SIZE) ? (std::int32_t)cacheIdx : -1;
+			vertexScore[vertIdx] = ForsythVertexScore(cachePosition[vertIdx], remaining[vertIdx]);
+		}
+
+		bestTriangle = NO_TRIANGLE;
+		float bestScore = -1.f;
+		for (std::uint32_t vertIdx : cache)
+		{
+			for (std::uint32_t i = 0u; i < remaining[vertIdx]; i++)
+			{
+				std::uint32_t triIdx = vertexTriangles[firstTriangle[vertIdx] + i];
+				triangleScore[triIdx] = vertexScore[indices[triIdx * 3u]] + vertexScore[indices[triIdx * 3u + 1u]] + vertexScore[indices[triIdx * 3u + 2u]];
+				if (triangleScore[triIdx] > bestScore)
+				{
+					bestScore = triangleScore[triIdx];
+					bestTriangle = triIdx;
+				}
+			}
+		}
+
+		if (cache.size() > FORSYTH_CACHE_SIZE)
+		{
+			cache.resize(FORSYTH_CACHE_SIZE);
+		}
+	}
+
+	indices.swap(output);
+}
+
+std::uint32_t OptimizeVertexFetch(void* vertices, std::uint32_t vertexStride, std::uint32_t numVertices, std::vector<std::uint32_t>& indices)
+{
+	std::uint8_t* data = reinterpret_cast<std::uint8_t*>(vertices);
+	std::vector<std::uint8_t> source(data, data + (std::size_t)numVertices * vertexStride);
+
+	std::vector<std::uint32_t> remap(numVertices, EMPTY_SLOT);
+	std::uint32_t numUsed = 0u;
+
+	for (std::uint32_t& index : indices)
+	{
+		assert(index < numVertices);
+		if (remap[index] == EMPTY_SLOT)
+		{
+			memcpy(data + (std::size_t)numUsed * vertexStride, &source[(std::size_t)index * vertexStride], vertexStride);
+			remap[index] = numUsed++;
+		}
+		index = remap[index];
+	}
+
+	return numUsed;
+}
+
+std::uint32_t OptimizeMesh(void* vertices, std::uint32_t vertexStride, std::uint32_t numVertices, std::vector<std::uint32_t>& indices, MeshOptimizationStats& outStats)
+{
+	outStats.Before = SimulateVertexCache(indices, numVertices, SIMULATED_CACHE_SIZE);
+
+	OptimizeVertexCache(indices, numVertices);
+	std::uint32_t numUsed = OptimizeVertexFetch(vertices, vertexStride, numVertices, indices);
+
+	outStats.After = SimulateVertexCache(indices, numUsed, SIMULATED_CACHE_SIZE);
+
+	return numUsed;
+}
+
+void InterleaveStreams(const void* a, std::uint32_t aStride, const void* b, std::uint32_t bStride, std::uint32_t numVertices, void* outInterleaved)
+{
+	const std::uint8_t* aData = static_cast<const std::uint8_t*>(a);
+	const std::uint8_t* bData = static_cast<const std::uint8_t*>(b);
+	std::uint8_t* out = static_cast<std::uint8_t*>(outInterleaved);
+	for (std::uint32_t vertIdx = 0u; vertIdx < numVertices; vertIdx++)
+	{
+		memcpy(out + (std::size_t)vertIdx * (aStride + bStride), aData + (std::size_t)vertIdx * aStride, aStride);
+		memcpy(out + (std::size_t)vertIdx * (aStride + bStride) + aStride, bData + (std::size_t)vertIdx * bStride, bStride);
+	}
+}
+
+void DeinterleaveStreams(const void* interleaved, std::uint32_t aStride, std::uint32_t bStride, std::uint32_t numVertices, void* outA, void* outB)
+{
+	const std::uint8_t* data = static_cast<const std::uint8_t*>(interleaved);
+	std::uint8_t* aData = static_cast<std::uint8_t*>(outA);
+	std::uint8_t* bData = static_cast<std::uint8_t*>(outB);
+	for (std::uint32_t vertIdx = 0u; vertIdx < numVertices; vertIdx++)
+	{
+		memcpy(aData + (std::size_t)vertIdx * aStride, data + (std::size_t)vertIdx * (aStride + bStride), aStride);
+		memcpy(bData + (std::size_t)vertIdx * bStride, data + (std::size_t)vertIdx * (aStride + bStride) + aStride, bStride);
+	}
+}
\ No newline at end of file
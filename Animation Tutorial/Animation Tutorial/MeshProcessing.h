@@ -0,0 +1,57 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+// Merges vertices whose bytes are identical (same position, normal, and so on), keeping
+//  the first copy of each. Vertices are compacted within the array in order of first use,
+//  and indices are rewritten to point at the compacted vertices.
+// Returns the number of vertices left - anything past that in the array is stale.
+std::uint32_t WeldVertices(void* vertices, std::uint32_t vertexStride, std::uint32_t numVertices, std::vector<std::uint32_t>& indices);
+
+// Smallest index size in bytes (2 or 4) able to address the given number of vertices
+std::uint32_t GetIndexSize(std::uint32_t numVertices);
+
+// Copies indices into 16 bit form - every index must fit
+void NarrowIndices(const std::vector<std::uint32_t>& indices, std::vector<std::uint16_t>& outIndices);
+
+// Efficiency of an index buffer on a FIFO post-transform vertex cache
+struct VertexCacheStats
+{
+public:
+	// Average cache miss ratio - vertices transformed per triangle. 0.5 is ideal for
+	//  large regular meshes, and 3 means no vertex is ever reused.
+	float ACMR;
+
+	// Average transform to vertex ratio - vertices transformed per vertex used. 1 is ideal.
+	float ATVR;
+};
+
+// Counts vertex shader invocations for the index buffer on a simulated FIFO cache
+VertexCacheStats SimulateVertexCache(const std::vector<std::uint32_t>& indices, std::uint32_t numVertices, std::uint32_t cacheSize);
+
+// Reorders triangles so that vertices are reused while still in the post-transform
+//  cache, using Tom Forsyth's linear-speed vertex cache optimization. The set of
+//  triangles and their winding is unchanged.
+void OptimizeVertexCache(std::vector<std::uint32_t>& indices, std::uint32_t numVertices);
+
+// Reorders vertices into the order the index buffer first uses them, so vertex fetch
+//  walks memory forwards, and drops vertices that are never used. Indices are rewritten
+//  to match. Returns the number of vertices left.
+std::uint32_t OptimizeVertexFetch(void* vertices, std::uint32_t vertexStride, std::uint32_t numVertices, std::vector<std::uint32_t>& indices);
+
+struct MeshOptimizationStats
+{
+public:
+	VertexCacheStats Before;
+	VertexCacheStats After;
+};
+
+// Runs OptimizeVertexCache followed by OptimizeVertexFetch, measuring the index buffer
+//  before and after. Returns the number of vertices left.
+std::uint32_t OptimizeMesh(void* vertices, std::uint32_t vertexStride, std::uint32_t numVertices, std::vector<std::uint32_t>& indices, MeshOptimizationStats& outStats);
+
+// Joins two vertex streams into one of aStride + bStride bytes a vertex, so that welding and
+//  optimizing keep the two together, and splits them apart again afterwards
+void InterleaveStreams(const void* a, std::uint32_t aStride, const void* b, std::uint32_t bStride, std::uint32_t numVertices, void* outInterleaved);
+void DeinterleaveStreams(const void* interleaved, std::uint32_t aStride, std::uint32_t bStride, std::uint32_t numVertices, void* outA, void* outB);
\ No newline at end of file
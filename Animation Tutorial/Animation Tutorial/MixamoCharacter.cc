@@ -1,224 +1,221 @@
 #include "MixamoCharacter.h"
-#include "Logger.h"
-#include <assimp/cimport.h>
-#include <assimp/scene.h>
-#include <assimp/postprocess.h>
-#include <assimp/material.h>
-#include <assimp/config.h>
-#include <sstream>
-#include <queue>
-
-#ifndef VALIDATE
-#define VALIDATE(hr, msg) if (FAILED(hr)) { Logger::Log(msg); return false; }
-#endif
-
-const char * MixamoCharacter::MODEL_FILENAME = "../../assets/Beta.fbx";
-const char * MixamoCharacter::ANIMATION_FILENAME = "../../assets/samba_dancing.fbx";
-
-MixamoCharacter::MixamoCharacter(std::shared_ptr<ShaderPNS4_MD1> shader, ComPtr<ID3D11DeviceContext> context, Transform transform)
-	: ISceneNode(transform)
-	, renderContext_(context)
-	, shader_(shader)
-	, models_()
-{}
+#include "ClipSampler.h"
+#include "MatrixPalette.h"
+#include <algorithm>
+#include <assert.h>
+#include <cmath>
 
-std::future<bool> MixamoCharacter::Initialize(ComPtr<ID3D11Device> device)
+namespace
 {
-	return std::async(std::launch::async, [this, device] {
-		return InitVertexAndIndexBuffers(device);
-	});
+
+// Scratch poses for blend trees. Characters update on the job system's workers, so each
+//  thread has its own.
+thread_local PosePool blendPosePool;
+
+}
+
+MixamoCharacter::MixamoCharacter(std::shared_ptr<const MixamoCharacterResources> resources, std::uint32_t shaderKey, Transform transform)
+	: ISceneNode(transform)
+	, shaderKey_(shaderKey)
+	, resources_(resources)
+	, modelNodes_()
+	, clipIdx_(0u)
+	, time_(0.f)
+	, cursors_(resources->GetSkeleton().GetBoneCount())
+	, pose_(resources->GetSkeleton().GetBoneCount())
+	, palette_(resources->GetSkeleton().GetBoneCount())
+	, skinningPalettes_()
+	, blendTree_(nullptr)
+	, blendState_()
+	, lodLevels_(nullptr)
+	, lodIdx_(0u)
+	, updatePhase_(0u)
+	, frameIdx_(0u)
+	, isEvaluated_(false)
+	, timeSinceEvaluation_(0.f)
+	, evaluationGap_(0.f)
+	, previousPalette_(resources->GetSkeleton().GetBoneCount())
+	, evaluatedPalette_(resources->GetSkeleton().GetBoneCount())
+{
+	for (const MixamoCharacterResources::ModelData& model : resources->GetModels())
+	{
+		skinningPalettes_.push_back(std::vector<Matrix3x4>(model.BoneIndices.size()));
+	}
 }
 
 void MixamoCharacter::SetTransform(Transform transform)
 {
-	transform_ = transform;
+	SetLocalTransform(transform);
 }
 
-bool MixamoCharacter::Update(float dt)
+void MixamoCharacter::PlayClip(std::uint32_t clipIdx, float startTime)
 {
-	return true;
+	clipIdx_ = clipIdx;
+	time_ = startTime;
+	blendTree_ = nullptr;
+
+	// Cursors refer to keys of the previous clip - start searching from scratch
+	std::fill(cursors_.begin(), cursors_.end(), BoneAnimation::Cursor());
+
+	// Don't blend from a pose of the previous clip
+	isEvaluated_ = false;
+}
+
+void MixamoCharacter::PlayBlendTree(std::shared_ptr<const BlendTree> blendTree)
+{
+	assert(blendTree != nullptr && blendTree->GetBoneCount() == resources_->GetSkeleton().GetBoneCount());
+
+	blendTree_ = blendTree;
+	blendState_ = blendTree->CreateState();
+	isEvaluated_ = false;
 }
 
-bool MixamoCharacter::Render()
+void MixamoCharacter::SetBlendParameter(std::uint32_t parameterIdx, float value)
 {
-	std::uint32_t stride = sizeof(ShaderPNS4_MD1::Vertex);
-	std::uint32_t offset = 0u;
+	assert(blendTree_ != nullptr && parameterIdx < blendState_.Parameters.size());
 
-	bool isValid = true;
+	blendState_.Parameters[parameterIdx] = value;
+}
+
+void MixamoCharacter::SetAnimationLod(std::shared_ptr<const std::vector<AnimationLodLevel>> lodLevels, std::uint32_t updatePhase)
+{
+	assert(lodLevels == nullptr || !lodLevels->empty());
+
+	lodLevels_ = lodLevels;
+	lodIdx_ = 0u;
+	updatePhase_ = updatePhase;
+}
 
-	for (ModelData model : models_)
-	//ModelData model = models_[1u];
+void MixamoCharacter::SelectLod(const Vec3& viewerPosition)
+{
+	if (lodLevels_ != nullptr)
 	{
-		renderContext_->IASetVertexBuffers(0, 1, model.VertexBuffer.GetAddressOf(), &stride, &offset);
-		renderContext_->IASetIndexBuffer(model.IndexBuffer.Get(), DXGI_FORMAT_R32_UINT, 0);
-		renderContext_->IASetPrimitiveTopology(D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
-		shader_->SetModelMatrix((transform_ * model.Transform).GetTransformMatrix());
-		shader_->SetObjectMaterial(model.Material);
-		isValid &= shader_->Render(renderContext_, model.NumIndices);
+		lodIdx_ = SelectAnimationLod(*lodLevels_, (GetWorldTransform().Pos - viewerPosition).Magnitude());
 	}
-
-	return isValid;
 }
 
-bool MixamoCharacter::InitVertexAndIndexBuffers(ComPtr<ID3D11Device> device)
+bool MixamoCharacter::Update(float dt)
 {
-	Logger::Log("Loading mixamo character");
+	if (blendTree_ != nullptr)
+	{
+		blendTree_->Advance(blendState_, dt);
+	}
+	else if (clipIdx_ < resources_->GetClipCount())
+	{
+		float duration = resources_->GetClipDuration(clipIdx_);
+
+		time_ += dt;
+		if (duration > 0.f && time_ > duration)
+		{
+			time_ = fmodf(time_, duration);
 
-	std::uint32_t nFaces = 0u;
+			// The pose jumps back to the start of the clip - don't blend palettes across that
+			isEvaluated_ = false;
+		}
+	}
+	else
+	{
+		return true;
+	}
 
-	auto mp = std::async(std::launch::async, [] { return aiImportFile(MixamoCharacter::MODEL_FILENAME, aiProcessPreset_TargetRealtime_MaxQuality); });
-	auto ap = std::async(std::launch::async, [] { return aiImportFile(MixamoCharacter::ANIMATION_FILENAME, aiProcessPreset_TargetRealtime_MaxQuality); });
+	const AnimationLodLevel* lod = (lodLevels_ != nullptr) ? &(*lodLevels_)[lodIdx_] : nullptr;
+	std::uint32_t updateInterval = (lod != nullptr) ? std::max(lod->UpdateInterval, 1u) : 1u;
 
-	const aiScene* mixamoModel = mp.get();
-	const aiScene* animation = ap.get();
-	if (!mixamoModel || !animation)
+	frameIdx_++;
+	timeSinceEvaluation_ += dt;
+	if (!isEvaluated_ || updateInterval == 1u || (frameIdx_ + updatePhase_) % updateInterval == 0u)
 	{
-		Logger::Log("Failed to load mixamo character model!");
-		return false;
+		previousPalette_.swap(evaluatedPalette_);
+		Evaluate(lod);
+
+		if (!isEvaluated_)
+		{
+			previousPalette_ = evaluatedPalette_;
+			isEvaluated_ = true;
+		}
+		evaluationGap_ = timeSinceEvaluation_;
+		timeSinceEvaluation_ = 0.f;
 	}
 
-	// Create each model, each of which should have a different material for use
-	models_.reserve(mixamoModel->mNumMeshes);
+	if (palette_.empty())
+	{
+		return true;
+	}
 
-	// Block to introduce scope of the vector
+	if (updateInterval == 1u)
 	{
-		// Using a vector to prevent frequent memory allocations and frees between models in the mesh
-		std::vector<ShaderPNS4_MD1::Vertex> vertices;
-		std::vector<std::uint32_t> indices;
-		for (std::uint32_t meshIdx = 0u; meshIdx < mixamoModel->mNumMeshes; meshIdx++)
+		palette_ = evaluatedPalette_;
+	}
+	else
+	{
+		// Trails the latest evaluation by one interval, so the palette always lies between
+		//  two evaluated poses, and reaches the latest one just as the next is made
+		float ratio = (evaluationGap_ > 0.f) ? std::min(timeSinceEvaluation_ / evaluationGap_, 1.f) : 1.f;
+		LerpMatrixPalette(&previousPalette_[0], &evaluatedPalette_[0], ratio, (std::uint32_t)palette_.size(), &palette_[0]);
+	}
+
+	const std::vector<MixamoCharacterResources::ModelData>& models = resources_->GetModels();
+	for (std::uint32_t modelIdx = 0u; modelIdx < models.size(); modelIdx++)
+	{
+		if (!skinningPalettes_[modelIdx].empty())
 		{
-			auto mesh = mixamoModel->mMeshes[meshIdx];
-
-			vertices.clear();
-			indices.clear();
-			vertices.reserve(mixamoModel->mMeshes[meshIdx]->mNumVertices);
-			indices.reserve(mixamoModel->mMeshes[meshIdx]->mNumFaces * 3u);
-			nFaces += mixamoModel->mMeshes[meshIdx]->mNumFaces;
-
-			if (!mixamoModel->mMeshes[meshIdx]->mNormals)
-			{
-				Logger::Log("Could not find normals for mesh (mixamo)");
-				return false;
-			}
-
-			if (mixamoModel->mMeshes[meshIdx]->mNumFaces == 0u)
-			{
-				Logger::Log("Mesh (mixamo model) does not contain any faces");
-				continue;
-			}
-
-			for (std::uint32_t vertIdx = 0u; vertIdx < mixamoModel->mMeshes[meshIdx]->mNumVertices; vertIdx++)
-			{
-				auto v = mixamoModel->mMeshes[meshIdx]->mVertices[vertIdx];
-				auto n = mixamoModel->mMeshes[meshIdx]->mNormals[vertIdx];
-
-				ShaderPNS4_MD1::Vertex toAdd;
-				toAdd.Position = Vec4(v.x, v.y, v.z, 1.f);
-				toAdd.Normal = Vec4(n.x, n.y, n.z, 0.f);
-
-				vertices.push_back(toAdd);
-			}
-
-			std::vector<std::string> boneNames;
-			std::vector<Transform> boneOffsets;
-			boneNames.reserve(mixamoModel->mMeshes[meshIdx]->mNumBones);
-			boneOffsets.reserve(mixamoModel->mMeshes[meshIdx]->mNumBones);
-
-			for (std::uint32_t boneIdx = 0u; boneIdx < mixamoModel->mMeshes[meshIdx]->mNumBones; boneIdx++)
-			{
-				auto bone = mixamoModel->mMeshes[meshIdx]->mBones[boneIdx];
-				boneNames.push_back(std::string(bone->mName.C_Str()));
-				boneOffsets.push_back(Transform::FromTransformMatrix(
-					Matrix(
-						bone->mOffsetMatrix.a1, bone->mOffsetMatrix.a2, bone->mOffsetMatrix.a3, bone->mOffsetMatrix.a4,
-						bone->mOffsetMatrix.b1, bone->mOffsetMatrix.b2, bone->mOffsetMatrix.b3, bone->mOffsetMatrix.b4,
-						bone->mOffsetMatrix.c1, bone->mOffsetMatrix.c2, bone->mOffsetMatrix.c3, bone->mOffsetMatrix.c4,
-						bone->mOffsetMatrix.d1, bone->mOffsetMatrix.d2, bone->mOffsetMatrix.d3, bone->mOffsetMatrix.d4
-						)));
-			}
-
-			unsigned int k = 0u;
-			for (std::uint32_t faceIdx = 0u; faceIdx < mixamoModel->mMeshes[meshIdx]->mNumFaces; faceIdx++)
-			{
-#if defined(DEBUG) | defined(_DEBUG)
-				if (mixamoModel->mMeshes[meshIdx]->mFaces[faceIdx].mNumIndices != 3u)
-				{
-					Logger::Log("Mesh (mixamo model) does not contain triangulated faces");
-					return false;
-				}
-#endif
-
-				indices.push_back(mixamoModel->mMeshes[meshIdx]->mFaces[faceIdx].mIndices[0u]);
-				indices.push_back(mixamoModel->mMeshes[meshIdx]->mFaces[faceIdx].mIndices[1u]);
-				indices.push_back(mixamoModel->mMeshes[meshIdx]->mFaces[faceIdx].mIndices[2u]);
-			}
-
-			// Vertices and indices are loaded, create buffers
-			D3D11_BUFFER_DESC vbDesc = { 0 };
-			vbDesc.BindFlags = D3D11_BIND_VERTEX_BUFFER;
-			vbDesc.ByteWidth = sizeof(ShaderPNS4_MD1::Vertex) * (UINT)vertices.size();
-			vbDesc.CPUAccessFlags = 0x00;
-			vbDesc.MiscFlags = 0x00;
-			vbDesc.StructureByteStride = 0x00;
-			vbDesc.Usage = D3D11_USAGE_IMMUTABLE;
-
-			D3D11_BUFFER_DESC ibDesc = { 0 };
-			ibDesc.BindFlags = D3D11_BIND_INDEX_BUFFER;
-			ibDesc.ByteWidth = sizeof(std::uint32_t) * (UINT)indices.size();
-			ibDesc.CPUAccessFlags = 0x00;
-			ibDesc.MiscFlags = 0x00;
-			ibDesc.StructureByteStride = 0x00;
-			ibDesc.Usage = D3D11_USAGE_IMMUTABLE;
-
-			// Vector elements must be stored contiguously. As per the C++11 standard,
-			//  they don't necessarily have to be stored as an array, but the identity
-			//  &v[n] = &v[0] + n for all 0 <= n < v.size() must hold true.
-			// http://www.open-std.org/jtc1/sc22/wg21/docs/lwg-defects.html#69
-			D3D11_SUBRESOURCE_DATA vertexData = { 0 };
-			D3D11_SUBRESOURCE_DATA indexData = { 0 };
-			vertexData.pSysMem = &vertices[0];
-			indexData.pSysMem = &indices[0];
-
-			HRESULT hr = { 0 };
-			ModelData nextModel;
-			hr = device->CreateBuffer(&vbDesc, &vertexData, &(nextModel.VertexBuffer));
-			VALIDATE(hr, "Failed to create vertex buffer (road model)");
-
-			hr = device->CreateBuffer(&ibDesc, &indexData, &nextModel.IndexBuffer);
-			VALIDATE(hr, "Failed to create index buffer (road model)");
-
-			nextModel.NumIndices = (std::uint32_t)indices.size();
-
-			// Material
-			auto foo = mixamoModel->mMaterials[mixamoModel->mMeshes[meshIdx]->mMaterialIndex];
-			aiColor4D diffuseColor;
-			aiColor4D ambientColor;
-			aiColor4D specularColor;
-			float shininess;
-
-			aiGetMaterialColor(foo, AI_MATKEY_COLOR_DIFFUSE, &diffuseColor);
-			aiGetMaterialColor(foo, AI_MATKEY_COLOR_DIFFUSE, &ambientColor);
-			aiGetMaterialColor(foo, AI_MATKEY_COLOR_SPECULAR, &specularColor);
-			aiGetMaterialFloat(foo, AI_MATKEY_SHININESS, &shininess);
-
-			nextModel.Material.AmbientColor = { ambientColor.r, ambientColor.g, ambientColor.b, ambientColor.a };
-			nextModel.Material.DiffuseColor = { diffuseColor.r, diffuseColor.g, diffuseColor.b, diffuseColor.a };
-			nextModel.Material.SpecularColor = { specularColor.r, specularColor.g, specularColor.b, specularColor.a };
-			nextModel.Material.SpecularColor.w = shininess;
-
-			// Transform
-			nextModel.Transform = Transform(); // Default identity transformation. We'll try this out.
-
-			models_.push_back(nextModel); // Lol, add the new model to the list!
+			BuildSkinningPalette(&palette_[0], &models[modelIdx].BoneIndices[0], &models[modelIdx].BoneOffsets[0],
+				(std::uint32_t)skinningPalettes_[modelIdx].size(), &skinningPalettes_[modelIdx][0]);
 		}
 	}
 
-	aiReleaseImport(mixamoModel);
-	aiReleaseImport(animation);
+	return true;
+}
 
-	std::stringstream ss;
-	ss << "The mixamo model has " << nFaces << " faces. Crazy, right?";
-	Logger::Log(ss.str());
+void MixamoCharacter::Evaluate(const AnimationLodLevel* lod)
+{
+	if (blendTree_ != nullptr)
+	{
+		// Bone masks are not applied - the tree's clips may be of either format
+		blendTree_->Evaluate(blendState_, blendPosePool, pose_);
+	}
+	else if (resources_->GetClipFormat() == MixamoCharacterResources::CLIP_FORMAT::RESAMPLED)
+	{
+		// Sampling a resampled clip costs the same for any number of bones, so it takes no bone mask
+		assert(lod == nullptr || lod->BoneMask.empty());
+		SampleClip(resources_->GetResampledClip(clipIdx_), time_, pose_);
+	}
+	else
+	{
+		const std::uint8_t* boneMask = (lod != nullptr && !lod->BoneMask.empty()) ? &lod->BoneMask[0] : nullptr;
+		SampleClip(resources_->GetClip(clipIdx_), time_, &cursors_[0], &resources_->GetSkeleton(), boneMask, pose_);
+	}
+	resources_->GetSkeleton().GetModelPose(pose_);
+	if (!evaluatedPalette_.empty())
+	{
+		BuildMatrixPalette(pose_, &evaluatedPalette_[0]);
+	}
+}
+
+void MixamoCharacter::AddToHierarchy(TransformHierarchy& hierarchy, std::uint32_t parentNode)
+{
+	ISceneNode::AddToHierarchy(hierarchy, parentNode);
+
+	modelNodes_.clear();
+	for (const MixamoCharacterResources::ModelData& model : resources_->GetModels())
+	{
+		modelNodes_.push_back(hierarchy.AddNode(hierarchyNode_, model.Transform));
+	}
+}
+
+bool MixamoCharacter::Render(RenderQueue& queue)
+{
+	assert(hierarchy_ != nullptr);
+
+	// Each mesh has its own palette, indexed by the palette indices of its vertices. Meshes
+	//  are shared by the whole crowd, so each becomes an instance of one draw for all characters.
+	const std::vector<MixamoCharacterResources::ModelData>& models = resources_->GetModels();
+	for (std::uint32_t modelIdx = 0u; modelIdx < models.size(); modelIdx++)
+	{
+		const std::vector<Matrix3x4>& skinningPalette = skinningPalettes_[modelIdx];
+		std::uint32_t paletteOffset = skinningPalette.empty() ? RenderQueue::INVALID_KEY : queue.AddPalette(&skinningPalette[0], (std::uint32_t)skinningPalette.size());
+		queue.AddDraw(DrawPacket(RenderQueue::SCENE_PASS, shaderKey_, models[modelIdx].MaterialKey, models[modelIdx].MeshKey, paletteOffset, hierarchy_->GetWorldMatrix(modelNodes_[modelIdx])));
+	}
 
 	return true;
 }
\ No newline at end of file
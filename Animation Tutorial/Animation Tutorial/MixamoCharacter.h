@@ -2,57 +2,92 @@
 
 #include "ISceneNode.h"
 #include "ShaderPNS4_MD1.h"
+#include "MixamoCharacterResources.h"
+#include "AnimationLod.h"
+#include "BlendTree.h"
+#include "Pose.h"
+#include "Matrix3x4.h"
 #include <wrl.h>
-#include <string>
 #include <memory>
-#include <map>
 #include <vector>
 using Microsoft::WRL::ComPtr;
 
+// One Mixamo character in the scene. Meshes, skeleton and clips are shared through
+//  MixamoCharacterResources - an instance only holds its own playback state and pose,
+//  so large crowds of characters stay cheap in memory.
 class MixamoCharacter : public ISceneNode
 {
-protected:
-	struct ModelData
-	{
-	public:
-		std::uint32_t NumIndices;
-		ComPtr<ID3D11Buffer> VertexBuffer;
-		ComPtr<ID3D11Buffer> IndexBuffer;
-		Material Material;
-		Transform Transform;
-
-		ModelData()
-			: NumIndices(0u)
-			, VertexBuffer(nullptr)
-			, IndexBuffer(nullptr)
-			, Material(Material::BasicGray)
-			, Transform()
-		{}
-	};
-
-protected:
-	static const char * MODEL_FILENAME;
-	static const char * ANIMATION_FILENAME;
-
 public:
 	MixamoCharacter() = delete;
 	~MixamoCharacter() = default;
 	MixamoCharacter(const MixamoCharacter&) = delete;
-	MixamoCharacter(std::shared_ptr<ShaderPNS4_MD1> shader, ComPtr<ID3D11DeviceContext> context, Transform transform);
+	MixamoCharacter(std::shared_ptr<const MixamoCharacterResources> resources, std::uint32_t shaderKey, Transform transform);
 
-	std::future<bool> Initialize(ComPtr<ID3D11Device> device);
 	void SetTransform(Transform transform);
 
+	// Clips always loop. Start time can be used to keep a crowd out of step.
+	void PlayClip(std::uint32_t clipIdx, float startTime);
+
+	// Plays a blend tree in place of a single clip, until the next PlayClip. Trees are shared,
+	//  and built from the clips of the resources - each character keeps its own parameters.
+	void PlayBlendTree(std::shared_ptr<const BlendTree> blendTree);
+	void SetBlendParameter(std::uint32_t parameterIdx, float value);
+
+	// Levels are shared by a crowd, and built for the skeleton of the resources. Characters
+	//  with the same update interval evaluate on different frames when given different
+	//  update phases, such as their index in the crowd.
+	void SetAnimationLod(std::shared_ptr<const std::vector<AnimationLodLevel>> lodLevels, std::uint32_t updatePhase);
+
+	// Picks the level to use from the distance between the character and the viewer
+	void SelectLod(const Vec3& viewerPosition);
+	std::uint32_t GetLod() const { return lodIdx_; }
+
+	// Model space transform of every skeleton bone, as of the last full evaluation
+	const Pose& GetPose() const { return pose_; }
+
+	// Model space matrix of every skeleton bone, as of the last update. Interpolated
+	//  between evaluations when the level of detail updates less than every frame.
+	const std::vector<Matrix3x4>& GetPalette() const { return palette_; }
+
+	// Palette the shader skins a model of the resources with, as of the last update - the
+	//  matrices above of the model's bones, times their offsets
+	const std::vector<Matrix3x4>& GetSkinningPalette(std::uint32_t modelIdx) const { return skinningPalettes_[modelIdx]; }
+
 public:
 	// Inherited via ISceneNode
 	virtual bool Update(float dt) override;
-	virtual bool Render() override;
+	virtual bool Render(RenderQueue& queue) override;
+	virtual void AddToHierarchy(TransformHierarchy& hierarchy, std::uint32_t parentNode) override;
 
 private:
-	bool InitVertexAndIndexBuffers(ComPtr<ID3D11Device> device);
+	// Samples the clip or blend tree at the current time into pose_, and its palette into evaluatedPalette_
+	void Evaluate(const AnimationLodLevel* lod);
 
 private:
-	ComPtr<ID3D11DeviceContext> renderContext_;
-	std::shared_ptr<ShaderPNS4_MD1> shader_;
-	std::vector<ModelData> models_;
+	std::uint32_t shaderKey_;
+	std::shared_ptr<const MixamoCharacterResources> resources_;
+
+	// Child hierarchy node of each model of the resources, placed at the model's transform
+	std::vector<std::uint32_t> modelNodes_;
+
+	// Per-instance playback state
+	std::uint32_t clipIdx_;
+	float time_;
+	std::vector<BoneAnimation::Cursor> cursors_;
+	Pose pose_;
+	std::vector<Matrix3x4> palette_;
+	std::vector<std::vector<Matrix3x4>> skinningPalettes_;
+	std::shared_ptr<const BlendTree> blendTree_;
+	BlendTree::State blendState_;
+
+	// Level of detail state
+	std::shared_ptr<const std::vector<AnimationLodLevel>> lodLevels_;
+	std::uint32_t lodIdx_;
+	std::uint32_t updatePhase_;
+	std::uint32_t frameIdx_;
+	bool isEvaluated_;
+	float timeSinceEvaluation_;
+	float evaluationGap_;
+	std::vector<Matrix3x4> previousPalette_;
+	std::vector<Matrix3x4> evaluatedPalette_;
 };
\ No newline at end of file
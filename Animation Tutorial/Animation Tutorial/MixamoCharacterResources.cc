@@ -0,0 +1,638 @@
+#include "MixamoCharacterResources.h"
+#include "ClipCompressor.h"
+#include "Logger.h"
+#include "MeshBaker.h"
+#include "MeshProcessing.h"
+#include "MatrixPalette.h"
+#include <assimp/cimport.h>
+#include <assimp/scene.h>
+#include <assimp/postprocess.h>
+#include <assimp/material.h>
+#include <assimp/config.h>
+#include <chrono>
+#include <sstream>
+#include <queue>
+
+#ifndef VALIDATE
+#define VALIDATE(hr, msg) if (FAILED(hr)) { Logger::Log(msg); return false; }
+#endif
+
+const char * MixamoCharacterResources::MODEL_FILENAME = "../../assets/Beta.fbx";
+const char * MixamoCharacterResources::BAKED_MODEL_FILENAME = "../../assets/Beta.mesh";
+const char * MixamoCharacterResources::ANIMATION_FILENAME = "../../assets/samba_dancing.fbx";
+
+// Weights to a 65536th are well beyond what anyone can see, at 12 bytes a vertex
+const INFLUENCE_WEIGHT_FORMAT MixamoCharacterResources::INFLUENCE_FORMAT = INFLUENCE_WEIGHT_FORMAT::UNORM16;
+
+namespace
+{
+
+// Model units are centimeters - allow a tenth of a millimeter of error, measured 3cm from each bone
+const float CLIP_TOLERANCE = 0.01f;
+const float CLIP_SHELL_DISTANCE = 3.f;
+
+// Largest relative difference allowed between a mesh's bone offsets and the skeleton's bind pose
+const float BIND_OFFSET_TOLERANCE = 1e-3f;
+
+// The offsets of a mesh bound in the skeleton's bind pose are the skeleton's inverse bind
+//  transforms, and those are used, so the mesh and the clips share one bind pose. A mesh bound
+//  in some other pose keeps the offsets it was loaded with.
+void UseSkeletonBindOffsets(const Skeleton& skeleton, std::uint32_t meshIdx, MixamoCharacterResources::ModelData& model)
+{
+	std::uint32_t numBones = (std::uint32_t)model.BoneIndices.size();
+	if (numBones == 0u)
+	{
+		return;
+	}
+
+	std::vector<Matrix3x4> bindOffsets(numBones);
+	BuildBindOffsets(skeleton, &model.BoneIndices[0], numBones, &bindOffsets[0]);
+	float difference = MeasureOffsetDifference(&model.BoneOffsets[0], &bindOffsets[0], numBones);
+	if (difference <= BIND_OFFSET_TOLERANCE)
+	{
+		model.BoneOffsets.swap(bindOffsets);
+		return;
+	}
+
+	std::stringstream ss;
+	ss << "Mixamo mesh " << meshIdx << " is not bound in the skeleton's bind pose (offsets differ by up to " << difference << "), keeping its own offsets";
+	Logger::Log(ss.str());
+}
+
+Matrix ToMatrix(const aiMatrix4x4& m)
+{
+	return Matrix(
+		m.a1, m.a2, m.a3, m.a4,
+		m.b1, m.b2, m.b3, m.b4,
+		m.c1, m.c2, m.c3, m.c4,
+		m.d1, m.d2, m.d3, m.d4
+		);
+}
+
+Transform ToTransform(const aiMatrix4x4& m)
+{
+	return Transform::FromTransformMatrix(ToMatrix(m));
+}
+
+// Uploads the influence stream of a mesh, and builds the mesh for CPU skinning
+bool InitInfluences(ComPtr<ID3D11Device> device, const ShaderPNS4_MD1::Vertex* vertices, const void* influences, std::uint32_t numVertices,
+	INFLUENCE_WEIGHT_FORMAT format, MixamoCharacterResources::ModelData& outModel)
+{
+	std::uint32_t influenceSize = GetPackedInfluenceSize(format);
+
+	D3D11_BUFFER_DESC desc = {};
+	desc.BindFlags = D3D11_BIND_VERTEX_BUFFER;
+	desc.ByteWidth = influenceSize * numVertices;
+	desc.Usage = D3D11_USAGE_IMMUTABLE;
+
+	D3D11_SUBRESOURCE_DATA data = {};
+	data.pSysMem = influences;
+
+	HRESULT hr = device->CreateBuffer(&desc, &data, &outModel.InfluenceBuffer);
+	VALIDATE(hr, "Failed to create influence buffer (mixamo model)");
+	outModel.InfluenceFormat = format;
+	outModel.InfluenceStride = influenceSize;
+
+	std::shared_ptr<SkinningMesh> skinningMesh = std::make_shared<SkinningMesh>(numVertices);
+	for (std::uint32_t vertIdx = 0u; vertIdx < numVertices; vertIdx++)
+	{
+		std::uint8_t boneIndices[VertexInfluences::MAX_INFLUENCES];
+		float weights[VertexInfluences::MAX_INFLUENCES];
+		UnpackInfluences(static_cast<const char*>(influences) + vertIdx * influenceSize, format, boneIndices, weights);
+
+		const ShaderPNS4_MD1::Vertex& vertex = vertices[vertIdx];
+		skinningMesh->SetVertex(vertIdx, Vec3(vertex.Position.x, vertex.Position.y, vertex.Position.z), Vec3(vertex.Normal.x, vertex.Normal.y, vertex.Normal.z),
+			boneIndices, weights, VertexInfluences::MAX_INFLUENCES);
+	}
+	outModel.SkinningMesh = skinningMesh;
+
+	return true;
+}
+
+}
+
+MixamoCharacterResources::MixamoCharacterResources(CLIP_FORMAT clipFormat)
+	: models_()
+	, skeleton_()
+	, clipFormat_(clipFormat)
+	, clipDurations_()
+	, clips_()
+	, resampledClips_()
+{}
+
+std::future<bool> MixamoCharacterResources::Initialize(ComPtr<ID3D11Device> device)
+{
+	return std::async(std::launch::async, [this, device] {
+		Logger::Log("Loading mixamo character");
+		auto loadStart = std::chrono::high_resolution_clock::now();
+
+		auto ap = std::async(std::launch::async, [] { return aiImportFile(MixamoCharacterResources::ANIMATION_FILENAME, aiProcessPreset_TargetRealtime_MaxQuality); });
+
+		// The FBX model is only imported if there is no baked mesh to use instead
+		std::shared_ptr<BakedMesh> bakedMesh = BakedMesh::Load(MixamoCharacterResources::BAKED_MODEL_FILENAME);
+		const aiScene* mixamoModel = nullptr;
+		if (!bakedMesh)
+		{
+			Logger::Log("No baked mixamo mesh found, importing FBX instead (run with --bake to create it)");
+			mixamoModel = aiImportFile(MixamoCharacterResources::MODEL_FILENAME, aiProcessPreset_TargetRealtime_MaxQuality);
+		}
+
+		const aiScene* animation = ap.get();
+		if ((!bakedMesh && !mixamoModel) || !animation)
+		{
+			Logger::Log("Failed to load mixamo character model!");
+			aiReleaseImport(mixamoModel);
+			aiReleaseImport(animation);
+			return false;
+		}
+
+		// Skeleton has to come first, so that mesh bones can be resolved to skeleton indices
+		bool isValid = InitSkeletonAndClips(animation)
+			&& (bakedMesh ? InitFromBakedMesh(device, *bakedMesh) : InitVertexAndIndexBuffers(device, mixamoModel));
+
+		aiReleaseImport(mixamoModel);
+		aiReleaseImport(animation);
+
+		std::stringstream ss;
+		ss << "Mixamo character loaded from " << (bakedMesh ? "baked mesh" : "FBX") << " in "
+			<< std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::high_resolution_clock::now() - loadStart).count() / 1000.f << "ms";
+		Logger::Log(ss.str());
+
+		return isValid;
+	});
+}
+
+void MixamoCharacterResources::AddMeshes(D3D11RenderBackend& backend)
+{
+	for (ModelData& model : models_)
+	{
+		model.MaterialKey = backend.AddMaterial(model.Material);
+		model.MeshKey = backend.AddMesh(D3D11RenderBackend::Mesh(model.VertexBuffer, model.IndexBuffer, model.IndexFormat, sizeof(ShaderPNS4_MD1::Vertex), model.NumIndices,
+			model.InfluenceBuffer, model.InfluenceStride));
+	}
+}
+
+bool MixamoCharacterResources::Bake()
+{
+	return BakeMesh(MixamoCharacterResources::MODEL_FILENAME, MixamoCharacterResources::BAKED_MODEL_FILENAME, MeshBakeOptions(false, INFLUENCE_FORMAT));
+}
+
+bool MixamoCharacterResources::InitSkeletonAndClips(const aiScene* animation)
+{
+	if (animation->mNumAnimations == 0u)
+	{
+		Logger::Log("Mixamo animation file does not contain any animations");
+		return false;
+	}
+
+	// Breadth first walk of the node hierarchy, which adds every parent before its children
+	skeleton_.Clear();
+	std::queue<std::pair<const aiNode*, std::uint32_t>> toVisit;
+	toVisit.push({ animation->mRootNode, Skeleton::INVALID_INDEX });
+	while (!toVisit.empty())
+	{
+		const aiNode* node = toVisit.front().first;
+		std::uint32_t parentIdx = toVisit.front().second;
+		toVisit.pop();
+
+		std::uint32_t boneIdx = skeleton_.AddBone(node->mName.C_Str(), parentIdx, ToTransform(node->mTransformation));
+		for (std::uint32_t childIdx = 0u; childIdx < node->mNumChildren; childIdx++)
+		{
+			toVisit.push({ node->mChildren[childIdx], boneIdx });
+		}
+	}
+
+	clipDurations_.clear();
+	clips_.clear();
+	resampledClips_.clear();
+
+	// Constant channel report, over the whole clip library
+	std::uint32_t libraryChannels = 0u;
+	std::uint32_t libraryConstantChannels = 0u;
+	std::uint32_t libraryStaticBones = 0u;
+	for (std::uint32_t animIdx = 0u; animIdx < animation->mNumAnimations; animIdx++)
+	{
+		const aiAnimation* anim = animation->mAnimations[animIdx];
+		float ticksPerSecond = (anim->mTicksPerSecond > 0.0) ? (float)anim->mTicksPerSecond : 25.f;
+
+		// Reserved up front - boneAnimations points into this vector
+		std::vector<BoneAnimation> tracks;
+		tracks.reserve(anim->mNumChannels);
+		std::vector<const BoneAnimation*> boneAnimations(skeleton_.GetBoneCount(), nullptr);
+
+		for (std::uint32_t channelIdx = 0u; channelIdx < anim->mNumChannels; channelIdx++)
+		{
+			const aiNodeAnim* channel = anim->mChannels[channelIdx];
+			std::uint32_t boneIdx = skeleton_.GetBoneIndex(channel->mNodeName.C_Str());
+			if (boneIdx == Skeleton::INVALID_INDEX)
+			{
+				Logger::Log("Mixamo animation channel does not match any node in the skeleton");
+				continue;
+			}
+
+			// Any channel without keys holds the bind transform
+			const Transform& bind = skeleton_.GetBone(boneIdx).FromParentTransform;
+			std::vector<PositionKeyframe> positions;
+			std::vector<RotationKeyframe> rotations;
+			std::vector<ScaleKeyframe> scales;
+
+			for (std::uint32_t keyIdx = 0u; keyIdx < channel->mNumPositionKeys; keyIdx++)
+			{
+				const aiVectorKey& key = channel->mPositionKeys[keyIdx];
+				positions.push_back(PositionKeyframe((float)key.mTime / ticksPerSecond, Vec3(key.mValue.x, key.mValue.y, key.mValue.z)));
+			}
+			if (positions.empty()) positions.push_back(PositionKeyframe(0.f, bind.Pos));
+
+			for (std::uint32_t keyIdx = 0u; keyIdx < channel->mNumRotationKeys; keyIdx++)
+			{
+				const aiQuatKey& key = channel->mRotationKeys[keyIdx];
+				rotations.push_back(RotationKeyframe((float)key.mTime / ticksPerSecond, Quaternion(key.mValue.w, key.mValue.x, key.mValue.y, key.mValue.z)));
+			}
+			if (rotations.empty()) rotations.push_back(RotationKeyframe(0.f, bind.Rotation));
+
+			for (std::uint32_t keyIdx = 0u; keyIdx < channel->mNumScalingKeys; keyIdx++)
+			{
+				const aiVectorKey& key = channel->mScalingKeys[keyIdx];
+				scales.push_back(ScaleKeyframe((float)key.mTime / ticksPerSecond, Vec3(key.mValue.x, key.mValue.y, key.mValue.z)));
+			}
+			if (scales.empty()) scales.push_back(ScaleKeyframe(0.f, bind.Scale));
+
+			tracks.push_back(BoneAnimation(positions, rotations, scales));
+			boneAnimations[boneIdx] = &tracks.back();
+		}
+
+		std::uint32_t constantChannels = 0u;
+		std::uint32_t staticBones = 0u;
+		for (auto&& track : tracks)
+		{
+			constantChannels += track.GetConstantChannelCount();
+			staticBones += track.IsStatic() ? 1u : 0u;
+		}
+		libraryChannels += (std::uint32_t)tracks.size() * 3u;
+		libraryConstantChannels += constantChannels;
+		libraryStaticBones += staticBones;
+
+		if (!tracks.empty())
+		{
+			std::stringstream ss;
+			ss << "Clip " << animIdx << " has " << constantChannels << " of " << tracks.size() * 3u << " channels constant ("
+				<< 100.f * constantChannels / (tracks.size() * 3u) << "%), and " << staticBones << " of " << tracks.size() << " animated bones static";
+			Logger::Log(ss.str());
+		}
+
+		std::shared_ptr<AnimationClip> clip = AnimationClip::Create(skeleton_, boneAnimations, (float)anim->mDuration / ticksPerSecond);
+		if (!clip)
+		{
+			return false;
+		}
+
+		std::stringstream ss;
+		if (clipFormat_ == CLIP_FORMAT::RESAMPLED)
+		{
+			ResampleStats stats;
+			std::shared_ptr<ResampledClip> resampledClip = ResampledClip::Create(*clip, ResampledClip::DEFAULT_SAMPLE_RATE, stats);
+			if (!resampledClip)
+			{
+				return false;
+			}
+			resampledClips_.push_back(resampledClip);
+
+			ss << "Clip " << animIdx << " resampled at " << resampledClip->GetSampleRate() << "Hz from " << clip->GetSizeInBytes() << " to " << stats.SizeInBytes
+				<< " bytes, max error position " << stats.MaxPositionError << ", rotation " << stats.MaxRotationError << " radians, scale " << stats.MaxScaleError;
+		}
+		else
+		{
+			ClipCompressionStats stats;
+			std::shared_ptr<CompressedClip> compressedClip = CompressClip(*clip, skeleton_, ClipCompressionOptions(CLIP_TOLERANCE, CLIP_SHELL_DISTANCE), stats);
+			if (!compressedClip)
+			{
+				return false;
+			}
+			clips_.push_back(compressedClip);
+
+			ss << "Clip " << animIdx << " compressed from " << stats.SourceBytes << " to " << stats.CompressedBytes << " bytes, "
+				<< stats.SourceKeys << " to " << stats.CompressedKeys << " keys, max error " << stats.MaxError;
+		}
+		clipDurations_.push_back(clip->GetDuration());
+		Logger::Log(ss.str());
+	}
+
+	std::stringstream ss;
+	ss << "Mixamo skeleton has " << skeleton_.GetBoneCount() << " bones, and " << clipDurations_.size() << " animation clip(s)";
+	Logger::Log(ss.str());
+
+	if (libraryChannels > 0u)
+	{
+		ss.str("");
+		ss << "Clip library: " << libraryConstantChannels << " of " << libraryChannels << " channels constant ("
+			<< 100.f * libraryConstantChannels / libraryChannels << "%) and stored as a single key, " << libraryStaticBones << " static bones";
+		Logger::Log(ss.str());
+	}
+
+	return true;
+}
+
+bool MixamoCharacterResources::InitVertexAndIndexBuffers(ComPtr<ID3D11Device> device, const aiScene* mixamoModel)
+{
+	std::uint32_t nFaces = 0u;
+
+	// Create each model, each of which should have a different material for use
+	models_.reserve(mixamoModel->mNumMeshes);
+
+	// Block to introduce scope of the vector
+	{
+		// Using a vector to prevent frequent memory allocations and frees between models in the mesh
+		std::vector<ShaderPNS4_MD1::Vertex> vertices;
+		std::vector<std::uint32_t> indices;
+		std::vector<std::uint16_t> shortIndices;
+		std::vector<VertexInfluences> influences;
+		std::vector<std::uint32_t> paletteBones;
+		std::vector<char> packedInfluences;
+		std::vector<char> interleaved;
+		for (std::uint32_t meshIdx = 0u; meshIdx < mixamoModel->mNumMeshes; meshIdx++)
+		{
+			auto mesh = mixamoModel->mMeshes[meshIdx];
+
+			vertices.clear();
+			indices.clear();
+			vertices.reserve(mixamoModel->mMeshes[meshIdx]->mNumVertices);
+			indices.reserve(mixamoModel->mMeshes[meshIdx]->mNumFaces * 3u);
+			nFaces += mixamoModel->mMeshes[meshIdx]->mNumFaces;
+
+			if (!mixamoModel->mMeshes[meshIdx]->mNormals)
+			{
+				Logger::Log("Could not find normals for mesh (mixamo)");
+				return false;
+			}
+
+			if (mixamoModel->mMeshes[meshIdx]->mNumFaces == 0u)
+			{
+				Logger::Log("Mesh (mixamo model) does not contain any faces");
+				continue;
+			}
+
+			for (std::uint32_t vertIdx = 0u; vertIdx < mixamoModel->mMeshes[meshIdx]->mNumVertices; vertIdx++)
+			{
+				auto v = mixamoModel->mMeshes[meshIdx]->mVertices[vertIdx];
+				auto n = mixamoModel->mMeshes[meshIdx]->mNormals[vertIdx];
+
+				ShaderPNS4_MD1::Vertex toAdd;
+				toAdd.Position = Vec4(v.x, v.y, v.z, 1.f);
+				toAdd.Normal = Vec4(n.x, n.y, n.z, 0.f);
+
+				vertices.push_back(toAdd);
+			}
+
+			// Only the bones some vertex keeps an influence on make it into the palette
+			influences.clear();
+			paletteBones.clear();
+			if (mesh->mNumBones > 0u)
+			{
+				GatherInfluences(mesh, influences);
+				CompactInfluencePalette(influences, mesh->mNumBones, paletteBones);
+				if (paletteBones.size() > MAX_PALETTE_BONES)
+				{
+					Logger::Log("Mixamo mesh has more influencing bones than a palette can index");
+					return false;
+				}
+
+				InfluenceStats influenceStats = MeasureInfluences(influences);
+				std::stringstream ss;
+				ss << "Mixamo mesh " << meshIdx << " influences: " << paletteBones.size() << " of " << mesh->mNumBones << " bones used, "
+					<< influenceStats.NumTruncatedVertices << " of " << influenceStats.NumVertices << " vertices lost weight (at most "
+					<< 100.f * influenceStats.MaxLostWeight << "%), " << influenceStats.NumUnweightedVertices << " unweighted";
+				Logger::Log(ss.str());
+			}
+
+			ModelData nextModel;
+			nextModel.BoneIndices.reserve(paletteBones.size());
+			nextModel.BoneOffsets.reserve(paletteBones.size());
+
+			for (std::uint32_t paletteIdx = 0u; paletteIdx < paletteBones.size(); paletteIdx++)
+			{
+				auto bone = mesh->mBones[paletteBones[paletteIdx]];
+				std::uint32_t skeletonIdx = skeleton_.GetBoneIndex(bone->mName.C_Str());
+				if (skeletonIdx == Skeleton::INVALID_INDEX)
+				{
+					Logger::Log("Mixamo mesh bone does not match any bone in the animation skeleton");
+					return false;
+				}
+
+				nextModel.BoneIndices.push_back(skeletonIdx);
+				nextModel.BoneOffsets.push_back(ToMatrix3x4(ToMatrix(bone->mOffsetMatrix)));
+			}
+			UseSkeletonBindOffsets(skeleton_, meshIdx, nextModel);
+
+			for (std::uint32_t faceIdx = 0u; faceIdx < mixamoModel->mMeshes[meshIdx]->mNumFaces; faceIdx++)
+			{
+#if defined(DEBUG) | defined(_DEBUG)
+				if (mixamoModel->mMeshes[meshIdx]->mFaces[faceIdx].mNumIndices != 3u)
+				{
+					Logger::Log("Mesh (mixamo model) does not contain triangulated faces");
+					return false;
+				}
+#endif
+
+				indices.push_back(mixamoModel->mMeshes[meshIdx]->mFaces[faceIdx].mIndices[0u]);
+				indices.push_back(mixamoModel->mMeshes[meshIdx]->mFaces[faceIdx].mIndices[1u]);
+				indices.push_back(mixamoModel->mMeshes[meshIdx]->mFaces[faceIdx].mIndices[2u]);
+			}
+
+			// Influences are packed per vertex, and travel with their vertex while it is reordered
+			std::uint32_t influenceSize = paletteBones.empty() ? 0u : GetPackedInfluenceSize(INFLUENCE_FORMAT);
+			packedInfluences.resize(vertices.size() * influenceSize);
+			for (std::uint32_t vertIdx = 0u; vertIdx < vertices.size() && influenceSize > 0u; vertIdx++)
+			{
+				PackInfluences(influences[vertIdx], INFLUENCE_FORMAT, &packedInfluences[vertIdx * influenceSize]);
+			}
+
+			std::uint32_t interleavedStride = sizeof(ShaderPNS4_MD1::Vertex) + influenceSize;
+			interleaved.resize(vertices.size() * interleavedStride);
+			InterleaveStreams(&vertices[0], sizeof(ShaderPNS4_MD1::Vertex), packedInfluences.empty() ? nullptr : &packedInfluences[0], influenceSize,
+				(std::uint32_t)vertices.size(), &interleaved[0]);
+
+			// Assimp emits triangles in source order - reorder them for the vertex cache
+			MeshOptimizationStats optimizationStats;
+			std::uint32_t numVertices = OptimizeMesh(&interleaved[0], interleavedStride, (std::uint32_t)vertices.size(), indices, optimizationStats);
+			vertices.erase(vertices.begin() + numVertices, vertices.end());
+			packedInfluences.resize(numVertices * influenceSize);
+			DeinterleaveStreams(&interleaved[0], sizeof(ShaderPNS4_MD1::Vertex), influenceSize, numVertices, &vertices[0], packedInfluences.empty() ? nullptr : &packedInfluences[0]);
+
+			std::stringstream ss;
+			ss << "Mixamo mesh " << meshIdx << " ACMR " << optimizationStats.Before.ACMR << " -> " << optimizationStats.After.ACMR
+				<< ", ATVR " << optimizationStats.Before.ATVR << " -> " << optimizationStats.After.ATVR;
+			Logger::Log(ss.str());
+
+			std::uint32_t indexSize = GetIndexSize(numVertices);
+			if (indexSize == sizeof(std::uint16_t))
+			{
+				NarrowIndices(indices, shortIndices);
+			}
+
+			// Vertices and indices are loaded, create buffers
+			D3D11_BUFFER_DESC vbDesc = {};
+			vbDesc.BindFlags = D3D11_BIND_VERTEX_BUFFER;
+			vbDesc.ByteWidth = sizeof(ShaderPNS4_MD1::Vertex) * (UINT)vertices.size();
+			vbDesc.CPUAccessFlags = 0x00;
+			vbDesc.MiscFlags = 0x00;
+			vbDesc.StructureByteStride = 0x00;
+			vbDesc.Usage = D3D11_USAGE_IMMUTABLE;
+
+			D3D11_BUFFER_DESC ibDesc = {};
+			ibDesc.BindFlags = D3D11_BIND_INDEX_BUFFER;
+			ibDesc.ByteWidth = indexSize * (UINT)indices.size();
+			ibDesc.CPUAccessFlags = 0x00;
+			ibDesc.MiscFlags = 0x00;
+			ibDesc.StructureByteStride = 0x00;
+			ibDesc.Usage = D3D11_USAGE_IMMUTABLE;
+
+			// Vector elements must be stored contiguously. As per the C++11 standard,
+			//  they don't necessarily have to be stored as an array, but the identity
+			//  &v[n] = &v[0] + n for all 0 <= n < v.size() must hold true.
+			// http://www.open-std.org/jtc1/sc22/wg21/docs/lwg-defects.html#69
+			D3D11_SUBRESOURCE_DATA vertexData = {};
+			D3D11_SUBRESOURCE_DATA indexData = {};
+			vertexData.pSysMem = &vertices[0];
+			indexData.pSysMem = (indexSize == sizeof(std::uint16_t)) ? (const void*)&shortIndices[0] : (const void*)&indices[0];
+
+			HRESULT hr = S_OK;
+			hr = device->CreateBuffer(&vbDesc, &vertexData, &(nextModel.VertexBuffer));
+			VALIDATE(hr, "Failed to create vertex buffer (mixamo model)");
+
+			hr = device->CreateBuffer(&ibDesc, &indexData, &nextModel.IndexBuffer);
+			VALIDATE(hr, "Failed to create index buffer (mixamo model)");
+
+			if (influenceSize > 0u && !InitInfluences(device, &vertices[0], &packedInfluences[0], numVertices, INFLUENCE_FORMAT, nextModel))
+			{
+				return false;
+			}
+
+			nextModel.NumIndices = (std::uint32_t)indices.size();
+			nextModel.IndexFormat = (indexSize == sizeof(std::uint16_t)) ? DXGI_FORMAT_R16_UINT : DXGI_FORMAT_R32_UINT;
+
+			// Material
+			auto foo = mixamoModel->mMaterials[mixamoModel->mMeshes[meshIdx]->mMaterialIndex];
+			aiColor4D diffuseColor;
+			aiColor4D ambientColor;
+			aiColor4D specularColor;
+			float shininess;
+
+			aiGetMaterialColor(foo, AI_MATKEY_COLOR_DIFFUSE, &diffuseColor);
+			aiGetMaterialColor(foo, AI_MATKEY_COLOR_DIFFUSE, &ambientColor);
+			aiGetMaterialColor(foo, AI_MATKEY_COLOR_SPECULAR, &specularColor);
+			aiGetMaterialFloat(foo, AI_MATKEY_SHININESS, &shininess);
+
+			nextModel.Material.AmbientColor = { ambientColor.r, ambientColor.g, ambientColor.b, ambientColor.a };
+			nextModel.Material.DiffuseColor = { diffuseColor.r, diffuseColor.g, diffuseColor.b, diffuseColor.a };
+			nextModel.Material.SpecularColor = { specularColor.r, specularColor.g, specularColor.b, specularColor.a };
+			nextModel.Material.SpecularColor.w = shininess;
+
+			// Transform
+			nextModel.Transform = Transform(); // Default identity transformation. We'll try this out.
+
+			models_.push_back(nextModel); // Lol, add the new model to the list!
+		}
+	}
+
+	std::stringstream ss;
+	ss << "The mixamo model has " << nFaces << " faces. Crazy, right?";
+	Logger::Log(ss.str());
+
+	return true;
+}
+
+bool MixamoCharacterResources::InitFromBakedMesh(ComPtr<ID3D11Device> device, const BakedMesh& bakedMesh)
+{
+	std::uint32_t nIndices = 0u;
+	models_.reserve(bakedMesh.GetMeshCount());
+
+	for (std::uint32_t meshIdx = 0u; meshIdx < bakedMesh.GetMeshCount(); meshIdx++)
+	{
+		const BakedMesh::MeshEntry& mesh = bakedMesh.GetMesh(meshIdx);
+		if (mesh.VertexStride != sizeof(ShaderPNS4_MD1::Vertex))
+		{
+			Logger::Log("Baked mixamo mesh does not match the character vertex format - rebake it");
+			return false;
+		}
+
+		ModelData nextModel;
+		nextModel.BoneIndices.reserve(mesh.NumBones);
+		nextModel.BoneOffsets.reserve(mesh.NumBones);
+		for (std::uint32_t boneIdx = 0u; boneIdx < mesh.NumBones; boneIdx++)
+		{
+			std::uint32_t skeletonIdx = skeleton_.GetBoneIndex(bakedMesh.GetBoneName(meshIdx, boneIdx));
+			if (skeletonIdx == Skeleton::INVALID_INDEX)
+			{
+				Logger::Log("Mixamo mesh bone does not match any bone in the animation skeleton");
+				return false;
+			}
+
+			const float* m = bakedMesh.GetBone(meshIdx, boneIdx).OffsetMatrix;
+			nextModel.BoneIndices.push_back(skeletonIdx);
+			nextModel.BoneOffsets.push_back(ToMatrix3x4(
+				Matrix(
+					m[0], m[1], m[2], m[3],
+					m[4], m[5], m[6], m[7],
+					m[8], m[9], m[10], m[11],
+					m[12], m[13], m[14], m[15]
+					)));
+		}
+		UseSkeletonBindOffsets(skeleton_, meshIdx, nextModel);
+
+		D3D11_BUFFER_DESC vbDesc = {};
+		vbDesc.BindFlags = D3D11_BIND_VERTEX_BUFFER;
+		vbDesc.ByteWidth = mesh.VertexStride * mesh.NumVertices;
+		vbDesc.Usage = D3D11_USAGE_IMMUTABLE;
+
+		D3D11_BUFFER_DESC ibDesc = {};
+		ibDesc.BindFlags = D3D11_BIND_INDEX_BUFFER;
+		ibDesc.ByteWidth = mesh.IndexSize * mesh.NumIndices;
+		ibDesc.Usage = D3D11_USAGE_IMMUTABLE;
+
+		// Streams are uploaded straight out of the mapped file
+		D3D11_SUBRESOURCE_DATA vertexData = {};
+		D3D11_SUBRESOURCE_DATA indexData = {};
+		vertexData.pSysMem = bakedMesh.GetVertexData(meshIdx);
+		indexData.pSysMem = bakedMesh.GetIndexData(meshIdx);
+
+		HRESULT hr = S_OK;
+		hr = device->CreateBuffer(&vbDesc, &vertexData, &nextModel.VertexBuffer);
+		VALIDATE(hr, "Failed to create vertex buffer (baked mixamo model)");
+
+		hr = device->CreateBuffer(&ibDesc, &indexData, &nextModel.IndexBuffer);
+		VALIDATE(hr, "Failed to create index buffer (baked mixamo model)");
+
+		if (mesh.NumBones > 0u && bakedMesh.GetInfluenceData(meshIdx) == nullptr)
+		{
+			Logger::Log("Baked mixamo mesh has no bone influences - rebake it");
+			return false;
+		}
+
+		if (bakedMesh.GetInfluenceData(meshIdx) != nullptr && (INFLUENCE_WEIGHT_FORMAT)mesh.InfluenceFormat != INFLUENCE_FORMAT)
+		{
+			Logger::Log("Baked mixamo mesh influences do not match the skinning shader's weight format - rebake it");
+			return false;
+		}
+
+		if (bakedMesh.GetInfluenceData(meshIdx) != nullptr
+			&& !InitInfluences(device, static_cast<const ShaderPNS4_MD1::Vertex*>(bakedMesh.GetVertexData(meshIdx)), bakedMesh.GetInfluenceData(meshIdx),
+				mesh.NumVertices, (INFLUENCE_WEIGHT_FORMAT)mesh.InfluenceFormat, nextModel))
+		{
+			return false;
+		}
+
+		nextModel.NumIndices = mesh.NumIndices;
+		nextModel.IndexFormat = (mesh.IndexSize == sizeof(std::uint16_t)) ? DXGI_FORMAT_R16_UINT : DXGI_FORMAT_R32_UINT;
+		nextModel.Material = bakedMesh.GetMaterial(meshIdx);
+		nextModel.Transform = Transform();
+		nIndices += mesh.NumIndices;
+
+		models_.push_back(nextModel);
+	}
+
+	std::stringstream ss;
+	ss << "The baked mixamo model has " << nIndices / 3u << " faces";
+	Logger::Log(ss.str());
+
+	return true;
+}
\ No newline at end of file
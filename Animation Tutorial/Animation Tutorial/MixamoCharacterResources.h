@@ -0,0 +1,127 @@
+#pragma once
+
+#include "ShaderPNS4_MD1.h"
+#include "D3D11RenderBackend.h"
+#include "RenderQueue.h"
+#include "Skeleton.h"
+#include "CompressedClip.h"
+#include "ResampledClip.h"
+#include "BakedMesh.h"
+#include "SkinningMesh.h"
+#include "SkinWeights.h"
+#include "Matrix3x4.h"
+#include <wrl.h>
+#include <future>
+#include <memory>
+#include <vector>
+using Microsoft::WRL::ComPtr;
+
+struct aiScene;
+
+// Everything about a Mixamo character that is the same for every copy of it - GPU mesh
+//  buffers, materials, the skeleton and the clip library. Loaded once and shared by all
+//  MixamoCharacter instances, which only keep their own playback state and pose. Clips
+//  are converted to their runtime format as they are loaded, and only that form is kept.
+class MixamoCharacterResources
+{
+public:
+	// Compressed clips are the smallest, resampled clips are the fastest to sample
+	enum class CLIP_FORMAT
+	{
+		COMPRESSED,
+		RESAMPLED
+	};
+
+
+	struct ModelData
+	{
+	public:
+		std::uint32_t NumIndices;
+		ComPtr<ID3D11Buffer> VertexBuffer;
+		ComPtr<ID3D11Buffer> IndexBuffer;
+		DXGI_FORMAT IndexFormat;
+		Material Material;
+		Transform Transform;
+
+		// Skeleton index and inverse bind (offset) matrix of each bone that influences this
+		//  mesh, in the order of the mesh's own palette (see BuildSkinningPalette)
+		std::vector<std::uint32_t> BoneIndices;
+		std::vector<Matrix3x4> BoneOffsets;
+
+		// Packed bone influences of every vertex, as a second vertex stream with palette
+		//  indices (see SkinWeights.h). Null for meshes without bones.
+		ComPtr<ID3D11Buffer> InfluenceBuffer;
+		INFLUENCE_WEIGHT_FORMAT InfluenceFormat;
+		std::uint32_t InfluenceStride;
+
+		// The same vertices and influences, for skinning on the CPU
+		std::shared_ptr<const ::SkinningMesh> SkinningMesh;
+
+		// Keys given by the render backend, once the mesh is added to it
+		std::uint32_t MeshKey;
+		std::uint32_t MaterialKey;
+
+		ModelData()
+			: NumIndices(0u)
+			, VertexBuffer(nullptr)
+			, IndexBuffer(nullptr)
+			, IndexFormat(DXGI_FORMAT_R32_UINT)
+			, Material(Material::BasicGray)
+			, Transform()
+			, BoneIndices()
+			, BoneOffsets()
+			, InfluenceBuffer(nullptr)
+			, InfluenceFormat(INFLUENCE_WEIGHT_FORMAT::UNORM16)
+			, InfluenceStride(0u)
+			, SkinningMesh(nullptr)
+			, MeshKey(RenderQueue::INVALID_KEY)
+			, MaterialKey(RenderQueue::INVALID_KEY)
+		{}
+	};
+
+protected:
+	static const char * MODEL_FILENAME;
+	static const char * BAKED_MODEL_FILENAME;
+	static const char * ANIMATION_FILENAME;
+
+public:
+	// Weight format of every mesh's influences, which the skinning shader must be created for
+	static const INFLUENCE_WEIGHT_FORMAT INFLUENCE_FORMAT;
+
+public:
+	explicit MixamoCharacterResources(CLIP_FORMAT clipFormat);
+	MixamoCharacterResources(const MixamoCharacterResources&) = delete;
+	~MixamoCharacterResources() = default;
+
+	std::future<bool> Initialize(ComPtr<ID3D11Device> device);
+
+	// Once initialized, gives the meshes and materials to the backend character draws will be submitted to
+	void AddMeshes(D3D11RenderBackend& backend);
+
+	// Writes the baked mesh that Initialize prefers over importing the model FBX file
+	static bool Bake();
+
+	const std::vector<ModelData>& GetModels() const { return models_; }
+	const Skeleton& GetSkeleton() const { return skeleton_; }
+
+	CLIP_FORMAT GetClipFormat() const { return clipFormat_; }
+	std::uint32_t GetClipCount() const { return (std::uint32_t)clipDurations_.size(); }
+	float GetClipDuration(std::uint32_t clipIdx) const { return clipDurations_[clipIdx]; }
+
+	// Only the clips of the chosen format are available
+	const CompressedClip& GetClip(std::uint32_t clipIdx) const { return *clips_[clipIdx]; }
+	const ResampledClip& GetResampledClip(std::uint32_t clipIdx) const { return *resampledClips_[clipIdx]; }
+
+private:
+	bool InitSkeletonAndClips(const aiScene* animation);
+	bool InitVertexAndIndexBuffers(ComPtr<ID3D11Device> device, const aiScene* mixamoModel);
+	bool InitFromBakedMesh(ComPtr<ID3D11Device> device, const BakedMesh& bakedMesh);
+
+private:
+	std::vector<ModelData> models_;
+	Skeleton skeleton_;
+	CLIP_FORMAT clipFormat_;
+	std::vector<float> clipDurations_;
+	std::vector<std::shared_ptr<const CompressedClip>> clips_;
+	std::vector<std::shared_ptr<const ResampledClip>> resampledClips_;
+};
\ No newline at end of file
@@ -1,12 +1,39 @@
 #include "OffBrandChewy.h"
 #include "Logger.h"
+#include <algorithm>
+#include <cfloat>
+#include <chrono>
+#include <cmath>
 #include <sstream>
 #include <string>
 
-#include "MixamoCharacter.h"
-
 #define VALIDATE(hr, msg) if (FAILED(hr)) { Logger::Log(msg); return false; }
 
+namespace
+{
+
+// Spacing of the square grid the crowd of mixamo characters is placed on
+const float CROWD_SPACING = 1.5f;
+
+// Compressed clips take a fraction of the memory and sample within 1.1-1.3x of raw ones
+//  (see BenchmarkCompressedSampling), and the LOD bone masks skip their detail bones.
+const MixamoCharacterResources::CLIP_FORMAT CROWD_CLIP_FORMAT = MixamoCharacterResources::CLIP_FORMAT::COMPRESSED;
+
+// Animation level of detail, by distance from the camera. Past the near distance characters
+//  evaluate every second frame, and past the far distance every fourth frame, and both
+//  skip their finger and face bones if the clips are compressed - resampled clips sample
+//  every bone regardless.
+const float LOD_NEAR_DISTANCE = 12.f;
+const float LOD_FAR_DISTANCE = 30.f;
+const std::uint32_t LOD_MID_INTERVAL = 2u;
+const std::uint32_t LOD_FAR_INTERVAL = 4u;
+const std::vector<std::string> LOD_DETAIL_BONES = { "Thumb", "Index", "Middle", "Ring", "Pinky", "Eye", "HeadTop" };
+
+// Seconds between logs of the scene update cost
+const float STATS_PERIOD = 5.f;
+
+}
+
 std::future<bool> OffBrandChewy::LoadScene()
 {
 	return std::async(std::launch::async, [this] {
@@ -35,8 +62,43 @@ std::future<bool> OffBrandChewy::UnloadScene()
 bool OffBrandChewy::Update(float dt)
 {
 	if (!camera_->Update(dt)) return false;
-	
+
+	Vec3 cameraPosition = camera_->GetPosition();
+	for (auto&& character : characters_)
+	{
+		character->SelectLod(cameraPosition);
+	}
+
+	auto updateStart = std::chrono::high_resolution_clock::now();
 	if (!sceneGraph_.Update(dt)) return false;
+	statsUpdateMilliseconds_ += std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - updateStart).count();
+	statsFrames_++;
+
+	statsTime_ += dt;
+	if (statsTime_ >= STATS_PERIOD)
+	{
+		std::uint32_t lodCounts[3] = { 0u, 0u, 0u };
+		for (auto&& character : characters_)
+		{
+			lodCounts[std::min(character->GetLod(), 2u)]++;
+		}
+
+		std::stringstream ss;
+		ss << "Scene update " << statsUpdateMilliseconds_ / statsFrames_ << "ms per frame over " << statsFrames_ << " frames, "
+			<< characters_.size() << " characters at animation LOD 0/1/2: " << lodCounts[0] << "/" << lodCounts[1] << "/" << lodCounts[2];
+		Logger::Log(ss.str());
+
+		const RenderQueueStats& renderStats = renderQueue_.GetStats();
+		std::stringstream rs;
+		rs << "Last frame drew " << renderStats.NumInstances << " meshes in " << renderStats.NumDraws << " instanced draws with "
+			<< renderStats.NumShaderBinds << " shader and " << renderStats.NumMeshBinds << " mesh binds, skipping "
+			<< renderStats.GetRedundantBindCount() << " redundant binds";
+		Logger::Log(rs.str());
+
+		statsTime_ = 0.f;
+		statsUpdateMilliseconds_ = 0.0;
+		statsFrames_ = 0u;
+	}
 
 	return true;
 }
@@ -75,7 +137,9 @@ bool OffBrandChewy::Render()
 	}
 
 	// Render the scene graph!
-	if (!sceneGraph_.Render()) return false;
+	renderQueue_.Clear();
+	if (!sceneGraph_.Render(renderQueue_)) return false;
+	if (!renderQueue_.Submit(*renderBackend_)) return false;
 
 	swapChain_->Present(1, 0);
 
@@ -231,6 +295,10 @@ bool OffBrandChewy::InitD3D()
 
 bool OffBrandChewy::InitScene()
 {
+	// Scene nodes (mostly character animation) update across every core
+	jobSystem_ = std::make_shared<JobSystem>(0u);
+	sceneGraph_.SetJobSystem(jobSystem_);
+
 	// Camera Details
 	camera_ = std::shared_ptr<DebugCamera>(new DebugCamera(Vec3::UnitZ * 1.8f - Vec3::UnitY * 4.f, Vec3::UnitZ * 1.8f + Vec3::UnitY, Vec3::UnitZ));
 	camera_->SetMoveSpeed(4.f);
@@ -256,7 +324,7 @@ bool OffBrandChewy::InitScene()
 	DirectionalLight light(Color::White * 0.3f, Color::White * 0.99f, Color::White * 2.4f, Vec3(0.34f, 1.f, -0.2f).Normal(), 300.f);
 	basicMDShader_->SetDirectionalLight1(light);
 
-	shaderPNS4MD1_ = std::shared_ptr<ShaderPNS4_MD1>(new ShaderPNS4_MD1());
+	shaderPNS4MD1_ = std::shared_ptr<ShaderPNS4_MD1>(new ShaderPNS4_MD1(MixamoCharacterResources::INFLUENCE_FORMAT));
 	Logger::Log("Initializing ShaderPNS4_MD1 (Material / Skinning [4 bones] / Normal / SingleDirectionalLight)");
 	if (!shaderPNS4MD1_->Initialize(device_).get())
 	{
@@ -265,12 +333,22 @@ bool OffBrandChewy::InitScene()
 	}
 	shaderPNS4MD1_->SetDirectionalLight1(light);
 
+	renderBackend_ = std::make_shared<D3D11RenderBackend>(device_, context_);
+	Logger::Log("Initializing D3D11 render backend");
+	if (!renderBackend_->Initialize())
+	{
+		Logger::Log("Failed to initialize render backend");
+		return false;
+	}
+	std::uint32_t basicMDShaderKey = renderBackend_->AddShader(basicMDShader_);
+	std::uint32_t shaderPNS4MD1Key = renderBackend_->AddShader(shaderPNS4MD1_);
+
 	// Object creation
-	std::shared_ptr<RoadBaseModel> roadModel = std::shared_ptr<RoadBaseModel>(new RoadBaseModel(basicMDShader_, context_, Transform()));
+	std::shared_ptr<RoadBaseModel> roadModel = std::shared_ptr<RoadBaseModel>(new RoadBaseModel(basicMDShaderKey, Transform()));
 	std::future<bool> roadModelLoaded = roadModel->Initialize(device_);
 
-	std::shared_ptr<MixamoCharacter> mixamoCharacter = std::shared_ptr<MixamoCharacter>(new MixamoCharacter(shaderPNS4MD1_, context_, Transform(Vec3::Zero, Quaternion(Vec3::UnitX, PI * 0.5f), Vec3(0.015f, 0.015f, 0.015f))));
-	std::future<bool> mixamoModelLoaded = mixamoCharacter->Initialize(device_);
+	std::shared_ptr<MixamoCharacterResources> mixamoResources = std::shared_ptr<MixamoCharacterResources>(new MixamoCharacterResources(CROWD_CLIP_FORMAT));
+	std::future<bool> mixamoModelLoaded = mixamoResources->Initialize(device_);
 
 	// TODO KAM: Continue to load other items asynchronously here
 
@@ -279,6 +357,7 @@ bool OffBrandChewy::InitScene()
 		Logger::Log("Failed to load all models, exiting");
 		return false;
 	}
+	roadModel->AddMeshes(*renderBackend_);
 	sceneGraph_.AddSceneNode("RoadModel", roadModel);
 
 	if (!mixamoModelLoaded.get())
@@ -286,7 +365,36 @@ bool OffBrandChewy::InitScene()
 		Logger::Log("Failed to load mixamo character, exiting");
 		return false;
 	}
-	sceneGraph_.AddSceneNode("MixamoCharacter", mixamoCharacter);
+	mixamoResources->AddMeshes(*renderBackend_);
+
+	// Full detail up close, fewer updates and bones further away
+	std::vector<std::uint8_t> farBoneMask;
+	if (CROWD_CLIP_FORMAT == MixamoCharacterResources::CLIP_FORMAT::COMPRESSED)
+	{
+		farBoneMask = BuildBoneMask(mixamoResources->GetSkeleton(), LOD_DETAIL_BONES);
+	}
+	std::shared_ptr<std::vector<AnimationLodLevel>> lodLevels = std::make_shared<std::vector<AnimationLodLevel>>();
+	lodLevels->push_back(AnimationLodLevel(LOD_NEAR_DISTANCE, 1u));
+	lodLevels->push_back(AnimationLodLevel(LOD_FAR_DISTANCE, LOD_MID_INTERVAL));
+	lodLevels->back().BoneMask = farBoneMask;
+	lodLevels->push_back(AnimationLodLevel(FLT_MAX, LOD_FAR_INTERVAL));
+	lodLevels->back().BoneMask = farBoneMask;
+
+	// Every character shares the same loaded resources, and only owns its own pose
+	std::uint32_t crowdColumns = std::max(1u, (std::uint32_t)ceilf(sqrtf((float)crowdSize_)));
+	characters_.reserve(crowdSize_);
+	for (std::uint32_t characterIdx = 0u; characterIdx < crowdSize_; characterIdx++)
+	{
+		std::uint32_t row = characterIdx / crowdColumns;
+		std::uint32_t col = characterIdx % crowdColumns;
+		Vec3 position = Vec3::UnitX * (col * CROWD_SPACING) + Vec3::UnitY * (row * CROWD_SPACING);
+		std::shared_ptr<MixamoCharacter> mixamoCharacter = std::shared_ptr<MixamoCharacter>(new MixamoCharacter(mixamoResources, shaderPNS4MD1Key, Transform(position, Quaternion(Vec3::UnitX, PI * 0.5f), Vec3(0.015f, 0.015f, 0.015f))));
+		mixamoCharacter->PlayClip(0u, characterIdx * 0.37f);
+		mixamoCharacter->SetAnimationLod(lodLevels, characterIdx);
+		characters_.push_back(mixamoCharacter);
+
+		sceneGraph_.AddSceneNode((characterIdx == 0u) ? "MixamoCharacter" : nullptr, mixamoCharacter);
+	}
 
 	return true;
 }
\ No newline at end of file
@@ -9,13 +9,16 @@
 #include "DebugCamera.h"
 #include "BasicShaderMD.h"
 #include "ShaderPNS4_MD1.h"
+#include "MixamoCharacter.h"
+#include "D3D11RenderBackend.h"
+#include "RenderQueue.h"
 
 #include "RoadBaseModel.h"
 
 class OffBrandChewy : public IScene
 {
 public:
-	OffBrandChewy(HWND hWnd, ComPtr<ID3D11Device> device, ComPtr<ID3D11DeviceContext> context)
+	OffBrandChewy(HWND hWnd, ComPtr<ID3D11Device> device, ComPtr<ID3D11DeviceContext> context, std::uint32_t crowdSize)
 		: IScene(hWnd, device, context)
 		, swapChain_(nullptr)
 		, renderTargetView_(nullptr)
@@ -24,11 +27,19 @@ public:
 		, rasterState_(nullptr)
 		, depthStencilView_(nullptr)
 		, viewport_()
+		, renderBackend_(nullptr)
+		, renderQueue_()
 		, sceneGraph_()
 		, projMatrix_(PerspectiveLH(Radians(90), 1920.f / 1080.f, 0.1f, 200.f))
 		, camera_(nullptr)
 		, debugShader_(nullptr)
 		, keyListeners_(0)
+		, jobSystem_(nullptr)
+		, crowdSize_(crowdSize)
+		, characters_()
+		, statsTime_(0.f)
+		, statsUpdateMilliseconds_(0.0)
+		, statsFrames_(0u)
 	{}
 
 	virtual std::future<bool> LoadScene() override;
@@ -49,6 +60,10 @@ protected:
 
 	D3D11_VIEWPORT viewport_;
 
+	// Scene nodes write their draws into the queue, which is then submitted to the backend
+	std::shared_ptr<D3D11RenderBackend> renderBackend_;
+	RenderQueue renderQueue_;
+
 // Scene
 protected:
 	SceneGraph sceneGraph_;
@@ -63,6 +78,16 @@ protected:
 // Logical
 protected:
 	std::vector<std::shared_ptr<IKeyEventListener>> keyListeners_;
+	std::shared_ptr<JobSystem> jobSystem_;
+
+	// Crowd, also held by the scene graph, for choosing animation levels of detail
+	std::uint32_t crowdSize_;
+	std::vector<std::shared_ptr<MixamoCharacter>> characters_;
+
+	// Scene update cost, logged every few seconds
+	float statsTime_;
+	double statsUpdateMilliseconds_;
+	std::uint32_t statsFrames_;
 
 private:
 	bool InitD3D();
@@ -0,0 +1,97 @@
+#include "Pose.h"
+#include "AlignedMemory.h"
+#include <cstring>
+
+Pose::Pose()
+	: data_(nullptr)
+	, numBones_(0u)
+	, paddedBones_(0u)
+{}
+
+Pose::Pose(std::uint32_t numBones)
+	: Pose()
+{
+	Resize(numBones);
+}
+
+Pose::Pose(const Pose& o)
+	: Pose()
+{
+	*this = o;
+}
+
+Pose& Pose::operator=(const Pose& o)
+{
+	if (this != &o)
+	{
+		if (paddedBones_ != o.paddedBones_)
+		{
+			Resize(o.numBones_);
+		}
+		numBones_ = o.numBones_;
+
+		if (paddedBones_ > 0u)
+		{
+			memcpy(data_, o.data_, sizeof(float) * paddedBones_ * (std::uint32_t)POSE_STREAM::COUNT);
+		}
+	}
+
+	return *this;
+}
+
+Pose::~Pose()
+{
+	_aligned_free(data_);
+}
+
+void Pose::Resize(std::uint32_t numBones)
+{
+	std::uint32_t paddedBones = (numBones + LANE_PADDING - 1u) / LANE_PADDING * LANE_PADDING;
+
+	if (paddedBones != paddedBones_)
+	{
+		_aligned_free(data_);
+		data_ = (paddedBones > 0u) ? (float*)_aligned_malloc(sizeof(float) * paddedBones * (std::uint32_t)POSE_STREAM::COUNT, ALIGNMENT) : nullptr;
+		paddedBones_ = paddedBones;
+	}
+
+	numBones_ = numBones;
+
+	SetIdentity();
+}
+
+Transform Pose::GetTransform(std::uint32_t boneIdx) const
+{
+	Transform tr;
+
+	tr.Pos = Vec3(GetStream(POSE_STREAM::POS_X)[boneIdx], GetStream(POSE_STREAM::POS_Y)[boneIdx], GetStream(POSE_STREAM::POS_Z)[boneIdx]);
+	tr.Rotation.x = GetStream(POSE_STREAM::ROT_X)[boneIdx];
+	tr.Rotation.y = GetStream(POSE_STREAM::ROT_Y)[boneIdx];
+	tr.Rotation.z = GetStream(POSE_STREAM::ROT_Z)[boneIdx];
+	tr.Rotation.w = GetStream(POSE_STREAM::ROT_W)[boneIdx];
+	tr.Scale = Vec3(GetStream(POSE_STREAM::SCALE_X)[boneIdx], GetStream(POSE_STREAM::SCALE_Y)[boneIdx], GetStream(POSE_STREAM::SCALE_Z)[boneIdx]);
+
+	return tr;
+}
+
+void Pose::SetTransform(std::uint32_t boneIdx, const Transform& transform)
+{
+	GetStream(POSE_STREAM::POS_X)[boneIdx] = transform.Pos.x;
+	GetStream(POSE_STREAM::POS_Y)[boneIdx] = transform.Pos.y;
+	GetStream(POSE_STREAM::POS_Z)[boneIdx] = transform.Pos.z;
+	GetStream(POSE_STREAM::ROT_X)[boneIdx] = transform.Rotation.x;
+	GetStream(POSE_STREAM::ROT_Y)[boneIdx] = transform.Rotation.y;
+	GetStream(POSE_STREAM::ROT_Z)[boneIdx] = transform.Rotation.z;
+	GetStream(POSE_STREAM::ROT_W)[boneIdx] = transform.Rotation.w;
+	GetStream(POSE_STREAM::SCALE_X)[boneIdx] = transform.Scale.x;
+	GetStream(POSE_STREAM::SCALE_Y)[boneIdx] = transform.Scale.y;
+	GetStream(POSE_STREAM::SCALE_Z)[boneIdx] = transform.Scale.z;
+}
+
+void Pose::SetIdentity()
+{
+	for (std::uint32_t boneIdx = 0u; boneIdx < paddedBones_; boneIdx++)
+	{
+		SetTransform(boneIdx, Transform::Identity);
+	}
+}
\ No newline at end of file
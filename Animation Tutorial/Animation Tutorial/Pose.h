@@ -0,0 +1,49 @@
+#pragma once
+
+#include "Transform.h"
+#include <cstdint>
+
+enum class POSE_STREAM
+{
+	POS_X, POS_Y, POS_Z,
+	ROT_X, ROT_Y, ROT_Z, ROT_W,
+	SCALE_X, SCALE_Y, SCALE_Z,
+	COUNT
+};
+
+// Transforms for every bone of a skeleton, stored as structure-of-arrays so that bones
+//  can be processed several at a time. Every stream is aligned and padded out to a
+//  multiple of LANE_PADDING bones, so SIMD kernels never need a scalar tail. Padding
+//  bones hold the identity transform.
+class Pose
+{
+public:
+	static const std::uint32_t LANE_PADDING = 8u;
+	static const std::uint32_t ALIGNMENT = 32u;
+
+public:
+	Pose();
+	explicit Pose(std::uint32_t numBones);
+	Pose(const Pose&);
+	Pose& operator=(const Pose&);
+	~Pose();
+
+	// Contents are reset to identity transforms
+	void Resize(std::uint32_t numBones);
+
+	std::uint32_t GetBoneCount() const { return numBones_; }
+	std::uint32_t GetPaddedBoneCount() const { return paddedBones_; }
+
+	float* GetStream(POSE_STREAM stream) { return data_ + (std::uint32_t)stream * paddedBones_; }
+	const float* GetStream(POSE_STREAM stream) const { return data_ + (std::uint32_t)stream * paddedBones_; }
+
+	Transform GetTransform(std::uint32_t boneIdx) const;
+	void SetTransform(std::uint32_t boneIdx, const Transform& transform);
+
+	void SetIdentity();
+
+private:
+	float* data_;
+	std::uint32_t numBones_;
+	std::uint32_t paddedBones_;
+};
\ No newline at end of file
@@ -0,0 +1,170 @@
+#include "PoseBlend.h"
+#include "Simd.h"
+#include "AlignedMemory.h"
+#include <assert.h>
+#include <cstring>
+
+namespace
+{
+
+SimdFloat LoadStream(const Pose& pose, POSE_STREAM stream, std::uint32_t batch)
+{
+	return SimdLoad(pose.GetStream(stream) + batch);
+}
+
+void StoreStream(Pose& pose, POSE_STREAM stream, std::uint32_t batch, SimdFloat value)
+{
+	SimdStore(pose.GetStream(stream) + batch, value);
+}
+
+SimdFloat BatchWeight(SimdFloat weight, const BoneWeights* boneWeights, std::uint32_t batch)
+{
+	return (boneWeights != nullptr) ? SimdMul(weight, SimdLoad(boneWeights->GetWeights() + batch)) : weight;
+}
+
+}
+
+BoneWeights::BoneWeights(std::uint32_t numBones, float weight)
+	: weights_(nullptr)
+	, numBones_(numBones)
+	, paddedBones_((numBones + Pose::LANE_PADDING - 1u) / Pose::LANE_PADDING * Pose::LANE_PADDING)
+{
+	weights_ = (paddedBones_ > 0u) ? (float*)_aligned_malloc(sizeof(float) * paddedBones_, Pose::ALIGNMENT) : nullptr;
+	for (std::uint32_t boneIdx = 0u; boneIdx < paddedBones_; boneIdx++)
+	{
+		weights_[boneIdx] = (boneIdx < numBones_) ? weight : 0.f;
+	}
+}
+
+BoneWeights::BoneWeights(const BoneWeights& o)
+	: BoneWeights(o.numBones_, 0.f)
+{
+	*this = o;
+}
+
+BoneWeights& BoneWeights::operator=(const BoneWeights& o)
+{
+	if (this != &o)
+	{
+		if (paddedBones_ != o.paddedBones_)
+		{
+			_aligned_free(weights_);
+			weights_ = (o.paddedBones_ > 0u) ? (float*)_aligned_malloc(sizeof(float) * o.paddedBones_, Pose::ALIGNMENT) : nullptr;
+			paddedBones_ = o.paddedBones_;
+		}
+		numBones_ = o.numBones_;
+
+		if (paddedBones_ > 0u)
+		{
+			memcpy(weights_, o.weights_, sizeof(float) * paddedBones_);
+		}
+	}
+
+	return *this;
+}
+
+BoneWeights::~BoneWeights()
+{
+	_aligned_free(weights_);
+}
+
+void BlendPoses(const Pose& a, const Pose& b, float weight, const BoneWeights* boneWeights, Pose& outPose)
+{
+	assert(a.GetBoneCount() == b.GetBoneCount() && outPose.GetBoneCount() == a.GetBoneCount());
+	assert(boneWeights == nullptr || boneWeights->GetBoneCount() == a.GetBoneCount());
+
+	SimdFloat w = SimdSet(weight);
+	for (std::uint32_t batch = 0u; batch < a.GetPaddedBoneCount(); batch += SIMD_WIDTH)
+	{
+		SimdFloat t = BatchWeight(w, boneWeights, batch);
+
+		StoreStream(outPose, POSE_STREAM::POS_X, batch, SimdLerp(LoadStream(a, POSE_STREAM::POS_X, batch), LoadStream(b, POSE_STREAM::POS_X, batch), t));
+		StoreStream(outPose, POSE_STREAM::POS_Y, batch, SimdLerp(LoadStream(a, POSE_STREAM::POS_Y, batch), LoadStream(b, POSE_STREAM::POS_Y, batch), t));
+		StoreStream(outPose, POSE_STREAM::POS_Z, batch, SimdLerp(LoadStream(a, POSE_STREAM::POS_Z, batch), LoadStream(b, POSE_STREAM::POS_Z, batch), t));
+
+		// Put b on the same hemisphere as a, so the nlerp takes the shorter arc
+		SimdFloat ax = LoadStream(a, POSE_STREAM::ROT_X, batch);
+		SimdFloat ay = LoadStream(a, POSE_STREAM::ROT_Y, batch);
+		SimdFloat az = LoadStream(a, POSE_STREAM::ROT_Z, batch);
+		SimdFloat aw = LoadStream(a, POSE_STREAM::ROT_W, batch);
+		SimdFloat bx = LoadStream(b, POSE_STREAM::ROT_X, batch);
+		SimdFloat by = LoadStream(b, POSE_STREAM::ROT_Y, batch);
+		SimdFloat bz = LoadStream(b, POSE_STREAM::ROT_Z, batch);
+		SimdFloat bw = LoadStream(b, POSE_STREAM::ROT_W, batch);
+		SimdFloat dot = SimdMulAdd(ax, bx, SimdMulAdd(ay, by, SimdMulAdd(az, bz, SimdMul(aw, bw))));
+
+		SimdFloat qx = SimdLerp(ax, SimdMulSign(bx, dot), t);
+		SimdFloat qy = SimdLerp(ay, SimdMulSign(by, dot), t);
+		SimdFloat qz = SimdLerp(az, SimdMulSign(bz, dot), t);
+		SimdFloat qw = SimdLerp(aw, SimdMulSign(bw, dot), t);
+		SimdFloat invLength = SimdRsqrt(SimdMulAdd(qx, qx, SimdMulAdd(qy, qy, SimdMulAdd(qz, qz, SimdMul(qw, qw)))));
+
+		StoreStream(outPose, POSE_STREAM::ROT_X, batch, SimdMul(qx, invLength));
+		StoreStream(outPose, POSE_STREAM::ROT_Y, batch, SimdMul(qy, invLength));
+		StoreStream(outPose, POSE_STREAM::ROT_Z, batch, SimdMul(qz, invLength));
+		StoreStream(outPose, POSE_STREAM::ROT_W, batch, SimdMul(qw, invLength));
+
+		StoreStream(outPose, POSE_STREAM::SCALE_X, batch, SimdLerp(LoadStream(a, POSE_STREAM::SCALE_X, batch), LoadStream(b, POSE_STREAM::SCALE_X, batch), t));
+		StoreStream(outPose, POSE_STREAM::SCALE_Y, batch, SimdLerp(LoadStream(a, POSE_STREAM::SCALE_Y, batch), LoadStream(b, POSE_STREAM::SCALE_Y, batch), t));
+		StoreStream(outPose, POSE_STREAM::SCALE_Z, batch, SimdLerp(LoadStream(a, POSE_STREAM::SCALE_Z, batch), LoadStream(b, POSE_STREAM::SCALE_Z, batch), t));
+	}
+}
+
+void AddPose(const Pose& base, const Pose& additive, const Pose& reference, float weight, const BoneWeights* boneWeights, Pose& outPose)
+{
+	assert(base.GetBoneCount() == additive.GetBoneCount() && base.GetBoneCount() == reference.GetBoneCount() && outPose.GetBoneCount() == base.GetBoneCount());
+	assert(boneWeights == nullptr || boneWeights->GetBoneCount() == base.GetBoneCount());
+
+	SimdFloat w = SimdSet(weight);
+	SimdFloat one = SimdSet(1.f);
+	for (std::uint32_t batch = 0u; batch < base.GetPaddedBoneCount(); batch += SIMD_WIDTH)
+	{
+		SimdFloat t = BatchWeight(w, boneWeights, batch);
+
+		const POSE_STREAM positions[3] = { POSE_STREAM::POS_X, POSE_STREAM::POS_Y, POSE_STREAM::POS_Z };
+		const POSE_STREAM scales[3] = { POSE_STREAM::SCALE_X, POSE_STREAM::SCALE_Y, POSE_STREAM::SCALE_Z };
+		for (std::uint32_t c = 0u; c < 3u; c++)
+		{
+			SimdFloat delta = SimdSub(LoadStream(additive, positions[c], batch), LoadStream(reference, positions[c], batch));
+			StoreStream(outPose, positions[c], batch, SimdMulAdd(delta, t, LoadStream(base, positions[c], batch)));
+
+			SimdFloat ratio = SimdDiv(LoadStream(additive, scales[c], batch), LoadStream(reference, scales[c], batch));
+			StoreStream(outPose, scales[c], batch, SimdMul(LoadStream(base, scales[c], batch), SimdLerp(one, ratio, t)));
+		}
+
+		// delta = conjugate(reference) * additive
+		SimdFloat rx = LoadStream(reference, POSE_STREAM::ROT_X, batch);
+		SimdFloat ry = LoadStream(reference, POSE_STREAM::ROT_Y, batch);
+		SimdFloat rz = LoadStream(reference, POSE_STREAM::ROT_Z, batch);
+		SimdFloat rw = LoadStream(reference, POSE_STREAM::ROT_W, batch);
+		SimdFloat ax = LoadStream(additive, POSE_STREAM::ROT_X, batch);
+		SimdFloat ay = LoadStream(additive, POSE_STREAM::ROT_Y, batch);
+		SimdFloat az = LoadStream(additive, POSE_STREAM::ROT_Z, batch);
+		SimdFloat aw = LoadStream(additive, POSE_STREAM::ROT_W, batch);
+		SimdFloat dx = SimdSub(SimdMulAdd(rw, ax, SimdMul(rz, ay)), SimdMulAdd(rx, aw, SimdMul(ry, az)));
+		SimdFloat dy = SimdSub(SimdMulAdd(rw, ay, SimdMul(rx, az)), SimdMulAdd(ry, aw, SimdMul(rz, ax)));
+		SimdFloat dz = SimdSub(SimdMulAdd(rw, az, SimdMul(ry, ax)), SimdMulAdd(rz, aw, SimdMul(rx, ay)));
+		SimdFloat dw = SimdMulAdd(rw, aw, SimdMulAdd(rx, ax, SimdMulAdd(ry, ay, SimdMul(rz, az))));
+
+		// Scale the delta by nlerping from identity, on the hemisphere nearest to it
+		SimdFloat sx = SimdMul(SimdMulSign(dx, dw), t);
+		SimdFloat sy = SimdMul(SimdMulSign(dy, dw), t);
+		SimdFloat sz = SimdMul(SimdMulSign(dz, dw), t);
+		SimdFloat sw = SimdLerp(one, SimdMulSign(dw, dw), t);
+		SimdFloat invLength = SimdRsqrt(SimdMulAdd(sx, sx, SimdMulAdd(sy, sy, SimdMulAdd(sz, sz, SimdMul(sw, sw)))));
+		sx = SimdMul(sx, invLength);
+		sy = SimdMul(sy, invLength);
+		sz = SimdMul(sz, invLength);
+		sw = SimdMul(sw, invLength);
+
+		// out = base * delta
+		SimdFloat bx = LoadStream(base, POSE_STREAM::ROT_X, batch);
+		SimdFloat by = LoadStream(base, POSE_STREAM::ROT_Y, batch);
+		SimdFloat bz = LoadStream(base, POSE_STREAM::ROT_Z, batch);
+		SimdFloat bw = LoadStream(base, POSE_STREAM::ROT_W, batch);
+		StoreStream(outPose, POSE_STREAM::ROT_X, batch, SimdSub(SimdMulAdd(bw, sx, SimdMulAdd(bx, sw, SimdMul(by, sz))), SimdMul(bz, sy)));
+		StoreStream(outPose, POSE_STREAM::ROT_Y, batch, SimdSub(SimdMulAdd(bw, sy, SimdMulAdd(by, sw, SimdMul(bz, sx))), SimdMul(bx, sz)));
+		StoreStream(outPose, POSE_STREAM::ROT_Z, batch, SimdSub(SimdMulAdd(bw, sz, SimdMulAdd(bz, sw, SimdMul(bx, sy))), SimdMul(by, sx)));
+		StoreStream(outPose, POSE_STREAM::ROT_W, batch, SimdSub(SimdMul(bw, sw), SimdMulAdd(bx, sx, SimdMulAdd(by, sy, SimdMul(bz, sz)))));
+	}
+}
\ No newline at end of file
@@ -0,0 +1,38 @@
+#pragma once
+
+#include "Pose.h"
+
+// Blend weight of every bone of a skeleton, from 0 to 1. Aligned and padded like the streams
+//  of a Pose, so blends can read it SIMD_WIDTH bones at a time. Padding bones have weight 0.
+class BoneWeights
+{
+public:
+	BoneWeights(std::uint32_t numBones, float weight);
+	BoneWeights(const BoneWeights&);
+	BoneWeights& operator=(const BoneWeights&);
+	~BoneWeights();
+
+	std::uint32_t GetBoneCount() const { return numBones_; }
+	float GetWeight(std::uint32_t boneIdx) const { return weights_[boneIdx]; }
+	void SetWeight(std::uint32_t boneIdx, float weight) { weights_[boneIdx] = weight; }
+
+	const float* GetWeights() const { return weights_; }
+
+private:
+	float* weights_;
+	std::uint32_t numBones_;
+	std::uint32_t paddedBones_;
+};
+
+// Local pose blends, SIMD_WIDTH bones at a time (see Simd.h). All poses must have the same
+//  bone count. Bone weights are optional, and scale the blend weight of each bone. The output
+//  pose may be the same as any of the inputs.
+
+// Lerps positions and scales, and nlerps rotations along the shorter arc. A weight of 0
+//  gives a, and 1 gives b.
+void BlendPoses(const Pose& a, const Pose& b, float weight, const BoneWeights* boneWeights, Pose& outPose);
+
+// Applies the difference between additive and reference on top of base - the additive rotation
+//  is taken relative to the reference rotation, and applied in the space of the base bone.
+//  Positions add the difference, and scales multiply by the ratio.
+void AddPose(const Pose& base, const Pose& additive, const Pose& reference, float weight, const BoneWeights* boneWeights, Pose& outPose);
\ No newline at end of file
@@ -0,0 +1,30 @@
+#include "PosePool.h"
+#include <assert.h>
+
+PosePool::PosePool()
+	: poses_()
+	, numInUse_(0u)
+{}
+
+Pose& PosePool::Acquire(std::uint32_t numBones)
+{
+	if (numInUse_ == poses_.size())
+	{
+		poses_.push_back(std::unique_ptr<Pose>(new Pose(numBones)));
+	}
+
+	Pose& pose = *poses_[numInUse_++];
+	if (pose.GetBoneCount() != numBones)
+	{
+		pose.Resize(numBones);
+	}
+
+	return pose;
+}
+
+void PosePool::Release(Pose& pose)
+{
+	assert(numInUse_ > 0u && poses_[numInUse_ - 1u].get() == &pose);
+
+	numInUse_--;
+}
\ No newline at end of file
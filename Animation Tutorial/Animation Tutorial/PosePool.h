@@ -0,0 +1,29 @@
+#pragma once
+
+#include "Pose.h"
+#include <memory>
+#include <vector>
+
+// Scratch poses for evaluating blends, handed out and given back in stack order, the way a
+//  blend tree is walked. Poses are kept once created, so once a pool has seen the deepest
+//  blend it will be asked for, evaluating blends allocates nothing.
+// Not thread safe - use one pool per thread.
+class PosePool
+{
+public:
+	PosePool();
+	PosePool(const PosePool&) = delete;
+	~PosePool() = default;
+
+	// Contents of the pose are left over from its last use
+	Pose& Acquire(std::uint32_t numBones);
+
+	// Must be the pose most recently acquired, and not yet released
+	void Release(Pose& pose);
+
+	std::uint32_t GetPoseCount() const { return (std::uint32_t)poses_.size(); }
+
+private:
+	std::vector<std::unique_ptr<Pose>> poses_;
+	std::uint32_t numInUse_;
+};
\ No newline at end of file
@@ -0,0 +1,19 @@
+#pragma once
+
+#include "maffs.h"
+
+struct PositionKeyframe
+{
+public:
+	float Time;
+	Vec3 Translation;
+
+public:
+	PositionKeyframe(float time, Vec3 translation)
+		: Time(time)
+		, Translation(translation)
+	{}
+	PositionKeyframe(const PositionKeyframe&) = default;
+
+	static Vec3 LERP(const PositionKeyframe& kf1, const PositionKeyframe& kf2, float time);
+};
\ No newline at end of file
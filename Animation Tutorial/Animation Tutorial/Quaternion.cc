@@ -1,4 +1,5 @@
 #include "Quaternion.h"
+#include "Simd.h"
 #include <algorithm>
 
 Quaternion::Quaternion() : x(0.f), y(0.f), z(0.f), w(1.f)
@@ -24,17 +25,29 @@ Quaternion::Quaternion(float W, float X, float Y, float Z)
 
 Quaternion Quaternion::Inverse() const
 {
+#if defined(MAFFS_SIMD4)
+	Quaternion inverse;
+	Simd4Store(&inverse.x, Simd4Normalize4(Simd4FlipSigns(Simd4Load(&x), false, false, false, true)));
+	return inverse;
+#else
 	return Quaternion(-w, x, y, z);
+#endif
 }
 
 Quaternion Quaternion::operator*(const Quaternion& o) const
 {
 	// TODO KAM: Is this math right? I'm not sure.
+#if defined(MAFFS_SIMD4)
+	Quaternion product;
+	Simd4Store(&product.x, Simd4Normalize4(Simd4QuatMul(Simd4Load(&x), Simd4Load(&o.x))));
+	return product;
+#else
 	return Quaternion(
 		o.w * w - o.x * x - o.y * y - o.z * z,
 		o.w * x + o.x * w - o.y * z + o.z * y,
 		o.w * y + o.x * z + o.y * w - o.z * x,
 		o.w * z - o.x * y + o.y * x + o.z * w);
+#endif
 }
 
 Quaternion& Quaternion::operator*=(const Quaternion& o)
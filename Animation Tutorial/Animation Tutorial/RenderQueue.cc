@@ -0,0 +1,219 @@
+#include "RenderQueue.h"
+#include <assert.h>
+#include <cstring>
+
+const std::uint32_t RenderQueue::INVALID_KEY = 0xFFFFFFFFu;
+
+namespace
+{
+
+// The sort is least significant digit first, a byte at a time
+const std::uint32_t RADIX_BITS = 8u;
+const std::uint32_t RADIX_SIZE = 1u << RADIX_BITS;
+const std::uint32_t NUM_DIGITS = 64u / RADIX_BITS;
+
+}
+
+RenderQueue::RenderQueue()
+	: packets_()
+	, palettes_()
+	, keys_()
+	, order_()
+	, stats_()
+	, scratchKeys_()
+	, scratchOrder_()
+	, instances_()
+	, batches_()
+	, batchOffsets_()
+{}
+
+void RenderQueue::Clear()
+{
+	packets_.clear();
+	palettes_.clear();
+}
+
+void RenderQueue::AddDraw(const DrawPacket& packet)
+{
+	packets_.push_back(packet);
+}
+
+std::uint32_t RenderQueue::AddPalette(const Matrix3x4* bones, std::uint32_t numBones)
+{
+	std::uint32_t paletteOffset = (std::uint32_t)palettes_.size();
+	palettes_.insert(palettes_.end(), bones, bones + numBones);
+	return paletteOffset;
+}
+
+std::uint64_t RenderQueue::MakeSortKey(const DrawPacket& packet)
+{
+	assert(packet.Pass < (1u << PASS_BITS));
+	assert(packet.ShaderKey < (1u << SHADER_BITS));
+	assert(packet.MeshKey < (1u << MESH_BITS));
+	assert(packet.MaterialKey < (1u << MATERIAL_BITS));
+
+	// Masked as well, so a key too large for its field cannot change the fields above it.
+	//  Material comes last, as it does not split instanced draws.
+	return ((std::uint64_t)(packet.Pass & ((1u << PASS_BITS) - 1u)) << (SHADER_BITS + MESH_BITS + MATERIAL_BITS))
+		| ((std::uint64_t)(packet.ShaderKey & ((1u << SHADER_BITS) - 1u)) << (MESH_BITS + MATERIAL_BITS))
+		| ((std::uint64_t)(packet.MeshKey & ((1u << MESH_BITS) - 1u)) << MATERIAL_BITS)
+		| (std::uint64_t)(packet.MaterialKey & ((1u << MATERIAL_BITS) - 1u));
+}
+
+void RenderQueue::Sort()
+{
+	std::uint32_t numPackets = (std::uint32_t)packets_.size();
+	keys_.resize(numPackets);
+	order_.resize(numPackets);
+	scratchKeys_.resize(numPackets);
+	scratchOrder_.resize(numPackets);
+
+	// Counts of every digit are gathered in one read of the keys
+	std::uint32_t counts[NUM_DIGITS][RADIX_SIZE];
+	memset(counts, 0, sizeof(counts));
+	for (std::uint32_t i = 0u; i < numPackets; i++)
+	{
+		std::uint64_t key = MakeSortKey(packets_[i]);
+		keys_[i] = key;
+		order_[i] = i;
+		for (std::uint32_t digit = 0u; digit < NUM_DIGITS; digit++)
+		{
+			counts[digit][(key >> (digit * RADIX_BITS)) & (RADIX_SIZE - 1u)]++;
+		}
+	}
+
+	// Each pass is stable, so packets with equal keys keep the order they were added in
+	for (std::uint32_t digit = 0u; digit < NUM_DIGITS; digit++)
+	{
+		// Scenes use few shaders, materials and meshes, so most digits are the same in
+		//  every key, and would leave the order as it is
+		std::uint32_t shift = digit * RADIX_BITS;
+		if (numPackets == 0u || counts[digit][(keys_[0u] >> shift) & (RADIX_SIZE - 1u)] == numPackets)
+		{
+			continue;
+		}
+
+		std::uint32_t offsets[RADIX_SIZE];
+		std::uint32_t total = 0u;
+		for (std::uint32_t bucket = 0u; bucket < RADIX_SIZE; bucket++)
+		{
+			offsets[bucket] = total;
+			total += counts[digit][bucket];
+		}
+
+		for (std::uint32_t i = 0u; i < numPackets; i++)
+		{
+			std::uint32_t dst = offsets[(keys_[i] >> shift) & (RADIX_SIZE - 1u)]++;
+			scratchKeys_[dst] = keys_[i];
+			scratchOrder_[dst] = order_[i];
+		}
+
+		keys_.swap(scratchKeys_);
+		order_.swap(scratchOrder_);
+	}
+}
+
+void RenderQueue::GatherInstances()
+{
+	instances_.resize(order_.size());
+	batches_.clear();
+
+	// Sorted keys of the same draw differ only in their material bits
+	std::uint64_t drawKey = 0u;
+	for (std::uint32_t i = 0u; i < order_.size(); i++)
+	{
+		const DrawPacket& packet = packets_[order_[i]];
+
+		InstanceData& instance = instances_[i];
+		instance.Model = packet.Model;
+		instance.MaterialKey = packet.MaterialKey;
+		instance.PaletteOffset = packet.PaletteOffset;
+		instance.Padding[0u] = 0u;
+		instance.Padding[1u] = 0u;
+
+		std::uint64_t key = keys_[i] >> MATERIAL_BITS;
+		if (batches_.empty() || key != drawKey || batches_.back().NumInstances == IRenderBackend::MAX_INSTANCES_PER_DRAW)
+		{
+			batches_.push_back(InstanceBatch(packet.ShaderKey, packet.MeshKey, i));
+			drawKey = key;
+		}
+		batches_.back().NumInstances++;
+	}
+}
+
+bool RenderQueue::Submit(IRenderBackend& backend)
+{
+	Sort();
+	GatherInstances();
+	stats_ = RenderQueueStats();
+
+	std::uint32_t shaderKey = INVALID_KEY;
+	std::uint32_t meshKey = INVALID_KEY;
+
+	// Nothing of a frame the backend could not begin is played, not even its end
+	if (!backend.BeginFrame())
+	{
+		return false;
+	}
+
+	bool isValid = true;
+	if (!palettes_.empty())
+	{
+		isValid &= backend.WritePaletteData(&palettes_[0], (std::uint32_t)palettes_.size());
+	}
+
+	// Instance data of the whole frame is written in one go, in the order it is drawn.
+	//  Draws whose instances could not be written are dropped.
+	batchOffsets_.resize(batches_.size());
+	for (std::uint32_t i = 0u; i < batches_.size(); i++)
+	{
+		const InstanceBatch& batch = batches_[i];
+		if (!backend.WriteInstanceData(&instances_[batch.FirstInstance], batch.NumInstances, batchOffsets_[i]))
+		{
+			batchOffsets_[i] = INVALID_KEY;
+			isValid = false;
+		}
+	}
+	isValid &= backend.FlushInstanceData();
+
+	// A failed bind leaves its key invalid, so the next draw tries it again
+	for (std::uint32_t i = 0u; i < batches_.size(); i++)
+	{
+		if (batchOffsets_[i] == INVALID_KEY)
+		{
+			continue;
+		}
+
+		const InstanceBatch& batch = batches_[i];
+
+		if (batch.ShaderKey != shaderKey)
+		{
+			shaderKey = backend.BindShader(batch.ShaderKey) ? batch.ShaderKey : INVALID_KEY;
+			isValid &= (shaderKey != INVALID_KEY);
+			stats_.NumShaderBinds++;
+		}
+		else
+		{
+			stats_.NumRedundantShaderBinds++;
+		}
+
+		if (batch.MeshKey != meshKey)
+		{
+			meshKey = backend.BindMesh(batch.MeshKey) ? batch.MeshKey : INVALID_KEY;
+			isValid &= (meshKey != INVALID_KEY);
+			stats_.NumMeshBinds++;
+		}
+		else
+		{
+			stats_.NumRedundantMeshBinds++;
+		}
+
+		isValid &= backend.BindInstanceData(batchOffsets_[i], batch.NumInstances);
+		isValid &= backend.Draw(batch.NumInstances);
+		stats_.NumDraws++;
+		stats_.NumInstances += batch.NumInstances;
+	}
+
+	isValid &= backend.EndFrame();
+	return isValid;
+}
\ No newline at end of file
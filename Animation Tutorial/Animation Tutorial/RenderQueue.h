@@ -0,0 +1,153 @@
+#pragma once
+
+#include "IRenderBackend.h"
+#include "Matrix.h"
+#include "Matrix3x4.h"
+#include <cstdint>
+#include <vector>
+
+// One draw of one mesh, as written into the render queue by scene nodes. Shader, material
+//  and mesh keys are given out by the render backend as each is added to it. Lower passes
+//  are drawn before higher ones. Packets of the same pass, shader and mesh become
+//  instances of one draw, whatever their material.
+struct DrawPacket
+{
+public:
+	std::uint32_t Pass;
+	std::uint32_t ShaderKey;
+	std::uint32_t MaterialKey;
+	std::uint32_t MeshKey;
+
+	// As returned by RenderQueue::AddPalette, or RenderQueue::INVALID_KEY
+	std::uint32_t PaletteOffset;
+	Matrix Model;
+
+	DrawPacket(std::uint32_t pass, std::uint32_t shaderKey, std::uint32_t materialKey, std::uint32_t meshKey, std::uint32_t paletteOffset, const Matrix& model)
+		: Pass(pass)
+		, ShaderKey(shaderKey)
+		, MaterialKey(materialKey)
+		, MeshKey(meshKey)
+		, PaletteOffset(paletteOffset)
+		, Model(model)
+	{}
+};
+
+// Packets gathered into one instanced draw - instances FirstInstance onwards of the frame,
+//  in the order of the sorted packets
+struct InstanceBatch
+{
+public:
+	std::uint32_t ShaderKey;
+	std::uint32_t MeshKey;
+	std::uint32_t FirstInstance;
+	std::uint32_t NumInstances;
+
+	InstanceBatch(std::uint32_t shaderKey, std::uint32_t meshKey, std::uint32_t firstInstance)
+		: ShaderKey(shaderKey)
+		, MeshKey(meshKey)
+		, FirstInstance(firstInstance)
+		, NumInstances(0u)
+	{}
+};
+
+// Draws made and binds made and skipped by the last submit of a queue
+struct RenderQueueStats
+{
+public:
+	std::uint32_t NumDraws;
+	std::uint32_t NumInstances;
+	std::uint32_t NumShaderBinds;
+	std::uint32_t NumMeshBinds;
+
+	// Binds of state that was already bound, skipped rather than sent to the backend
+	std::uint32_t NumRedundantShaderBinds;
+	std::uint32_t NumRedundantMeshBinds;
+
+	RenderQueueStats()
+		: NumDraws(0u)
+		, NumInstances(0u)
+		, NumShaderBinds(0u)
+		, NumMeshBinds(0u)
+		, NumRedundantShaderBinds(0u)
+		, NumRedundantMeshBinds(0u)
+	{}
+
+	std::uint32_t GetBindCount() const { return NumShaderBinds + NumMeshBinds; }
+	std::uint32_t GetRedundantBindCount() const { return NumRedundantShaderBinds + NumRedundantMeshBinds; }
+};
+
+// Draws of a frame, collected from the scene before any of them reach the GPU. Nodes only
+//  describe what to draw - how it is drawn is up to the backend the queue is submitted to,
+//  which is the D3D11 context when running, or a recording backend for tests on machines
+//  without a GPU (see HeadlessRenderBackend.h).
+// On submit, draws are sorted by a 64 bit key of pass, shader, mesh and material, from the
+//  most significant bits down, so draws sharing state end up next to each other and only
+//  the first of them binds it. Runs of draws of the same pass, shader and mesh are then
+//  compacted into instanced draws, so a crowd of one character costs a draw per mesh
+//  rather than a draw per mesh per character.
+class RenderQueue
+{
+public:
+	// Key of a shader, material or mesh that has not been added to a backend
+	static const std::uint32_t INVALID_KEY;
+
+	// Pass of everything in the scene
+	static const std::uint32_t SCENE_PASS = 0u;
+
+	// Width of each field of the sort key. Keys must fit in their field.
+	static const std::uint32_t PASS_BITS = 4u;
+	static const std::uint32_t SHADER_BITS = 12u;
+	static const std::uint32_t MESH_BITS = 24u;
+	static const std::uint32_t MATERIAL_BITS = 24u;
+
+public:
+	RenderQueue();
+	RenderQueue(const RenderQueue&) = delete;
+	~RenderQueue() = default;
+
+	// Storage is kept between frames, so a steady scene stops allocating after its first frame
+	void Clear();
+	void AddDraw(const DrawPacket& packet);
+
+	// Copies a bone palette into the frame's palette data, and returns the offset draw
+	//  packets refer to it by. Palettes are indexed by the bone indices of a mesh's
+	//  vertices, so each skinned mesh adds its own.
+	std::uint32_t AddPalette(const Matrix3x4* bones, std::uint32_t numBones);
+
+	const std::vector<DrawPacket>& GetPackets() const { return packets_; }
+	std::uint32_t GetDrawCount() const { return (std::uint32_t)packets_.size(); }
+
+	// Sorts the packets and gathers them into instanced draws, then plays them into the
+	//  backend as one frame
+	bool Submit(IRenderBackend& backend);
+
+	// Of the last submit - packet indices in the order they were drawn, which is also the
+	//  order of their instances, the instanced draws made, and the binds made
+	const std::vector<std::uint32_t>& GetSubmitOrder() const { return order_; }
+	const std::vector<InstanceData>& GetInstances() const { return instances_; }
+	const std::vector<InstanceBatch>& GetBatches() const { return batches_; }
+	const RenderQueueStats& GetStats() const { return stats_; }
+
+	static std::uint64_t MakeSortKey(const DrawPacket& packet);
+
+private:
+	void Sort();
+	void GatherInstances();
+
+private:
+	std::vector<DrawPacket> packets_;
+	std::vector<Matrix3x4> palettes_;
+	std::vector<std::uint64_t> keys_;
+	std::vector<std::uint32_t> order_;
+	RenderQueueStats stats_;
+
+	// Ping-pong buffers of the radix sort
+	std::vector<std::uint64_t> scratchKeys_;
+	std::vector<std::uint32_t> scratchOrder_;
+
+	// Instance data of the sorted packets, the draws it is split into, and where the
+	//  backend wrote the instances of each draw
+	std::vector<InstanceData> instances_;
+	std::vector<InstanceBatch> batches_;
+	std::vector<std::uint32_t> batchOffsets_;
+};
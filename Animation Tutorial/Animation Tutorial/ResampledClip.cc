@@ -0,0 +1,148 @@
+#include "ResampledClip.h"
+#include "ClipSampler.h"
+#include "AlignedMemory.h"
+#include "Logger.h"
+#include <algorithm>
+#include <cstring>
+#include <cmath>
+#include <vector>
+
+const float ResampledClip::DEFAULT_SAMPLE_RATE = 30.f;
+
+namespace
+{
+
+// Flips rotations onto the same side of the hypersphere as the previous frame, so that
+//  lerping between frames never takes the long way around
+void MatchHemispheres(const float* previousFrame, float* frame, std::uint32_t numBones, std::uint32_t paddedBones)
+{
+	const std::uint32_t firstRotationStream = (std::uint32_t)POSE_STREAM::ROT_X;
+
+	for (std::uint32_t boneIdx = 0u; boneIdx < numBones; boneIdx++)
+	{
+		float dot = 0.f;
+		for (std::uint32_t c = 0u; c < 4u; c++)
+		{
+			dot += previousFrame[(firstRotationStream + c) * paddedBones + boneIdx] * frame[(firstRotationStream + c) * paddedBones + boneIdx];
+		}
+
+		if (dot < 0.f)
+		{
+			for (std::uint32_t c = 0u; c < 4u; c++)
+			{
+				frame[(firstRotationStream + c) * paddedBones + boneIdx] *= -1.f;
+			}
+		}
+	}
+}
+
+// Every distinct key time of every channel in the clip
+std::vector<float> GetSourceKeyTimes(const AnimationClip& clip)
+{
+	std::vector<float> times;
+	for (std::uint32_t boneIdx = 0u; boneIdx < clip.GetBoneCount(); boneIdx++)
+	{
+		const AnimationClip::TrackRange& position = clip.GetPositionTrack(boneIdx);
+		const AnimationClip::TrackRange& rotation = clip.GetRotationTrack(boneIdx);
+		const AnimationClip::TrackRange& scale = clip.GetScaleTrack(boneIdx);
+		times.insert(times.end(), clip.GetPositionStream(0u) + position.FirstKey, clip.GetPositionStream(0u) + position.FirstKey + position.NumKeys);
+		times.insert(times.end(), clip.GetRotationStream(0u) + rotation.FirstKey, clip.GetRotationStream(0u) + rotation.FirstKey + rotation.NumKeys);
+		times.insert(times.end(), clip.GetScaleStream(0u) + scale.FirstKey, clip.GetScaleStream(0u) + scale.FirstKey + scale.NumKeys);
+	}
+
+	std::sort(times.begin(), times.end());
+	times.erase(std::unique(times.begin(), times.end()), times.end());
+	return times;
+}
+
+void MeasureErrors(const AnimationClip& source, const ResampledClip& resampled, ResampleStats& outStats)
+{
+	outStats.MaxPositionError = 0.f;
+	outStats.MaxRotationError = 0.f;
+	outStats.MaxScaleError = 0.f;
+
+	std::uint32_t numBones = source.GetBoneCount();
+	if (numBones == 0u)
+	{
+		return;
+	}
+
+	std::vector<Transform> sourceTransforms(numBones);
+	Pose pose(numBones);
+	for (float time : GetSourceKeyTimes(source))
+	{
+		source.Sample(time, nullptr, &sourceTransforms[0]);
+		SampleClip(resampled, time, pose);
+
+		for (std::uint32_t boneIdx = 0u; boneIdx < numBones; boneIdx++)
+		{
+			const Transform& expected = sourceTransforms[boneIdx];
+			Transform actual = pose.GetTransform(boneIdx);
+
+			float dot = fabsf(expected.Rotation.x * actual.Rotation.x + expected.Rotation.y * actual.Rotation.y
+				+ expected.Rotation.z * actual.Rotation.z + expected.Rotation.w * actual.Rotation.w);
+			outStats.MaxPositionError = std::max(outStats.MaxPositionError, (expected.Pos - actual.Pos).Magnitude());
+			outStats.MaxRotationError = std::max(outStats.MaxRotationError, 2.f * acosf(std::min(1.f, dot)));
+			outStats.MaxScaleError = std::max(outStats.MaxScaleError, (expected.Scale - actual.Scale).Magnitude());
+		}
+	}
+}
+
+}
+
+ResampledClip::ResampledClip(std::uint32_t numBones, std::uint32_t paddedBones, std::uint32_t numFrames, float duration, float sampleRate, float* frames)
+	: numBones_(numBones)
+	, paddedBones_(paddedBones)
+	, numFrames_(numFrames)
+	, duration_(duration)
+	, sampleRate_(sampleRate)
+	, frames_(frames)
+{}
+
+ResampledClip::~ResampledClip()
+{
+	_aligned_free(frames_);
+}
+
+std::shared_ptr<ResampledClip> ResampledClip::Create(const AnimationClip& clip, float sampleRate, ResampleStats& outStats)
+{
+	// Always at least two frames, so sampling can lerp between a frame and the next without checks
+	float duration = clip.GetDuration();
+	std::uint32_t numIntervals = std::max(1u, (std::uint32_t)(duration * sampleRate + 0.5f));
+	std::uint32_t numFrames = numIntervals + 1u;
+	float rate = (duration > 0.f) ? numIntervals / duration : 0.f;
+
+	std::uint32_t numBones = clip.GetBoneCount();
+	Pose pose(numBones);
+	std::uint32_t paddedBones = pose.GetPaddedBoneCount();
+	std::uint32_t frameSize = paddedBones * (std::uint32_t)POSE_STREAM::COUNT;
+
+	float* frames = (float*)_aligned_malloc(sizeof(float) * std::max(1u, numFrames * frameSize), Pose::ALIGNMENT);
+	if (frames == nullptr)
+	{
+		Logger::Log("Failed to allocate memory for resampled animation clip");
+		return nullptr;
+	}
+
+	std::shared_ptr<ResampledClip> resampled(new ResampledClip(numBones, paddedBones, numFrames, duration, rate, frames));
+
+	std::vector<BoneAnimation::Cursor> cursors(numBones);
+	for (std::uint32_t frameIdx = 0u; frameIdx < numFrames && numBones > 0u; frameIdx++)
+	{
+		float time = (rate > 0.f) ? std::min(frameIdx / rate, duration) : 0.f;
+		SampleClip(clip, time, &cursors[0], pose);
+
+		// Poses are laid out stream by stream already, the same as a frame
+		float* frame = frames + frameIdx * frameSize;
+		memcpy(frame, pose.GetStream(POSE_STREAM::POS_X), sizeof(float) * frameSize);
+		if (frameIdx > 0u)
+		{
+			MatchHemispheres(frame - frameSize, frame, numBones, paddedBones);
+		}
+	}
+
+	outStats.SizeInBytes = resampled->GetSizeInBytes();
+	MeasureErrors(clip, *resampled, outStats);
+
+	return resampled;
+}
\ No newline at end of file
@@ -0,0 +1,58 @@
+#pragma once
+
+#include "AnimationClip.h"
+#include "Pose.h"
+#include <memory>
+
+struct ResampleStats
+{
+public:
+	std::uint32_t SizeInBytes;
+
+	// Largest difference from the source clip, checked at every source key time
+	float MaxPositionError;
+	float MaxRotationError; // radians
+	float MaxScaleError;
+};
+
+// An AnimationClip sampled at a fixed rate into whole-skeleton frames. Each frame has the
+//  same layout as a Pose (every stream padded to LANE_PADDING bones), and frames are stored
+//  one after another, so sampling is an index computation and one SIMD lerp between two
+//  contiguous frames - no key searches, and no per-instance cursors.
+// Trades memory for speed - every bone stores every component at every frame.
+class ResampledClip
+{
+public:
+	static const float DEFAULT_SAMPLE_RATE;
+
+public:
+	ResampledClip() = delete;
+	ResampledClip(const ResampledClip&) = delete;
+	~ResampledClip();
+
+	// The rate is adjusted slightly so that frames land exactly on the start and end of the clip
+	static std::shared_ptr<ResampledClip> Create(const AnimationClip& clip, float sampleRate, ResampleStats& outStats);
+
+	std::uint32_t GetBoneCount() const { return numBones_; }
+	std::uint32_t GetPaddedBoneCount() const { return paddedBones_; }
+	float GetDuration() const { return duration_; }
+	float GetSampleRate() const { return sampleRate_; }
+	std::uint32_t GetFrameCount() const { return numFrames_; }
+	std::uint32_t GetSizeInBytes() const { return numFrames_ * GetFrameSize() * (std::uint32_t)sizeof(float); }
+
+	// POSE_STREAM::COUNT streams of GetPaddedBoneCount() floats each
+	const float* GetFrame(std::uint32_t frameIdx) const { return frames_ + frameIdx * GetFrameSize(); }
+
+private:
+	ResampledClip(std::uint32_t numBones, std::uint32_t paddedBones, std::uint32_t numFrames, float duration, float sampleRate, float* frames);
+
+	std::uint32_t GetFrameSize() const { return paddedBones_ * (std::uint32_t)POSE_STREAM::COUNT; }
+
+private:
+	std::uint32_t numBones_;
+	std::uint32_t paddedBones_;
+	std::uint32_t numFrames_;
+	float duration_;
+	float sampleRate_;
+	float* frames_;
+};
\ No newline at end of file
@@ -1,33 +1,80 @@
 #include "RoadBaseModel.h"
 #include "Logger.h"
+#include "MeshBaker.h"
+#include "MeshProcessing.h"
 #include <assimp/cimport.h>
 #include <assimp/scene.h>
 #include <assimp/postprocess.h>
 #include <assimp/material.h>
+#include <assert.h>
+#include <chrono>
+#include <sstream>
 
 #ifndef VALIDATE
 #define VALIDATE(hr, msg) if (FAILED(hr)) { Logger::Log(msg); return false; }
 #endif
 
 const char * RoadBaseModel::FILENAME = "../../assets/Road.fbx";
+const char * RoadBaseModel::BAKED_FILENAME = "../../assets/Road.mesh";
 
-RoadBaseModel::RoadBaseModel(std::shared_ptr<BasicShaderMD> shader, ComPtr<ID3D11DeviceContext> context, Transform transform)
+RoadBaseModel::RoadBaseModel(std::uint32_t shaderKey, Transform transform)
 	: ISceneNode(transform)
-	, renderContext_(context)
-	, shader_(shader)
+	, shaderKey_(shaderKey)
 	, models_()
 {}
 
 std::future<bool> RoadBaseModel::Initialize(ComPtr<ID3D11Device> device)
 {
 	return std::async(std::launch::async, [this, device] {
-		return InitVertexAndIndexBuffers(device);
+		auto loadStart = std::chrono::high_resolution_clock::now();
+
+		bool isValid = false;
+		std::shared_ptr<BakedMesh> bakedMesh = BakedMesh::Load(RoadBaseModel::BAKED_FILENAME);
+		if (bakedMesh)
+		{
+			isValid = InitFromBakedMesh(device, *bakedMesh);
+		}
+		else
+		{
+			Logger::Log("No baked road mesh found, importing FBX instead (run with --bake to create it)");
+			isValid = InitVertexAndIndexBuffers(device);
+		}
+
+		std::stringstream ss;
+		ss << "Road model loaded from " << (bakedMesh ? "baked mesh" : "FBX") << " in "
+			<< std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::high_resolution_clock::now() - loadStart).count() / 1000.f << "ms";
+		Logger::Log(ss.str());
+
+		return isValid;
 	});
 }
 
+bool RoadBaseModel::Bake()
+{
+	return BakeMesh(RoadBaseModel::FILENAME, RoadBaseModel::BAKED_FILENAME, MeshBakeOptions(true, INFLUENCE_WEIGHT_FORMAT::UNORM16));
+}
+
+void RoadBaseModel::AddMeshes(D3D11RenderBackend& backend)
+{
+	for (ModelData& model : models_)
+	{
+		model.MaterialKey = backend.AddMaterial(model.Material);
+		model.MeshKey = backend.AddMesh(D3D11RenderBackend::Mesh(model.VertexBuffer, model.IndexBuffer, model.IndexFormat, sizeof(BasicShaderMD::Vertex), model.NumIndices));
+	}
+}
+
 void RoadBaseModel::SetTransform(Transform transform)
 {
-	transform_ = transform;
+	SetLocalTransform(transform);
+}
+
+void RoadBaseModel::AddToHierarchy(TransformHierarchy& hierarchy, std::uint32_t parentNode)
+{
+	ISceneNode::AddToHierarchy(hierarchy, parentNode);
+	for (ModelData& model : models_)
+	{
+		model.HierarchyNode = hierarchy.AddNode(hierarchyNode_, model.Transform);
+	}
 }
 
 bool RoadBaseModel::Update(float dt)
@@ -36,27 +83,18 @@ bool RoadBaseModel::Update(float dt)
 	return true;
 }
 
-bool RoadBaseModel::Render()
+bool RoadBaseModel::Render(RenderQueue& queue)
 {
-	std::uint32_t stride = sizeof(BasicShaderMD::Vertex);
-	std::uint32_t offset = 0u;
-	
-	bool isValid = true;
+	assert(hierarchy_ != nullptr);
 
-	for (ModelData model : models_)
+	// The queue gathers the draws of each mesh, across every copy of the model, into one
+	//  instanced draw
+	for (const ModelData& model : models_)
 	{
-		// NEXT TIME: Optimize this by passing to a manager to render all
-		//  things at once that require the same shader and bindings.
-		// Try to minimize graphics card data binding changes, etc.
-		renderContext_->IASetVertexBuffers(0, 1, model.VertexBuffer.GetAddressOf(), &stride, &offset);
-		renderContext_->IASetIndexBuffer(model.IndexBuffer.Get(), DXGI_FORMAT_R16_UINT, 0);
-		renderContext_->IASetPrimitiveTopology(D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
-		shader_->SetModelMatrix((transform_ * model.Transform).GetTransformMatrix());
-		shader_->SetObjectMaterial(model.Material);
-		isValid &= shader_->Render(renderContext_, model.NumIndices);
+		queue.AddDraw(DrawPacket(RenderQueue::SCENE_PASS, shaderKey_, model.MaterialKey, model.MeshKey, RenderQueue::INVALID_KEY, hierarchy_->GetWorldMatrix(model.HierarchyNode)));
 	}
 
-	return isValid;
+	return true;
 }
 
 bool RoadBaseModel::InitVertexAndIndexBuffers(ComPtr<ID3D11Device> device)
@@ -77,8 +115,9 @@ bool RoadBaseModel::InitVertexAndIndexBuffers(ComPtr<ID3D11Device> device)
 		// Using a vector to prevent frequent memory allocations and frees between
 		//  models in the mesh.
 		std::vector<BasicShaderMD::Vertex> vertices;
-		std::vector<std::uint16_t> indices;
-		for (std::uint8_t meshIdx = 0u; meshIdx < roadBaseModel->mNumMeshes; meshIdx++)
+		std::vector<std::uint32_t> indices;
+		std::vector<std::uint16_t> shortIndices;
+		for (std::uint32_t meshIdx = 0u; meshIdx < roadBaseModel->mNumMeshes; meshIdx++)
 		{
 			vertices.clear();
 			indices.clear();
@@ -105,8 +144,8 @@ bool RoadBaseModel::InitVertexAndIndexBuffers(ComPtr<ID3D11Device> device)
 			//	vertices.push_back(BasicShaderMD::Vertex(Vec4(v.x, v.y, v.z, 1.f), Vec4(n.x, n.y, n.z, 0.f)));
 			//}
 
-			unsigned int k = 0u;
-			for (std::uint16_t faceIdx = 0u; faceIdx < roadBaseModel->mMeshes[meshIdx]->mNumFaces; faceIdx++)
+			std::uint32_t k = 0u;
+			for (std::uint32_t faceIdx = 0u; faceIdx < roadBaseModel->mMeshes[meshIdx]->mNumFaces; faceIdx++)
 			{
 #if defined(DEBUG) | defined(_DEBUG)
 				if (roadBaseModel->mMeshes[meshIdx]->mFaces[faceIdx].mNumIndices != 3u)
@@ -119,6 +158,7 @@ bool RoadBaseModel::InitVertexAndIndexBuffers(ComPtr<ID3D11Device> device)
 				auto v2 = roadBaseModel->mMeshes[meshIdx]->mVertices[roadBaseModel->mMeshes[meshIdx]->mFaces[faceIdx].mIndices[1u]];
 				auto v3  = roadBaseModel->mMeshes[meshIdx]->mVertices[roadBaseModel->mMeshes[meshIdx]->mFaces[faceIdx].mIndices[2u]];
 				auto n = Vec3::Cross(Vec3(v2.x - v1.x, v2.y - v1.y, v2.z - v1.z), Vec3(v3.x - v1.x, v3.y - v1.y, v3.z - v1.z)).Normal();
+				n = n + Vec3(0.f, 0.f, 0.f); // -0 to +0, so welding treats them as equal
 				//auto n = roadBaseModel->mMeshes[meshIdx]->mNormals[roadBaseModel->mMeshes[meshIdx]->mFaces[faceIdx].mIndices[0u]];
 				vertices.push_back(BasicShaderMD::Vertex(Vec4(v1.x, v1.y, v1.z, 1.f), Vec4(n.x, n.y, n.z, 0.f)));
 
@@ -136,6 +176,26 @@ bool RoadBaseModel::InitVertexAndIndexBuffers(ComPtr<ID3D11Device> device)
 				indices.push_back(k++);
 			}
 
+			// Every face was given its own vertices above - share the ones that match
+			std::uint32_t numSourceVertices = (std::uint32_t)vertices.size();
+			std::uint32_t numVertices = WeldVertices(&vertices[0], sizeof(BasicShaderMD::Vertex), numSourceVertices, indices);
+
+			MeshOptimizationStats optimizationStats;
+			numVertices = OptimizeMesh(&vertices[0], sizeof(BasicShaderMD::Vertex), numVertices, indices, optimizationStats);
+			vertices.erase(vertices.begin() + numVertices, vertices.end());
+
+			std::stringstream ss;
+			ss << "Road mesh " << meshIdx << " welded from " << numSourceVertices << " to " << numVertices << " vertices, ACMR "
+				<< optimizationStats.Before.ACMR << " -> " << optimizationStats.After.ACMR << ", ATVR "
+				<< optimizationStats.Before.ATVR << " -> " << optimizationStats.After.ATVR;
+			Logger::Log(ss.str());
+
+			std::uint32_t indexSize = GetIndexSize(numVertices);
+			if (indexSize == sizeof(std::uint16_t))
+			{
+				NarrowIndices(indices, shortIndices);
+			}
+
 			// Vertices and indices are loaded, create buffers
 			D3D11_BUFFER_DESC vbDesc = { 0 };
 			vbDesc.BindFlags = D3D11_BIND_VERTEX_BUFFER;
@@ -147,7 +207,7 @@ bool RoadBaseModel::InitVertexAndIndexBuffers(ComPtr<ID3D11Device> device)
 
 			D3D11_BUFFER_DESC ibDesc = { 0 };
 			ibDesc.BindFlags = D3D11_BIND_INDEX_BUFFER;
-			ibDesc.ByteWidth = sizeof(std::uint16_t) * (UINT)indices.size();
+			ibDesc.ByteWidth = indexSize * (UINT)indices.size();
 			ibDesc.CPUAccessFlags = 0x00;
 			ibDesc.MiscFlags = 0x00;
 			ibDesc.StructureByteStride = 0x00;
@@ -160,7 +220,7 @@ bool RoadBaseModel::InitVertexAndIndexBuffers(ComPtr<ID3D11Device> device)
 			D3D11_SUBRESOURCE_DATA vertexData = { 0 };
 			D3D11_SUBRESOURCE_DATA indexData = { 0 };
 			vertexData.pSysMem = &vertices[0];
-			indexData.pSysMem = &indices[0];
+			indexData.pSysMem = (indexSize == sizeof(std::uint16_t)) ? (const void*)&shortIndices[0] : (const void*)&indices[0];
 
 			HRESULT hr = { 0 };
 			ModelData nextModel;
@@ -171,6 +231,7 @@ bool RoadBaseModel::InitVertexAndIndexBuffers(ComPtr<ID3D11Device> device)
 			VALIDATE(hr, "Failed to create index buffer (road model)");
 
 			nextModel.NumIndices = (std::uint32_t)indices.size();
+			nextModel.IndexFormat = (indexSize == sizeof(std::uint16_t)) ? DXGI_FORMAT_R16_UINT : DXGI_FORMAT_R32_UINT;
 			
 			// Material
 			auto foo = roadBaseModel->mMaterials[roadBaseModel->mMeshes[meshIdx]->mMaterialIndex];
@@ -199,5 +260,53 @@ bool RoadBaseModel::InitVertexAndIndexBuffers(ComPtr<ID3D11Device> device)
 
 	aiReleaseImport(roadBaseModel);
 
+	return true;
+}
+
+bool RoadBaseModel::InitFromBakedMesh(ComPtr<ID3D11Device> device, const BakedMesh& bakedMesh)
+{
+	models_.reserve(bakedMesh.GetMeshCount());
+
+	for (std::uint32_t meshIdx = 0u; meshIdx < bakedMesh.GetMeshCount(); meshIdx++)
+	{
+		const BakedMesh::MeshEntry& mesh = bakedMesh.GetMesh(meshIdx);
+		if (mesh.VertexStride != sizeof(BasicShaderMD::Vertex))
+		{
+			Logger::Log("Baked road mesh does not match the road model vertex format - rebake it");
+			return false;
+		}
+
+		D3D11_BUFFER_DESC vbDesc = {};
+		vbDesc.BindFlags = D3D11_BIND_VERTEX_BUFFER;
+		vbDesc.ByteWidth = mesh.VertexStride * mesh.NumVertices;
+		vbDesc.Usage = D3D11_USAGE_IMMUTABLE;
+
+		D3D11_BUFFER_DESC ibDesc = {};
+		ibDesc.BindFlags = D3D11_BIND_INDEX_BUFFER;
+		ibDesc.ByteWidth = mesh.IndexSize * mesh.NumIndices;
+		ibDesc.Usage = D3D11_USAGE_IMMUTABLE;
+
+		// Streams are uploaded straight out of the mapped file
+		D3D11_SUBRESOURCE_DATA vertexData = {};
+		D3D11_SUBRESOURCE_DATA indexData = {};
+		vertexData.pSysMem = bakedMesh.GetVertexData(meshIdx);
+		indexData.pSysMem = bakedMesh.GetIndexData(meshIdx);
+
+		HRESULT hr = S_OK;
+		ModelData nextModel;
+		hr = device->CreateBuffer(&vbDesc, &vertexData, &nextModel.VertexBuffer);
+		VALIDATE(hr, "Failed to create vertex buffer (baked road model)");
+
+		hr = device->CreateBuffer(&ibDesc, &indexData, &nextModel.IndexBuffer);
+		VALIDATE(hr, "Failed to create index buffer (baked road model)");
+
+		nextModel.NumIndices = mesh.NumIndices;
+		nextModel.IndexFormat = (mesh.IndexSize == sizeof(std::uint16_t)) ? DXGI_FORMAT_R16_UINT : DXGI_FORMAT_R32_UINT;
+		nextModel.Material = bakedMesh.GetMaterial(meshIdx);
+		nextModel.Transform = Transform();
+
+		models_.push_back(nextModel);
+	}
+
 	return true;
 }
\ No newline at end of file
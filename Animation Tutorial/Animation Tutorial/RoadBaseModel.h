@@ -2,6 +2,8 @@
 
 #include "ISceneNode.h"
 #include "BasicShaderMD.h"
+#include "D3D11RenderBackend.h"
+#include "BakedMesh.h"
 #include <wrl.h>
 #include <string>
 #include <vector>
@@ -17,40 +19,60 @@ protected:
 		std::uint32_t NumIndices;
 		ComPtr<ID3D11Buffer> VertexBuffer;
 		ComPtr<ID3D11Buffer> IndexBuffer;
+		DXGI_FORMAT IndexFormat;
 		Material Material;
 		Transform Transform;
 
+		// Keys given by the render backend, once the mesh is added to it
+		std::uint32_t MeshKey;
+		std::uint32_t MaterialKey;
+
+		// Child of the model's node, placed at Transform
+		std::uint32_t HierarchyNode;
+
 		ModelData()
 			: NumIndices(0u)
 			, VertexBuffer(nullptr)
 			, IndexBuffer(nullptr)
+			, IndexFormat(DXGI_FORMAT_R32_UINT)
 			, Material(Material::BasicGray)
 			, Transform()
+			, MeshKey(RenderQueue::INVALID_KEY)
+			, MaterialKey(RenderQueue::INVALID_KEY)
+			, HierarchyNode(TransformHierarchy::INVALID_INDEX)
 		{}
 	};
 
 protected:
 	static const char * FILENAME;
+	static const char * BAKED_FILENAME;
 
 public:
 	RoadBaseModel() = delete;
-	RoadBaseModel(std::shared_ptr<BasicShaderMD> shader, ComPtr<ID3D11DeviceContext> context, Transform transform);
+	RoadBaseModel(std::uint32_t shaderKey, Transform transform);
 	RoadBaseModel(const RoadBaseModel&) = delete;
 	~RoadBaseModel() = default;
 
 	std::future<bool> Initialize(ComPtr<ID3D11Device> device);
+
+	// Once initialized, gives the meshes and materials to the backend its draws will be submitted to
+	void AddMeshes(D3D11RenderBackend& backend);
 	void SetTransform(Transform transform);
 
+	// Writes the baked mesh that Initialize prefers over importing the FBX file
+	static bool Bake();
+
 public:
 	// Inherited via ISceneNode
 	virtual bool Update(float dt) override;
-	virtual bool Render() override;
+	virtual bool Render(RenderQueue& queue) override;
+	virtual void AddToHierarchy(TransformHierarchy& hierarchy, std::uint32_t parentNode) override;
 
 private:
 	bool InitVertexAndIndexBuffers(ComPtr<ID3D11Device> device);
+	bool InitFromBakedMesh(ComPtr<ID3D11Device> device, const BakedMesh& bakedMesh);
 
 private:
-	ComPtr<ID3D11DeviceContext> renderContext_;
-	std::shared_ptr<BasicShaderMD> shader_;
+	std::uint32_t shaderKey_;
 	std::vector<ModelData> models_;
 };
\ No newline at end of file
@@ -1,11 +1,37 @@
 #include "RootSceneNode.h"
+#include <algorithm>
+
+namespace
+{
+
+// Children updated by each job - enough to amortize the cost of a job on cheap nodes,
+//  while still leaving plenty of jobs to balance across threads
+const std::uint32_t CHILDREN_PER_JOB = 4u;
+
+}
 
 RootSceneNode::RootSceneNode()
 	: ISceneNode()
+	, children_()
+	, jobSystem_(nullptr)
+	, updateResults_()
 {}
 
 bool RootSceneNode::Update(float dt)
 {
+	if (jobSystem_)
+	{
+		updateResults_.resize(children_.size());
+		jobSystem_->ParallelFor((std::uint32_t)children_.size(), CHILDREN_PER_JOB, [this, dt](std::uint32_t begin, std::uint32_t end) {
+			for (std::uint32_t i = begin; i < end; i++)
+			{
+				updateResults_[i] = children_[i]->Update(dt) ? 1u : 0u;
+			}
+		});
+
+		return std::find(updateResults_.begin(), updateResults_.end(), 0u) == updateResults_.end();
+	}
+
 	bool isValid = true;
 	for (auto child : children_)
 	{
@@ -14,12 +40,12 @@ bool RootSceneNode::Update(float dt)
 	return isValid;
 }
 
-bool RootSceneNode::Render()
+bool RootSceneNode::Render(RenderQueue& queue)
 {
 	bool isValid = true;
 	for (auto child : children_)
 	{
-		isValid &= child->Render();
+		isValid &= child->Render(queue);
 	}
 	return isValid;
 }
\ No newline at end of file
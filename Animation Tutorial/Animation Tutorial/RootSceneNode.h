@@ -1,6 +1,8 @@
 #pragma once
 
 #include "ISceneNode.h"
+#include "JobSystem.h"
+#include <memory>
 #include <vector>
 
 class RootSceneNode : public ISceneNode
@@ -10,11 +12,21 @@ public:
 
 	// Inherited via ISceneNode
 	virtual bool Update(float dt) override;
-	virtual bool Render() override;
+	virtual bool Render(RenderQueue& queue) override;
 
+	// Every node of the scene graph, wherever it is in the transform hierarchy - updating
+	//  and rendering do not depend on the hierarchy, so the list stays flat
 	std::vector<std::shared_ptr<ISceneNode>>& Children() { return children_; }
 	void AddChild(std::shared_ptr<ISceneNode> newChild) { children_.push_back(newChild); }
 
+	// With a job system, children update in parallel and must not touch each other's state.
+	//  Update still returns only once every child has finished, so rendering is unaffected.
+	void SetJobSystem(std::shared_ptr<JobSystem> jobSystem) { jobSystem_ = jobSystem; }
+
 private:
 	std::vector<std::shared_ptr<ISceneNode>> children_;
+	std::shared_ptr<JobSystem> jobSystem_;
+
+	// One result per child, so parallel updates never write to the same memory
+	std::vector<std::uint8_t> updateResults_;
 };
\ No newline at end of file
@@ -0,0 +1,19 @@
+#pragma once
+
+#include "maffs.h"
+
+struct RotationKeyframe
+{
+public:
+	float Time;
+	Quaternion Rotation;
+
+public:
+	RotationKeyframe(float time, Quaternion rotation)
+		: Time(time)
+		, Rotation(rotation)
+	{}
+	RotationKeyframe(const RotationKeyframe&) = default;
+
+	static Quaternion LERP(const RotationKeyframe& kf1, const RotationKeyframe& kf2, float time);
+};
\ No newline at end of file
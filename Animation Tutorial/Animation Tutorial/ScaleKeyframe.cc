@@ -0,0 +1,8 @@
+#include "ScaleKeyframe.h"
+
+Vec3 ScaleKeyframe::LERP(const ScaleKeyframe& kf1, const ScaleKeyframe& kf2, float time)
+{
+	float ratio = (time - kf1.Time) / (kf2.Time - kf1.Time);
+
+	return kf1.Scale * (1.f - ratio) + kf2.Scale * ratio;
+}
\ No newline at end of file
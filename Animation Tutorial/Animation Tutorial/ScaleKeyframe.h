@@ -0,0 +1,19 @@
+#pragma once
+
+#include "maffs.h"
+
+struct ScaleKeyframe
+{
+public:
+	float Time;
+	Vec3 Scale;
+
+public:
+	ScaleKeyframe(float time, Vec3 scale)
+		: Time(time)
+		, Scale(scale)
+	{}
+	ScaleKeyframe(const ScaleKeyframe&) = default;
+
+	static Vec3 LERP(const ScaleKeyframe& kf1, const ScaleKeyframe& kf2, float time);
+};
\ No newline at end of file
@@ -2,22 +2,35 @@
 #include "Logger.h"
 
 SceneGraph::SceneGraph()
-	: sceneRoot_()
+	: hierarchy_()
+	, numTransformUpdates_(0u)
+	, sceneRoot_()
 	, sceneNodes_()
-{}
+{
+	sceneRoot_.AddToHierarchy(hierarchy_, TransformHierarchy::INVALID_INDEX);
+}
 
 bool SceneGraph::Update(float dt)
 {
-	return sceneRoot_.Update(dt);
+	bool isValid = sceneRoot_.Update(dt);
+	numTransformUpdates_ = hierarchy_.UpdateWorldTransforms();
+	return isValid;
 }
 
-bool SceneGraph::Render()
+bool SceneGraph::Render(RenderQueue& queue)
 {
-	return sceneRoot_.Render();
+	return sceneRoot_.Render(queue);
 }
 
 void SceneGraph::AddSceneNode(const char* nodeName, std::shared_ptr<ISceneNode> sceneNode)
 {
+	AddSceneNode(nodeName, sceneNode, nullptr);
+}
+
+void SceneGraph::AddSceneNode(const char* nodeName, std::shared_ptr<ISceneNode> sceneNode, std::shared_ptr<ISceneNode> parentNode)
+{
+	sceneNode->AddToHierarchy(hierarchy_, (parentNode != nullptr) ? parentNode->GetHierarchyNode() : sceneRoot_.GetHierarchyNode());
+
 	if (nodeName != nullptr)
 	{
 		sceneNodes_.emplace(std::string(nodeName), sceneNode);
@@ -26,6 +39,12 @@ void SceneGraph::AddSceneNode(const char* nodeName, std::shared_ptr<ISceneNode>
 	sceneRoot_.AddChild(sceneNode);
 }
 
+void SceneGraph::SetJobSystem(std::shared_ptr<JobSystem> jobSystem)
+{
+	sceneRoot_.SetJobSystem(jobSystem);
+	hierarchy_.SetJobSystem(jobSystem);
+}
+
 std::shared_ptr<ISceneNode> SceneGraph::GetNodeByName(std::string nodeName)
 {
 	return sceneNodes_[nodeName];
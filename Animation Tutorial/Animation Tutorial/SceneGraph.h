@@ -1,23 +1,40 @@
 #pragma once
 
 #include "RootSceneNode.h"
+#include "TransformHierarchy.h"
 #include <vector>
 #include <map>
 #include <memory>
 
+// Every node of the scene, updated and rendered through the root. Node transforms form a
+//  hierarchy of their own (see TransformHierarchy.h): once the nodes have updated, the world
+//  transforms of the nodes they moved, and of everything below those, are brought up to date
+//  before anything renders.
 class SceneGraph
 {
 public:
 	SceneGraph();
 
 	bool Update(float dt);
-	bool Render();
+	bool Render(RenderQueue& queue);
 
+	// The parent, if given, must already be in the scene graph. Nodes without one hang off the root.
 	void AddSceneNode(const char* nodeName, std::shared_ptr<ISceneNode> sceneNode);
+	void AddSceneNode(const char* nodeName, std::shared_ptr<ISceneNode> sceneNode, std::shared_ptr<ISceneNode> parentNode);
 	std::shared_ptr<ISceneNode> GetNodeByName(std::string nodeName);
 	RootSceneNode& GetRoot() { return sceneRoot_; }
+	const TransformHierarchy& GetHierarchy() const { return hierarchy_; }
+
+	// World transforms recomputed by the last update
+	std::uint32_t GetTransformUpdateCount() const { return numTransformUpdates_; }
+
+	// Nodes and wide levels of the hierarchy update in parallel on the given job system, or
+	//  serially if it is null
+	void SetJobSystem(std::shared_ptr<JobSystem> jobSystem);
 
 private:
+	TransformHierarchy hierarchy_;
+	std::uint32_t numTransformUpdates_;
 	RootSceneNode sceneRoot_;
 	std::map<std::string, std::shared_ptr<ISceneNode>> sceneNodes_;
 };
\ No newline at end of file
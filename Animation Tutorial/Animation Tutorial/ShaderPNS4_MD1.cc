@@ -6,18 +6,15 @@
 #define VALIDATE(hr, msg) if (FAILED(hr)) { Logger::Log(msg); return false; }
 #endif
 
-ShaderPNS4_MD1::ShaderPNS4_MD1()
+ShaderPNS4_MD1::ShaderPNS4_MD1(INFLUENCE_WEIGHT_FORMAT influenceFormat)
 	: vs_cb_frame_({ Matrix(), Matrix() })
-	, vs_cb_object_({ Matrix() })
-	, ps_cb_object_({ Material::BasicGray })
 	, ps_cb_scene_({ DirectionalLight(Color::White, Color::White, Color::White, Vec3::Zero, 1.f) })
 	, ps_cb_frame_({ Vec4(0.f, 0.f, 0.f, 1.f) })
+	, influenceFormat_(influenceFormat)
 	, vertShader_(nullptr)
 	, pixelShader_(nullptr)
 	, inputLayout_(nullptr)
 	, vs_cb_frame_buffer_(nullptr)
-	, vs_cb_object_buffer_(nullptr)
-	, ps_cb_object_buffer_(nullptr)
 	, ps_cb_scene_buffer_(nullptr)
 	, ps_cb_frame_buffer_(nullptr)
 {}
@@ -25,7 +22,7 @@ ShaderPNS4_MD1::ShaderPNS4_MD1()
 std::future<bool> ShaderPNS4_MD1::Initialize(ComPtr<ID3D11Device> device)
 {
 	return std::async(std::launch::async, [this, device] {
-		const char* vsFname = "./BasicPosNorm.cso";
+		const char* vsFname = "./SkinnedPosNorm.cso";
 		const char* psFname = "./BasicMaterialDirectional1.ps.cso";
 		
 		std::uint32_t vsDataLength = 0u;
@@ -33,10 +30,14 @@ std::future<bool> ShaderPNS4_MD1::Initialize(ComPtr<ID3D11Device> device)
 
 		HRESULT hr = { 0 };
 
+		// Influences are the second stream, packed as PackInfluences lays them out
+		DXGI_FORMAT weightFormat = (influenceFormat_ == INFLUENCE_WEIGHT_FORMAT::UNORM16) ? DXGI_FORMAT_R16G16B16A16_UNORM : DXGI_FORMAT_R8G8B8A8_UNORM;
 		D3D11_INPUT_ELEMENT_DESC inputLayout[] =
 		{
 			{ "POSITION", 0, DXGI_FORMAT_R32G32B32A32_FLOAT, 0, 0, D3D11_INPUT_PER_VERTEX_DATA, 0 },
-			{ "NORMAL", 0, DXGI_FORMAT_R32G32B32A32_FLOAT, 0, D3D11_APPEND_ALIGNED_ELEMENT, D3D11_INPUT_PER_VERTEX_DATA, 0 }
+			{ "NORMAL", 0, DXGI_FORMAT_R32G32B32A32_FLOAT, 0, D3D11_APPEND_ALIGNED_ELEMENT, D3D11_INPUT_PER_VERTEX_DATA, 0 },
+			{ "BLENDINDICES", 0, DXGI_FORMAT_R8G8B8A8_UINT, 1, 0, D3D11_INPUT_PER_VERTEX_DATA, 0 },
+			{ "BLENDWEIGHT", 0, weightFormat, 1, D3D11_APPEND_ALIGNED_ELEMENT, D3D11_INPUT_PER_VERTEX_DATA, 0 }
 		};
 		std::uint32_t numElements = _countof(inputLayout);
 
@@ -81,18 +82,10 @@ std::future<bool> ShaderPNS4_MD1::Initialize(ComPtr<ID3D11Device> device)
 		bufferDesc.MiscFlags = 0x00;
 		bufferDesc.StructureByteStride = 0x00;
 
-		bufferDesc.ByteWidth = sizeof(ShaderPNS4_MD1::VSCBuffer_PerObject_Type);
-		hr = device->CreateBuffer(&bufferDesc, nullptr, &vs_cb_object_buffer_);
-		VALIDATE(hr, "Failed to create vertex buffer per-object constant buffer");
-
 		bufferDesc.ByteWidth = sizeof(ShaderPNS4_MD1::VSCBuffer_PerFrame_Type);
 		hr = device->CreateBuffer(&bufferDesc, nullptr, &vs_cb_frame_buffer_);
 		VALIDATE(hr, "Failed to create vertex buffer per-frame constant buffer");
 
-		bufferDesc.ByteWidth = sizeof(ShaderPNS4_MD1::PSCBuffer_PerObject_Type);
-		hr = device->CreateBuffer(&bufferDesc, nullptr, &ps_cb_object_buffer_);
-		VALIDATE(hr, "Failed to create pixel buffer per-object constant buffer");
-
 		bufferDesc.ByteWidth = sizeof(ShaderPNS4_MD1::PSCBuffer_PerScene_Type);
 		hr = device->CreateBuffer(&bufferDesc, nullptr, &ps_cb_scene_buffer_);
 		VALIDATE(hr, "Failed to create pixel buffer per-scene constant buffer");
@@ -127,7 +120,7 @@ std::future<bool> ShaderPNS4_MD1::Initialize(ComPtr<ID3D11Device> device)
 	});
 }
 
-bool ShaderPNS4_MD1::Render(ComPtr<ID3D11DeviceContext> context, std::uint32_t nVertsToDraw)
+bool ShaderPNS4_MD1::Bind(ComPtr<ID3D11DeviceContext> context)
 {
 	HRESULT hr = { 0 };
 
@@ -152,39 +145,9 @@ bool ShaderPNS4_MD1::Render(ComPtr<ID3D11DeviceContext> context, std::uint32_t n
 		vs_cb_frame_.Clean();
 	}
 
-	if (vs_cb_object_.IsDirty())
-	{
-		D3D11_MAPPED_SUBRESOURCE vscb;
-		VSCBuffer_PerObject_Type* data;
-
-		hr = context->Map(vs_cb_object_buffer_.Get(), 0, D3D11_MAP_WRITE_DISCARD, 0x00, &vscb);
-		VALIDATE(hr, "Failed to map vertex per-object constant buffer for CPU writing");
-
-		data = (VSCBuffer_PerObject_Type*)vscb.pData;
-		data->Model = vs_cb_object_.Get().Model;
-
-		context->Unmap(vs_cb_object_buffer_.Get(), 0);
-
-		vs_cb_object_.Clean();
-	}
-	ID3D11Buffer* vsCBuffers[] = { vs_cb_object_buffer_.Get(), vs_cb_frame_buffer_.Get() };
-	context->VSSetConstantBuffers(0, _countof(vsCBuffers), vsCBuffers);
-
-	if (ps_cb_object_.IsDirty())
-	{
-		D3D11_MAPPED_SUBRESOURCE pscb;
-		PSCBuffer_PerObject_Type* data;
-
-		hr = context->Map(ps_cb_object_buffer_.Get(), 0, D3D11_MAP_WRITE_DISCARD, 0x00, &pscb);
-		VALIDATE(hr, "Failed to map per-object constant buffer for CPU writing");
-
-		data = (PSCBuffer_PerObject_Type*)pscb.pData;
-		data->ObjectMaterial = ps_cb_object_.Get().ObjectMaterial;
-
-		context->Unmap(ps_cb_object_buffer_.Get(), 0);
-
-		ps_cb_object_.Clean();
-	}
+	// Slot 0 holds the per-object constants, bound by the render backend for each draw
+	ID3D11Buffer* vsCBuffers[] = { vs_cb_frame_buffer_.Get() };
+	context->VSSetConstantBuffers(1, _countof(vsCBuffers), vsCBuffers);
 
 	if (ps_cb_scene_.IsDirty())
 	{
@@ -218,21 +181,12 @@ bool ShaderPNS4_MD1::Render(ComPtr<ID3D11DeviceContext> context, std::uint32_t n
 		ps_cb_frame_.Clean();
 	}
 
-	ID3D11Buffer*psCBuffers[] = { ps_cb_object_buffer_.Get(), ps_cb_scene_buffer_.Get(), ps_cb_frame_buffer_.Get() };
-	context->PSSetConstantBuffers(0, _countof(psCBuffers), psCBuffers);
-
-	// Perform actual draw calls
-	context->DrawIndexed(nVertsToDraw, 0, 0);
+	ID3D11Buffer*psCBuffers[] = { ps_cb_scene_buffer_.Get(), ps_cb_frame_buffer_.Get() };
+	context->PSSetConstantBuffers(1, _countof(psCBuffers), psCBuffers);
 
 	return true;
 }
 
-void ShaderPNS4_MD1::SetModelMatrix(const Matrix& model)
-{
-	vs_cb_object_.Get().Model = model;
-	vs_cb_object_.Dirty();
-}
-
 void ShaderPNS4_MD1::SetViewMatrix(const Matrix& view)
 {
 	vs_cb_frame_.Get().View = view.Transpose();
@@ -251,12 +205,6 @@ void ShaderPNS4_MD1::SetCameraPosition(const Vec3 & position)
 	ps_cb_frame_.Dirty();
 }
 
-void ShaderPNS4_MD1::SetObjectMaterial(const Material& mat)
-{
-	ps_cb_object_.Get().ObjectMaterial = mat;
-	ps_cb_object_.Dirty();
-}
-
 void ShaderPNS4_MD1::SetDirectionalLight1(const DirectionalLight& dl)
 {
 	ps_cb_scene_.Get().DirectionalLight1 = dl;
@@ -11,13 +11,18 @@
 #include "Dirtyable.h"
 #include <d3d11.h>
 #include "Material.h"
+#include "IShader.h"
 #include "DirectionalLight.h"
 #include "Transform.h"
+#include "SkinWeights.h"
 #include <wrl.h>
 #include <vector>
 using Microsoft::WRL::ComPtr;
 
-class ShaderPNS4_MD1
+// Skins its vertices with up to four bones each, reading the palette of each instance from
+//  the frame's palettes. Meshes drawn with it give their packed influences (see SkinWeights.h)
+//  as a second vertex stream, with weights of the format the shader was created for.
+class ShaderPNS4_MD1 : public IShader
 {
 public:
 	struct Vertex
@@ -28,22 +33,12 @@ public:
 	};
 
 protected:
-	struct VSCBuffer_PerObject_Type
-	{
-		Matrix Model;
-	};
-
 	struct VSCBuffer_PerFrame_Type
 	{
 		Matrix View;
 		Matrix Proj;
 	};
 
-	struct PSCBuffer_PerObject_Type
-	{
-		Material ObjectMaterial;
-	};
-
 	struct PSCBuffer_PerFrame_Type
 	{
 		Vec4 CameraPosition;
@@ -55,36 +50,32 @@ protected:
 	};
 
 public:
-	ShaderPNS4_MD1();
+	explicit ShaderPNS4_MD1(INFLUENCE_WEIGHT_FORMAT influenceFormat);
 	ShaderPNS4_MD1(const ShaderPNS4_MD1&) = delete;
 	~ShaderPNS4_MD1() = default;
 
 	std::future<bool> Initialize(ComPtr<ID3D11Device> device);
-	bool Render(ComPtr<ID3D11DeviceContext> context, std::uint32_t nVertsToDraw);
+
+	// Inherited via IShader
+	virtual bool Bind(ComPtr<ID3D11DeviceContext> context) override;
 
 	// Shader property setters
-	void SetModelMatrix(const Matrix& model);
 	void SetViewMatrix(const Matrix& view);
 	void SetProjMatrix(const Matrix& proj);
 	void SetCameraPosition(const Vec3& position);
-
-	void SetObjectMaterial(const Material& mat);
 	void SetDirectionalLight1(const DirectionalLight& dl1);
 
 private:
 	Dirtyable<VSCBuffer_PerFrame_Type> vs_cb_frame_;
-	Dirtyable<VSCBuffer_PerObject_Type> vs_cb_object_;
-	Dirtyable<PSCBuffer_PerObject_Type> ps_cb_object_;
 	Dirtyable<PSCBuffer_PerScene_Type> ps_cb_scene_;
 	Dirtyable<PSCBuffer_PerFrame_Type> ps_cb_frame_;
 
 private:
+	INFLUENCE_WEIGHT_FORMAT influenceFormat_;
 	ComPtr<ID3D11VertexShader> vertShader_;
 	ComPtr<ID3D11PixelShader> pixelShader_;
 	ComPtr<ID3D11InputLayout> inputLayout_;
 	ComPtr<ID3D11Buffer> vs_cb_frame_buffer_;
-	ComPtr<ID3D11Buffer> vs_cb_object_buffer_;
-	ComPtr<ID3D11Buffer> ps_cb_object_buffer_;
 	ComPtr<ID3D11Buffer> ps_cb_scene_buffer_;
 	ComPtr<ID3D11Buffer> ps_cb_frame_buffer_;
 };
\ No newline at end of file
@@ -0,0 +1,198 @@
+#pragma once
+
+// Thin wrapper over the widest float vector available at build time, so batch kernels
+//  (animation sampling, skinning, etc.) can be written once:
+//  - AVX2 (8 lanes) when building with /arch:AVX2
+//  - SSE2 (4 lanes) on x64, or x86 with /arch:SSE2
+//  - Plain floats (1 lane) otherwise, or when MAFFS_NO_SIMD is defined
+// Loads and stores require SIMD_WIDTH * 4 byte alignment.
+
+#include <cstdint>
+#include <cmath>
+
+#if !defined(MAFFS_NO_SIMD) && defined(__AVX2__)
+#define MAFFS_SIMD_AVX2
+#elif !defined(MAFFS_NO_SIMD) && (defined(_M_X64) || defined(__SSE2__) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2))
+#define MAFFS_SIMD_SSE2
+#else
+#define MAFFS_SIMD_SCALAR
+#endif
+
+// Fused multiply-add comes with AVX2 hardware. MSVC has no /arch flag of its own for it.
+#if !defined(MAFFS_NO_SIMD) && (defined(__FMA__) || (defined(_MSC_VER) && defined(__AVX2__)))
+#define MAFFS_SIMD_FMA
+#endif
+
+#if defined(MAFFS_SIMD_AVX2)
+
+#include <immintrin.h>
+
+typedef __m256 SimdFloat;
+const std::uint32_t SIMD_WIDTH = 8u;
+
+inline SimdFloat SimdLoad(const float* p) { return _mm256_load_ps(p); }
+inline void SimdStore(float* p, SimdFloat v) { _mm256_store_ps(p, v); }
+inline SimdFloat SimdSet(float s) { return _mm256_set1_ps(s); }
+inline SimdFloat SimdAdd(SimdFloat a, SimdFloat b) { return _mm256_add_ps(a, b); }
+inline SimdFloat SimdSub(SimdFloat a, SimdFloat b) { return _mm256_sub_ps(a, b); }
+inline SimdFloat SimdMul(SimdFloat a, SimdFloat b) { return _mm256_mul_ps(a, b); }
+inline SimdFloat SimdDiv(SimdFloat a, SimdFloat b) { return _mm256_div_ps(a, b); }
+inline SimdFloat SimdSqrt(SimdFloat a) { return _mm256_sqrt_ps(a); }
+// v with its sign flipped in every lane where s is negative (including -0)
+inline SimdFloat SimdMulSign(SimdFloat v, SimdFloat s) { return _mm256_xor_ps(v, _mm256_and_ps(s, _mm256_set1_ps(-0.f))); }
+inline SimdFloat SimdMin(SimdFloat a, SimdFloat b) { return _mm256_min_ps(a, b); }
+inline SimdFloat SimdMax(SimdFloat a, SimdFloat b) { return _mm256_max_ps(a, b); }
+inline SimdFloat SimdRsqrtEst(SimdFloat a) { return _mm256_rsqrt_ps(a); }
+#if defined(MAFFS_SIMD_FMA)
+inline SimdFloat SimdMulAdd(SimdFloat a, SimdFloat b, SimdFloat c) { return _mm256_fmadd_ps(a, b, c); }
+#else
+inline SimdFloat SimdMulAdd(SimdFloat a, SimdFloat b, SimdFloat c) { return _mm256_add_ps(_mm256_mul_ps(a, b), c); }
+#endif
+
+#elif defined(MAFFS_SIMD_SSE2)
+
+#include <emmintrin.h>
+
+typedef __m128 SimdFloat;
+const std::uint32_t SIMD_WIDTH = 4u;
+
+inline SimdFloat SimdLoad(const float* p) { return _mm_load_ps(p); }
+inline void SimdStore(float* p, SimdFloat v) { _mm_store_ps(p, v); }
+inline SimdFloat SimdSet(float s) { return _mm_set1_ps(s); }
+inline SimdFloat SimdAdd(SimdFloat a, SimdFloat b) { return _mm_add_ps(a, b); }
+inline SimdFloat SimdSub(SimdFloat a, SimdFloat b) { return _mm_sub_ps(a, b); }
+inline SimdFloat SimdMul(SimdFloat a, SimdFloat b) { return _mm_mul_ps(a, b); }
+inline SimdFloat SimdDiv(SimdFloat a, SimdFloat b) { return _mm_div_ps(a, b); }
+inline SimdFloat SimdSqrt(SimdFloat a) { return _mm_sqrt_ps(a); }
+inline SimdFloat SimdMulSign(SimdFloat v, SimdFloat s) { return _mm_xor_ps(v, _mm_and_ps(s, _mm_set1_ps(-0.f))); }
+inline SimdFloat SimdMin(SimdFloat a, SimdFloat b) { return _mm_min_ps(a, b); }
+inline SimdFloat SimdMax(SimdFloat a, SimdFloat b) { return _mm_max_ps(a, b); }
+inline SimdFloat SimdRsqrtEst(SimdFloat a) { return _mm_rsqrt_ps(a); }
+inline SimdFloat SimdMulAdd(SimdFloat a, SimdFloat b, SimdFloat c) { return _mm_add_ps(_mm_mul_ps(a, b), c); }
+
+#else
+
+typedef float SimdFloat;
+const std::uint32_t SIMD_WIDTH = 1u;
+
+inline SimdFloat SimdLoad(const float* p) { return *p; }
+inline void SimdStore(float* p, SimdFloat v) { *p = v; }
+inline SimdFloat SimdSet(float s) { return s; }
+inline SimdFloat SimdAdd(SimdFloat a, SimdFloat b) { return a + b; }
+inline SimdFloat SimdSub(SimdFloat a, SimdFloat b) { return a - b; }
+inline SimdFloat SimdMul(SimdFloat a, SimdFloat b) { return a * b; }
+inline SimdFloat SimdDiv(SimdFloat a, SimdFloat b) { return a / b; }
+inline SimdFloat SimdSqrt(SimdFloat a) { return sqrtf(a); }
+inline SimdFloat SimdMulSign(SimdFloat v, SimdFloat s) { return std::signbit(s) ? -v : v; }
+inline SimdFloat SimdMin(SimdFloat a, SimdFloat b) { return (a < b) ? a : b; }
+inline SimdFloat SimdMax(SimdFloat a, SimdFloat b) { return (a > b) ? a : b; }
+inline SimdFloat SimdRsqrtEst(SimdFloat a) { return 1.f / sqrtf(a); }
+inline SimdFloat SimdMulAdd(SimdFloat a, SimdFloat b, SimdFloat c) { return a * b + c; }
+
+#endif
+
+// a + (b - a) * t
+inline SimdFloat SimdLerp(SimdFloat a, SimdFloat b, SimdFloat t)
+{
+	return SimdMulAdd(SimdSub(b, a), t, a);
+}
+
+// Hardware reciprocal square root estimates are only good to ~12 bits, so refine
+//  with one Newton-Raphson step: y' = y * (1.5 - 0.5 * x * y * y)
+inline SimdFloat SimdRsqrt(SimdFloat x)
+{
+	SimdFloat y = SimdRsqrtEst(x);
+	SimdFloat halfXYY = SimdMul(SimdMul(SimdSet(0.5f), x), SimdMul(y, y));
+	return SimdMul(y, SimdSub(SimdSet(1.5f), halfXYY));
+}
+
+// Four lanes, for kernels that work on one vector, quaternion or matrix row at a time
+//  (Matrix, Quaternion, Transform). These stay SSE width in AVX2 builds, but use FMA
+//  when it is available. Loads and stores are unaligned, since the maffs types are not
+//  16 byte aligned. Scalar builds keep the plain float code of each type instead.
+#if !defined(MAFFS_SIMD_SCALAR)
+
+#include <emmintrin.h>
+#define MAFFS_SIMD4
+
+typedef __m128 SimdFloat4;
+
+inline SimdFloat4 Simd4Load(const float* p) { return _mm_loadu_ps(p); }
+inline void Simd4Store(float* p, SimdFloat4 v) { _mm_storeu_ps(p, v); }
+inline SimdFloat4 Simd4Set(float x, float y, float z, float w) { return _mm_setr_ps(x, y, z, w); }
+inline SimdFloat4 Simd4Splat(float s) { return _mm_set1_ps(s); }
+inline SimdFloat4 Simd4Add(SimdFloat4 a, SimdFloat4 b) { return _mm_add_ps(a, b); }
+inline SimdFloat4 Simd4Sub(SimdFloat4 a, SimdFloat4 b) { return _mm_sub_ps(a, b); }
+inline SimdFloat4 Simd4Mul(SimdFloat4 a, SimdFloat4 b) { return _mm_mul_ps(a, b); }
+inline SimdFloat4 Simd4Div(SimdFloat4 a, SimdFloat4 b) { return _mm_div_ps(a, b); }
+inline SimdFloat4 Simd4Sqrt(SimdFloat4 a) { return _mm_sqrt_ps(a); }
+inline SimdFloat4 Simd4Xor(SimdFloat4 a, SimdFloat4 b) { return _mm_xor_ps(a, b); }
+#if defined(MAFFS_SIMD_FMA)
+inline SimdFloat4 Simd4MulAdd(SimdFloat4 a, SimdFloat4 b, SimdFloat4 c) { return _mm_fmadd_ps(a, b, c); }
+#else
+inline SimdFloat4 Simd4MulAdd(SimdFloat4 a, SimdFloat4 b, SimdFloat4 c) { return _mm_add_ps(_mm_mul_ps(a, b), c); }
+#endif
+
+// Result lanes are (v[X], v[Y], v[Z], v[W])
+template <int X, int Y, int Z, int W>
+inline SimdFloat4 Simd4Shuffle(SimdFloat4 v) { return _mm_shuffle_ps(v, v, _MM_SHUFFLE(W, Z, Y, X)); }
+
+template <int Lane>
+inline SimdFloat4 Simd4SplatLane(SimdFloat4 v) { return Simd4Shuffle<Lane, Lane, Lane, Lane>(v); }
+
+// Flips the sign of each lane whose flag is set
+inline SimdFloat4 Simd4FlipSigns(SimdFloat4 v, bool x, bool y, bool z, bool w)
+{
+	return Simd4Xor(v, Simd4Set(x ? -0.f : 0.f, y ? -0.f : 0.f, z ? -0.f : 0.f, w ? -0.f : 0.f));
+}
+
+// Sum of the first three lanes, in every lane
+inline SimdFloat4 Simd4Dot3(SimdFloat4 a, SimdFloat4 b)
+{
+	SimdFloat4 m = Simd4Mul(a, b);
+	return Simd4Add(Simd4Add(Simd4SplatLane<0>(m), Simd4SplatLane<1>(m)), Simd4SplatLane<2>(m));
+}
+
+// Sum of all four lanes, in every lane
+inline SimdFloat4 Simd4Dot4(SimdFloat4 a, SimdFloat4 b)
+{
+	SimdFloat4 m = Simd4Mul(a, b);
+	m = Simd4Add(m, Simd4Shuffle<2, 3, 0, 1>(m));
+	return Simd4Add(m, Simd4Shuffle<1, 0, 3, 2>(m));
+}
+
+// a.yzx * b.zxy - a.zxy * b.yzx. The w lane of the result is zero.
+inline SimdFloat4 Simd4Cross3(SimdFloat4 a, SimdFloat4 b)
+{
+	return Simd4Sub(
+		Simd4Mul(Simd4Shuffle<1, 2, 0, 3>(a), Simd4Shuffle<2, 0, 1, 3>(b)),
+		Simd4Mul(Simd4Shuffle<2, 0, 1, 3>(a), Simd4Shuffle<1, 2, 0, 3>(b)));
+}
+
+// Quaternions are held as (x, y, z, w), the memory layout of Quaternion.
+//  Same product as Quaternion::operator*, without the normalization.
+inline SimdFloat4 Simd4QuatMul(SimdFloat4 q, SimdFloat4 o)
+{
+	SimdFloat4 result = Simd4Mul(Simd4SplatLane<3>(o), q);
+	result = Simd4MulAdd(Simd4SplatLane<0>(o), Simd4FlipSigns(Simd4Shuffle<3, 2, 1, 0>(q), false, false, true, true), result);
+	result = Simd4MulAdd(Simd4SplatLane<1>(o), Simd4FlipSigns(Simd4Shuffle<2, 3, 0, 1>(q), true, false, false, true), result);
+	return Simd4MulAdd(Simd4SplatLane<2>(o), Simd4FlipSigns(Simd4Shuffle<1, 0, 3, 2>(q), false, true, false, true), result);
+}
+
+inline SimdFloat4 Simd4Normalize4(SimdFloat4 q)
+{
+	return Simd4Div(q, Simd4Sqrt(Simd4Dot4(q, q)));
+}
+
+// Rotates the vector in the first three lanes: 2(u.v)u + (s^2 - u.u)v + 2s(u x v),
+//  where u is the vector part of the quaternion and s is the scalar part
+inline SimdFloat4 Simd4QuatRotate(SimdFloat4 v, SimdFloat4 q)
+{
+	SimdFloat4 s = Simd4SplatLane<3>(q);
+	SimdFloat4 two = Simd4Splat(2.f);
+	SimdFloat4 result = Simd4Mul(q, Simd4Mul(two, Simd4Dot3(q, v)));
+	result = Simd4MulAdd(v, Simd4Sub(Simd4Mul(s, s), Simd4Dot3(q, q)), result);
+	return Simd4MulAdd(Simd4Cross3(q, v), Simd4Mul(two, s), result);
+}
+
+#endif
\ No newline at end of file
@@ -0,0 +1,74 @@
+#include "Skeleton.h"
+#include <assert.h>
+
+const std::uint32_t Skeleton::INVALID_INDEX = 0xFFFFFFFFu;
+
+Skeleton::Skeleton()
+	: bones_()
+	, boneIndices_()
+	, bindModelTransforms_()
+	, inverseBindTransforms_()
+{}
+
+std::uint32_t Skeleton::AddBone(std::string name, std::uint32_t parentIndex, Transform fromParentTransform)
+{
+	assert(parentIndex == INVALID_INDEX || parentIndex < bones_.size());
+	assert(boneIndices_.count(name) == 0u);
+
+	std::uint32_t boneIdx = (std::uint32_t)bones_.size();
+	bones_.push_back(Bone(name, parentIndex, fromParentTransform));
+	boneIndices_.insert({ name, boneIdx });
+
+	// The parent's bind transform is already final, since bones can't be edited once added
+	Transform bindModelTransform = (parentIndex == INVALID_INDEX) ? fromParentTransform : bindModelTransforms_[parentIndex] * fromParentTransform;
+	bindModelTransforms_.push_back(bindModelTransform);
+	inverseBindTransforms_.push_back(bindModelTransform.Inverse());
+
+	return boneIdx;
+}
+
+void Skeleton::Clear()
+{
+	bones_.clear();
+	boneIndices_.clear();
+	bindModelTransforms_.clear();
+	inverseBindTransforms_.clear();
+}
+
+std::uint32_t Skeleton::GetBoneIndex(const std::string& name) const
+{
+	auto it = boneIndices_.find(name);
+	return (it == boneIndices_.end()) ? INVALID_INDEX : it->second;
+}
+
+void Skeleton::GetModelTransforms(const Transform* localTransforms, Transform* outModelTransforms) const
+{
+	// Parents always come before their children, so by the time a bone is visited
+	//  the model transform of its parent has already been computed.
+	for (std::uint32_t boneIdx = 0u; boneIdx < bones_.size(); boneIdx++)
+	{
+		std::uint32_t parentIdx = bones_[boneIdx].ParentIndex;
+		if (parentIdx == INVALID_INDEX)
+		{
+			outModelTransforms[boneIdx] = localTransforms[boneIdx];
+		}
+		else
+		{
+			outModelTransforms[boneIdx] = outModelTransforms[parentIdx] * localTransforms[boneIdx];
+		}
+	}
+}
+
+void Skeleton::GetModelPose(Pose& pose) const
+{
+	assert(pose.GetBoneCount() == bones_.size());
+
+	for (std::uint32_t boneIdx = 0u; boneIdx < bones_.size(); boneIdx++)
+	{
+		std::uint32_t parentIdx = bones_[boneIdx].ParentIndex;
+		if (parentIdx != INVALID_INDEX)
+		{
+			pose.SetTransform(boneIdx, pose.GetTransform(parentIdx) * pose.GetTransform(boneIdx));
+		}
+	}
+}
\ No newline at end of file
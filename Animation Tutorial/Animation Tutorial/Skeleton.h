@@ -0,0 +1,62 @@
+#pragma once
+
+#include "Transform.h"
+#include "Pose.h"
+#include <string>
+#include <vector>
+#include <map>
+
+// Flattened bone hierarchy. Bones are referred to by index, and every bone is
+//  stored after its parent so that model space transforms can be built in a
+//  single forward pass, instead of walking up the parent chain by name.
+class Skeleton
+{
+public:
+	struct Bone
+	{
+	public:
+		std::string Name;
+		std::uint32_t ParentIndex;
+		Transform FromParentTransform;
+
+	public:
+		Bone(std::string name, std::uint32_t parentIndex, Transform fromParentTransform)
+			: Name(name)
+			, ParentIndex(parentIndex)
+			, FromParentTransform(fromParentTransform)
+		{}
+	};
+
+public:
+	static const std::uint32_t INVALID_INDEX;
+
+public:
+	Skeleton();
+	Skeleton(const Skeleton&) = default;
+	~Skeleton() = default;
+
+	// Parent must already be in the skeleton (or INVALID_INDEX for a root bone)
+	std::uint32_t AddBone(std::string name, std::uint32_t parentIndex, Transform fromParentTransform);
+	void Clear();
+
+	std::uint32_t GetBoneIndex(const std::string& name) const;
+	std::uint32_t GetBoneCount() const { return (std::uint32_t)bones_.size(); }
+	const Bone& GetBone(std::uint32_t boneIdx) const { return bones_[boneIdx]; }
+
+	// Bind pose, built up as bones are added. Model space bind transforms, and their inverses
+	//  which take model space into the space of each bone.
+	const Transform& GetBindModelTransform(std::uint32_t boneIdx) const { return bindModelTransforms_[boneIdx]; }
+	const Transform& GetInverseBindTransform(std::uint32_t boneIdx) const { return inverseBindTransforms_[boneIdx]; }
+
+	// Both arrays must hold GetBoneCount() elements
+	void GetModelTransforms(const Transform* localTransforms, Transform* outModelTransforms) const;
+
+	// Converts a pose sized for this skeleton from local to model space, in place
+	void GetModelPose(Pose& pose) const;
+
+private:
+	std::vector<Bone> bones_;
+	std::map<std::string, std::uint32_t> boneIndices_;
+	std::vector<Transform> bindModelTransforms_;
+	std::vector<Transform> inverseBindTransforms_;
+};
\ No newline at end of file
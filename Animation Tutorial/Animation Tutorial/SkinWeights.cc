@@ -0,0 +1,154 @@
+#include "SkinWeights.h"
+#include <algorithm>
+#include <assert.h>
+#include <cmath>
+#include <cstring>
+
+void AddInfluence(VertexInfluences& influences, std::uint32_t boneIdx, float weight)
+{
+	if (weight <= 0.f)
+	{
+		return;
+	}
+	influences.TotalWeight += weight;
+
+	// Kept sorted heaviest first, so the lightest is the one dropped
+	std::uint32_t slot = influences.NumInfluences;
+	if (slot == VertexInfluences::MAX_INFLUENCES)
+	{
+		if (weight <= influences.Weights[slot - 1u])
+		{
+			influences.LostWeight += weight;
+			return;
+		}
+		influences.LostWeight += influences.Weights[--slot];
+	}
+	else
+	{
+		influences.NumInfluences++;
+	}
+
+	while (slot > 0u && influences.Weights[slot - 1u] < weight)
+	{
+		influences.BoneIndices[slot] = influences.BoneIndices[slot - 1u];
+		influences.Weights[slot] = influences.Weights[slot - 1u];
+		slot--;
+	}
+	influences.BoneIndices[slot] = boneIdx;
+	influences.Weights[slot] = weight;
+}
+
+InfluenceStats MeasureInfluences(const std::vector<VertexInfluences>& influences)
+{
+	InfluenceStats stats = {};
+	stats.NumVertices = (std::uint32_t)influences.size();
+	for (const VertexInfluences& vertex : influences)
+	{
+		if (vertex.NumInfluences == 0u)
+		{
+			stats.NumUnweightedVertices++;
+		}
+		else if (vertex.LostWeight > 0.f)
+		{
+			stats.NumTruncatedVertices++;
+			stats.MaxLostWeight = std::max(stats.MaxLostWeight, vertex.LostWeight / vertex.TotalWeight);
+		}
+	}
+	return stats;
+}
+
+void CompactInfluencePalette(std::vector<VertexInfluences>& influences, std::uint32_t numSourceBones, std::vector<std::uint32_t>& outPaletteBones)
+{
+	const std::uint32_t UNUSED = 0xFFFFFFFFu;
+	std::vector<std::uint32_t> paletteIndices(numSourceBones, UNUSED);
+	for (const VertexInfluences& vertex : influences)
+	{
+		for (std::uint32_t i = 0u; i < vertex.NumInfluences; i++)
+		{
+			paletteIndices[vertex.BoneIndices[i]] = 0u;
+		}
+	}
+
+	outPaletteBones.clear();
+	for (std::uint32_t boneIdx = 0u; boneIdx < numSourceBones; boneIdx++)
+	{
+		if (paletteIndices[boneIdx] != UNUSED)
+		{
+			paletteIndices[boneIdx] = (std::uint32_t)outPaletteBones.size();
+			outPaletteBones.push_back(boneIdx);
+		}
+	}
+
+	for (VertexInfluences& vertex : influences)
+	{
+		for (std::uint32_t i = 0u; i < vertex.NumInfluences; i++)
+		{
+			vertex.BoneIndices[i] = paletteIndices[vertex.BoneIndices[i]];
+		}
+	}
+}
+
+std::uint32_t GetPackedInfluenceSize(INFLUENCE_WEIGHT_FORMAT format)
+{
+	return VertexInfluences::MAX_INFLUENCES * ((format == INFLUENCE_WEIGHT_FORMAT::UNORM16) ? 3u : 2u);
+}
+
+void PackInfluences(const VertexInfluences& influences, INFLUENCE_WEIGHT_FORMAT format, void* outPacked)
+{
+	std::uint32_t maxWeight = (format == INFLUENCE_WEIGHT_FORMAT::UNORM16) ? 0xFFFFu : 0xFFu;
+
+	float keptWeight = 0.f;
+	for (std::uint32_t i = 0u; i < influences.NumInfluences; i++)
+	{
+		keptWeight += influences.Weights[i];
+	}
+
+	std::uint8_t boneIndices[VertexInfluences::MAX_INFLUENCES] = { 0u };
+	std::uint32_t weights[VertexInfluences::MAX_INFLUENCES] = { 0u };
+	std::uint32_t packedTotal = 0u;
+	for (std::uint32_t i = 0u; i < influences.NumInfluences; i++)
+	{
+		assert(influences.BoneIndices[i] < MAX_PALETTE_BONES);
+		boneIndices[i] = (std::uint8_t)influences.BoneIndices[i];
+		weights[i] = std::min((std::uint32_t)floorf(influences.Weights[i] / keptWeight * maxWeight + 0.5f), maxWeight);
+		packedTotal += weights[i];
+	}
+
+	// Weights are sorted, so the first is the heaviest, and a rounding error of a few units
+	//  can't take it below zero. Unweighted vertices follow bone 0.
+	weights[0u] = (std::uint32_t)((std::int32_t)weights[0u] + (std::int32_t)maxWeight - (std::int32_t)packedTotal);
+
+	std::uint8_t* packed = static_cast<std::uint8_t*>(outPacked);
+	memcpy(packed, boneIndices, sizeof(boneIndices));
+	for (std::uint32_t i = 0u; i < VertexInfluences::MAX_INFLUENCES; i++)
+	{
+		if (format == INFLUENCE_WEIGHT_FORMAT::UNORM16)
+		{
+			std::uint16_t weight = (std::uint16_t)weights[i];
+			memcpy(packed + sizeof(boneIndices) + i * sizeof(std::uint16_t), &weight, sizeof(weight));
+		}
+		else
+		{
+			packed[sizeof(boneIndices) + i] = (std::uint8_t)weights[i];
+		}
+	}
+}
+
+void UnpackInfluences(const void* packed, INFLUENCE_WEIGHT_FORMAT format, std::uint8_t* outBoneIndices, float* outWeights)
+{
+	const std::uint8_t* bytes = static_cast<const std::uint8_t*>(packed);
+	memcpy(outBoneIndices, bytes, VertexInfluences::MAX_INFLUENCES);
+	for (std::uint32_t i = 0u; i < VertexInfluences::MAX_INFLUENCES; i++)
+	{
+		if (format == INFLUENCE_WEIGHT_FORMAT::UNORM16)
+		{
+			std::uint16_t weight = 0u;
+			memcpy(&weight, bytes + VertexInfluences::MAX_INFLUENCES + i * sizeof(std::uint16_t), sizeof(weight));
+			outWeights[i] = weight / 65535.f;
+		}
+		else
+		{
+			outWeights[i] = bytes[VertexInfluences::MAX_INFLUENCES + i] / 255.f;
+		}
+	}
+}
\ No newline at end of file
@@ -0,0 +1,68 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+// Bone influences of one vertex, gathered from a source mesh one bone at a time. Only the
+//  MAX_INFLUENCES heaviest are kept, and the weight of any others is counted as lost.
+struct VertexInfluences
+{
+public:
+	static const std::uint32_t MAX_INFLUENCES = 4u;
+
+	std::uint32_t BoneIndices[MAX_INFLUENCES];
+	float Weights[MAX_INFLUENCES];
+	std::uint32_t NumInfluences;
+	float TotalWeight;
+	float LostWeight;
+
+	VertexInfluences()
+		: BoneIndices()
+		, Weights()
+		, NumInfluences(0u)
+		, TotalWeight(0.f)
+		, LostWeight(0.f)
+	{}
+};
+
+// Packed influences are four 8 bit bone indices (R8G8B8A8_UINT) followed by four weights,
+//  either 16 bit (R16G16B16A16_UNORM, 12 bytes a vertex) or 8 bit (R8G8B8A8_UNORM, 8 bytes).
+//  Packed weights always sum to exactly one.
+enum class INFLUENCE_WEIGHT_FORMAT
+{
+	UNORM16,
+	UNORM8
+};
+
+struct InfluenceStats
+{
+public:
+	std::uint32_t NumVertices;
+
+	// Vertices with more than MAX_INFLUENCES bones, which lost the weight of the lightest
+	std::uint32_t NumTruncatedVertices;
+
+	// Vertices no bone has weight on - these are left on the first bone of the palette
+	std::uint32_t NumUnweightedVertices;
+
+	// Largest share of a vertex's weight that was lost, from 0 to 1
+	float MaxLostWeight;
+};
+
+// Palette indices are 8 bit
+const std::uint32_t MAX_PALETTE_BONES = 256u;
+
+void AddInfluence(VertexInfluences& influences, std::uint32_t boneIdx, float weight);
+
+InfluenceStats MeasureInfluences(const std::vector<VertexInfluences>& influences);
+
+// Builds the palette of bones that some vertex kept an influence on, in source order, and
+//  renumbers every influence to its palette index. outPaletteBones gets the source index of
+//  each palette entry.
+void CompactInfluencePalette(std::vector<VertexInfluences>& influences, std::uint32_t numSourceBones, std::vector<std::uint32_t>& outPaletteBones);
+
+// Renormalizes and quantizes the kept influences - the rounding error goes to the heaviest.
+//  Bone indices must already be palette indices.
+std::uint32_t GetPackedInfluenceSize(INFLUENCE_WEIGHT_FORMAT format);
+void PackInfluences(const VertexInfluences& influences, INFLUENCE_WEIGHT_FORMAT format, void* outPacked);
+void UnpackInfluences(const void* packed, INFLUENCE_WEIGHT_FORMAT format, std::uint8_t* outBoneIndices, float* outWeights);
\ No newline at end of file
@@ -0,0 +1,100 @@
+// Vertex buffer to process skinned vertices in a basic context
+//  Each vertex has a position and a normal, and a second stream gives the four bones that
+//  influence it, as indices into its mesh's palette, and their weights
+
+//
+// STRUCT DEFS
+//
+struct SkinnedPosNormVertexInput
+{
+	float4 Position : POSITION;
+	float4 Normal : NORMAL;
+	uint4 BoneIndices : BLENDINDICES;
+	float4 BoneWeights : BLENDWEIGHT;
+	uint InstanceId : SV_InstanceID;
+};
+
+struct BasicPosNormVertexOutput
+{
+	float4 Position : SV_POSITION;
+	float4 WorldPosition : POSITION;
+	float4 Normal : NORMAL;
+	nointerpolation uint MaterialKey : MATERIAL;
+};
+
+// Laid out like InstanceData (IRenderBackend.h)
+struct Instance
+{
+	matrix mModel;
+	uint MaterialKey;
+	uint PaletteOffset;
+	uint2 Padding;
+};
+
+// Laid out like Matrix3x4 (Matrix3x4.h) - the top three rows, translation in the last column
+struct Bone
+{
+	float4 Rows[3];
+};
+
+//
+// CBUFFERS
+//
+
+// Must match IRenderBackend::MAX_INSTANCES_PER_DRAW. Only the instances of the draw are bound.
+#define MAX_INSTANCES_PER_DRAW 512
+
+// Must match RenderQueue::INVALID_KEY, the palette offset of instances without bones
+#define INVALID_PALETTE_OFFSET 0xffffffff
+
+cbuffer PerDraw : register(b0)
+{
+	Instance Instances[MAX_INSTANCES_PER_DRAW];
+}
+
+cbuffer PerFrame : register(b1)
+{
+	matrix mView;
+	matrix mProj;
+}
+
+// The palettes of every skinned instance of the frame, one after another
+StructuredBuffer<Bone> Palettes : register(t0);
+
+BasicPosNormVertexOutput main(SkinnedPosNormVertexInput vin)
+{
+	BasicPosNormVertexOutput vout;
+	Instance instance = Instances[vin.InstanceId];
+
+	vin.Position.w = 1.f;
+	vin.Normal.w = 0.f;
+
+	// Linear blend skinning, as SkinVertices does it on the CPU - the weighted sum of the bone
+	//  matrices transforms the vertex into the space of the model
+	if (instance.PaletteOffset != INVALID_PALETTE_OFFSET)
+	{
+		float4 rows[3] = { float4(0.f, 0.f, 0.f, 0.f), float4(0.f, 0.f, 0.f, 0.f), float4(0.f, 0.f, 0.f, 0.f) };
+		[unroll]
+		for (uint i = 0; i < 4; i++)
+		{
+			Bone bone = Palettes[instance.PaletteOffset + vin.BoneIndices[i]];
+			rows[0] += bone.Rows[0] * vin.BoneWeights[i];
+			rows[1] += bone.Rows[1] * vin.BoneWeights[i];
+			rows[2] += bone.Rows[2] * vin.BoneWeights[i];
+		}
+
+		vin.Position = float4(dot(rows[0], vin.Position), dot(rows[1], vin.Position), dot(rows[2], vin.Position), 1.f);
+		vin.Normal = float4(dot(rows[0], vin.Normal), dot(rows[1], vin.Normal), dot(rows[2], vin.Normal), 0.f);
+	}
+
+	vout.Position = mul(vin.Position, instance.mModel);
+	vout.Position = mul(vout.Position, mView);
+	vout.Position = mul(vout.Position, mProj);
+
+	vout.WorldPosition = mul(vin.Position, instance.mModel);
+
+	vout.Normal = mul(vin.Normal, instance.mModel);
+	vout.MaterialKey = instance.MaterialKey;
+
+	return vout;
+}
\ No newline at end of file
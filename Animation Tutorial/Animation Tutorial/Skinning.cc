@@ -0,0 +1,349 @@
+#include "Skinning.h"
+#include "Pose.h"
+#include "Simd.h"
+#include <assert.h>
+#include <cmath>
+
+namespace
+{
+
+const std::uint32_t PALETTE_ROWS = 3u;
+const std::uint32_t PALETTE_COLUMNS = 4u;
+
+// One batch of the mesh, loaded from its streams
+struct BatchVertices
+{
+public:
+	SimdFloat Position[3];
+	SimdFloat Normal[3];
+	SimdFloat Weights[SkinningMesh::MAX_INFLUENCES];
+};
+
+// Palette elements of one influence of a batch, one lane per vertex
+struct BatchMatrices
+{
+	alignas(32) float Elements[PALETTE_ROWS][PALETTE_COLUMNS][SIMD_WIDTH];
+};
+
+struct BatchDualQuaternions
+{
+	alignas(32) float Real[4][SIMD_WIDTH];
+	alignas(32) float Dual[4][SIMD_WIDTH];
+};
+
+void LoadBatch(const SkinningMesh& mesh, std::uint32_t batch, BatchVertices& outBatch)
+{
+	for (std::uint32_t c = 0u; c < 3u; c++)
+	{
+		outBatch.Position[c] = SimdLoad(mesh.GetStream((SKINNING_STREAM)((std::uint32_t)SKINNING_STREAM::POS_X + c)) + batch);
+		outBatch.Normal[c] = SimdLoad(mesh.GetStream((SKINNING_STREAM)((std::uint32_t)SKINNING_STREAM::NORMAL_X + c)) + batch);
+	}
+	for (std::uint32_t influence = 0u; influence < SkinningMesh::MAX_INFLUENCES; influence++)
+	{
+		outBatch.Weights[influence] = SimdLoad(mesh.GetStream((SKINNING_STREAM)((std::uint32_t)SKINNING_STREAM::WEIGHT_0 + influence)) + batch);
+	}
+}
+
+// Whether any vertex of the batch has weight on the influence - the last influences of
+//  most batches have none, and are skipped entirely
+bool HasWeight(const SkinningMesh& mesh, std::uint32_t influence, std::uint32_t batch)
+{
+	const float* weights = mesh.GetStream((SKINNING_STREAM)((std::uint32_t)SKINNING_STREAM::WEIGHT_0 + influence)) + batch;
+	for (std::uint32_t lane = 0u; lane < SIMD_WIDTH; lane++)
+	{
+		if (weights[lane] != 0.f)
+		{
+			return true;
+		}
+	}
+	return false;
+}
+
+// Writes the lanes of one batch out to each vertex, skipping padding and vertices past the range
+void StoreBatch(const SimdFloat* positions, const SimdFloat* normals, std::uint32_t batch, std::uint32_t endVertex, const SkinningOutput& output)
+{
+	alignas(32) float lanes[6][SIMD_WIDTH];
+	for (std::uint32_t c = 0u; c < 3u; c++)
+	{
+		SimdStore(lanes[c], positions[c]);
+		SimdStore(lanes[3u + c], normals[c]);
+	}
+
+	for (std::uint32_t lane = 0u; lane < SIMD_WIDTH && batch + lane < endVertex; lane++)
+	{
+		std::uint64_t offset = (std::uint64_t)(batch + lane) * output.Stride;
+		float* position = reinterpret_cast<float*>(reinterpret_cast<char*>(output.Positions) + offset);
+		float* normal = reinterpret_cast<float*>(reinterpret_cast<char*>(output.Normals) + offset);
+		position[0u] = lanes[0u][lane];
+		position[1u] = lanes[1u][lane];
+		position[2u] = lanes[2u][lane];
+		normal[0u] = lanes[3u][lane];
+		normal[1u] = lanes[4u][lane];
+		normal[2u] = lanes[5u][lane];
+	}
+}
+
+void Normalize(SimdFloat* v)
+{
+	SimdFloat invLength = SimdRsqrt(SimdMulAdd(v[0u], v[0u], SimdMulAdd(v[1u], v[1u], SimdMul(v[2u], v[2u]))));
+	v[0u] = SimdMul(v[0u], invLength);
+	v[1u] = SimdMul(v[1u], invLength);
+	v[2u] = SimdMul(v[2u], invLength);
+}
+
+void Cross(const SimdFloat* a, const SimdFloat* b, SimdFloat* out)
+{
+	out[0u] = SimdSub(SimdMul(a[1u], b[2u]), SimdMul(a[2u], b[1u]));
+	out[1u] = SimdSub(SimdMul(a[2u], b[0u]), SimdMul(a[0u], b[2u]));
+	out[2u] = SimdSub(SimdMul(a[0u], b[1u]), SimdMul(a[1u], b[0u]));
+}
+
+// Rotation of a matrix with its scale divided out
+void MatrixToQuaternion(const Matrix3x4& matrix, float* outXYZW)
+{
+	float m[3][3];
+	for (std::uint32_t column = 0u; column < 3u; column++)
+	{
+		float length = sqrtf(matrix.m[0u][column] * matrix.m[0u][column] + matrix.m[1u][column] * matrix.m[1u][column] + matrix.m[2u][column] * matrix.m[2u][column]);
+		float invLength = (length > 0.f) ? 1.f / length : 0.f;
+		for (std::uint32_t row = 0u; row < 3u; row++)
+		{
+			m[row][column] = matrix.m[row][column] * invLength;
+		}
+	}
+
+	// Taken from the largest of w, x, y and z, which keeps the divide well away from zero
+	float trace = m[0u][0u] + m[1u][1u] + m[2u][2u];
+	if (trace > 0.f)
+	{
+		float s = 2.f * sqrtf(trace + 1.f);
+		outXYZW[0u] = (m[2u][1u] - m[1u][2u]) / s;
+		outXYZW[1u] = (m[0u][2u] - m[2u][0u]) / s;
+		outXYZW[2u] = (m[1u][0u] - m[0u][1u]) / s;
+		outXYZW[3u] = 0.25f * s;
+	}
+	else if (m[0u][0u] > m[1u][1u] && m[0u][0u] > m[2u][2u])
+	{
+		float s = 2.f * sqrtf(1.f + m[0u][0u] - m[1u][1u] - m[2u][2u]);
+		outXYZW[0u] = 0.25f * s;
+		outXYZW[1u] = (m[0u][1u] + m[1u][0u]) / s;
+		outXYZW[2u] = (m[0u][2u] + m[2u][0u]) / s;
+		outXYZW[3u] = (m[2u][1u] - m[1u][2u]) / s;
+	}
+	else if (m[1u][1u] > m[2u][2u])
+	{
+		float s = 2.f * sqrtf(1.f + m[1u][1u] - m[0u][0u] - m[2u][2u]);
+		outXYZW[0u] = (m[0u][1u] + m[1u][0u]) / s;
+		outXYZW[1u] = 0.25f * s;
+		outXYZW[2u] = (m[1u][2u] + m[2u][1u]) / s;
+		outXYZW[3u] = (m[0u][2u] - m[2u][0u]) / s;
+	}
+	else
+	{
+		float s = 2.f * sqrtf(1.f + m[2u][2u] - m[0u][0u] - m[1u][1u]);
+		outXYZW[0u] = (m[0u][2u] + m[2u][0u]) / s;
+		outXYZW[1u] = (m[1u][2u] + m[2u][1u]) / s;
+		outXYZW[2u] = 0.25f * s;
+		outXYZW[3u] = (m[1u][0u] - m[0u][1u]) / s;
+	}
+}
+
+}
+
+void SkinVertices(const SkinningMesh& mesh, const Matrix3x4* palette, std::uint32_t firstVertex, std::uint32_t endVertex, const SkinningOutput& output)
+{
+	assert(firstVertex % Pose::LANE_PADDING == 0u && endVertex <= mesh.GetVertexCount());
+
+	BatchMatrices gathered;
+	for (std::uint32_t batch = firstVertex; batch < endVertex; batch += SIMD_WIDTH)
+	{
+		BatchVertices vertices;
+		LoadBatch(mesh, batch, vertices);
+
+		// Weighted sum of the influence matrices
+		SimdFloat blended[PALETTE_ROWS][PALETTE_COLUMNS];
+		for (std::uint32_t row = 0u; row < PALETTE_ROWS; row++)
+		{
+			for (std::uint32_t column = 0u; column < PALETTE_COLUMNS; column++)
+			{
+				blended[row][column] = SimdSet(0.f);
+			}
+		}
+
+		for (std::uint32_t influence = 0u; influence < SkinningMesh::MAX_INFLUENCES; influence++)
+		{
+			if (!HasWeight(mesh, influence, batch))
+			{
+				continue;
+			}
+
+			const std::uint8_t* boneIndices = mesh.GetBoneIndices(influence) + batch;
+			for (std::uint32_t lane = 0u; lane < SIMD_WIDTH; lane++)
+			{
+				const Matrix3x4& matrix = palette[boneIndices[lane]];
+				for (std::uint32_t row = 0u; row < PALETTE_ROWS; row++)
+				{
+					for (std::uint32_t column = 0u; column < PALETTE_COLUMNS; column++)
+					{
+						gathered.Elements[row][column][lane] = matrix.m[row][column];
+					}
+				}
+			}
+
+			for (std::uint32_t row = 0u; row < PALETTE_ROWS; row++)
+			{
+				for (std::uint32_t column = 0u; column < PALETTE_COLUMNS; column++)
+				{
+					blended[row][column] = SimdMulAdd(vertices.Weights[influence], SimdLoad(gathered.Elements[row][column]), blended[row][column]);
+				}
+			}
+		}
+
+		SimdFloat positions[3];
+		SimdFloat normals[3];
+		for (std::uint32_t row = 0u; row < PALETTE_ROWS; row++)
+		{
+			positions[row] = SimdMulAdd(blended[row][0u], vertices.Position[0u], SimdMulAdd(blended[row][1u], vertices.Position[1u], SimdMulAdd(blended[row][2u], vertices.Position[2u], blended[row][3u])));
+			normals[row] = SimdMulAdd(blended[row][0u], vertices.Normal[0u], SimdMulAdd(blended[row][1u], vertices.Normal[1u], SimdMul(blended[row][2u], vertices.Normal[2u])));
+		}
+		Normalize(normals);
+
+		StoreBatch(positions, normals, batch, endVertex, output);
+	}
+}
+
+void SkinVertices(const SkinningMesh& mesh, const DualQuaternion* palette, std::uint32_t firstVertex, std::uint32_t endVertex, const SkinningOutput& output)
+{
+	assert(firstVertex % Pose::LANE_PADDING == 0u && endVertex <= mesh.GetVertexCount());
+
+	BatchDualQuaternions gathered;
+	for (std::uint32_t batch = firstVertex; batch < endVertex; batch += SIMD_WIDTH)
+	{
+		BatchVertices vertices;
+		LoadBatch(mesh, batch, vertices);
+
+		SimdFloat real[4];
+		SimdFloat dual[4];
+		for (std::uint32_t c = 0u; c < 4u; c++)
+		{
+			real[c] = SimdSet(0.f);
+			dual[c] = SimdSet(0.f);
+		}
+
+		for (std::uint32_t influence = 0u; influence < SkinningMesh::MAX_INFLUENCES; influence++)
+		{
+			if (!HasWeight(mesh, influence, batch))
+			{
+				continue;
+			}
+
+			const std::uint8_t* boneIndices = mesh.GetBoneIndices(influence) + batch;
+			for (std::uint32_t lane = 0u; lane < SIMD_WIDTH; lane++)
+			{
+				const DualQuaternion& dq = palette[boneIndices[lane]];
+				for (std::uint32_t c = 0u; c < 4u; c++)
+				{
+					gathered.Real[c][lane] = dq.Real[c];
+					gathered.Dual[c][lane] = dq.Dual[c];
+				}
+			}
+
+			SimdFloat r[4] = { SimdLoad(gathered.Real[0u]), SimdLoad(gathered.Real[1u]), SimdLoad(gathered.Real[2u]), SimdLoad(gathered.Real[3u]) };
+
+			// Blend every influence on the same hemisphere as those before it, so they don't cancel out
+			SimdFloat weight = vertices.Weights[influence];
+			if (influence > 0u)
+			{
+				SimdFloat dot = SimdMulAdd(real[0u], r[0u], SimdMulAdd(real[1u], r[1u], SimdMulAdd(real[2u], r[2u], SimdMul(real[3u], r[3u]))));
+				weight = SimdMulSign(weight, dot);
+			}
+
+			for (std::uint32_t c = 0u; c < 4u; c++)
+			{
+				real[c] = SimdMulAdd(weight, r[c], real[c]);
+				dual[c] = SimdMulAdd(weight, SimdLoad(gathered.Dual[c]), dual[c]);
+			}
+		}
+
+		SimdFloat invLength = SimdRsqrt(SimdMulAdd(real[0u], real[0u], SimdMulAdd(real[1u], real[1u], SimdMulAdd(real[2u], real[2u], SimdMul(real[3u], real[3u])))));
+		for (std::uint32_t c = 0u; c < 4u; c++)
+		{
+			real[c] = SimdMul(real[c], invLength);
+			dual[c] = SimdMul(dual[c], invLength);
+		}
+
+		// Rotate: v + 2 r x (r x v + w v)
+		SimdFloat two = SimdSet(2.f);
+		SimdFloat t[3];
+		SimdFloat u[3];
+		SimdFloat positions[3];
+		SimdFloat normals[3];
+
+		Cross(real, vertices.Position, t);
+		for (std::uint32_t c = 0u; c < 3u; c++)
+		{
+			t[c] = SimdMulAdd(real[3u], vertices.Position[c], t[c]);
+		}
+		Cross(real, t, u);
+		for (std::uint32_t c = 0u; c < 3u; c++)
+		{
+			positions[c] = SimdMulAdd(two, u[c], vertices.Position[c]);
+		}
+
+		Cross(real, vertices.Normal, t);
+		for (std::uint32_t c = 0u; c < 3u; c++)
+		{
+			t[c] = SimdMulAdd(real[3u], vertices.Normal[c], t[c]);
+		}
+		Cross(real, t, u);
+		for (std::uint32_t c = 0u; c < 3u; c++)
+		{
+			normals[c] = SimdMulAdd(two, u[c], vertices.Normal[c]);
+		}
+
+		// Translate: 2 (w d - dw r + r x d)
+		Cross(real, dual, t);
+		for (std::uint32_t c = 0u; c < 3u; c++)
+		{
+			SimdFloat translation = SimdSub(SimdMulAdd(real[3u], dual[c], t[c]), SimdMul(dual[3u], real[c]));
+			positions[c] = SimdMulAdd(two, translation, positions[c]);
+		}
+
+		StoreBatch(positions, normals, batch, endVertex, output);
+	}
+}
+
+void SkinVertices(JobSystem& jobSystem, const SkinningMesh& mesh, const Matrix3x4* palette, const SkinningOutput& output)
+{
+	jobSystem.ParallelFor(mesh.GetVertexCount(), SKINNING_GRAIN_SIZE, [&mesh, palette, &output](std::uint32_t begin, std::uint32_t end)
+	{
+		SkinVertices(mesh, palette, begin, end, output);
+	});
+}
+
+void SkinVertices(JobSystem& jobSystem, const SkinningMesh& mesh, const DualQuaternion* palette, const SkinningOutput& output)
+{
+	jobSystem.ParallelFor(mesh.GetVertexCount(), SKINNING_GRAIN_SIZE, [&mesh, palette, &output](std::uint32_t begin, std::uint32_t end)
+	{
+		SkinVertices(mesh, palette, begin, end, output);
+	});
+}
+
+void BuildDualQuaternionPalette(const Matrix3x4* palette, std::uint32_t nBones, DualQuaternion* outPalette)
+{
+	for (std::uint32_t boneIdx = 0u; boneIdx < nBones; boneIdx++)
+	{
+		float* r = outPalette[boneIdx].Real;
+		MatrixToQuaternion(palette[boneIdx], r);
+
+		// Dual = 0.5 * (translation, 0) * real
+		float tx = palette[boneIdx].m[0u][3u];
+		float ty = palette[boneIdx].m[1u][3u];
+		float tz = palette[boneIdx].m[2u][3u];
+		float* d = outPalette[boneIdx].Dual;
+		d[0u] = 0.5f * (tx * r[3u] + ty * r[2u] - tz * r[1u]);
+		d[1u] = 0.5f * (ty * r[3u] + tz * r[0u] - tx * r[2u]);
+		d[2u] = 0.5f * (tz * r[3u] + tx * r[1u] - ty * r[0u]);
+		d[3u] = -0.5f * (tx * r[0u] + ty * r[1u] + tz * r[2u]);
+	}
+}
\ No newline at end of file
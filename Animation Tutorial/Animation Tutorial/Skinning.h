@@ -0,0 +1,50 @@
+#pragma once
+
+#include "SkinningMesh.h"
+#include "Matrix3x4.h"
+#include "JobSystem.h"
+
+// Rigid bone transform as a unit dual quaternion, (x, y, z, w) like Quaternion. Real is the
+//  rotation, and Dual is half the translation multiplied by it.
+struct alignas(16) DualQuaternion
+{
+public:
+	float Real[4];
+	float Dual[4];
+};
+
+// Where skinned vertices are written. Each vertex writes x, y and z of its position and
+//  normal, and leaves anything else in the vertex alone - so the output can be a vertex
+//  buffer mapped for writing, such as ShaderPNS4_MD1::Vertex with a stride of its size.
+struct SkinningOutput
+{
+public:
+	float* Positions;
+	float* Normals;
+	std::uint32_t Stride; // bytes
+};
+
+// CPU skinning, SIMD_WIDTH vertices at a time (see Simd.h). The four influences of every
+//  vertex in a batch are gathered from the palette into lanes, blended across lanes, and
+//  applied to the batch at once. Palettes hold one skinning transform (model space bone
+//  transform times inverse bind transform) per bone index used by the mesh.
+// Ranges cover [firstVertex, endVertex), and firstVertex must be a multiple of
+//  Pose::LANE_PADDING, so that ranges can be skinned on different threads.
+
+// Linear blend skinning - blends the matrices of the influences. Normals are transformed by
+//  the blended matrix and renormalized, which is exact for rotations and uniform scales.
+void SkinVertices(const SkinningMesh& mesh, const Matrix3x4* palette, std::uint32_t firstVertex, std::uint32_t endVertex, const SkinningOutput& output);
+
+// Dual quaternion skinning - blends rotations rather than matrices, so twisting joints keep
+//  their volume instead of collapsing. Palettes are built with BuildDualQuaternionPalette.
+void SkinVertices(const SkinningMesh& mesh, const DualQuaternion* palette, std::uint32_t firstVertex, std::uint32_t endVertex, const SkinningOutput& output);
+
+// Same as above, over the whole mesh, with ranges of SKINNING_GRAIN_SIZE vertices spread
+//  across the job system
+const std::uint32_t SKINNING_GRAIN_SIZE = 2048u;
+void SkinVertices(JobSystem& jobSystem, const SkinningMesh& mesh, const Matrix3x4* palette, const SkinningOutput& output);
+void SkinVertices(JobSystem& jobSystem, const SkinningMesh& mesh, const DualQuaternion* palette, const SkinningOutput& output);
+
+// Converts a skinning palette for dual quaternion skinning. Dual quaternions can only hold
+//  rotations and translations - any scale in the matrices is dropped.
+void BuildDualQuaternionPalette(const Matrix3x4* palette, std::uint32_t nBones, DualQuaternion* outPalette);
\ No newline at end of file
@@ -0,0 +1,45 @@
+#include "SkinningMesh.h"
+#include "Pose.h"
+#include "AlignedMemory.h"
+#include <assert.h>
+#include <cstring>
+
+SkinningMesh::SkinningMesh(std::uint32_t numVertices)
+	: data_(nullptr)
+	, boneIndices_(nullptr)
+	, numVertices_(numVertices)
+	, paddedVertices_((numVertices + Pose::LANE_PADDING - 1u) / Pose::LANE_PADDING * Pose::LANE_PADDING)
+{
+	if (paddedVertices_ > 0u)
+	{
+		data_ = (float*)_aligned_malloc(sizeof(float) * paddedVertices_ * (std::uint32_t)SKINNING_STREAM::COUNT, Pose::ALIGNMENT);
+		boneIndices_ = (std::uint8_t*)_aligned_malloc(paddedVertices_ * MAX_INFLUENCES, Pose::ALIGNMENT);
+		memset(data_, 0, sizeof(float) * paddedVertices_ * (std::uint32_t)SKINNING_STREAM::COUNT);
+		memset(boneIndices_, 0, paddedVertices_ * MAX_INFLUENCES);
+	}
+}
+
+SkinningMesh::~SkinningMesh()
+{
+	_aligned_free(data_);
+	_aligned_free(boneIndices_);
+}
+
+void SkinningMesh::SetVertex(std::uint32_t vertexIdx, const Vec3& position, const Vec3& normal, const std::uint8_t* boneIndices, const float* weights, std::uint32_t numInfluences)
+{
+	assert(vertexIdx < numVertices_ && numInfluences <= MAX_INFLUENCES);
+
+	GetStream(SKINNING_STREAM::POS_X)[vertexIdx] = position.x;
+	GetStream(SKINNING_STREAM::POS_Y)[vertexIdx] = position.y;
+	GetStream(SKINNING_STREAM::POS_Z)[vertexIdx] = position.z;
+	GetStream(SKINNING_STREAM::NORMAL_X)[vertexIdx] = normal.x;
+	GetStream(SKINNING_STREAM::NORMAL_Y)[vertexIdx] = normal.y;
+	GetStream(SKINNING_STREAM::NORMAL_Z)[vertexIdx] = normal.z;
+
+	for (std::uint32_t influence = 0u; influence < MAX_INFLUENCES; influence++)
+	{
+		bool isUsed = influence < numInfluences;
+		GetStream((SKINNING_STREAM)((std::uint32_t)SKINNING_STREAM::WEIGHT_0 + influence))[vertexIdx] = isUsed ? weights[influence] : 0.f;
+		boneIndices_[influence * paddedVertices_ + vertexIdx] = isUsed ? boneIndices[influence] : 0u;
+	}
+}
\ No newline at end of file
@@ -0,0 +1,45 @@
+#pragma once
+
+#include "Vec3.h"
+#include <cstdint>
+
+enum class SKINNING_STREAM
+{
+	POS_X, POS_Y, POS_Z,
+	NORMAL_X, NORMAL_Y, NORMAL_Z,
+	WEIGHT_0, WEIGHT_1, WEIGHT_2, WEIGHT_3,
+	COUNT
+};
+
+// Bind pose of a mesh for CPU skinning (see Skinning.h) - positions, normals and up to four
+//  bone influences per vertex. Stored as structure-of-arrays like a Pose, with every stream
+//  aligned and padded out to a multiple of Pose::LANE_PADDING vertices. Padding vertices have
+//  no weight, and are never written out.
+class SkinningMesh
+{
+public:
+	static const std::uint32_t MAX_INFLUENCES = 4u;
+
+public:
+	explicit SkinningMesh(std::uint32_t numVertices);
+	SkinningMesh(const SkinningMesh&) = delete;
+	~SkinningMesh();
+
+	// Influences beyond the first numInfluences get no weight. Weights should sum to 1.
+	void SetVertex(std::uint32_t vertexIdx, const Vec3& position, const Vec3& normal, const std::uint8_t* boneIndices, const float* weights, std::uint32_t numInfluences);
+
+	std::uint32_t GetVertexCount() const { return numVertices_; }
+	std::uint32_t GetPaddedVertexCount() const { return paddedVertices_; }
+
+	float* GetStream(SKINNING_STREAM stream) { return data_ + (std::uint32_t)stream * paddedVertices_; }
+	const float* GetStream(SKINNING_STREAM stream) const { return data_ + (std::uint32_t)stream * paddedVertices_; }
+
+	// Palette index of one influence of every vertex
+	const std::uint8_t* GetBoneIndices(std::uint32_t influence) const { return boneIndices_ + influence * paddedVertices_; }
+
+private:
+	float* data_;
+	std::uint8_t* boneIndices_;
+	std::uint32_t numVertices_;
+	std::uint32_t paddedVertices_;
+};
\ No newline at end of file
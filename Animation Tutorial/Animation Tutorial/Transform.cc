@@ -1,4 +1,5 @@
 #include "Transform.h"
+#include "Simd.h"
 
 const Transform Transform::Identity = Transform();
 
@@ -18,11 +19,29 @@ Transform Transform::operator*(const Transform& o) const
 {
 	// Apply first this transformation, and then the next transformation.
 	// TODO KAM: Is this math right? I'm not sure.
+#if defined(MAFFS_SIMD4)
+	// Same math as below, with every part kept in registers
+	SimdFloat4 rotation = Simd4Load(&Rotation.x);
+	SimdFloat4 scale = Simd4Set(Scale.x, Scale.y, Scale.z, 0.f);
+	SimdFloat4 otherPos = Simd4Set(o.Pos.x, o.Pos.y, o.Pos.z, 0.f);
+	SimdFloat4 otherScale = Simd4Set(o.Scale.x, o.Scale.y, o.Scale.z, 0.f);
+
+	float pos[4];
+	float newScale[4];
+	Transform result;
+	Simd4Store(pos, Simd4MulAdd(Simd4QuatRotate(otherPos, rotation), scale, Simd4Set(Pos.x, Pos.y, Pos.z, 0.f)));
+	Simd4Store(&result.Rotation.x, Simd4Normalize4(Simd4QuatMul(rotation, Simd4Load(&o.Rotation.x))));
+	Simd4Store(newScale, Simd4Mul(scale, otherScale));
+	result.Pos = Vec3(pos[0], pos[1], pos[2]);
+	result.Scale = Vec3(newScale[0], newScale[1], newScale[2]);
+	return result;
+#else
 	return Transform(
 		Pos + Vec3::ComponentProduct(o.Pos * Rotation, Scale),
 		Rotation * o.Rotation,
 		Vec3::ComponentProduct(Scale, o.Scale)
 		);
+#endif
 }
 
 Matrix Transform::GetTransformMatrix() const
@@ -54,7 +73,24 @@ Matrix Transform::GetTransformMatrix() const
 
 Transform Transform::Inverse() const
 {
-	return Transform({ -Pos, Rotation.Inverse(), Vec3(1.f / Scale.x, 1.f / Scale.y, 1.f / Scale.z) });
+	// The inverse undoes the scale and rotation before the translation, so the translation
+	//  has to be taken back through both. Exact for uniform scale - TRS transforms with
+	//  non-uniform scale and rotation have no exact TRS inverse.
+#if defined(MAFFS_SIMD4)
+	Quaternion rotation = Rotation.Inverse();
+	SimdFloat4 scale = Simd4Div(Simd4Splat(1.f), Simd4Set(Scale.x, Scale.y, Scale.z, 1.f));
+	SimdFloat4 pos = Simd4Mul(Simd4QuatRotate(Simd4Set(-Pos.x, -Pos.y, -Pos.z, 0.f), Simd4Load(&rotation.x)), scale);
+
+	float newPos[4];
+	float newScale[4];
+	Simd4Store(newPos, pos);
+	Simd4Store(newScale, scale);
+	return Transform(Vec3(newPos[0], newPos[1], newPos[2]), rotation, Vec3(newScale[0], newScale[1], newScale[2]));
+#else
+	Quaternion rotation = Rotation.Inverse();
+	Vec3 scale(1.f / Scale.x, 1.f / Scale.y, 1.f / Scale.z);
+	return Transform(Vec3::ComponentProduct(-Pos * rotation, scale), rotation, scale);
+#endif
 }
 
 Transform Transform::Lerp(const Transform& t1, const Transform& t2, float ratio)
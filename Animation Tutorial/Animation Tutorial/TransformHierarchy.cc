@@ -0,0 +1,239 @@
+#include "TransformHierarchy.h"
+#include <algorithm>
+#include <assert.h>
+#include <atomic>
+
+const std::uint32_t TransformHierarchy::INVALID_INDEX = 0xFFFFFFFFu;
+
+namespace
+{
+
+// Nodes updated by each job - a few microseconds of work, so narrow levels stay on the
+//  calling thread and only crowds of nodes are split up
+const std::uint32_t NODES_PER_JOB = 256u;
+
+// Moves the value at each old slot to the new slot of the node held there
+template <typename T>
+void Reorder(std::vector<T>& values, const std::vector<std::uint32_t>& slotNodes, const std::vector<std::uint32_t>& newNodeSlots)
+{
+	std::vector<T> reordered(values.size());
+	for (std::uint32_t slot = 0u; slot < values.size(); slot++)
+	{
+		reordered[newNodeSlots[slotNodes[slot]]] = values[slot];
+	}
+	values.swap(reordered);
+}
+
+}
+
+TransformHierarchy::TransformHierarchy()
+	: parentSlots_()
+	, localTransforms_()
+	, worldTransforms_()
+	, worldMatrices_()
+	, isDirty_()
+	, isWorldChanged_()
+	, slotNodes_()
+	, nodeSlots_()
+	, levelStarts_()
+	, isLayoutStale_(false)
+	, firstChangedSlot_(0u)
+	, jobSystem_(nullptr)
+{}
+
+std::uint32_t TransformHierarchy::AddNode(std::uint32_t parentIdx, const Transform& localTransform)
+{
+	assert(parentIdx == INVALID_INDEX || parentIdx < nodeSlots_.size());
+
+	// Given a world transform straight away, so it is usable before the next update
+	Transform worldTransform = (parentIdx == INVALID_INDEX) ? localTransform : GetWorldTransform(parentIdx) * localTransform;
+
+	std::uint32_t nodeIdx = (std::uint32_t)nodeSlots_.size();
+	parentSlots_.push_back((parentIdx == INVALID_INDEX) ? INVALID_INDEX : nodeSlots_[parentIdx]);
+	localTransforms_.push_back(localTransform);
+	worldTransforms_.push_back(worldTransform);
+	worldMatrices_.push_back(worldTransform.GetTransformMatrix());
+	isDirty_.push_back(1u);
+	isWorldChanged_.push_back(0u);
+	slotNodes_.push_back(nodeIdx);
+
+	nodeSlots_.push_back((std::uint32_t)slotNodes_.size() - 1u);
+
+	isLayoutStale_ = true;
+	return nodeIdx;
+}
+
+std::uint32_t TransformHierarchy::GetParent(std::uint32_t nodeIdx) const
+{
+	std::uint32_t parentSlot = parentSlots_[nodeSlots_[nodeIdx]];
+	return (parentSlot == INVALID_INDEX) ? INVALID_INDEX : slotNodes_[parentSlot];
+}
+
+bool TransformHierarchy::SetParent(std::uint32_t nodeIdx, std::uint32_t parentIdx)
+{
+	assert(nodeIdx < nodeSlots_.size() && (parentIdx == INVALID_INDEX || parentIdx < nodeSlots_.size()));
+
+	for (std::uint32_t ancestorIdx = parentIdx; ancestorIdx != INVALID_INDEX; ancestorIdx = GetParent(ancestorIdx))
+	{
+		if (ancestorIdx == nodeIdx)
+		{
+			return false;
+		}
+	}
+
+	// Marked dirty, so the whole subtree is recomputed under its new parent
+	std::uint32_t slot = nodeSlots_[nodeIdx];
+	parentSlots_[slot] = (parentIdx == INVALID_INDEX) ? INVALID_INDEX : nodeSlots_[parentIdx];
+	isDirty_[slot] = 1u;
+	isLayoutStale_ = true;
+	return true;
+}
+
+void TransformHierarchy::SetLocalTransform(std::uint32_t nodeIdx, const Transform& localTransform)
+{
+	std::uint32_t slot = nodeSlots_[nodeIdx];
+	localTransforms_[slot] = localTransform;
+	isDirty_[slot] = 1u;
+}
+
+void TransformHierarchy::Layout()
+{
+	std::uint32_t numNodes = (std::uint32_t)nodeSlots_.size();
+
+	// Depths are found again every layout, as reparenting moves whole subtrees. Each node
+	//  walks up to the first ancestor of known depth, then gives depths to the nodes it passed.
+	std::vector<std::uint32_t> nodeDepths(numNodes, INVALID_INDEX);
+	std::vector<std::uint32_t> path;
+	for (std::uint32_t nodeIdx = 0u; nodeIdx < numNodes; nodeIdx++)
+	{
+		std::uint32_t ancestorIdx = nodeIdx;
+		while (ancestorIdx != INVALID_INDEX && nodeDepths[ancestorIdx] == INVALID_INDEX)
+		{
+			path.push_back(ancestorIdx);
+			ancestorIdx = GetParent(ancestorIdx);
+		}
+
+		std::uint32_t depth = (ancestorIdx == INVALID_INDEX) ? 0u : nodeDepths[ancestorIdx] + 1u;
+		for (; !path.empty(); path.pop_back(), depth++)
+		{
+			nodeDepths[path.back()] = depth;
+		}
+	}
+
+	// Counting sort by depth, which is stable, so nodes of a level keep the order they were added in
+	std::uint32_t numLevels = 0u;
+	for (std::uint32_t depth : nodeDepths)
+	{
+		numLevels = std::max(numLevels, depth + 1u);
+	}
+
+	levelStarts_.assign(numLevels + 1u, 0u);
+	for (std::uint32_t depth : nodeDepths)
+	{
+		levelStarts_[depth + 1u]++;
+	}
+	for (std::uint32_t level = 1u; level <= numLevels; level++)
+	{
+		levelStarts_[level] += levelStarts_[level - 1u];
+	}
+
+	std::vector<std::uint32_t> nextSlots(levelStarts_.begin(), levelStarts_.end() - 1);
+	std::vector<std::uint32_t> newNodeSlots(numNodes);
+	for (std::uint32_t nodeIdx = 0u; nodeIdx < numNodes; nodeIdx++)
+	{
+		newNodeSlots[nodeIdx] = nextSlots[nodeDepths[nodeIdx]]++;
+	}
+
+	for (std::uint32_t& parentSlot : parentSlots_)
+	{
+		if (parentSlot != INVALID_INDEX)
+		{
+			parentSlot = newNodeSlots[slotNodes_[parentSlot]];
+		}
+	}
+
+	Reorder(parentSlots_, slotNodes_, newNodeSlots);
+	Reorder(localTransforms_, slotNodes_, newNodeSlots);
+	Reorder(worldTransforms_, slotNodes_, newNodeSlots);
+	Reorder(worldMatrices_, slotNodes_, newNodeSlots);
+	Reorder(isDirty_, slotNodes_, newNodeSlots);
+	Reorder(slotNodes_, slotNodes_, newNodeSlots);
+	nodeSlots_.swap(newNodeSlots);
+
+	// Changes of the last update refer to the old slots
+	std::fill(isWorldChanged_.begin(), isWorldChanged_.end(), (std::uint8_t)0u);
+	firstChangedSlot_ = numNodes;
+	isLayoutStale_ = false;
+}
+
+std::uint32_t TransformHierarchy::UpdateWorldTransforms()
+{
+	if (isLayoutStale_)
+	{
+		Layout();
+	}
+
+	// Parents come before their children, so nothing before the first dirty node can change.
+	//  Flags are searched for rather than counted as they are set, so nodes on different
+	//  threads can be moved without sharing a counter.
+	std::uint32_t numSlots = (std::uint32_t)isDirty_.size();
+	std::uint32_t firstDirtySlot = (std::uint32_t)(std::find(isDirty_.begin(), isDirty_.end(), (std::uint8_t)1u) - isDirty_.begin());
+
+	// Flags from the first dirty node on are all rewritten below - clear the ones before it
+	if (firstChangedSlot_ < firstDirtySlot)
+	{
+		std::fill(isWorldChanged_.begin() + firstChangedSlot_, isWorldChanged_.begin() + firstDirtySlot, (std::uint8_t)0u);
+	}
+	firstChangedSlot_ = firstDirtySlot;
+
+	if (firstDirtySlot == numSlots)
+	{
+		return 0u;
+	}
+
+	// Each level only reads the one above it, which is complete by the time it starts
+	std::uint32_t numUpdated = 0u;
+	std::uint32_t level = (std::uint32_t)(std::upper_bound(levelStarts_.begin(), levelStarts_.end(), firstDirtySlot) - levelStarts_.begin()) - 1u;
+	for (; level + 1u < levelStarts_.size(); level++)
+	{
+		std::uint32_t begin = std::max(levelStarts_[level], firstDirtySlot);
+		std::uint32_t end = levelStarts_[level + 1u];
+
+		if (jobSystem_ && end - begin > NODES_PER_JOB)
+		{
+			std::atomic<std::uint32_t> numLevelUpdated(0u);
+			jobSystem_->ParallelFor(end - begin, NODES_PER_JOB, [this, begin, &numLevelUpdated](std::uint32_t jobBegin, std::uint32_t jobEnd) {
+				numLevelUpdated.fetch_add(UpdateSlots(begin + jobBegin, begin + jobEnd), std::memory_order_relaxed);
+			});
+			numUpdated += numLevelUpdated.load(std::memory_order_relaxed);
+		}
+		else
+		{
+			numUpdated += UpdateSlots(begin, end);
+		}
+	}
+
+	return numUpdated;
+}
+
+std::uint32_t TransformHierarchy::UpdateSlots(std::uint32_t begin, std::uint32_t end)
+{
+	std::uint32_t numUpdated = 0u;
+	for (std::uint32_t slot = begin; slot < end; slot++)
+	{
+		std::uint32_t parentSlot = parentSlots_[slot];
+		bool isChanged = isDirty_[slot] != 0u || (parentSlot != INVALID_INDEX && isWorldChanged_[parentSlot] != 0u);
+		isWorldChanged_[slot] = isChanged ? 1u : 0u;
+		if (!isChanged)
+		{
+			continue;
+		}
+
+		worldTransforms_[slot] = (parentSlot == INVALID_INDEX) ? localTransforms_[slot] : worldTransforms_[parentSlot] * localTransforms_[slot];
+		worldMatrices_[slot] = worldTransforms_[slot].GetTransformMatrix();
+		isDirty_[slot] = 0u;
+		numUpdated++;
+	}
+
+	return numUpdated;
+}
\ No newline at end of file
@@ -0,0 +1,85 @@
+#pragma once
+
+#include "Transform.h"
+#include "Matrix.h"
+#include "JobSystem.h"
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+// Local and world transforms of every node of a scene, as flat arrays in topological order.
+//  Nodes are laid out by depth, so each node comes after its parent, and every level of the
+//  tree is one contiguous range.
+// Setting a local transform only marks its node dirty. UpdateWorldTransforms then walks the
+//  levels once, from the first dirty node on, and recomputes the world transform of dirty
+//  nodes and of nodes whose parent changed - the rest of the tree costs a flag test per node.
+//  Nodes of a level never depend on each other, so wide levels are split across the job system.
+// Nodes are referred to by the index AddNode returned, which stays the same when nodes are
+//  laid out again after more are added or nodes are reparented.
+class TransformHierarchy
+{
+public:
+	static const std::uint32_t INVALID_INDEX;
+
+public:
+	TransformHierarchy();
+	TransformHierarchy(const TransformHierarchy&) = delete;
+	~TransformHierarchy() = default;
+
+	// Parent must already be in the hierarchy (or INVALID_INDEX for a root node). Not thread safe.
+	std::uint32_t AddNode(std::uint32_t parentIdx, const Transform& localTransform);
+	std::uint32_t GetNodeCount() const { return (std::uint32_t)nodeSlots_.size(); }
+	std::uint32_t GetParent(std::uint32_t nodeIdx) const;
+
+	// Moves a node and everything below it under another parent (or INVALID_INDEX to make
+	//  it a root), keeping its local transform. Returns false, changing nothing, if the new
+	//  parent is the node itself or below it. Not thread safe.
+	bool SetParent(std::uint32_t nodeIdx, std::uint32_t parentIdx);
+
+	// Different nodes may be set from different threads at once, as scene nodes update in parallel
+	void SetLocalTransform(std::uint32_t nodeIdx, const Transform& localTransform);
+	const Transform& GetLocalTransform(std::uint32_t nodeIdx) const { return localTransforms_[nodeSlots_[nodeIdx]]; }
+
+	// As of the last UpdateWorldTransforms, and whether it changed them
+	const Transform& GetWorldTransform(std::uint32_t nodeIdx) const { return worldTransforms_[nodeSlots_[nodeIdx]]; }
+	const Matrix& GetWorldMatrix(std::uint32_t nodeIdx) const { return worldMatrices_[nodeSlots_[nodeIdx]]; }
+	bool IsWorldChanged(std::uint32_t nodeIdx) const { return isWorldChanged_[nodeSlots_[nodeIdx]] != 0u; }
+
+	// Returns the number of world transforms recomputed. Local transforms must not be set
+	//  while it runs.
+	std::uint32_t UpdateWorldTransforms();
+
+	// Wide levels update in parallel on the given job system, or serially if it is null
+	void SetJobSystem(std::shared_ptr<JobSystem> jobSystem) { jobSystem_ = jobSystem; }
+
+private:
+	// Sorts the nodes by depth, keeping the order they were added in within a level
+	void Layout();
+	std::uint32_t UpdateSlots(std::uint32_t begin, std::uint32_t end);
+
+private:
+	// Indexed by slot, the position of the node in the current layout
+	std::vector<std::uint32_t> parentSlots_;
+	std::vector<Transform> localTransforms_;
+	std::vector<Transform> worldTransforms_;
+	std::vector<Matrix> worldMatrices_;
+	std::vector<std::uint8_t> isDirty_;
+	std::vector<std::uint8_t> isWorldChanged_;
+	std::vector<std::uint32_t> slotNodes_;
+
+	// Indexed by node
+	std::vector<std::uint32_t> nodeSlots_;
+
+	// First slot of each level, and one past the last slot of the deepest
+	std::vector<std::uint32_t> levelStarts_;
+
+	// Nodes added since the last layout are at the end, in the order they were added - a
+	//  valid order, but not one split into levels. Reparented nodes may come before their
+	//  new parents until the next layout.
+	bool isLayoutStale_;
+
+	// Slots before this one have isWorldChanged_ clear
+	std::uint32_t firstChangedSlot_;
+
+	std::shared_ptr<JobSystem> jobSystem_;
+};
\ No newline at end of file
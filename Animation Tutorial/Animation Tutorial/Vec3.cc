@@ -3,86 +3,4 @@
 const Vec3 Vec3::Zero = Vec3(0.f, 0.f, 0.f);
 const Vec3 Vec3::UnitX = Vec3(1.f, 0.f, 0.f);
 const Vec3 Vec3::UnitY = Vec3(0.f, 1.f, 0.f);
-const Vec3 Vec3::UnitZ = Vec3(0.f, 0.f, 1.f);
-
-Vec3::Vec3() : x(0.f), y(0.f), z(0.f)
-{}
-
-Vec3::Vec3(float _x, float _y, float _z) : x(_x), y(_y), z(_z)
-{}
-
-Vec3 Vec3::operator+(const Vec3& o) const
-{
-	return Vec3(x + o.x, y + o.y, z + o.z);
-}
-
-Vec3 Vec3::operator-(const Vec3 & o) const
-{
-	return Vec3(x - o.x, y - o.y, z - o.z);
-}
-
-Vec3 Vec3::operator-() const
-{
-	return Vec3(-x, -y, -z);
-}
-
-Vec3 Vec3::operator*(float s) const
-{
-	return Vec3(x * s, y * s, z * s);
-}
-
-Vec3 & Vec3::operator+=(const Vec3 & o)
-{
-	x += o.x;
-	y += o.y;
-	z += o.z;
-	return *this;
-}
-
-Vec3 & Vec3::operator-=(const Vec3 & o)
-{
-	x -= o.x;
-	y -= o.y;
-	z -= o.z;
-	return *this;
-}
-
-Vec3 & Vec3::operator*=(float s)
-{
-	x *= s;
-	y *= s;
-	z *= s;
-	return *this;
-}
-
-float Vec3::Dot(const Vec3 & _1, const Vec3 & _2)
-{
-	return
-		_1.x * _2.x +
-		_1.y * _2.y +
-		_1.z * _2.z;
-}
-
-Vec3 Vec3::Cross(const Vec3 & _1, const Vec3 & _2)
-{
-	return Vec3(
-		_1.y * _2.z - _1.z *_2.y,
-		_1.z * _2.x - _1.x * _2.z,
-		_1.x * _2.y - _1.y * _2.x
-		);
-}
-
-Vec3 Vec3::ComponentProduct(const Vec3 & l, const Vec3 & r)
-{
-	return Vec3(l.x * r.x, l.y * r.y, l.z * r.z);
-}
-
-float Vec3::Magnitude() const
-{
-	return sqrt(x * x + y * y + z * z);
-}
-
-Vec3 Vec3::Normal() const
-{
-	return *this * (1.f / Magnitude());
-}
+const Vec3 Vec3::UnitZ = Vec3(0.f, 0.f, 1.f);
\ No newline at end of file
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <cmath>
 #include <memory>
 
 struct Vec3
@@ -34,4 +35,88 @@ public:
 	const static Vec3 UnitX;
 	const static Vec3 UnitY;
 	const static Vec3 UnitZ;
-};
\ No newline at end of file
+};
+
+// Small enough to be inlined at every call site, which lets the compiler keep them in registers
+
+inline Vec3::Vec3() : x(0.f), y(0.f), z(0.f)
+{}
+
+inline Vec3::Vec3(float _x, float _y, float _z) : x(_x), y(_y), z(_z)
+{}
+
+inline Vec3 Vec3::operator+(const Vec3& o) const
+{
+	return Vec3(x + o.x, y + o.y, z + o.z);
+}
+
+inline Vec3 Vec3::operator-(const Vec3 & o) const
+{
+	return Vec3(x - o.x, y - o.y, z - o.z);
+}
+
+inline Vec3 Vec3::operator-() const
+{
+	return Vec3(-x, -y, -z);
+}
+
+inline Vec3 Vec3::operator*(float s) const
+{
+	return Vec3(x * s, y * s, z * s);
+}
+
+inline Vec3 & Vec3::operator+=(const Vec3 & o)
+{
+	x += o.x;
+	y += o.y;
+	z += o.z;
+	return *this;
+}
+
+inline Vec3 & Vec3::operator-=(const Vec3 & o)
+{
+	x -= o.x;
+	y -= o.y;
+	z -= o.z;
+	return *this;
+}
+
+inline Vec3 & Vec3::operator*=(float s)
+{
+	x *= s;
+	y *= s;
+	z *= s;
+	return *this;
+}
+
+inline float Vec3::Dot(const Vec3 & _1, const Vec3 & _2)
+{
+	return
+		_1.x * _2.x +
+		_1.y * _2.y +
+		_1.z * _2.z;
+}
+
+inline Vec3 Vec3::Cross(const Vec3 & _1, const Vec3 & _2)
+{
+	return Vec3(
+		_1.y * _2.z - _1.z *_2.y,
+		_1.z * _2.x - _1.x * _2.z,
+		_1.x * _2.y - _1.y * _2.x
+		);
+}
+
+inline Vec3 Vec3::ComponentProduct(const Vec3 & l, const Vec3 & r)
+{
+	return Vec3(l.x * r.x, l.y * r.y, l.z * r.z);
+}
+
+inline float Vec3::Magnitude() const
+{
+	return sqrtf(x * x + y * y + z * z);
+}
+
+inline Vec3 Vec3::Normal() const
+{
+	return *this * (1.f / Magnitude());
+}
\ No newline at end of file
@@ -1,10 +1,15 @@
 #include "maffs.h"
-
-#include <DirectXMath.h> // TODO KAM: Remove dependency on DirectXMath
+#include "Simd.h"
+#include <cmath>
 
 // http://gamedev.stackexchange.com/questions/28395/rotating-vector3-by-a-quaternion
 Vec3 operator*(const Vec3 &v, const Quaternion &q)
 {
+#if defined(MAFFS_SIMD4)
+	float rotated[4];
+	Simd4Store(rotated, Simd4QuatRotate(Simd4Set(v.x, v.y, v.z, 0.f), Simd4Load(&q.x)));
+	return Vec3(rotated[0], rotated[1], rotated[2]);
+#else
 	Vec3 u(q.x, q.y, q.z);
 
 	float s = q.w;
@@ -12,33 +17,47 @@ Vec3 operator*(const Vec3 &v, const Quaternion &q)
 	return u * 2.f * Vec3::Dot(u, v)
 		+ v * (s * s - Vec3::Dot(u, u))
 		+ Vec3::Cross(u, v) * 2.f * s;
+#endif
 }
 
 Vec4 operator*(const Matrix & m, const Vec4 & v)
 {
+#if defined(MAFFS_SIMD4)
+	// Multiply each row by the vector, then transpose so that the row sums line up
+	SimdFloat4 vec = Simd4Load(&v.x);
+	SimdFloat4 r0 = Simd4Mul(Simd4Load(m.m[0]), vec);
+	SimdFloat4 r1 = Simd4Mul(Simd4Load(m.m[1]), vec);
+	SimdFloat4 r2 = Simd4Mul(Simd4Load(m.m[2]), vec);
+	SimdFloat4 r3 = Simd4Mul(Simd4Load(m.m[3]), vec);
+	_MM_TRANSPOSE4_PS(r0, r1, r2, r3);
+
+	Vec4 result;
+	Simd4Store(&result.x, Simd4Add(Simd4Add(r0, r1), Simd4Add(r2, r3)));
+	return result;
+#else
 	return Vec4(
 		m._11 * v.x + m._12 * v.y + m._13 * v.z + m._14 * v.w,
 		m._21 * v.x + m._22 * v.y + m._23 * v.z + m._24 * v.w,
 		m._31 * v.x + m._32 * v.y + m._33 * v.z + m._34 * v.w,
 		m._41 * v.x + m._42 * v.y + m._43 * v.z + m._44 * v.w
 		);
+#endif
 }
 
+// Same matrix as DirectX::XMMatrixPerspectiveFovLH, for row vectors: view space z from
+//  nearZ to farZ maps to depth 0 to 1, and w takes the view space z
 Matrix PerspectiveLH(float fovY, float aspect, float nearZ, float farZ)
 {
-	DirectX::XMFLOAT4X4 tr;
-	Matrix m;
-	DirectX::XMStoreFloat4x4(&tr, DirectX::XMMatrixPerspectiveFovLH(fovY, aspect, nearZ, farZ));
-	
-	for (std::uint8_t i = 0u; i < 4u; i++)
-	{
-		for (std::uint8_t j = 0u; j < 4u; j++)
-		{
-			m.m[i][j] = tr.m[i][j];
-		}
-	}
-
-	return m;
+	float height = cosf(0.5f * fovY) / sinf(0.5f * fovY);
+	float width = height / aspect;
+	float range = farZ / (farZ - nearZ);
+
+	return Matrix(
+		width, 0.f, 0.f, 0.f,
+		0.f, height, 0.f, 0.f,
+		0.f, 0.f, range, 1.f,
+		0.f, 0.f, -range * nearZ, 0.f
+		);
 }
 
 float Radians(float angle)
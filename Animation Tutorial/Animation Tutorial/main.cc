@@ -5,10 +5,25 @@
 #undef WIN32_LEAN_AND_MEAN
 
 #include "DemoApp.h"
+#include <cstdlib>
+#include <cstring>
 
 int main(int argc, char** argv)
 {
-	Run(GetModuleHandle(nullptr));
+	// "--bake" writes baked meshes next to the FBX assets and exits, instead of running
+	if (argc > 1 && strcmp(argv[1], "--bake") == 0)
+	{
+		return BakeAssets() ? EXIT_SUCCESS : EXIT_FAILURE;
+	}
+
+	// "--crowd <count>" places that many characters in the scene instead of the default
+	std::uint32_t crowdSize = DEFAULT_CROWD_SIZE;
+	if (argc > 2 && strcmp(argv[1], "--crowd") == 0)
+	{
+		crowdSize = (std::uint32_t)strtoul(argv[2], nullptr, 10);
+	}
+
+	Run(GetModuleHandle(nullptr), crowdSize);
 
 	return EXIT_SUCCESS;
 }
\ No newline at end of file